@@ -0,0 +1,54 @@
+# 界面部分的源文件，由 app 和 bench 引用
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+QT += widgets
+
+include(../core/core.pri)
+
+SOURCES += \
+    $$PWD/componentmanager.cpp \
+    $$PWD/dimoduleconfigdialog.cpp \
+    $$PWD/domoduleconfigdialog.cpp \
+    $$PWD/findreplacepanel.cpp \
+    $$PWD/gotosymboldialog.cpp \
+    $$PWD/hostmoduleconfigdialog.cpp \
+    $$PWD/loopdevicedelegate.cpp \
+    $$PWD/loopdevicetablemodel.cpp \
+    $$PWD/loopmoduleconfigdialog.cpp \
+    $$PWD/loopmoduleconfigwidget.cpp \
+    $$PWD/mainwindow.cpp \
+    $$PWD/projecttreedelegate.cpp \
+    $$PWD/replicationdialog.cpp \
+    $$PWD/searchresultmodel.cpp \
+    $$PWD/symbolcompleterdelegate.cpp \
+    $$PWD/thememanager.cpp \
+    $$PWD/newprojectwizard.cpp \
+    $$PWD/hostmoduleconfigwidget.cpp \
+    $$PWD/dimoduleconfigwidget.cpp \
+    $$PWD/domoduleconfigwidget.cpp
+
+HEADERS += \
+    $$PWD/componentmanager.h \
+    $$PWD/dimoduleconfigdialog.h \
+    $$PWD/domoduleconfigdialog.h \
+    $$PWD/findreplacepanel.h \
+    $$PWD/gotosymboldialog.h \
+    $$PWD/hostmoduleconfigdialog.h \
+    $$PWD/loopdevicedelegate.h \
+    $$PWD/loopdevicetablemodel.h \
+    $$PWD/loopmoduleconfigdialog.h \
+    $$PWD/loopmoduleconfigwidget.h \
+    $$PWD/mainwindow.h \
+    $$PWD/projecttreedelegate.h \
+    $$PWD/replicationdialog.h \
+    $$PWD/searchresultmodel.h \
+    $$PWD/symbolcompleterdelegate.h \
+    $$PWD/thememanager.h \
+    $$PWD/newprojectwizard.h \
+    $$PWD/hostmoduleconfigwidget.h \
+    $$PWD/dimoduleconfigwidget.h \
+    $$PWD/domoduleconfigwidget.h
+
+RESOURCES += \
+    $$PWD/../resources.qrc
@@ -0,0 +1,639 @@
+#include "componentmanager.h"
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTreeView>     // 添加此头文件
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+#include <QVBoxLayout>
+
+#include "dimoduleconfigdialog.h"   // 添加DI模块配置对话框头文件
+#include "dimoduleconfigwidget.h"   // 添加DI模块配置部件头文件
+#include "domoduleconfigdialog.h"   // 添加DO模块配置对话框头文件
+#include "domoduleconfigwidget.h"   // 添加DO模块配置部件头文件
+#include "hostmoduleconfigdialog.h" // 添加主机模块配置对话框头文件
+#include "hostmoduleconfigwidget.h" // 添加主机模块配置部件头文件
+#include "loopmoduleconfigdialog.h" // 添加回路模块配置对话框头文件
+#include "loopmoduleconfigwidget.h" // 添加回路模块配置部件头文件
+#include "projectcommands.h"
+#include "replicationdialog.h"
+
+ComponentManager::ComponentManager(ProjectModel *model, QObject *parent)
+    : QObject(parent), m_model(model), m_symbolIndex(nullptr) {
+  // 初始化组件类型列表
+  initializeComponentTypes();
+
+  // 模块实例在首次使用时按组件创建，不再使用共享的单例
+  m_registry = new ModuleRegistry(this);
+  m_undoStack = new UndoStack(m_model, m_registry, this);
+  m_replicator = new ProjectReplicator(m_model, m_registry, m_undoStack, this);
+  connect(m_replicator, &ProjectReplicator::finished, this,
+          [this](const QModelIndex &firstIndex, int copies) {
+            if (m_replicateProgress) {
+              m_replicateProgress->hide();
+            }
+            emit componentsReplicated(firstIndex, copies);
+          });
+  connect(m_replicator, &ProjectReplicator::failed, this,
+          [this](const QString &errorString) {
+            if (m_replicateProgress) {
+              m_replicateProgress->hide();
+            }
+            QMessageBox::warning(nullptr, "复制组件", errorString);
+          });
+  connect(m_registry, &ModuleRegistry::moduleChanged, this,
+          [this](quint64 id) {
+            emit componentConfigChanged(m_model->indexForComponentId(id));
+          });
+  // 项目树中的拖放
+  connect(m_model, &ProjectModel::moveRequested, this,
+          &ComponentManager::moveComponents);
+}
+
+ModuleRegistry *ComponentManager::moduleRegistry() const { return m_registry; }
+
+void ComponentManager::setSymbolIndex(const SymbolIndex *index) {
+  m_symbolIndex = index;
+}
+
+UndoStack *ComponentManager::undoStack() const { return m_undoStack; }
+
+// 为配置界面接入变量名补全和撤销栈
+template <typename Editor>
+Editor *ComponentManager::prepareEditor(Editor *editor,
+                                        const QModelIndex &index) {
+  if (m_symbolIndex) {
+    editor->setSymbolIndex(m_symbolIndex);
+  }
+  editor->setUndoStack(m_undoStack, m_model->componentId(index));
+  return editor;
+}
+
+QModelIndex ComponentManager::addComponent(const QModelIndex &parent,
+                                           const QString &name,
+                                           const QString &type) {
+  AddComponentCommand *command =
+      new AddComponentCommand(parent, name, type, m_model);
+  m_undoStack->push(command);
+  return m_model->indexForComponentId(command->componentId());
+}
+
+QModelIndex ComponentManager::addComponents(const QModelIndex &parent,
+                                            const QStringList &names,
+                                            const QString &type, int row) {
+  if (names.isEmpty()) {
+    return QModelIndex();
+  }
+
+  QVector<ProjectModel::NodeSpec> nodes;
+  nodes.reserve(names.size());
+  for (const QString &name : names) {
+    ProjectModel::NodeSpec node;
+    node.name = name;
+    node.type = type;
+    node.componentId = 0;
+    node.childCount = 0;
+    nodes.append(node);
+  }
+
+  QString text = names.size() == 1
+                     ? QString("添加组件 %1").arg(names.first())
+                     : QString("添加 %1 个组件").arg(names.size());
+  AddComponentsCommand *command =
+      new AddComponentsCommand(text, parent, row, nodes, m_model);
+  m_undoStack->push(command);
+  return m_model->indexForComponentId(command->firstComponentId());
+}
+
+void ComponentManager::deleteComponent(const QModelIndex &index) {
+  if (index.isValid() && index.parent().isValid()) {
+    m_undoStack->push(new DeleteComponentCommand(index, m_model));
+  }
+}
+
+void ComponentManager::moveComponent(const QModelIndex &index,
+                                     const QModelIndex &newParent) {
+  if (index.isValid() && index.parent().isValid() && newParent.isValid()) {
+    m_undoStack->push(new MoveComponentCommand(
+        QString("移动组件 %1").arg(m_model->nodeName(index)), index, newParent,
+        -1, m_model));
+  }
+}
+
+void ComponentManager::moveComponents(const QList<quint64> &componentIds,
+                                      const QModelIndex &newParent, int row) {
+  if (componentIds.isEmpty() || !newParent.isValid()) {
+    return;
+  }
+
+  QString text =
+      componentIds.size() == 1
+          ? QString("移动组件 %1")
+                .arg(m_model->nodeName(
+                    m_model->indexForComponentId(componentIds.first())))
+          : QString("移动 %1 个组件").arg(componentIds.size());
+  m_undoStack->push(
+      new MoveComponentsCommand(text, componentIds, newParent, row, m_model));
+}
+
+void ComponentManager::renameComponent(const QModelIndex &index,
+                                       const QString &name) {
+  if (index.isValid() && name != m_model->nodeName(index)) {
+    m_undoStack->push(new RenameComponentCommand(index, name, m_model));
+  }
+}
+
+// 获取或创建组件对应的模块，首次访问时才解析保存的配置段
+QObject *ComponentManager::getOrCreateModule(const QModelIndex &index) {
+  quint64 id = m_model->componentId(index);
+  if (QObject *module = m_registry->module(id)) {
+    return module;
+  }
+
+  return m_registry->acquire(id, m_model->nodeType(index),
+                             m_model->nodeConfig(index),
+                             m_model->nodeName(index));
+}
+
+void ComponentManager::storeConfiguration(quint64 id) {
+  QModelIndex index = m_model->indexForComponentId(id);
+  if (index.isValid() && m_registry->contains(id)) {
+    // 内容未变化时模型不会发出 dataChanged
+    m_model->setNodeConfig(index, m_registry->configuration(id));
+  }
+  m_registry->clearModified(id);
+}
+
+void ComponentManager::storeConfigurations() {
+  for (quint64 id : m_registry->modifiedIds()) {
+    storeConfiguration(id);
+  }
+}
+
+void ComponentManager::releaseModules(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  for (int row = 0; row < m_model->rowCount(index); ++row) {
+    releaseModules(m_model->index(row, 0, index));
+  }
+
+  quint64 id = m_model->componentId(index);
+  if (m_registry->isModified(id)) {
+    storeConfiguration(id);
+  }
+  m_registry->release(id);
+}
+
+void ComponentManager::clearModules() {
+  // 正在生成的副本属于旧项目
+  m_replicator->cancel();
+  if (m_replicateProgress) {
+    m_replicateProgress->hide();
+  }
+  m_registry->clear();
+  // 撤销历史中的组件编号属于旧项目
+  m_undoStack->clear();
+}
+
+void ComponentManager::showHostModuleConfigDialog(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  // 获取或创建该组件对应的主机模块实例
+  HostModule *hostModule = moduleFor<HostModule>(index);
+
+  // 创建主机模块配置对话框
+  HostModuleConfigDialog dialog(hostModule);
+
+  if (dialog.exec() == QDialog::Accepted) {
+    // 配置已保存，可以在这里更新项目树中的组件信息
+    // 例如，更新组件名称或图标等
+
+    // 可以根据配置更新组件显示名称
+    HostConfiguration config = hostModule->getConfiguration();
+    if (!config.hostName.isEmpty()) {
+      renameComponent(index, config.hostName);
+    }
+  }
+}
+
+ComponentManager::~ComponentManager() { delete m_replicateProgress; }
+
+void ComponentManager::initializeComponentTypes() {
+  // 定义组件类型及其层级关系
+  // 第一层级 - 主机模块
+  ComponentInfo hostModule;
+  hostModule.name = "主机模块";
+  hostModule.type = "HostModule";
+  hostModule.description = "控制器主机模块";
+  hostModule.level = 1;
+  hostModule.iconPath = ":/icons/host.png"; // 设置图标路径
+  m_componentTypes.append(hostModule);
+
+  // 第二层级 - 其他模块
+  QStringList secondLevelModules = {"回路模块", "DI模块",     "DO模块",
+                                    "AI模块",   "继电器模块", "通信模块"};
+
+  QStringList moduleTypes = {"LoopModule", "DIModule",    "DOModule",
+                             "AIModule",   "RelayModule", "CommModule"};
+
+  QStringList iconPaths = {":/icons/loop.png",  ":/icons/di.png",
+                           ":/icons/do.png",    ":/icons/ai.png",
+                           ":/icons/relay.png", ":/icons/comm.png"};
+
+  for (int i = 0; i < secondLevelModules.size(); ++i) {
+    ComponentInfo module;
+    module.name = secondLevelModules[i];
+    module.type = i < moduleTypes.size() ? moduleTypes[i] : "UnknownModule";
+    module.description =
+        QString("%1，连接到主机模块").arg(secondLevelModules[i]);
+    module.level = 2;
+    module.iconPath =
+        i < iconPaths.size() ? iconPaths[i] : ":/icons/default.png";
+    m_componentTypes.append(module);
+  }
+}
+
+void ComponentManager::showAddComponentDialog() {
+  QDialog dialog;
+  dialog.setWindowTitle("添加组件");
+  dialog.setMinimumWidth(400);
+
+  QVBoxLayout *layout = new QVBoxLayout(&dialog);
+
+  QLabel *label = new QLabel("选择要添加的组件类型:");
+  layout->addWidget(label);
+
+  QListWidget *componentList = new QListWidget(&dialog);
+  for (const ComponentInfo &component : m_componentTypes) {
+    QListWidgetItem *item = new QListWidgetItem(component.name);
+    item->setToolTip(component.description);
+    item->setData(Qt::UserRole, component.type);
+    item->setData(Qt::UserRole + 1, component.level);
+    item->setData(Qt::UserRole + 2, component.iconPath);
+
+    // 设置图标
+    if (!component.iconPath.isEmpty()) {
+      item->setIcon(QIcon(component.iconPath));
+    }
+
+    componentList->addItem(item);
+  }
+  layout->addWidget(componentList);
+
+  // 添加组件命名输入框
+  QHBoxLayout *nameLayout = new QHBoxLayout();
+  QLabel *nameLabel = new QLabel("组件名称:");
+  QLineEdit *nameEdit = new QLineEdit();
+  nameLayout->addWidget(nameLabel);
+  nameLayout->addWidget(nameEdit);
+  layout->addLayout(nameLayout);
+
+  // 一次添加多个同类组件时名称后附加序号
+  QHBoxLayout *countLayout = new QHBoxLayout();
+  QLabel *countLabel = new QLabel("数量:");
+  QSpinBox *countSpinBox = new QSpinBox();
+  countSpinBox->setRange(1, 9999);
+  countLayout->addWidget(countLabel);
+  countLayout->addWidget(countSpinBox);
+  countLayout->addStretch();
+  layout->addLayout(countLayout);
+
+  // 当选择组件时，自动填充默认名称
+  connect(componentList, &QListWidget::currentItemChanged,
+          [nameEdit](QListWidgetItem *current, QListWidgetItem *) {
+            if (current) {
+              nameEdit->setText(current->text());
+              nameEdit->selectAll();
+            }
+          });
+
+  // 添加双击处理
+  connect(componentList, &QListWidget::itemDoubleClicked,
+          [&dialog](QListWidgetItem *) { dialog.accept(); });
+
+  QDialogButtonBox *buttonBox = new QDialogButtonBox(
+      QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+  layout->addWidget(buttonBox);
+
+  connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+  connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+  // 如果没有选择组件，禁用确定按钮
+  QPushButton *okButton = buttonBox->button(QDialogButtonBox::Ok);
+  okButton->setEnabled(false);
+  connect(componentList, &QListWidget::currentItemChanged,
+          [okButton](QListWidgetItem *current, QListWidgetItem *) {
+            okButton->setEnabled(current != nullptr);
+          });
+
+  if (dialog.exec() == QDialog::Accepted) {
+    QListWidgetItem *selectedItem = componentList->currentItem();
+    if (selectedItem) {
+      QString componentName = nameEdit->text().trimmed();
+      if (componentName.isEmpty()) {
+        componentName = selectedItem->text();
+      }
+
+      QString componentType = selectedItem->data(Qt::UserRole).toString();
+      int componentLevel = selectedItem->data(Qt::UserRole + 1).toInt();
+      QString iconPath = selectedItem->data(Qt::UserRole + 2).toString();
+
+      // 创建组件信息并发送信号
+      ComponentInfo component;
+      component.name = componentName;
+      component.type = componentType;
+      component.level = componentLevel;
+      component.iconPath = iconPath;
+
+      // 查找完整的组件信息
+      for (const ComponentInfo &info : m_componentTypes) {
+        if (info.type == componentType) {
+          component.description = info.description;
+          break;
+        }
+      }
+
+      emit componentAdded(component, countSpinBox->value());
+    }
+  }
+}
+
+// 取得某类组件的属性面板并切换到 index 对应的模块，只填充当前可见的内容
+template <typename Panel, typename Module>
+Panel *ComponentManager::configPanel(const QModelIndex &index,
+                                     bool *created) {
+  Module *module = moduleFor<Module>(index);
+  QPointer<QWidget> &cached = m_configPanels[m_model->nodeType(index)];
+  Panel *panel = qobject_cast<Panel *>(cached.data());
+  *created = !panel;
+  if (panel) {
+    panel->setModule(module);
+  } else {
+    panel = new Panel(module);
+    cached = panel;
+  }
+  return panel;
+}
+
+// 编辑器面板首次创建时接入补全和撤销栈，复用时只更新组件编号
+template <typename Panel, typename Module>
+QWidget *ComponentManager::editorPanel(const QModelIndex &index) {
+  bool created = false;
+  Panel *panel = configPanel<Panel, Module>(index, &created);
+  if (created) {
+    return prepareEditor(panel, index);
+  }
+  panel->setUndoStack(m_undoStack, m_model->componentId(index));
+  return panel;
+}
+
+QWidget *ComponentManager::getComponentConfigWidget(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return nullptr;
+  }
+
+  // 根据组件类型显示不同的配置对话框
+  QString componentType = m_model->nodeType(index);
+
+  if (componentType == "DIModule") {
+    return editorPanel<DIModuleConfigWidget, DIModule>(index);
+  } else if (componentType == "DOModule") {
+    return editorPanel<DOModuleConfigWidget, DOModule>(index);
+  } else if (componentType == "HostModule") {
+    bool created = false;
+    return configPanel<HostModuleConfigWidget, HostModule>(index, &created);
+  } else if (componentType == "LoopModule") {
+    return editorPanel<LoopModuleConfigWidget, LoopModule>(index);
+  }
+
+  if (!m_placeholderPanel) {
+    m_placeholderPanel = new QLabel("此组件暂无详细配置界面或尚未实现。");
+  }
+  return m_placeholderPanel;
+}
+
+void ComponentManager::showConfigureComponentDialog(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  // 根据组件类型显示不同的配置对话框
+  QString componentType = m_model->nodeType(index);
+
+  if (componentType == "DIModule") {
+    showDIModuleConfigDialog(index);
+  } else if (componentType == "DOModule") {
+    showDOModuleConfigDialog(index);
+  } else if (componentType == "HostModule") {
+    showHostModuleConfigDialog(index);
+  } else if (componentType == "LoopModule") {
+    showLoopModuleConfigDialog(index);
+  } else {
+    // 其他类型的组件配置
+    QMessageBox::information(nullptr, "配置组件",
+                             "组件配置功能将在后续版本中实现");
+  }
+}
+
+void ComponentManager::showDIModuleConfigDialog(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  // 创建DI模块配置对话框
+  DIModuleConfigDialog dialog(moduleFor<DIModule>(index));
+  prepareEditor(&dialog, index);
+
+  if (dialog.exec() == QDialog::Accepted) {
+    // 配置已保存，可以在这里更新项目树中的组件信息
+    // 例如，更新组件名称或图标等
+  }
+}
+
+void ComponentManager::showDOModuleConfigDialog(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  // 创建DO模块配置对话框
+  DOModuleConfigDialog dialog(moduleFor<DOModule>(index));
+  prepareEditor(&dialog, index);
+
+  if (dialog.exec() == QDialog::Accepted) {
+    // 配置已保存，可以在这里更新项目树中的组件信息
+    // 例如，更新组件名称或图标等
+  }
+}
+
+void ComponentManager::showLoopModuleConfigDialog(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  // 创建回路模块配置对话框
+  LoopModuleConfigDialog dialog(moduleFor<LoopModule>(index));
+  prepareEditor(&dialog, index);
+
+  if (dialog.exec() == QDialog::Accepted) {
+    // 配置已保存
+  }
+}
+
+void ComponentManager::showDeleteComponentDialog(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  QMessageBox msgBox;
+  msgBox.setWindowTitle("删除组件");
+  msgBox.setText(
+      QString("确定要删除组件 \"%1\" 吗?").arg(m_model->nodeName(index)));
+  msgBox.setInformativeText("删除后可以通过撤销恢复。");
+  msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+  msgBox.setDefaultButton(QMessageBox::No);
+
+  if (msgBox.exec() == QMessageBox::Yes) {
+    emit componentDeleted(index);
+  }
+}
+
+void ComponentManager::showReplicateDialog(const QModelIndex &index) {
+  if (!index.isValid() || !index.parent().isValid()) {
+    return;
+  }
+
+  ReplicationDialog dialog(m_model->nodeName(index));
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+  ReplicationRules rules = dialog.rules();
+  if (!m_replicator->start(index, rules)) {
+    return;
+  }
+
+  if (!m_replicateProgress) {
+    m_replicateProgress = new QProgressDialog();
+    m_replicateProgress->setWindowTitle("复制组件");
+    m_replicateProgress->setCancelButtonText("取消");
+    m_replicateProgress->setWindowModality(Qt::ApplicationModal);
+    m_replicateProgress->setAutoClose(false);
+    m_replicateProgress->setAutoReset(false);
+    connect(m_replicator, &ProjectReplicator::progressChanged,
+            m_replicateProgress.data(),
+            [this](int finishedCopies, int totalCopies) {
+              m_replicateProgress->setMaximum(totalCopies);
+              m_replicateProgress->setValue(finishedCopies);
+            });
+    // 已生成的副本全部丢弃，项目树不变
+    connect(m_replicateProgress.data(), &QProgressDialog::canceled,
+            m_replicator, &ProjectReplicator::cancel);
+  }
+
+  m_replicateProgress->setLabelText(
+      QString("正在复制 %1...").arg(m_model->nodeName(index)));
+  m_replicateProgress->setRange(0, rules.copies);
+  m_replicateProgress->setValue(0);
+  m_replicateProgress->show();
+}
+
+void ComponentManager::showMoveComponentDialog(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  QDialog dialog;
+  dialog.setWindowTitle("移动组件");
+  dialog.setMinimumWidth(400);
+
+  QVBoxLayout *layout = new QVBoxLayout(&dialog);
+
+  QLabel *label = new QLabel(
+      QString("选择 \"%1\" 的新位置:").arg(m_model->nodeName(index)));
+  layout->addWidget(label);
+
+  // 创建树形视图显示可能的目标位置
+  QTreeView *treeView = new QTreeView(&dialog);
+  treeView->setModel(m_model);
+  treeView->expandAll();
+  layout->addWidget(treeView);
+
+  QDialogButtonBox *buttonBox = new QDialogButtonBox(
+      QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+  layout->addWidget(buttonBox);
+
+  connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+  connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+  if (dialog.exec() == QDialog::Accepted) {
+    QModelIndex selectedIndex = treeView->currentIndex();
+    if (selectedIndex.isValid() && selectedIndex != index) {
+      emit componentMoved(index, selectedIndex);
+    }
+  }
+}
+
+void ComponentManager::moveComponentUp(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  QModelIndex parentIndex = index.parent();
+  if (!parentIndex.isValid()) {
+    return;
+  }
+
+  int row = index.row();
+  if (row <= 0) {
+    // 已经是第一个，无法上移
+    return;
+  }
+
+  // 整个子树在原父节点下移动到上一行
+  quint64 id = m_model->componentId(index);
+  m_undoStack->push(new MoveComponentCommand(
+      QString("上移组件 %1").arg(m_model->nodeName(index)), index,
+      parentIndex, row - 1, m_model));
+
+  // 发出顺序变更信号
+  emit componentOrderChanged(m_model->indexForComponentId(id), true);
+}
+
+void ComponentManager::moveComponentDown(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  QModelIndex parentIndex = index.parent();
+  if (!parentIndex.isValid()) {
+    return;
+  }
+
+  int row = index.row();
+  if (row >= m_model->rowCount(parentIndex) - 1) {
+    // 已经是最后一个，无法下移
+    return;
+  }
+
+  // 目标位置按移动前的行号计算，移到下一行之后
+  quint64 id = m_model->componentId(index);
+  m_undoStack->push(new MoveComponentCommand(
+      QString("下移组件 %1").arg(m_model->nodeName(index)), index,
+      parentIndex, row + 2, m_model));
+
+  // 发出顺序变更信号
+  emit componentOrderChanged(m_model->indexForComponentId(id), false);
+}
+
+QList<ComponentInfo> ComponentManager::getComponentTypes() const {
+  return m_componentTypes;
+}
@@ -0,0 +1,139 @@
+#ifndef COMPONENTMANAGER_H
+#define COMPONENTMANAGER_H
+
+#include "dimodule.h"
+#include "domodule.h"
+#include "hostmodule.h"
+#include "loopmodule.h"
+#include "moduleregistry.h"
+#include "projectmodel.h"
+#include "projectreplicator.h"
+#include "symbolindex.h"
+#include "undostack.h"
+#include <QHash>
+#include <QLabel>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QString>
+
+// 组件信息结构体
+struct ComponentInfo {
+  QString name;
+  QString type;
+  QString description;
+  int level;
+  QString iconPath;
+};
+
+class ComponentManager : public QObject {
+  Q_OBJECT
+
+public:
+  explicit ComponentManager(ProjectModel *model, QObject *parent = nullptr);
+  ~ComponentManager();
+
+  void showAddComponentDialog();
+  void showConfigureComponentDialog(const QModelIndex &index = QModelIndex());
+  void showDeleteComponentDialog(const QModelIndex &index);
+  void showMoveComponentDialog(const QModelIndex &index);
+  void moveComponentUp(const QModelIndex &index);
+  void moveComponentDown(const QModelIndex &index);
+  // 按规则把主机连同下属模块复制多份，副本在后台生成后一次插入
+  void showReplicateDialog(const QModelIndex &index);
+
+  // 获取组件的属性面板。每种组件类型只创建一个面板，之后选中同类组件时
+  // 切换到该组件的模块。面板创建时没有父对象，由显示它的容器接管。
+  QWidget *getComponentConfigWidget(const QModelIndex &index);
+
+  // 添加DI模块配置对话框
+  void showDIModuleConfigDialog(const QModelIndex &index);
+
+  // 添加DO模块配置对话框
+  void showDOModuleConfigDialog(const QModelIndex &index);
+
+  // 添加主机模块配置对话框
+  void showHostModuleConfigDialog(const QModelIndex &index);
+
+  // 添加回路模块配置对话框
+  void showLoopModuleConfigDialog(const QModelIndex &index);
+
+  QList<ComponentInfo> getComponentTypes() const;
+
+  // 将已创建模块的配置写回项目树节点，保存项目前调用
+  void storeConfigurations();
+
+  // 释放节点及其子节点对应的模块，释放前会写回配置
+  void releaseModules(const QModelIndex &index);
+
+  // 项目被替换时丢弃所有模块实例
+  void clearModules();
+
+  ModuleRegistry *moduleRegistry() const;
+
+  // 配置界面中变量名输入的自动补全来源，可为空
+  void setSymbolIndex(const SymbolIndex *index);
+
+  // 项目的撤销栈，组件的增删、移动、重命名和配置界面中的编辑都经过它
+  UndoStack *undoStack() const;
+
+  // 以可撤销的方式修改项目树
+  QModelIndex addComponent(const QModelIndex &parent, const QString &name,
+                           const QString &type);
+  // 在 parent 的第 row 行起添加一组同类组件，作为一步撤销，视图只收到一次
+  // 行插入通知。row 为 -1 时追加到末尾，返回第一个新组件。
+  QModelIndex addComponents(const QModelIndex &parent, const QStringList &names,
+                            const QString &type, int row = -1);
+  void deleteComponent(const QModelIndex &index);
+  void moveComponent(const QModelIndex &index, const QModelIndex &newParent);
+  // 把多个组件依次放到 newParent 的第 row 行之前，作为一步撤销
+  void moveComponents(const QList<quint64> &componentIds,
+                      const QModelIndex &newParent, int row = -1);
+  void renameComponent(const QModelIndex &index, const QString &name);
+
+signals:
+  // 添加对话框确认后发出，count 为要添加的数量
+  void componentAdded(const ComponentInfo &component, int count);
+  void componentDeleted(const QModelIndex &index);
+  void componentMoved(const QModelIndex &index, const QModelIndex &newParent);
+  void componentOrderChanged(const QModelIndex &index, bool moveUp);
+  void componentConfigChanged(const QModelIndex &index);
+  // 复制完成，firstIndex 为第一个副本
+  void componentsReplicated(const QModelIndex &firstIndex, int copies);
+
+private:
+  void initializeComponentTypes();
+  QList<ComponentInfo> m_componentTypes;
+
+  ProjectModel *m_model;
+
+  // 每个组件按组件编号对应一个独立的模块实例
+  // 项目加载时只保存原始配置段，首次选中或配置组件时才创建模块
+  ModuleRegistry *m_registry;
+  const SymbolIndex *m_symbolIndex;
+  UndoStack *m_undoStack;
+  ProjectReplicator *m_replicator;
+  // 复制进度，取消时停止生成，首次复制时创建
+  QPointer<QProgressDialog> m_replicateProgress;
+
+  // 按组件类型缓存的属性面板，没有专用界面的类型共用一个提示标签
+  QHash<QString, QPointer<QWidget>> m_configPanels;
+  QPointer<QLabel> m_placeholderPanel;
+
+  // 添加辅助方法
+  QObject *getOrCreateModule(const QModelIndex &index);
+  void storeConfiguration(quint64 id);
+  template <typename Editor>
+  Editor *prepareEditor(Editor *editor, const QModelIndex &index);
+  template <typename Panel, typename Module>
+  Panel *configPanel(const QModelIndex &index, bool *created);
+  template <typename Panel, typename Module>
+  QWidget *editorPanel(const QModelIndex &index);
+
+  template <typename T> T *moduleFor(const QModelIndex &index) {
+    return qobject_cast<T *>(getOrCreateModule(index));
+  }
+};
+
+#endif // COMPONENTMANAGER_H
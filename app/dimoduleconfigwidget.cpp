@@ -1,20 +1,104 @@
 #include "dimoduleconfigwidget.h"
+#include "projectcommands.h"
+#include "symbolcompleterdelegate.h"
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QLabel>
 #include <QMessageBox>
+#include <QSignalBlocker>
 #include <QSplitter>
 #include <QVBoxLayout>
 
 
 DIModuleConfigWidget::DIModuleConfigWidget(DIModule *module, QWidget *parent)
-    : QWidget(parent), m_module(module), m_currentChannelIndex(0) {
+    : QWidget(parent), m_module(nullptr), m_currentChannelIndex(0),
+      m_undoStack(nullptr), m_componentId(0) {
   setupUI();
-  updateBitTable(m_currentChannelIndex);
+  setModule(module);
 }
 
 DIModuleConfigWidget::~DIModuleConfigWidget() {}
 
+void DIModuleConfigWidget::setSymbolIndex(const SymbolIndex *index) {
+  int nameColumn = 1; // 变量名列的逻辑索引
+  m_bitTable->setItemDelegateForColumn(
+      nameColumn, new SymbolCompleterDelegate(index, m_bitTable));
+}
+
+void DIModuleConfigWidget::setModule(DIModule *module) {
+  disconnect(m_moduleConnection);
+  disconnect(m_countConnection);
+  disconnect(m_valuesConnection);
+  m_module = module;
+  m_valuesConnection = connect(
+      m_module, &DIModule::valuesChanged, this,
+      [this](const QVector<BitEdge> &edges) {
+        for (const BitEdge &edge : edges) {
+          if (edge.channel != m_currentChannelIndex) {
+            continue;
+          }
+          QComboBox *valueCombo = qobject_cast<QComboBox *>(
+              m_bitTable->cellWidget(edge.bit, 2));
+          if (valueCombo) {
+            // 实时值不经过撤销栈，也不标记配置已修改
+            QSignalBlocker blocker(valueCombo);
+            valueCombo->setCurrentIndex(edge.rising ? 1 : 0);
+          }
+        }
+      });
+  // 只刷新撤销或重做涉及当前通道的情况
+  m_moduleConnection = connect(
+      m_module, &DIModule::channelsChanged, this,
+      [this](int firstChannel, int lastChannel) {
+        if (m_undoStack && m_undoStack->isApplying() &&
+            m_currentChannelIndex >= firstChannel &&
+            m_currentChannelIndex <= lastChannel) {
+          updateBitTable(m_currentChannelIndex);
+        }
+      });
+  m_countConnection =
+      connect(m_module, &DIModule::channelCountChanged, this, [this]() {
+        if (m_undoStack && m_undoStack->isApplying()) {
+          loadChannels();
+          updateBitTable(m_currentChannelIndex);
+        }
+      });
+
+  loadChannels();
+  updateBitTable(m_currentChannelIndex);
+}
+
+void DIModuleConfigWidget::setUndoStack(UndoStack *stack, quint64 componentId) {
+  m_undoStack = stack;
+  m_componentId = componentId;
+}
+
+void DIModuleConfigWidget::applyBitVariable(int bit,
+                                            const DIBitVariable &variable) {
+  if (!m_undoStack) {
+    m_module->setBitVariable(m_currentChannelIndex, bit, variable);
+    return;
+  }
+  // 撤销时刷新表格会触发值下拉框的信号，此时模块已是目标状态
+  if (m_undoStack->isApplying()) {
+    return;
+  }
+
+  // 刷新表格或切换模块时值下拉框也会发出信号，内容未变时不记录
+  DIBitVariable current = m_module->getBitVariable(m_currentChannelIndex, bit);
+  if (variable.name == current.name &&
+      variable.description == current.description &&
+      variable.isGlobal == current.isGlobal &&
+      variable.value == current.value) {
+    return;
+  }
+
+  DIBitVariablesCommand *command =
+      new DIBitVariablesCommand("编辑位变量", m_componentId);
+  command->addChange(m_currentChannelIndex, bit, current, variable);
+  m_undoStack->push(command);
+}
+
 void DIModuleConfigWidget::setupUI() {
   QVBoxLayout *mainLayout = new QVBoxLayout(this);
 
@@ -26,21 +110,6 @@ void DIModuleConfigWidget::setupUI() {
   m_channelCountCombo->addItem("16通道", 16);
   m_channelCountCombo->addItem("32通道", 32);
 
-  // 设置当前选中的通道数量
-  int currentIndex = 0;
-  switch (m_module->getChannelCount()) {
-  case 8:
-    currentIndex = 0;
-    break;
-  case 16:
-    currentIndex = 1;
-    break;
-  case 32:
-    currentIndex = 2;
-    break;
-  }
-  m_channelCountCombo->setCurrentIndex(currentIndex);
-
   channelCountLayout->addWidget(channelCountLabel);
   channelCountLayout->addWidget(m_channelCountCombo);
 
@@ -48,11 +117,6 @@ void DIModuleConfigWidget::setupUI() {
   QLabel *channelSelectLabel = new QLabel("选择通道:", this);
   m_channelSelectCombo = new QComboBox(this);
 
-  // 根据当前通道数量填充通道选择下拉框
-  for (int i = 0; i < m_module->getChannelCount(); ++i) {
-    m_channelSelectCombo->addItem(QString("通道 %1").arg(i), i);
-  }
-
   channelCountLayout->addSpacing(20);
   channelCountLayout->addWidget(channelSelectLabel);
   channelCountLayout->addWidget(m_channelSelectCombo);
@@ -117,6 +181,22 @@ void DIModuleConfigWidget::setupUI() {
           });
 }
 
+void DIModuleConfigWidget::loadChannels() {
+  // 按模块填充下拉框，不触发通道数量和通道选择的槽函数
+  QSignalBlocker countBlocker(m_channelCountCombo);
+  QSignalBlocker selectBlocker(m_channelSelectCombo);
+
+  int countIndex = m_channelCountCombo->findData(m_module->getChannelCount());
+  m_channelCountCombo->setCurrentIndex(countIndex >= 0 ? countIndex : 0);
+
+  m_channelSelectCombo->clear();
+  for (int i = 0; i < m_module->getChannelCount(); ++i) {
+    m_channelSelectCombo->addItem(QString("通道 %1").arg(i), i);
+  }
+  m_currentChannelIndex = 0;
+  m_channelSelectCombo->setCurrentIndex(0);
+}
+
 void DIModuleConfigWidget::updateBitTable(int channelIndex) {
   if (channelIndex < 0 || channelIndex >= m_module->getChannelCount()) {
     return;
@@ -162,7 +242,7 @@ void DIModuleConfigWidget::updateBitTable(int channelIndex) {
       valueCombo = new QComboBox();
       valueCombo->addItem("0", 0);
       valueCombo->addItem("1", 1);
-      valueCombo->setCurrentIndex(channel->bits[j].value);
+      valueCombo->setCurrentIndex(m_module->bitValue(channelIndex, j));
 
       // 连接值变化信号
       connect(valueCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
@@ -170,12 +250,12 @@ void DIModuleConfigWidget::updateBitTable(int channelIndex) {
                 DIBitVariable variable =
                     m_module->getBitVariable(m_currentChannelIndex, j);
                 variable.value = index;
-                m_module->setBitVariable(m_currentChannelIndex, j, variable);
+                applyBitVariable(j, variable);
               });
 
       m_bitTable->setCellWidget(j, 2, valueCombo);
     } else {
-      valueCombo->setCurrentIndex(channel->bits[j].value);
+      valueCombo->setCurrentIndex(m_module->bitValue(channelIndex, j));
     }
 
     // 描述
@@ -231,13 +311,28 @@ void DIModuleConfigWidget::onBitVariableChanged(int row, int column) {
   variable.isGlobal = true; // 默认设置为全局变量
   variable.value = value;   // 设置值
 
-  m_module->setBitVariable(m_currentChannelIndex, row, variable);
+  applyBitVariable(row, variable);
 }
 
 void DIModuleConfigWidget::onChannelCountChanged(int index) {
   // 获取新的通道数量
   int newChannelCount = m_channelCountCombo->itemData(index).toInt();
 
+  // 经过撤销栈时由 dataChanged 刷新下拉框和表格
+  if (m_undoStack) {
+    if (m_undoStack->isApplying()) {
+      return;
+    }
+    DIChannelCountCommand *command = new DIChannelCountCommand(
+        "修改通道数量", m_componentId, m_module, newChannelCount);
+    if (command->isEmpty()) {
+      delete command;
+      return;
+    }
+    m_undoStack->push(command);
+    return;
+  }
+
   // 更新模块的通道数量
   m_module->setChannelCount(newChannelCount);
 
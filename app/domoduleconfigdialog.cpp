@@ -1,4 +1,6 @@
 #include "domoduleconfigdialog.h"
+#include "projectcommands.h"
+#include "symbolcompleterdelegate.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -7,7 +9,8 @@
 #include <QSplitter>
 
 DOModuleConfigDialog::DOModuleConfigDialog(DOModule *module, QWidget *parent)
-    : QDialog(parent), m_module(module), m_currentChannelIndex(0)
+    : QDialog(parent), m_module(module), m_currentChannelIndex(0),
+      m_undoStack(nullptr), m_componentId(0)
 {
     setWindowTitle("DO模块配置");
     setMinimumSize(600, 400);
@@ -20,6 +23,46 @@ DOModuleConfigDialog::~DOModuleConfigDialog()
 {
 }
 
+void DOModuleConfigDialog::setSymbolIndex(const SymbolIndex *index)
+{
+    int nameColumn = 1;  // 变量名列的逻辑索引
+    m_bitTable->setItemDelegateForColumn(nameColumn, new SymbolCompleterDelegate(index, m_bitTable));
+}
+
+void DOModuleConfigDialog::setUndoStack(UndoStack *stack, quint64 componentId)
+{
+    m_undoStack = stack;
+    m_componentId = componentId;
+    connect(m_module, &DOModule::dataChanged, this, [this]() {
+        if (m_undoStack->isApplying()) {
+            updateBitTable(m_currentChannelIndex);
+        }
+    });
+}
+
+void DOModuleConfigDialog::applyBitVariable(int bit, const DOBitVariable &variable)
+{
+    if (!m_undoStack) {
+        m_module->setBitVariable(m_currentChannelIndex, bit, variable);
+        return;
+    }
+    // 撤销时刷新表格会触发值下拉框的信号，此时模块已是目标状态
+    if (m_undoStack->isApplying()) {
+        return;
+    }
+
+    // 切换通道刷新表格时值下拉框也会发出信号，内容未变时不记录
+    DOBitVariable current = m_module->getBitVariable(m_currentChannelIndex, bit);
+    if (variable.name == current.name && variable.description == current.description &&
+        variable.isGlobal == current.isGlobal && variable.value == current.value) {
+        return;
+    }
+
+    DOBitVariablesCommand *command = new DOBitVariablesCommand("编辑位变量", m_componentId);
+    command->addChange(m_currentChannelIndex, bit, current, variable);
+    m_undoStack->push(command);
+}
+
 void DOModuleConfigDialog::setupUI()
 {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -157,19 +200,19 @@ void DOModuleConfigDialog::updateBitTable(int channelIndex)
             valueCombo = new QComboBox();
             valueCombo->addItem("0", 0);
             valueCombo->addItem("1", 1);
-            valueCombo->setCurrentIndex(channel->bits[j].value);
+            valueCombo->setCurrentIndex(m_module->bitValue(channelIndex, j));
             
             // 连接值变化信号
             connect(valueCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), 
                     this, [this, j](int index) {
                 DOBitVariable variable = m_module->getBitVariable(m_currentChannelIndex, j);
                 variable.value = index;
-                m_module->setBitVariable(m_currentChannelIndex, j, variable);
+                applyBitVariable(j, variable);
             });
             
             m_bitTable->setCellWidget(j, 2, valueCombo);
         } else {
-            valueCombo->setCurrentIndex(channel->bits[j].value);
+            valueCombo->setCurrentIndex(m_module->bitValue(channelIndex, j));
         }
         
         // 描述
@@ -216,7 +259,7 @@ void DOModuleConfigDialog::onBitVariableChanged(int row, int column)
     }
     
     // 保存更新后的变量
-    m_module->setBitVariable(m_currentChannelIndex, row, variable);
+    applyBitVariable(row, variable);
 }
 
 void DOModuleConfigDialog::saveConfiguration()
@@ -233,8 +276,16 @@ void DOModuleConfigDialog::onChannelCountChanged(int index)
     // 获取新的通道数量
     int newChannelCount = m_channelCountCombo->itemData(index).toInt();
     
-    // 更新模块的通道数量
-    m_module->setChannelCount(newChannelCount);
+    // 更新模块的通道数量，减少通道时丢弃的位变量保存在撤销命令中
+    if (m_undoStack) {
+        if (m_undoStack->isApplying()) {
+            return;
+        }
+        m_undoStack->push(new DOChannelCountCommand("修改通道数量", m_componentId,
+                                                    m_module, newChannelCount));
+    } else {
+        m_module->setChannelCount(newChannelCount);
+    }
     
     // 更新通道选择下拉框
     m_channelSelectCombo->clear();
@@ -7,6 +7,8 @@
 #include <QTableWidget>
 #include <QPushButton>
 #include "domodule.h"
+#include "symbolindex.h"
+#include "undostack.h"
 
 class DOModuleConfigDialog : public QDialog
 {
@@ -16,6 +18,12 @@ public:
     explicit DOModuleConfigDialog(DOModule *module, QWidget *parent = nullptr);
     ~DOModuleConfigDialog();
     
+    // 变量名列按项目符号索引自动补全
+    void setSymbolIndex(const SymbolIndex *index);
+    
+    // 设置后位变量的修改经由撤销栈，撤销或重做时刷新表格
+    void setUndoStack(UndoStack *stack, quint64 componentId);
+    
 private slots:
     void onChannelCountChanged(int index);
     void onBitVariableChanged(int row, int column);
@@ -26,6 +34,7 @@ private:
     void setupUI();
     void updateChannelTabs();
     void updateBitTable(int channelIndex);
+    void applyBitVariable(int bit, const DOBitVariable &variable);
     
     DOModule *m_module;
     QComboBox *m_channelCountCombo;
@@ -34,6 +43,8 @@ private:
     QPushButton *m_saveButton;
     QPushButton *m_cancelButton;
     int m_currentChannelIndex;        // 当前选中的通道索引
+    UndoStack *m_undoStack;
+    quint64 m_componentId;
 };
 
 #endif // DOMODULECONFIGDIALOG_H
\ No newline at end of file
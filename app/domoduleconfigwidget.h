@@ -2,6 +2,8 @@
 #define DOMODULECONFIGWIDGET_H
 
 #include "domodule.h"
+#include "symbolindex.h"
+#include "undostack.h"
 #include <QComboBox>
 #include <QPushButton>
 #include <QTabWidget>
@@ -16,6 +18,15 @@ public:
   explicit DOModuleConfigWidget(DOModule *module, QWidget *parent = nullptr);
   ~DOModuleConfigWidget();
 
+  // 变量名列按项目符号索引自动补全
+  void setSymbolIndex(const SymbolIndex *index);
+
+  // 切换到另一个模块，属性面板在选中同类组件时复用
+  void setModule(DOModule *module);
+
+  // 设置后位变量的修改经由撤销栈，撤销或重做时刷新表格
+  void setUndoStack(UndoStack *stack, quint64 componentId);
+
 private slots:
   void onChannelCountChanged(int index);
   void onBitVariableChanged(int row, int column);
@@ -24,7 +35,9 @@ private slots:
 
 private:
   void setupUI();
+  void loadChannels();
   void updateBitTable(int channelIndex);
+  void applyBitVariable(int bit, const DOBitVariable &variable);
 
   DOModule *m_module;
   QComboBox *m_channelCountCombo;
@@ -32,6 +45,13 @@ private:
   QTableWidget *m_bitTable;        // 使用单个表格替代多个选项卡
   QPushButton *m_saveButton;
   int m_currentChannelIndex; // 当前选中的通道索引
+  UndoStack *m_undoStack;
+  quint64 m_componentId;
+  // 撤销时刷新表格和通道下拉框的连接，模块可能先于面板被释放，按连接断开
+  QMetaObject::Connection m_moduleConnection;
+  QMetaObject::Connection m_countConnection;
+  // 在线监控写入的实时值，只刷新当前通道中变化的值下拉框
+  QMetaObject::Connection m_valuesConnection;
 };
 
 #endif // DOMODULECONFIGWIDGET_H
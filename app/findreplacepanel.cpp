@@ -0,0 +1,170 @@
+#include "findreplacepanel.h"
+#include <QApplication>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+FindReplacePanel::FindReplacePanel(ProjectModel *model,
+                                   ModuleRegistry *registry,
+                                   UndoStack *undoStack, QWidget *parent)
+    : QWidget(parent) {
+  m_search = new ProjectSearch(model, registry, undoStack, this);
+  m_resultModel = new SearchResultModel(model, this);
+
+  QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+  QGridLayout *inputLayout = new QGridLayout();
+  m_findEdit = new QLineEdit(this);
+  m_findEdit->setPlaceholderText("查找");
+  m_findButton = new QPushButton("查找", this);
+  m_replaceEdit = new QLineEdit(this);
+  m_replaceEdit->setPlaceholderText("替换为");
+  m_replaceAllButton = new QPushButton("全部替换", this);
+  m_replaceAllButton->setEnabled(false);
+  inputLayout->addWidget(m_findEdit, 0, 0);
+  inputLayout->addWidget(m_findButton, 0, 1);
+  inputLayout->addWidget(m_replaceEdit, 1, 0);
+  inputLayout->addWidget(m_replaceAllButton, 1, 1);
+  mainLayout->addLayout(inputLayout);
+
+  QHBoxLayout *optionLayout = new QHBoxLayout();
+  m_regexCheck = new QCheckBox("正则表达式", this);
+  m_caseCheck = new QCheckBox("区分大小写", this);
+  m_namesCheck = new QCheckBox("组件名称", this);
+  m_namesCheck->setChecked(true);
+  m_devicesCheck = new QCheckBox("回路设备", this);
+  m_devicesCheck->setChecked(true);
+  m_bitsCheck = new QCheckBox("位变量", this);
+  m_bitsCheck->setChecked(true);
+  optionLayout->addWidget(m_regexCheck);
+  optionLayout->addWidget(m_caseCheck);
+  optionLayout->addSpacing(12);
+  optionLayout->addWidget(m_namesCheck);
+  optionLayout->addWidget(m_devicesCheck);
+  optionLayout->addWidget(m_bitsCheck);
+  optionLayout->addStretch();
+  mainLayout->addLayout(optionLayout);
+
+  // 统一行高让视图只为可见行取数据，结果很多时也不会卡顿
+  m_resultView = new QListView(this);
+  m_resultView->setModel(m_resultModel);
+  m_resultView->setUniformItemSizes(true);
+  m_resultView->setLayoutMode(QListView::Batched);
+  m_resultView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  mainLayout->addWidget(m_resultView);
+
+  m_statusLabel = new QLabel(this);
+  mainLayout->addWidget(m_statusLabel);
+
+  connect(m_findEdit, &QLineEdit::returnPressed, this,
+          &FindReplacePanel::startSearch);
+  connect(m_findButton, &QPushButton::clicked, this,
+          &FindReplacePanel::startSearch);
+  connect(m_replaceAllButton, &QPushButton::clicked, this,
+          &FindReplacePanel::replaceAll);
+  connect(m_resultView, &QListView::activated, this,
+          &FindReplacePanel::onResultActivated);
+  connect(m_search, &ProjectSearch::matchesFound, this,
+          &FindReplacePanel::onMatchesFound);
+  connect(m_search, &ProjectSearch::finished, this,
+          &FindReplacePanel::onSearchFinished);
+
+  // 项目被替换后旧结果中的组件编号不再有效
+  connect(model, &QAbstractItemModel::modelReset, this, [this]() {
+    m_search->cancel();
+    m_resultModel->clear();
+    m_replaceAllButton->setEnabled(false);
+    m_statusLabel->clear();
+  });
+}
+
+void FindReplacePanel::activate(bool replace) {
+  QLineEdit *edit = replace ? m_replaceEdit : m_findEdit;
+  edit->setFocus();
+  edit->selectAll();
+}
+
+SearchQuery FindReplacePanel::currentQuery() const {
+  SearchQuery query;
+  query.pattern = m_findEdit->text();
+  query.useRegex = m_regexCheck->isChecked();
+  query.caseSensitive = m_caseCheck->isChecked();
+  query.scopes = 0;
+  if (m_namesCheck->isChecked()) {
+    query.scopes |= SearchQuery::ComponentNames;
+  }
+  if (m_devicesCheck->isChecked()) {
+    query.scopes |= SearchQuery::LoopDevices;
+  }
+  if (m_bitsCheck->isChecked()) {
+    query.scopes |= SearchQuery::BitVariables;
+  }
+  return query;
+}
+
+void FindReplacePanel::startSearch() {
+  SearchQuery query = currentQuery();
+  TextMatcher matcher(query);
+  if (!matcher.isValid()) {
+    m_statusLabel->setText(matcher.errorString());
+    return;
+  }
+
+  m_replaceMessage.clear();
+  m_resultModel->clear();
+  m_replaceAllButton->setEnabled(false);
+  m_statusLabel->setText("正在查找...");
+  m_search->start(query);
+}
+
+void FindReplacePanel::replaceAll() {
+  if (m_search->isRunning() || m_search->matchCount() == 0) {
+    return;
+  }
+
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  int count = m_search->replaceAll(m_replaceEdit->text());
+  QApplication::restoreOverrideCursor();
+
+  // 替换后重新查找，列表中只留下仍然匹配的内容
+  m_replaceMessage = QString("已替换 %1 处").arg(count);
+  m_resultModel->clear();
+  m_replaceAllButton->setEnabled(false);
+  m_search->start(m_search->query());
+}
+
+void FindReplacePanel::onMatchesFound(const QVector<SearchMatch> &matches) {
+  m_resultModel->appendMatches(matches);
+  updateStatus();
+}
+
+void FindReplacePanel::onSearchFinished() {
+  m_replaceAllButton->setEnabled(m_search->matchCount() > 0);
+  updateStatus();
+}
+
+void FindReplacePanel::onResultActivated(const QModelIndex &index) {
+  if (index.isValid()) {
+    emit componentActivated(m_resultModel->match(index.row())
+                                .location.componentId);
+  }
+}
+
+void FindReplacePanel::updateStatus() {
+  int count = m_search->matchCount();
+  QString text = m_replaceMessage;
+  if (!text.isEmpty()) {
+    text += "，";
+  }
+  if (count > m_resultModel->rowCount()) {
+    text += QString("找到 %1 处，列出前 %2 处")
+                .arg(count)
+                .arg(m_resultModel->rowCount());
+  } else {
+    text += QString("找到 %1 处").arg(count);
+  }
+  if (m_search->isRunning()) {
+    text += "，正在查找...";
+  }
+  m_statusLabel->setText(text);
+}
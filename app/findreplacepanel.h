@@ -0,0 +1,57 @@
+#ifndef FINDREPLACEPANEL_H
+#define FINDREPLACEPANEL_H
+
+#include "projectsearch.h"
+#include "searchresultmodel.h"
+#include <QCheckBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QPushButton>
+#include <QWidget>
+
+// 查找和替换面板
+class FindReplacePanel : public QWidget {
+  Q_OBJECT
+
+public:
+  FindReplacePanel(ProjectModel *model, ModuleRegistry *registry,
+                   UndoStack *undoStack, QWidget *parent = nullptr);
+
+  // 把输入焦点放到查找框，replace 为 true 时放到替换框
+  void activate(bool replace);
+
+signals:
+  // 双击结果时发出，参数为所在组件的编号
+  void componentActivated(quint64 id);
+
+private slots:
+  void startSearch();
+  void replaceAll();
+  void onMatchesFound(const QVector<SearchMatch> &matches);
+  void onSearchFinished();
+  void onResultActivated(const QModelIndex &index);
+
+private:
+  SearchQuery currentQuery() const;
+  void updateStatus();
+
+  ProjectSearch *m_search;
+  SearchResultModel *m_resultModel;
+
+  QLineEdit *m_findEdit;
+  QLineEdit *m_replaceEdit;
+  QCheckBox *m_regexCheck;
+  QCheckBox *m_caseCheck;
+  QCheckBox *m_namesCheck;
+  QCheckBox *m_devicesCheck;
+  QCheckBox *m_bitsCheck;
+  QPushButton *m_findButton;
+  QPushButton *m_replaceAllButton;
+  QListView *m_resultView;
+  QLabel *m_statusLabel;
+  // 全部替换后重新查找时，状态中保留替换结果
+  QString m_replaceMessage;
+};
+
+#endif // FINDREPLACEPANEL_H
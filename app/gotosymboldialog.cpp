@@ -0,0 +1,84 @@
+#include "gotosymboldialog.h"
+#include <QDialogButtonBox>
+#include <QVBoxLayout>
+
+namespace {
+// 列表只显示前面这些名称，继续输入可以缩小范围
+const int kMaxListedNames = 200;
+} // namespace
+
+GoToSymbolDialog::GoToSymbolDialog(const SymbolIndex *index,
+                                   ProjectModel *model, QWidget *parent)
+    : QDialog(parent), m_symbolIndex(index), m_model(model), m_selectedId(0) {
+  setWindowTitle("转到符号");
+  resize(480, 360);
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  m_filterEdit = new QLineEdit(this);
+  m_filterEdit->setPlaceholderText("输入变量名");
+  layout->addWidget(m_filterEdit);
+
+  m_matchList = new QListWidget(this);
+  layout->addWidget(m_matchList);
+
+  QDialogButtonBox *buttonBox =
+      new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+  layout->addWidget(buttonBox);
+
+  connect(m_filterEdit, &QLineEdit::textChanged, this,
+          &GoToSymbolDialog::updateMatches);
+  connect(m_filterEdit, &QLineEdit::returnPressed, this,
+          &GoToSymbolDialog::accept);
+  connect(m_matchList, &QListWidget::itemActivated, this,
+          &GoToSymbolDialog::onItemActivated);
+  connect(buttonBox, &QDialogButtonBox::accepted, this,
+          &GoToSymbolDialog::accept);
+  connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+  updateMatches(QString());
+}
+
+quint64 GoToSymbolDialog::selectedComponentId() const { return m_selectedId; }
+
+void GoToSymbolDialog::updateMatches(const QString &text) {
+  m_matchList->clear();
+
+  // 同名变量可能出现在多个组件中，每个位置单独列出
+  const QStringList names =
+      m_symbolIndex->completions(text.trimmed(), kMaxListedNames);
+  for (const QString &name : names) {
+    for (const ComponentLocation &location : m_symbolIndex->locations(name)) {
+      QString componentName =
+          m_model->nodeName(m_model->indexForComponentId(location.componentId));
+      QString place = componentName;
+      if (location.channel >= 0) {
+        place += QString(" 通道 %1").arg(location.channel + 1);
+      }
+      if (location.index >= 0) {
+        place += QString(" #%1").arg(location.index + 1);
+      }
+
+      QListWidgetItem *item = new QListWidgetItem(
+          QString("%1    %2").arg(name, place), m_matchList);
+      item->setData(Qt::UserRole, QVariant::fromValue(location.componentId));
+    }
+  }
+
+  if (m_matchList->count() > 0) {
+    m_matchList->setCurrentRow(0);
+  }
+}
+
+void GoToSymbolDialog::onItemActivated(QListWidgetItem *item) {
+  m_matchList->setCurrentItem(item);
+  accept();
+}
+
+void GoToSymbolDialog::accept() {
+  QListWidgetItem *item = m_matchList->currentItem();
+  if (!item) {
+    return;
+  }
+  m_selectedId = item->data(Qt::UserRole).toULongLong();
+  QDialog::accept();
+}
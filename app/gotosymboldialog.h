@@ -0,0 +1,38 @@
+#ifndef GOTOSYMBOLDIALOG_H
+#define GOTOSYMBOLDIALOG_H
+
+#include "projectmodel.h"
+#include "symbolindex.h"
+#include <QDialog>
+#include <QLineEdit>
+#include <QListWidget>
+
+// 转到符号对话框
+//
+// 输入变量名前缀后列出匹配的变量及其所在组件、通道和位置，选中后
+// selectedComponentId() 返回所在组件的编号。
+class GoToSymbolDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  GoToSymbolDialog(const SymbolIndex *index, ProjectModel *model,
+                   QWidget *parent = nullptr);
+
+  quint64 selectedComponentId() const;
+
+public slots:
+  void accept() override;
+
+private slots:
+  void updateMatches(const QString &text);
+  void onItemActivated(QListWidgetItem *item);
+
+private:
+  const SymbolIndex *m_symbolIndex;
+  ProjectModel *m_model;
+  QLineEdit *m_filterEdit;
+  QListWidget *m_matchList;
+  quint64 m_selectedId;
+};
+
+#endif // GOTOSYMBOLDIALOG_H
@@ -13,10 +13,22 @@ HostModuleConfigWidget::HostModuleConfigWidget(HostModule *module,
     : QWidget(parent), m_module(module) {
   setupUI();
   loadConfiguration();
+  connect(&m_prober, &HostProber::hostFinished, this,
+          &HostModuleConfigWidget::onTestFinished);
 }
 
 HostModuleConfigWidget::~HostModuleConfigWidget() {}
 
+void HostModuleConfigWidget::setModule(HostModule *module) {
+  // 上一个主机的测试结果不再显示
+  m_prober.cancel();
+  m_module = module;
+  loadConfiguration();
+  validateInput();
+  m_statusLabel->setText("状态: 未测试");
+  m_statusLabel->setStyleSheet("color: gray; font-style: italic;");
+}
+
 void HostModuleConfigWidget::setupUI() {
   QVBoxLayout *mainLayout = new QVBoxLayout(this);
 
@@ -188,14 +200,35 @@ void HostModuleConfigWidget::onTestConnection() {
     return;
   }
 
-  // 模拟连接测试
+  if (tempConfig.protocol != CommunicationProtocol::TCP) {
+    m_statusLabel->setText("状态: UDP 无法通过建立连接测试");
+    m_statusLabel->setStyleSheet("color: gray; font-style: italic;");
+    return;
+  }
+
   m_statusLabel->setText("状态: 正在测试连接...");
   m_statusLabel->setStyleSheet("color: orange; font-style: italic;");
+  m_testButton->setEnabled(false);
+
+  HostProber::Target target;
+  target.hostId = 0;
+  target.address = tempConfig.ipAddress;
+  target.port = static_cast<quint16>(tempConfig.port);
+  m_prober.start(QVector<HostProber::Target>() << target);
+}
 
-  // 这里可以添加实际的网络连接测试逻辑
-  // 暂时模拟测试成功
-  m_statusLabel->setText("状态: 连接测试成功");
-  m_statusLabel->setStyleSheet("color: green; font-weight: bold;");
+void HostModuleConfigWidget::onTestFinished(const HostProber::Result &result) {
+  validateInput();
+  if (result.status == HostProber::Reachable) {
+    m_statusLabel->setText(
+        QString("状态: 连接测试成功 (%1 ms)").arg(result.latency, 0, 'f', 1));
+    m_statusLabel->setStyleSheet("color: green; font-weight: bold;");
+  } else {
+    m_statusLabel->setText(QString("状态: %1 - %2")
+                               .arg(HostProber::statusText(result.status),
+                                    result.errorString));
+    m_statusLabel->setStyleSheet("color: red; font-weight: bold;");
+  }
 }
 
 void HostModuleConfigWidget::saveConfiguration() {
@@ -2,6 +2,7 @@
 #define HOSTMODULECONFIGWIDGET_H
 
 #include "hostmodule.h"
+#include "hostprober.h"
 #include <QCheckBox>
 #include <QComboBox>
 #include <QLabel>
@@ -20,10 +21,14 @@ public:
                                   QWidget *parent = nullptr);
   ~HostModuleConfigWidget();
 
+  // 切换到另一个主机模块，属性面板在选中主机时复用
+  void setModule(HostModule *module);
+
 private slots:
   void onProtocolChanged(int index);
   void onDhcpToggled(bool enabled);
   void onTestConnection();
+  void onTestFinished(const HostProber::Result &result);
   void saveConfiguration();
   void validateInput();
 
@@ -54,6 +59,9 @@ private:
 
   // 状态标签
   QLabel *m_statusLabel;
+
+  // 测试连接在后台进行，不阻塞界面
+  HostProber m_prober;
 };
 
 #endif // HOSTMODULECONFIGWIDGET_H
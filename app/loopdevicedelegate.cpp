@@ -0,0 +1,39 @@
+#include "loopdevicedelegate.h"
+#include "loopdevicetablemodel.h"
+#include <QComboBox>
+
+LoopDeviceDelegate::LoopDeviceDelegate(QObject *parent)
+    : QStyledItemDelegate(parent) {}
+
+QWidget *LoopDeviceDelegate::createEditor(QWidget *parent,
+                                          const QStyleOptionViewItem &option,
+                                          const QModelIndex &index) const {
+  if (index.column() != LoopDeviceTableModel::TypeColumn) {
+    return QStyledItemDelegate::createEditor(parent, option, index);
+  }
+
+  QComboBox *typeCombo = new QComboBox(parent);
+  typeCombo->addItems(LoopModule::deviceTypes());
+  return typeCombo;
+}
+
+void LoopDeviceDelegate::setEditorData(QWidget *editor,
+                                       const QModelIndex &index) const {
+  QComboBox *typeCombo = qobject_cast<QComboBox *>(editor);
+  if (!typeCombo) {
+    QStyledItemDelegate::setEditorData(editor, index);
+    return;
+  }
+  typeCombo->setCurrentText(index.data(Qt::EditRole).toString());
+}
+
+void LoopDeviceDelegate::setModelData(QWidget *editor,
+                                      QAbstractItemModel *model,
+                                      const QModelIndex &index) const {
+  QComboBox *typeCombo = qobject_cast<QComboBox *>(editor);
+  if (!typeCombo) {
+    QStyledItemDelegate::setModelData(editor, model, index);
+    return;
+  }
+  model->setData(index, typeCombo->currentText(), Qt::EditRole);
+}
@@ -0,0 +1,23 @@
+#ifndef LOOPDEVICEDELEGATE_H
+#define LOOPDEVICEDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Item delegate for the loop device table.
+//
+// The type column is painted as plain text like every other cell; a combo box
+// is only created while that cell is being edited.
+class LoopDeviceDelegate : public QStyledItemDelegate {
+  Q_OBJECT
+
+public:
+  explicit LoopDeviceDelegate(QObject *parent = nullptr);
+
+  QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option,
+                        const QModelIndex &index) const override;
+  void setEditorData(QWidget *editor, const QModelIndex &index) const override;
+  void setModelData(QWidget *editor, QAbstractItemModel *model,
+                    const QModelIndex &index) const override;
+};
+
+#endif // LOOPDEVICEDELEGATE_H
@@ -0,0 +1,139 @@
+#include "loopdevicetablemodel.h"
+#include <algorithm>
+#include <functional>
+
+LoopDeviceTableModel::LoopDeviceTableModel(LoopModule *module, QObject *parent)
+    : QAbstractTableModel(parent), m_module(module), m_channel(0),
+      m_rowCount(module->deviceCount(0)) {
+  connect(m_module, &LoopModule::devicesInserted, this,
+          &LoopDeviceTableModel::onDevicesInserted);
+  connect(m_module, &LoopModule::devicesRemoved, this,
+          &LoopDeviceTableModel::onDevicesRemoved);
+  connect(m_module, &LoopModule::devicesChanged, this,
+          &LoopDeviceTableModel::onDevicesChanged);
+  connect(m_module, &LoopModule::devicesReset, this,
+          &LoopDeviceTableModel::onDevicesReset);
+}
+
+int LoopDeviceTableModel::channel() const { return m_channel; }
+
+void LoopDeviceTableModel::setChannel(int channelIndex) {
+  beginResetModel();
+  m_channel = channelIndex;
+  m_rowCount = m_module->deviceCount(m_channel);
+  endResetModel();
+}
+
+int LoopDeviceTableModel::rowCount(const QModelIndex &parent) const {
+  if (parent.isValid()) {
+    return 0;
+  }
+  return m_rowCount;
+}
+
+int LoopDeviceTableModel::columnCount(const QModelIndex &parent) const {
+  if (parent.isValid()) {
+    return 0;
+  }
+  return ColumnCount;
+}
+
+QVariant LoopDeviceTableModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+    return QVariant();
+  }
+
+  return m_module->channelDevices(m_channel).value(index.row(),
+                                                   index.column());
+}
+
+bool LoopDeviceTableModel::setData(const QModelIndex &index,
+                                   const QVariant &value, int role) {
+  if (!index.isValid() || role != Qt::EditRole) {
+    return false;
+  }
+
+  // The module reports the change through devicesChanged()
+  return m_module->setDeviceValue(m_channel, index.row(), index.column(),
+                                  value);
+}
+
+Qt::ItemFlags LoopDeviceTableModel::flags(const QModelIndex &index) const {
+  if (!index.isValid()) {
+    return Qt::NoItemFlags;
+  }
+  return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+}
+
+QVariant LoopDeviceTableModel::headerData(int section,
+                                          Qt::Orientation orientation,
+                                          int role) const {
+  if (role != Qt::DisplayRole) {
+    return QVariant();
+  }
+
+  if (orientation == Qt::Vertical) {
+    return section + 1;
+  }
+
+  return LoopModule::deviceFieldLabels().value(section);
+}
+
+void LoopDeviceTableModel::appendDevice(const LoopDevice &device) {
+  m_module->addDevice(m_channel, device);
+}
+
+void LoopDeviceTableModel::removeDevices(QList<int> rows) {
+  // Remove from bottom up so the remaining row numbers stay valid, taking
+  // runs of adjacent rows in one call
+  std::sort(rows.begin(), rows.end(), std::greater<int>());
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+  int i = 0;
+  while (i < rows.size()) {
+    int last = rows.at(i);
+    int first = last;
+    ++i;
+    while (i < rows.size() && rows.at(i) == first - 1) {
+      first = rows.at(i);
+      ++i;
+    }
+    if (first >= 0 && last < m_module->deviceCount(m_channel)) {
+      m_module->removeDevices(m_channel, first, last - first + 1);
+    }
+  }
+}
+
+void LoopDeviceTableModel::onDevicesInserted(int channelIndex, int firstIndex,
+                                             int lastIndex) {
+  if (channelIndex != m_channel) {
+    return;
+  }
+  beginInsertRows(QModelIndex(), firstIndex, lastIndex);
+  m_rowCount += lastIndex - firstIndex + 1;
+  endInsertRows();
+}
+
+void LoopDeviceTableModel::onDevicesRemoved(int channelIndex, int firstIndex,
+                                            int lastIndex) {
+  if (channelIndex != m_channel) {
+    return;
+  }
+  beginRemoveRows(QModelIndex(), firstIndex, lastIndex);
+  m_rowCount -= lastIndex - firstIndex + 1;
+  endRemoveRows();
+}
+
+void LoopDeviceTableModel::onDevicesChanged(int channelIndex, int firstIndex,
+                                            int lastIndex) {
+  if (channelIndex != m_channel) {
+    return;
+  }
+  emit dataChanged(index(firstIndex, 0), index(lastIndex, ColumnCount - 1));
+}
+
+void LoopDeviceTableModel::onDevicesReset(int channelIndex) {
+  if (channelIndex == m_channel) {
+    setChannel(m_channel);
+  }
+}
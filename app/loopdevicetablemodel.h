@@ -0,0 +1,65 @@
+#ifndef LOOPDEVICETABLEMODEL_H
+#define LOOPDEVICETABLEMODEL_H
+
+#include "loopmodule.h"
+#include <QAbstractTableModel>
+#include <QList>
+
+// Table model over the devices of one loop channel.
+//
+// Rows are read straight from the LoopModule storage, so switching channels
+// is a model reset instead of building widgets and items for every device.
+// Edits go through the module; the model follows the module's range signals,
+// so changes made elsewhere show up as well.
+class LoopDeviceTableModel : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  // Columns follow the LoopDevice field order
+  enum Column {
+    TypeColumn = LoopDevice::TypeField,
+    SerialNumberColumn = LoopDevice::SerialNumberField,
+    AddressColumn = LoopDevice::AddressField,
+    PersonalityCodeColumn = LoopDevice::PersonalityCodeField,
+    PanelNumberColumn = LoopDevice::PanelNumberField,
+    CardNumberColumn = LoopDevice::CardNumberField,
+    DescriptionColumn = LoopDevice::DescriptionField,
+    IdentifierColumn = LoopDevice::IdentifierField,
+    VariableNameColumn = LoopDevice::VariableNameField,
+    ColumnCount = LoopDevice::FieldCount
+  };
+
+  explicit LoopDeviceTableModel(LoopModule *module, QObject *parent = nullptr);
+
+  int channel() const;
+  void setChannel(int channelIndex);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override;
+  bool setData(const QModelIndex &index, const QVariant &value,
+               int role = Qt::EditRole) override;
+  Qt::ItemFlags flags(const QModelIndex &index) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+  // Device editing on the current channel
+  void appendDevice(const LoopDevice &device);
+  // Rows may be given in any order and may contain duplicates
+  void removeDevices(QList<int> rows);
+
+private slots:
+  void onDevicesInserted(int channelIndex, int firstIndex, int lastIndex);
+  void onDevicesRemoved(int channelIndex, int firstIndex, int lastIndex);
+  void onDevicesChanged(int channelIndex, int firstIndex, int lastIndex);
+  void onDevicesReset(int channelIndex);
+
+private:
+  LoopModule *m_module;
+  int m_channel;
+  // Row count as last announced to the views
+  int m_rowCount;
+};
+
+#endif // LOOPDEVICETABLEMODEL_H
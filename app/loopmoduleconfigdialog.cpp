@@ -1,28 +1,90 @@
 #include "loopmoduleconfigdialog.h"
+#include "loopdevicecsv.h"
+#include "loopdevicedelegate.h"
+#include "moduleupdateguard.h"
+#include "projectcommands.h"
+#include "symbolcompleterdelegate.h"
 #include <QDebug>
+#include <QFileDialog>
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QLabel>
 #include <QMessageBox>
+#include <QSaveFile>
 #include <QVBoxLayout>
+#include <QtConcurrent>
 
 LoopModuleConfigDialog::LoopModuleConfigDialog(LoopModule *module,
                                                QWidget *parent)
-    : QDialog(parent), m_module(module), m_currentChannelIndex(0) {
+    : QDialog(parent), m_module(module), m_currentChannelIndex(0),
+      m_importChannel(0), m_undoStack(nullptr), m_componentId(0) {
   setWindowTitle("回路模块配置");
   setMinimumSize(800, 600);
 
-  // Load initial data into temp storage
-  for (int i = 0; i < m_module->getChannelCount(); ++i) {
-    m_tempDevices[i] = m_module->getDevices(i);
-  }
+  // Load initial data into the working copy
+  m_workingCopy = new LoopModule(this);
+  m_workingCopy->copyFrom(m_module);
 
   setupUI();
   loadData();
+
+  connect(&m_importWatcher,
+          &QFutureWatcher<LoopDeviceCsv::FileImport>::finished, this,
+          &LoopModuleConfigDialog::onImportFinished);
 }
 
 LoopModuleConfigDialog::~LoopModuleConfigDialog() {}
 
+void LoopModuleConfigDialog::setSymbolIndex(const SymbolIndex *index) {
+  m_deviceTable->setItemDelegateForColumn(
+      LoopDeviceTableModel::VariableNameColumn,
+      new SymbolCompleterDelegate(index, m_deviceTable));
+}
+
+void LoopModuleConfigDialog::setUndoStack(UndoStack *stack,
+                                          quint64 componentId) {
+  m_undoStack = stack;
+  m_componentId = componentId;
+  // Undo and redo change the module underneath the editor
+  connect(m_module, &LoopModule::dataChanged, this, [this]() {
+    if (m_undoStack->isApplying()) {
+      reloadFromModule();
+    }
+  });
+}
+
+void LoopModuleConfigDialog::reloadFromModule() {
+  int channel = m_currentChannelIndex;
+  m_workingCopy->copyFrom(m_module);
+  loadData();
+  if (channel < m_channelSelectCombo->count()) {
+    m_channelSelectCombo->setCurrentIndex(channel);
+  }
+}
+
+void LoopModuleConfigDialog::pushChanges() {
+  LoopSettings settings;
+  settings.channelCount = m_channelCountCombo->currentData().toInt();
+  settings.loopMode = (LoopMode)m_loopModeCombo->currentData().toInt();
+  settings.initialized = m_initCheckBox->isChecked();
+  settings.mappingSupported = m_mapCheckBox->isChecked();
+
+  // Only the rows that differ from the module are recorded
+  LoopModuleCommand *command =
+      new LoopModuleCommand("修改回路模块", m_componentId);
+  command->setSettings(LoopSettings::of(m_module), settings);
+  for (int i = 0; i < settings.channelCount; ++i) {
+    command->addChannelDiff(i, m_module->channelDevices(i),
+                            m_workingCopy->channelDevices(i));
+  }
+
+  if (command->isEmpty()) {
+    delete command;
+    return;
+  }
+  m_undoStack->push(command);
+}
+
 void LoopModuleConfigDialog::setupUI() {
   QVBoxLayout *mainLayout = new QVBoxLayout(this);
 
@@ -76,24 +138,23 @@ void LoopModuleConfigDialog::setupUI() {
   configLayout->addLayout(channelSelectLayout);
 
   // Device List Table
-  m_deviceTable = new QTableWidget(this);
-  QStringList headers;
-  headers << "类型"
-          << "序列号"
-          << "地址"
-          << "个性代码"
-          << "盘号"
-          << "卡号"
-          << "设备说明"
-          << "设备标识"
-          << "变量名";
-  m_deviceTable->setColumnCount(headers.size());
-  m_deviceTable->setHorizontalHeaderLabels(headers);
+  // Rows come from the model on demand, so large channels open instantly
+  m_deviceModel = new LoopDeviceTableModel(m_workingCopy, this);
+  m_deviceTable = new QTableView(this);
+  m_deviceTable->setModel(m_deviceModel);
+  m_deviceTable->setItemDelegate(new LoopDeviceDelegate(m_deviceTable));
   m_deviceTable->horizontalHeader()->setSectionResizeMode(
       QHeaderView::Interactive);
   m_deviceTable->horizontalHeader()->setStretchLastSection(true);
   m_deviceTable->horizontalHeader()->setSectionsMovable(true);
+  m_deviceTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+  m_deviceTable->verticalHeader()->setDefaultSectionSize(
+      m_deviceTable->fontMetrics().height() + 8);
   m_deviceTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_deviceTable->setEditTriggers(QAbstractItemView::DoubleClicked |
+                                 QAbstractItemView::SelectedClicked |
+                                 QAbstractItemView::EditKeyPressed |
+                                 QAbstractItemView::AnyKeyPressed);
   m_deviceTable->setAlternatingRowColors(true);
 
   // Set default column widths
@@ -116,6 +177,10 @@ void LoopModuleConfigDialog::setupUI() {
   actionLayout->addWidget(m_addDeviceBtn);
   actionLayout->addWidget(m_removeDeviceBtn);
   actionLayout->addStretch();
+  m_importDevicesBtn = new QPushButton("导入CSV", this);
+  m_exportDevicesBtn = new QPushButton("导出CSV", this);
+  actionLayout->addWidget(m_importDevicesBtn);
+  actionLayout->addWidget(m_exportDevicesBtn);
   configLayout->addLayout(actionLayout);
 
   m_tabWidget->addTab(configTab, "回路配置");
@@ -152,6 +217,10 @@ void LoopModuleConfigDialog::setupUI() {
           &LoopModuleConfigDialog::onAddDevice);
   connect(m_removeDeviceBtn, &QPushButton::clicked, this,
           &LoopModuleConfigDialog::onRemoveDevice);
+  connect(m_importDevicesBtn, &QPushButton::clicked, this,
+          &LoopModuleConfigDialog::onImportDevices);
+  connect(m_exportDevicesBtn, &QPushButton::clicked, this,
+          &LoopModuleConfigDialog::onExportDevices);
   connect(m_saveBtn, &QPushButton::clicked, this,
           &LoopModuleConfigDialog::onSave);
   connect(m_cancelBtn, &QPushButton::clicked, this,
@@ -189,119 +258,7 @@ void LoopModuleConfigDialog::loadData() {
 }
 
 void LoopModuleConfigDialog::updateDeviceTable(int channelIndex) {
-  m_deviceTable->setRowCount(0);
-
-  if (!m_tempDevices.contains(channelIndex))
-    return;
-
-  const QList<LoopDevice> &devices = m_tempDevices[channelIndex];
-  m_deviceTable->setRowCount(devices.size());
-
-  for (int i = 0; i < devices.size(); ++i) {
-    const LoopDevice &device = devices[i];
-
-    // Type (ComboBox)
-    QComboBox *typeCombo = new QComboBox();
-    typeCombo->addItem("烟温复合探测器");
-    typeCombo->addItem("手动报警按钮");
-    typeCombo->addItem("输入输出模块");
-    typeCombo->addItem("声光报警器");
-    typeCombo->setCurrentText(device.type);
-    m_deviceTable->setCellWidget(i, 0, typeCombo);
-
-    // Serial Number
-    m_deviceTable->setItem(i, 1, new QTableWidgetItem(device.serialNumber));
-
-    // Address
-    m_deviceTable->setItem(
-        i, 2, new QTableWidgetItem(QString::number(device.address)));
-
-    // Personality Code
-    m_deviceTable->setItem(i, 3, new QTableWidgetItem(device.personalityCode));
-
-    // Panel Number
-    m_deviceTable->setItem(
-        i, 4, new QTableWidgetItem(QString::number(device.panelNumber)));
-
-    // Card Number
-    m_deviceTable->setItem(
-        i, 5, new QTableWidgetItem(QString::number(device.cardNumber)));
-
-    // Description
-    m_deviceTable->setItem(i, 6, new QTableWidgetItem(device.description));
-
-    // Identifier
-    m_deviceTable->setItem(i, 7, new QTableWidgetItem(device.identifier));
-
-    // Variable Name
-    m_deviceTable->setItem(i, 8, new QTableWidgetItem(device.variableName));
-
-    // Set icons based on type (Placeholder logic)
-    QTableWidgetItem *headerItem = m_deviceTable->verticalHeaderItem(i);
-    if (!headerItem) {
-      headerItem = new QTableWidgetItem();
-      m_deviceTable->setVerticalHeaderItem(i, headerItem);
-    }
-    // In a real app, you'd set an icon here:
-    // headerItem->setIcon(QIcon(":/icons/device.png"));
-  }
-}
-
-void LoopModuleConfigDialog::saveCurrentChannelData() {
-  QList<LoopDevice> devices;
-  for (int i = 0; i < m_deviceTable->rowCount(); ++i) {
-    LoopDevice device;
-
-    // Type
-    QComboBox *typeCombo =
-        qobject_cast<QComboBox *>(m_deviceTable->cellWidget(i, 0));
-    if (typeCombo)
-      device.type = typeCombo->currentText();
-
-    // Serial
-    QTableWidgetItem *item = m_deviceTable->item(i, 1);
-    if (item)
-      device.serialNumber = item->text();
-
-    // Address
-    item = m_deviceTable->item(i, 2);
-    if (item)
-      device.address = item->text().toInt();
-
-    // Personality
-    item = m_deviceTable->item(i, 3);
-    if (item)
-      device.personalityCode = item->text();
-
-    // Panel
-    item = m_deviceTable->item(i, 4);
-    if (item)
-      device.panelNumber = item->text().toInt();
-
-    // Card
-    item = m_deviceTable->item(i, 5);
-    if (item)
-      device.cardNumber = item->text().toInt();
-
-    // Description
-    item = m_deviceTable->item(i, 6);
-    if (item)
-      device.description = item->text();
-
-    // Identifier
-    item = m_deviceTable->item(i, 7);
-    if (item)
-      device.identifier = item->text();
-
-    // Variable Name
-    item = m_deviceTable->item(i, 8);
-    if (item)
-      device.variableName = item->text();
-
-    devices.append(device);
-  }
-
-  m_tempDevices[m_currentChannelIndex] = devices;
+  m_deviceModel->setChannel(channelIndex);
 }
 
 void LoopModuleConfigDialog::onChannelCountChanged(int index) {
@@ -326,82 +283,136 @@ void LoopModuleConfigDialog::onChannelSelectionChanged(int index) {
   if (index < 0)
     return;
 
-  // Save current table data before switching
-  saveCurrentChannelData();
-
   m_currentChannelIndex = index;
   updateDeviceTable(m_currentChannelIndex);
 }
 
 void LoopModuleConfigDialog::onAddDevice() {
-  int row = m_deviceTable->rowCount();
+  LoopDevice device;
+  device.type = LoopModule::deviceTypes().first();
 
   // Calculate next address
-  int nextAddress = 1;
-  if (row > 0) {
-    QTableWidgetItem *lastAddressItem = m_deviceTable->item(row - 1, 2);
-    if (lastAddressItem) {
-      nextAddress = lastAddressItem->text().toInt() + 1;
-    }
+  device.address = 1;
+  const LoopChannelDevices &devices =
+      m_workingCopy->channelDevices(m_currentChannelIndex);
+  if (!devices.isEmpty()) {
+    device.address = devices.address(devices.size() - 1) + 1;
   }
 
-  m_deviceTable->insertRow(row);
-
-  // Initialize new row with default widgets
-  QComboBox *typeCombo = new QComboBox();
-  typeCombo->addItem("烟温复合探测器");
-  typeCombo->addItem("手动报警按钮");
-  typeCombo->addItem("输入输出模块");
-  typeCombo->addItem("声光报警器");
-  m_deviceTable->setCellWidget(row, 0, typeCombo);
-
-  m_deviceTable->setItem(row, 1, new QTableWidgetItem(""));
-  m_deviceTable->setItem(row, 2,
-                         new QTableWidgetItem(QString::number(nextAddress)));
-  m_deviceTable->setItem(row, 3, new QTableWidgetItem(""));
-  m_deviceTable->setItem(row, 4, new QTableWidgetItem("0"));
-  m_deviceTable->setItem(row, 5, new QTableWidgetItem("0"));
-  m_deviceTable->setItem(row, 6, new QTableWidgetItem(""));
-  m_deviceTable->setItem(row, 7, new QTableWidgetItem(""));
-  m_deviceTable->setItem(row, 8, new QTableWidgetItem(""));
+  m_deviceModel->appendDevice(device);
+  m_deviceTable->scrollToBottom();
 }
 
 void LoopModuleConfigDialog::onRemoveDevice() {
-  QList<QTableWidgetItem *> selectedItems = m_deviceTable->selectedItems();
-  if (selectedItems.isEmpty())
+  QModelIndexList selected =
+      m_deviceTable->selectionModel()->selectedIndexes();
+  if (selected.isEmpty())
+    return;
+
+  // The model removes unique rows from the bottom up
+  QList<int> rows;
+  for (const QModelIndex &index : selected) {
+    rows.append(index.row());
+  }
+  m_deviceModel->removeDevices(rows);
+}
+
+void LoopModuleConfigDialog::onImportDevices() {
+  if (m_importWatcher.isRunning())
+    return;
+
+  QString filePath = QFileDialog::getOpenFileName(
+      this, "导入设备", "", "CSV 文件 (*.csv);;所有文件 (*)");
+  if (filePath.isEmpty())
+    return;
+
+  // Exporting now would write the rows that are about to be replaced
+  m_importDevicesBtn->setEnabled(false);
+  m_exportDevicesBtn->setEnabled(false);
+  m_importChannel = m_currentChannelIndex;
+  m_importWatcher.setFuture(
+      QtConcurrent::run(&LoopDeviceCsv::readFile, filePath));
+}
+
+void LoopModuleConfigDialog::onImportFinished() {
+  m_importDevicesBtn->setEnabled(true);
+  m_exportDevicesBtn->setEnabled(true);
+
+  const LoopDeviceCsv::FileImport import = m_importWatcher.result();
+  if (!import.ok) {
+    QMessageBox::warning(
+        this, "导入设备", QString("读取文件失败: %1").arg(import.errorString));
+    return;
+  }
+  if (m_importChannel >= m_channelSelectCombo->count()) {
+    QMessageBox::warning(this, "导入设备", "通道已移除，导入已取消");
+    return;
+  }
+
+  // Replace the channel's devices in one step
+  const LoopDeviceCsv::ImportResult &result = import.result;
+  m_workingCopy->setDevices(m_importChannel, result.devices);
+  if (m_importChannel != m_currentChannelIndex)
+    m_channelSelectCombo->setCurrentIndex(m_importChannel);
+
+  QString summary = QString("已导入 %1 个设备").arg(result.devices.size());
+  if (result.errors.isEmpty()) {
+    QMessageBox::information(this, "导入设备", summary);
     return;
+  }
 
-  // Get unique rows to remove (since multiple cells in one row might be
-  // selected)
-  QSet<int> rows;
-  for (auto item : selectedItems) {
-    rows.insert(item->row());
+  QStringList details;
+  for (const LoopDeviceCsv::RowError &error : result.errors) {
+    details << QString("第 %1 行: %2").arg(error.line).arg(error.message);
   }
+  QMessageBox box(QMessageBox::Warning, "导入设备",
+                  QString("%1，%2 行有错误已跳过")
+                      .arg(summary)
+                      .arg(result.errors.size()),
+                  QMessageBox::Ok, this);
+  box.setDetailedText(details.join('\n'));
+  box.exec();
+}
 
-  // Remove from bottom up to avoid index shifting issues
-  QList<int> sortedRows = rows.values();
-  std::sort(sortedRows.begin(), sortedRows.end(), std::greater<int>());
+void LoopModuleConfigDialog::onExportDevices() {
+  QString filePath = QFileDialog::getSaveFileName(
+      this, "导出设备", "", "CSV 文件 (*.csv)");
+  if (filePath.isEmpty())
+    return;
 
-  for (int row : sortedRows) {
-    m_deviceTable->removeRow(row);
+  QSaveFile file(filePath);
+  QString errorString;
+  bool ok = file.open(QIODevice::WriteOnly) &&
+            LoopDeviceCsv::write(
+                &file, m_workingCopy->channelDevices(m_currentChannelIndex),
+                &errorString) &&
+            file.commit();
+  if (!ok) {
+    if (errorString.isEmpty())
+      errorString = file.errorString();
+    QMessageBox::warning(this, "导出设备",
+                         QString("写入文件失败: %1").arg(errorString));
   }
 }
 
 void LoopModuleConfigDialog::onSave() {
-  // Save the currently visible table data first
-  saveCurrentChannelData();
+  if (m_undoStack) {
+    pushChanges();
+    accept();
+    return;
+  }
 
-  // Apply all changes to the module
+  // Apply all changes to the module as one update
+  ModuleUpdateGuard<LoopModule> guard(m_module);
   m_module->setChannelCount(m_channelCountCombo->currentData().toInt());
   m_module->setLoopMode((LoopMode)m_loopModeCombo->currentData().toInt());
   m_module->setInitialized(m_initCheckBox->isChecked());
   m_module->setMappingSupported(m_mapCheckBox->isChecked());
 
   // Save devices for each channel
-  for (auto it = m_tempDevices.begin(); it != m_tempDevices.end(); ++it) {
-    // Only save up to the current channel count
-    if (it.key() < m_module->getChannelCount()) {
-      m_module->setDevices(it.key(), it.value());
+  for (int i = 0; i < m_module->getChannelCount(); ++i) {
+    if (m_workingCopy->deviceCount(i) > 0 || m_module->deviceCount(i) > 0) {
+      m_module->setDevices(i, m_workingCopy->getDevices(i));
     }
   }
 
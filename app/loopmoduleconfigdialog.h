@@ -1,14 +1,19 @@
 #ifndef LOOPMODULECONFIGDIALOG_H
 #define LOOPMODULECONFIGDIALOG_H
 
+#include "loopdevicecsv.h"
+#include "loopdevicetablemodel.h"
 #include "loopmodule.h"
+#include "symbolindex.h"
+#include "undostack.h"
 #include <QCheckBox>
 #include <QComboBox>
 #include <QDialog>
+#include <QFutureWatcher>
 #include <QGroupBox>
 #include <QPushButton>
 #include <QTabWidget>
-#include <QTableWidget>
+#include <QTableView>
 
 class LoopModuleConfigDialog : public QDialog {
   Q_OBJECT
@@ -18,11 +23,19 @@ public:
                                   QWidget *parent = nullptr);
   ~LoopModuleConfigDialog();
 
+  // Completes variable names from the project-wide symbol index
+  void setSymbolIndex(const SymbolIndex *index);
+  // Records saved changes as undoable commands for the given component
+  void setUndoStack(UndoStack *stack, quint64 componentId);
+
 private slots:
   void onChannelCountChanged(int index);
   void onChannelSelectionChanged(int index);
   void onAddDevice();
   void onRemoveDevice();
+  void onImportDevices();
+  void onExportDevices();
+  void onImportFinished();
   void onSave();
   void onLoopModeChanged(int index);
 
@@ -30,7 +43,8 @@ private:
   void setupUI();
   void loadData();
   void updateDeviceTable(int channelIndex);
-  void saveCurrentChannelData();
+  void reloadFromModule();
+  void pushChanges();
 
   LoopModule *m_module;
   int m_currentChannelIndex;
@@ -43,14 +57,25 @@ private:
   QCheckBox *m_initCheckBox;
   QCheckBox *m_mapCheckBox;
 
-  QTableWidget *m_deviceTable;
+  QTableView *m_deviceTable;
+  LoopDeviceTableModel *m_deviceModel;
   QPushButton *m_addDeviceBtn;
   QPushButton *m_removeDeviceBtn;
+  QPushButton *m_importDevicesBtn;
+  QPushButton *m_exportDevicesBtn;
   QPushButton *m_saveBtn;
   QPushButton *m_cancelBtn;
 
-  // Temporary storage for edits before saving
-  QMap<int, QList<LoopDevice>> m_tempDevices;
+  // Working copy that holds the edits until they are saved
+  LoopModule *m_workingCopy;
+
+  // CSV files are parsed off the GUI thread; the channel is recorded so the
+  // result still lands where the import was started
+  QFutureWatcher<LoopDeviceCsv::FileImport> m_importWatcher;
+  int m_importChannel;
+
+  UndoStack *m_undoStack;
+  quint64 m_componentId;
 };
 
 #endif // LOOPMODULECONFIGDIALOG_H
@@ -1,25 +1,94 @@
 #include "loopmoduleconfigwidget.h"
+#include "loopdevicecsv.h"
+#include "loopdevicedelegate.h"
+#include "moduleupdateguard.h"
+#include "projectcommands.h"
+#include "symbolcompleterdelegate.h"
 #include <QDebug>
+#include <QFileDialog>
 #include <QHBoxLayout>
 #include <QHeaderView>
 #include <QLabel>
 #include <QMessageBox>
+#include <QSaveFile>
 #include <QVBoxLayout>
+#include <QtConcurrent>
 
 LoopModuleConfigWidget::LoopModuleConfigWidget(LoopModule *module,
                                                QWidget *parent)
-    : QWidget(parent), m_module(module), m_currentChannelIndex(0) {
+    : QWidget(parent), m_module(nullptr), m_currentChannelIndex(0),
+      m_importModule(nullptr), m_importChannel(0), m_undoStack(nullptr),
+      m_componentId(0) {
+  m_workingCopy = new LoopModule(this);
+  setupUI();
+  setModule(module);
 
-  // Load initial data into temp storage
-  for (int i = 0; i < m_module->getChannelCount(); ++i) {
-    m_tempDevices[i] = m_module->getDevices(i);
-  }
+  connect(&m_importWatcher,
+          &QFutureWatcher<LoopDeviceCsv::FileImport>::finished, this,
+          &LoopModuleConfigWidget::onImportFinished);
+}
 
-  setupUI();
+LoopModuleConfigWidget::~LoopModuleConfigWidget() {}
+
+void LoopModuleConfigWidget::setSymbolIndex(const SymbolIndex *index) {
+  m_deviceTable->setItemDelegateForColumn(
+      LoopDeviceTableModel::VariableNameColumn,
+      new SymbolCompleterDelegate(index, m_deviceTable));
+}
+
+void LoopModuleConfigWidget::setModule(LoopModule *module) {
+  disconnect(m_moduleConnection);
+  m_module = module;
+  // Undo and redo change the module underneath the editor
+  m_moduleConnection =
+      connect(m_module, &LoopModule::dataChanged, this, [this]() {
+        if (m_undoStack && m_undoStack->isApplying()) {
+          reloadFromModule();
+        }
+      });
+
+  // Shares the module's storage; rows are copied only once they are edited
+  m_workingCopy->copyFrom(m_module);
   loadData();
 }
 
-LoopModuleConfigWidget::~LoopModuleConfigWidget() {}
+void LoopModuleConfigWidget::setUndoStack(UndoStack *stack,
+                                          quint64 componentId) {
+  m_undoStack = stack;
+  m_componentId = componentId;
+}
+
+void LoopModuleConfigWidget::reloadFromModule() {
+  int channel = m_currentChannelIndex;
+  m_workingCopy->copyFrom(m_module);
+  loadData();
+  if (channel < m_channelSelectCombo->count()) {
+    m_channelSelectCombo->setCurrentIndex(channel);
+  }
+}
+
+void LoopModuleConfigWidget::pushChanges() {
+  LoopSettings settings;
+  settings.channelCount = m_channelCountCombo->currentData().toInt();
+  settings.loopMode = (LoopMode)m_loopModeCombo->currentData().toInt();
+  settings.initialized = m_initCheckBox->isChecked();
+  settings.mappingSupported = m_mapCheckBox->isChecked();
+
+  // Only the rows that differ from the module are recorded
+  LoopModuleCommand *command =
+      new LoopModuleCommand("修改回路模块", m_componentId);
+  command->setSettings(LoopSettings::of(m_module), settings);
+  for (int i = 0; i < settings.channelCount; ++i) {
+    command->addChannelDiff(i, m_module->channelDevices(i),
+                            m_workingCopy->channelDevices(i));
+  }
+
+  if (command->isEmpty()) {
+    delete command;
+    return;
+  }
+  m_undoStack->push(command);
+}
 
 void LoopModuleConfigWidget::setupUI() {
   QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -74,24 +143,23 @@ void LoopModuleConfigWidget::setupUI() {
   configLayout->addLayout(channelSelectLayout);
 
   // Device List Table
-  m_deviceTable = new QTableWidget(this);
-  QStringList headers;
-  headers << "类型"
-          << "序列号"
-          << "地址"
-          << "个性代码"
-          << "盘号"
-          << "卡号"
-          << "设备说明"
-          << "设备标识"
-          << "变量名";
-  m_deviceTable->setColumnCount(headers.size());
-  m_deviceTable->setHorizontalHeaderLabels(headers);
+  // Rows come from the model on demand, so large channels open instantly
+  m_deviceModel = new LoopDeviceTableModel(m_workingCopy, this);
+  m_deviceTable = new QTableView(this);
+  m_deviceTable->setModel(m_deviceModel);
+  m_deviceTable->setItemDelegate(new LoopDeviceDelegate(m_deviceTable));
   m_deviceTable->horizontalHeader()->setSectionResizeMode(
       QHeaderView::Interactive);
   m_deviceTable->horizontalHeader()->setStretchLastSection(true);
   m_deviceTable->horizontalHeader()->setSectionsMovable(true);
+  m_deviceTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+  m_deviceTable->verticalHeader()->setDefaultSectionSize(
+      m_deviceTable->fontMetrics().height() + 8);
   m_deviceTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_deviceTable->setEditTriggers(QAbstractItemView::DoubleClicked |
+                                 QAbstractItemView::SelectedClicked |
+                                 QAbstractItemView::EditKeyPressed |
+                                 QAbstractItemView::AnyKeyPressed);
   m_deviceTable->setAlternatingRowColors(true);
 
   // Set default column widths
@@ -114,6 +182,10 @@ void LoopModuleConfigWidget::setupUI() {
   actionLayout->addWidget(m_addDeviceBtn);
   actionLayout->addWidget(m_removeDeviceBtn);
   actionLayout->addStretch();
+  m_importDevicesBtn = new QPushButton("导入CSV", this);
+  m_exportDevicesBtn = new QPushButton("导出CSV", this);
+  actionLayout->addWidget(m_importDevicesBtn);
+  actionLayout->addWidget(m_exportDevicesBtn);
   configLayout->addLayout(actionLayout);
 
   m_tabWidget->addTab(configTab, "回路配置");
@@ -148,6 +220,10 @@ void LoopModuleConfigWidget::setupUI() {
           &LoopModuleConfigWidget::onAddDevice);
   connect(m_removeDeviceBtn, &QPushButton::clicked, this,
           &LoopModuleConfigWidget::onRemoveDevice);
+  connect(m_importDevicesBtn, &QPushButton::clicked, this,
+          &LoopModuleConfigWidget::onImportDevices);
+  connect(m_exportDevicesBtn, &QPushButton::clicked, this,
+          &LoopModuleConfigWidget::onExportDevices);
   connect(m_saveBtn, &QPushButton::clicked, this,
           &LoopModuleConfigWidget::onSave);
 }
@@ -183,110 +259,7 @@ void LoopModuleConfigWidget::loadData() {
 }
 
 void LoopModuleConfigWidget::updateDeviceTable(int channelIndex) {
-  m_deviceTable->setRowCount(0);
-
-  if (!m_tempDevices.contains(channelIndex))
-    return;
-
-  const QList<LoopDevice> &devices = m_tempDevices[channelIndex];
-  m_deviceTable->setRowCount(devices.size());
-
-  for (int i = 0; i < devices.size(); ++i) {
-    const LoopDevice &device = devices[i];
-
-    // Type (ComboBox)
-    QComboBox *typeCombo = new QComboBox();
-    typeCombo->addItem("烟温复合探测器");
-    typeCombo->addItem("手动报警按钮");
-    typeCombo->addItem("输入输出模块");
-    typeCombo->addItem("声光报警器");
-    typeCombo->setCurrentText(device.type);
-    m_deviceTable->setCellWidget(i, 0, typeCombo);
-
-    // Serial Number
-    m_deviceTable->setItem(i, 1, new QTableWidgetItem(device.serialNumber));
-
-    // Address
-    m_deviceTable->setItem(
-        i, 2, new QTableWidgetItem(QString::number(device.address)));
-
-    // Personality Code
-    m_deviceTable->setItem(i, 3, new QTableWidgetItem(device.personalityCode));
-
-    // Panel Number
-    m_deviceTable->setItem(
-        i, 4, new QTableWidgetItem(QString::number(device.panelNumber)));
-
-    // Card Number
-    m_deviceTable->setItem(
-        i, 5, new QTableWidgetItem(QString::number(device.cardNumber)));
-
-    // Description
-    m_deviceTable->setItem(i, 6, new QTableWidgetItem(device.description));
-
-    // Identifier
-    m_deviceTable->setItem(i, 7, new QTableWidgetItem(device.identifier));
-
-    // Variable Name
-    m_deviceTable->setItem(i, 8, new QTableWidgetItem(device.variableName));
-  }
-}
-
-void LoopModuleConfigWidget::saveCurrentChannelData() {
-  QList<LoopDevice> devices;
-  for (int i = 0; i < m_deviceTable->rowCount(); ++i) {
-    LoopDevice device;
-
-    // Type
-    QComboBox *typeCombo =
-        qobject_cast<QComboBox *>(m_deviceTable->cellWidget(i, 0));
-    if (typeCombo)
-      device.type = typeCombo->currentText();
-
-    // Serial
-    QTableWidgetItem *item = m_deviceTable->item(i, 1);
-    if (item)
-      device.serialNumber = item->text();
-
-    // Address
-    item = m_deviceTable->item(i, 2);
-    if (item)
-      device.address = item->text().toInt();
-
-    // Personality
-    item = m_deviceTable->item(i, 3);
-    if (item)
-      device.personalityCode = item->text();
-
-    // Panel
-    item = m_deviceTable->item(i, 4);
-    if (item)
-      device.panelNumber = item->text().toInt();
-
-    // Card
-    item = m_deviceTable->item(i, 5);
-    if (item)
-      device.cardNumber = item->text().toInt();
-
-    // Description
-    item = m_deviceTable->item(i, 6);
-    if (item)
-      device.description = item->text();
-
-    // Identifier
-    item = m_deviceTable->item(i, 7);
-    if (item)
-      device.identifier = item->text();
-
-    // Variable Name
-    item = m_deviceTable->item(i, 8);
-    if (item)
-      device.variableName = item->text();
-
-    devices.append(device);
-  }
-
-  m_tempDevices[m_currentChannelIndex] = devices;
+  m_deviceModel->setChannel(channelIndex);
 }
 
 void LoopModuleConfigWidget::onChannelCountChanged(int index) {
@@ -311,63 +284,117 @@ void LoopModuleConfigWidget::onChannelSelectionChanged(int index) {
   if (index < 0)
     return;
 
-  // Save current table data before switching
-  saveCurrentChannelData();
-
   m_currentChannelIndex = index;
   updateDeviceTable(m_currentChannelIndex);
 }
 
 void LoopModuleConfigWidget::onAddDevice() {
-  int row = m_deviceTable->rowCount();
+  LoopDevice device;
+  device.type = LoopModule::deviceTypes().first();
 
   // Calculate next address
-  int nextAddress = 1;
-  if (row > 0) {
-    QTableWidgetItem *lastAddressItem = m_deviceTable->item(row - 1, 2);
-    if (lastAddressItem) {
-      nextAddress = lastAddressItem->text().toInt() + 1;
-    }
+  device.address = 1;
+  const LoopChannelDevices &devices =
+      m_workingCopy->channelDevices(m_currentChannelIndex);
+  if (!devices.isEmpty()) {
+    device.address = devices.address(devices.size() - 1) + 1;
   }
 
-  m_deviceTable->insertRow(row);
-
-  // Initialize new row with default widgets
-  QComboBox *typeCombo = new QComboBox();
-  typeCombo->addItem("烟温复合探测器");
-  typeCombo->addItem("手动报警按钮");
-  typeCombo->addItem("输入输出模块");
-  typeCombo->addItem("声光报警器");
-  m_deviceTable->setCellWidget(row, 0, typeCombo);
-
-  m_deviceTable->setItem(row, 1, new QTableWidgetItem(""));
-  m_deviceTable->setItem(row, 2,
-                         new QTableWidgetItem(QString::number(nextAddress)));
-  m_deviceTable->setItem(row, 3, new QTableWidgetItem(""));
-  m_deviceTable->setItem(row, 4, new QTableWidgetItem("0"));
-  m_deviceTable->setItem(row, 5, new QTableWidgetItem("0"));
-  m_deviceTable->setItem(row, 6, new QTableWidgetItem(""));
-  m_deviceTable->setItem(row, 7, new QTableWidgetItem(""));
-  m_deviceTable->setItem(row, 8, new QTableWidgetItem(""));
+  m_deviceModel->appendDevice(device);
+  m_deviceTable->scrollToBottom();
 }
 
 void LoopModuleConfigWidget::onRemoveDevice() {
-  QList<QTableWidgetItem *> selectedItems = m_deviceTable->selectedItems();
-  if (selectedItems.isEmpty())
+  QModelIndexList selected =
+      m_deviceTable->selectionModel()->selectedIndexes();
+  if (selected.isEmpty())
+    return;
+
+  // The model removes unique rows from the bottom up
+  QList<int> rows;
+  for (const QModelIndex &index : selected) {
+    rows.append(index.row());
+  }
+  m_deviceModel->removeDevices(rows);
+}
+
+void LoopModuleConfigWidget::onImportDevices() {
+  if (m_importWatcher.isRunning())
+    return;
+
+  QString filePath = QFileDialog::getOpenFileName(
+      this, "导入设备", "", "CSV 文件 (*.csv);;所有文件 (*)");
+  if (filePath.isEmpty())
+    return;
+
+  // Exporting now would write the rows that are about to be replaced
+  m_importDevicesBtn->setEnabled(false);
+  m_exportDevicesBtn->setEnabled(false);
+  m_importModule = m_module;
+  m_importChannel = m_currentChannelIndex;
+  m_importWatcher.setFuture(
+      QtConcurrent::run(&LoopDeviceCsv::readFile, filePath));
+}
+
+void LoopModuleConfigWidget::onImportFinished() {
+  m_importDevicesBtn->setEnabled(true);
+  m_exportDevicesBtn->setEnabled(true);
+
+  const LoopDeviceCsv::FileImport import = m_importWatcher.result();
+  if (!import.ok) {
+    QMessageBox::warning(
+        this, "导入设备", QString("读取文件失败: %1").arg(import.errorString));
+    return;
+  }
+  if (m_importModule != m_module ||
+      m_importChannel >= m_channelSelectCombo->count()) {
+    QMessageBox::warning(this, "导入设备", "模块已切换，导入已取消");
+    return;
+  }
+
+  // Replace the channel's devices in one step
+  const LoopDeviceCsv::ImportResult &result = import.result;
+  m_workingCopy->setDevices(m_importChannel, result.devices);
+  if (m_importChannel != m_currentChannelIndex)
+    m_channelSelectCombo->setCurrentIndex(m_importChannel);
+
+  QString summary = QString("已导入 %1 个设备").arg(result.devices.size());
+  if (result.errors.isEmpty()) {
+    QMessageBox::information(this, "导入设备", summary);
     return;
+  }
 
-  // Get unique rows to remove
-  QSet<int> rows;
-  for (auto item : selectedItems) {
-    rows.insert(item->row());
+  QStringList details;
+  for (const LoopDeviceCsv::RowError &error : result.errors) {
+    details << QString("第 %1 行: %2").arg(error.line).arg(error.message);
   }
+  QMessageBox box(QMessageBox::Warning, "导入设备",
+                  QString("%1，%2 行有错误已跳过")
+                      .arg(summary)
+                      .arg(result.errors.size()),
+                  QMessageBox::Ok, this);
+  box.setDetailedText(details.join('\n'));
+  box.exec();
+}
 
-  // Remove from bottom up
-  QList<int> sortedRows = rows.values();
-  std::sort(sortedRows.begin(), sortedRows.end(), std::greater<int>());
+void LoopModuleConfigWidget::onExportDevices() {
+  QString filePath = QFileDialog::getSaveFileName(
+      this, "导出设备", "", "CSV 文件 (*.csv)");
+  if (filePath.isEmpty())
+    return;
 
-  for (int row : sortedRows) {
-    m_deviceTable->removeRow(row);
+  QSaveFile file(filePath);
+  QString errorString;
+  bool ok = file.open(QIODevice::WriteOnly) &&
+            LoopDeviceCsv::write(
+                &file, m_workingCopy->channelDevices(m_currentChannelIndex),
+                &errorString) &&
+            file.commit();
+  if (!ok) {
+    if (errorString.isEmpty())
+      errorString = file.errorString();
+    QMessageBox::warning(this, "导出设备",
+                         QString("写入文件失败: %1").arg(errorString));
   }
 }
 
@@ -377,20 +404,22 @@ void LoopModuleConfigWidget::onSave() {
 }
 
 void LoopModuleConfigWidget::save() {
-  // Save the currently visible table data first
-  saveCurrentChannelData();
+  if (m_undoStack) {
+    pushChanges();
+    return;
+  }
 
-  // Apply all changes to the module
+  // Apply all changes to the module as one update
+  ModuleUpdateGuard<LoopModule> guard(m_module);
   m_module->setChannelCount(m_channelCountCombo->currentData().toInt());
   m_module->setLoopMode((LoopMode)m_loopModeCombo->currentData().toInt());
   m_module->setInitialized(m_initCheckBox->isChecked());
   m_module->setMappingSupported(m_mapCheckBox->isChecked());
 
   // Save devices for each channel
-  for (auto it = m_tempDevices.begin(); it != m_tempDevices.end(); ++it) {
-    // Only save up to the current channel count
-    if (it.key() < m_module->getChannelCount()) {
-      m_module->setDevices(it.key(), it.value());
+  for (int i = 0; i < m_module->getChannelCount(); ++i) {
+    if (m_workingCopy->deviceCount(i) > 0 || m_module->deviceCount(i) > 0) {
+      m_module->setDevices(i, m_workingCopy->getDevices(i));
     }
   }
 }
@@ -0,0 +1,89 @@
+#ifndef LOOPMODULECONFIGWIDGET_H
+#define LOOPMODULECONFIGWIDGET_H
+
+#include "loopdevicecsv.h"
+#include "loopdevicetablemodel.h"
+#include "loopmodule.h"
+#include "symbolindex.h"
+#include "undostack.h"
+#include <QCheckBox>
+#include <QComboBox>
+#include <QFutureWatcher>
+#include <QGroupBox>
+#include <QPushButton>
+#include <QTabWidget>
+#include <QTableView>
+#include <QWidget>
+
+
+class LoopModuleConfigWidget : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit LoopModuleConfigWidget(LoopModule *module,
+                                  QWidget *parent = nullptr);
+  ~LoopModuleConfigWidget();
+
+  // Completes variable names from the project-wide symbol index
+  void setSymbolIndex(const SymbolIndex *index);
+  // Rebinds the panel to another module; unsaved edits are discarded
+  void setModule(LoopModule *module);
+
+  // Records saved changes as undoable commands for the given component
+  void setUndoStack(UndoStack *stack, quint64 componentId);
+
+  void save(); // Public save method
+
+private slots:
+  void onChannelCountChanged(int index);
+  void onChannelSelectionChanged(int index);
+  void onAddDevice();
+  void onRemoveDevice();
+  void onImportDevices();
+  void onExportDevices();
+  void onImportFinished();
+  void onSave(); // Internal slot for save button
+  void onLoopModeChanged(int index);
+
+private:
+  void setupUI();
+  void loadData();
+  void updateDeviceTable(int channelIndex);
+  void reloadFromModule();
+  void pushChanges();
+
+  LoopModule *m_module;
+  int m_currentChannelIndex;
+
+  // UI Elements
+  QTabWidget *m_tabWidget;
+  QComboBox *m_channelCountCombo;
+  QComboBox *m_channelSelectCombo;
+  QComboBox *m_loopModeCombo;
+  QCheckBox *m_initCheckBox;
+  QCheckBox *m_mapCheckBox;
+
+  QTableView *m_deviceTable;
+  LoopDeviceTableModel *m_deviceModel;
+  QPushButton *m_addDeviceBtn;
+  QPushButton *m_removeDeviceBtn;
+  QPushButton *m_importDevicesBtn;
+  QPushButton *m_exportDevicesBtn;
+  QPushButton *m_saveBtn;
+
+  // Working copy that holds the edits until they are saved
+  LoopModule *m_workingCopy;
+
+  // CSV files are parsed off the GUI thread; the target module and channel
+  // are recorded so a result that arrives after a switch is dropped
+  QFutureWatcher<LoopDeviceCsv::FileImport> m_importWatcher;
+  LoopModule *m_importModule;
+  int m_importChannel;
+
+  UndoStack *m_undoStack;
+  quint64 m_componentId;
+  // Disconnected by handle since the module may be released first
+  QMetaObject::Connection m_moduleConnection;
+};
+
+#endif // LOOPMODULECONFIGWIDGET_H
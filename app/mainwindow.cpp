@@ -0,0 +1,1168 @@
+#include "mainwindow.h"
+#include "gotosymboldialog.h"
+#include "hostmodule.h"
+#include "newprojectwizard.h"
+#include "projectexport.h"
+#include "projecttreedelegate.h"
+#include "thememanager.h"
+#include <QAction>
+#include <QFileDialog>
+#include <QIcon>
+#include <QInputDialog> // 添加此头文件
+#include <QKeySequence>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QMenu> // 添加此头文件
+#include <QMessageBox>
+#include <QScopedPointer>
+#include <QStatusBar>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <QLabel>
+
+
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent), probeTimeout(2000), loadProgressDialog(nullptr) {
+  projectManager = new ProjectManager(this);
+  componentManager =
+      new ComponentManager(projectManager->projectModel(), this);
+
+  // 项目树按组件类型显示图标
+  ProjectModel *model = projectManager->projectModel();
+  model->setTypeDecoration("Project", QIcon(":/icons/default.png"));
+  for (const ComponentInfo &info : componentManager->getComponentTypes()) {
+    if (!info.iconPath.isEmpty()) {
+      model->setTypeDecoration(info.type, QIcon(info.iconPath));
+    }
+  }
+
+  setupUI();
+  // 初始化主题管理器
+  themeManager = new ThemeManager(this);
+
+  createActions();
+  createMenus();
+  createToolbars();
+  createDockWindows();
+
+  setWindowTitle(tr("Controller IDE"));
+  setMinimumSize(800, 600);
+
+  // 连接组件管理器信号
+  connect(componentManager, &ComponentManager::componentAdded, this,
+          &MainWindow::onComponentAdded);
+  connect(componentManager, &ComponentManager::componentDeleted, this,
+          &MainWindow::onComponentDeleted);
+  connect(componentManager, &ComponentManager::componentMoved, this,
+          &MainWindow::onComponentMoved);
+  connect(componentManager, &ComponentManager::componentOrderChanged, this,
+          &MainWindow::onComponentOrderChanged);
+  connect(componentManager, &ComponentManager::componentsReplicated, this,
+          [this](const QModelIndex &firstIndex, int copies) {
+            projectManager->setUnsavedChanges(true);
+            projectTreeView->setCurrentIndex(firstIndex);
+            statusBar()->showMessage(tr("已生成 %1 个副本").arg(copies), 3000);
+          });
+  connect(componentManager, &ComponentManager::componentConfigChanged, this,
+          [this](const QModelIndex &) {
+            projectManager->setUnsavedChanges(true);
+          });
+
+  // 连接项目加载信号
+  connect(projectManager, &ProjectManager::loadFinished, this,
+          &MainWindow::onProjectLoadFinished);
+
+  // 项目被替换时清空属性面板并释放旧项目的模块
+  connect(projectManager->projectModel(), &QAbstractItemModel::modelReset,
+          this, [this]() {
+            onProjectSelectionChanged(QModelIndex(), QModelIndex());
+            qDeleteAll(hostMonitors);
+            hostMonitors.clear();
+            qDeleteAll(hostSimulators);
+            hostSimulators.clear();
+            hostProber.cancel();
+            probeHostsAction->setEnabled(true);
+            componentManager->clearModules();
+          });
+
+  connect(&hostProber, &HostProber::hostStarted, this, [this](quint64 id) {
+    projectManager->projectModel()->setNodeStatus(
+        id, HostProber::statusText(HostProber::Connecting));
+  });
+  connect(&hostProber, &HostProber::hostFinished, this,
+          &MainWindow::onHostProbeFinished);
+  connect(&hostProber, &HostProber::finished, this,
+          &MainWindow::onProbeAllFinished);
+
+  // 项目校验在上面的连接之后创建，项目替换时先释放旧模块再重新校验
+  projectValidator =
+      new ProjectValidator(projectManager->projectModel(),
+                           componentManager->moduleRegistry(), this);
+  connect(projectValidator, &ProjectValidator::problemsChanged, this,
+          &MainWindow::refreshProblemList);
+  componentManager->setSymbolIndex(&projectValidator->symbolIndex());
+}
+
+MainWindow::~MainWindow() {}
+
+void MainWindow::setupUI() {
+  // 中央编辑区域可以根据需要添加
+  setCentralWidget(new QWidget());
+}
+
+void MainWindow::createActions() {
+  newProjectAction = new QAction(tr("新建项目"), this);
+  connect(newProjectAction, &QAction::triggered, this, &MainWindow::newProject);
+
+  openProjectAction = new QAction(tr("打开项目"), this);
+  connect(openProjectAction, &QAction::triggered, this,
+          &MainWindow::openProject);
+
+  saveProjectAction = new QAction(tr("保存项目"), this);
+  connect(saveProjectAction, &QAction::triggered, this,
+          &MainWindow::saveProject);
+
+  saveAsProjectAction = new QAction(tr("项目另存为"), this);
+  connect(saveAsProjectAction, &QAction::triggered, this,
+          &MainWindow::saveProjectAs);
+
+  addComponentAction = new QAction(tr("添加组件"), this);
+  connect(addComponentAction, &QAction::triggered, this,
+          &MainWindow::addComponent);
+
+  configureComponentAction = new QAction(tr("配置组件"), this);
+  connect(configureComponentAction, &QAction::triggered, this,
+          &MainWindow::configureComponent);
+
+  exitAction = new QAction(tr("退出"), this);
+  connect(exitAction, &QAction::triggered, this, &QWidget::close);
+
+  renameProjectAction = new QAction(tr("重命名项目"), this);
+  connect(renameProjectAction, &QAction::triggered, this,
+          &MainWindow::renameProject);
+
+  deleteComponentAction = new QAction(tr("删除组件"), this);
+  connect(deleteComponentAction, &QAction::triggered, this,
+          &MainWindow::deleteComponent);
+
+  moveComponentAction = new QAction(tr("移动组件"), this);
+  connect(moveComponentAction, &QAction::triggered, this,
+          &MainWindow::moveComponent);
+
+  // 主题切换动作
+  defaultThemeAction = new QAction(tr("默认主题"), this);
+  defaultThemeAction->setCheckable(true);
+  defaultThemeAction->setChecked(true);
+  connect(defaultThemeAction, &QAction::triggered, this,
+          &MainWindow::setDefaultTheme);
+
+  atomOneThemeAction = new QAction(tr("ATOM ONE"), this);
+  atomOneThemeAction->setCheckable(true);
+  connect(atomOneThemeAction, &QAction::triggered, this,
+          &MainWindow::setAtomOneTheme);
+
+  solarizedLightThemeAction = new QAction(tr("Solarized Light"), this);
+  solarizedLightThemeAction->setCheckable(true);
+  connect(solarizedLightThemeAction, &QAction::triggered, this,
+          &MainWindow::setSolarizedLightTheme);
+
+  // 上移和下移组件动作
+  moveUpAction = new QAction(tr("上移组件"), this);
+  moveUpAction->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_Up));
+  connect(moveUpAction, &QAction::triggered, this,
+          &MainWindow::moveComponentUp);
+
+  moveDownAction = new QAction(tr("下移组件"), this);
+  moveDownAction->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_Down));
+  connect(moveDownAction, &QAction::triggered, this,
+          &MainWindow::moveComponentDown);
+
+  goToSymbolAction = new QAction(tr("转到符号"), this);
+  goToSymbolAction->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_T));
+  connect(goToSymbolAction, &QAction::triggered, this,
+          &MainWindow::goToSymbol);
+
+  UndoStack *undoStack = componentManager->undoStack();
+  undoAction = new QAction(QIcon(":/icons/undo.png"), tr("撤销"), this);
+  undoAction->setShortcut(QKeySequence::Undo);
+  connect(undoAction, &QAction::triggered, undoStack, &UndoStack::undo);
+
+  redoAction = new QAction(QIcon(":/icons/redo.png"), tr("重做"), this);
+  redoAction->setShortcut(QKeySequence::Redo);
+  connect(redoAction, &QAction::triggered, undoStack, &UndoStack::redo);
+
+  connect(undoStack, &UndoStack::stateChanged, this,
+          &MainWindow::updateUndoActions);
+  connect(undoStack, &UndoStack::projectEdited, this,
+          [this]() { projectManager->setUnsavedChanges(true); });
+  updateUndoActions();
+
+  findAction = new QAction(QIcon(":/icons/find.png"), tr("查找"), this);
+  findAction->setShortcut(QKeySequence::Find);
+  connect(findAction, &QAction::triggered, this, &MainWindow::showFindPanel);
+
+  replaceAction = new QAction(QIcon(":/icons/replace.png"), tr("替换"), this);
+  replaceAction->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_H));
+  connect(replaceAction, &QAction::triggered, this,
+          &MainWindow::showReplacePanel);
+
+  compileImagesAction = new QAction(QIcon(":/icons/flash-outline.png"),
+                                    tr("编译下载镜像"), this);
+  connect(compileImagesAction, &QAction::triggered, this,
+          &MainWindow::compileDownloadImages);
+
+  probeHostsAction =
+      new QAction(QIcon(":/icons/comm.png"), tr("探测全部主机"), this);
+  connect(probeHostsAction, &QAction::triggered, this,
+          &MainWindow::probeAllHosts);
+}
+
+void MainWindow::createMenus() {
+  QMenu *fileMenu = menuBar()->addMenu(tr("文件"));
+  fileMenu->addAction(newProjectAction);
+  fileMenu->addAction(openProjectAction);
+  fileMenu->addAction(saveProjectAction);
+  fileMenu->addAction(saveAsProjectAction);
+  fileMenu->addAction(renameProjectAction); // 添加重命名项目菜单项
+  fileMenu->addSeparator();
+  fileMenu->addAction(compileImagesAction);
+  fileMenu->addAction(probeHostsAction);
+  fileMenu->addSeparator();
+  fileMenu->addAction(exitAction);
+
+  QMenu *componentMenu = menuBar()->addMenu(tr("组件"));
+  componentMenu->addAction(addComponentAction);
+  componentMenu->addAction(deleteComponentAction); // 添加删除组件菜单项
+  componentMenu->addAction(moveComponentAction); // 添加移动组件菜单项
+  componentMenu->addAction(configureComponentAction);
+
+  // 添加主题菜单
+  themeMenu = menuBar()->addMenu(tr("主题"));
+  themeMenu->addAction(defaultThemeAction);
+  themeMenu->addAction(atomOneThemeAction);
+  themeMenu->addAction(solarizedLightThemeAction);
+
+  // 添加到编辑菜单
+  // Initialize editMenu
+  editMenu = menuBar()->addMenu(tr("编辑"));
+  editMenu->addAction(undoAction);
+  editMenu->addAction(redoAction);
+  editMenu->addSeparator();
+  editMenu->addAction(moveUpAction);
+  editMenu->addAction(moveDownAction);
+  editMenu->addSeparator();
+  editMenu->addAction(findAction);
+  editMenu->addAction(replaceAction);
+  editMenu->addAction(goToSymbolAction);
+}
+
+void MainWindow::createToolbars() {
+  QToolBar *fileToolBar = addToolBar(tr("文件"));
+  fileToolBar->addAction(newProjectAction);
+  fileToolBar->addAction(openProjectAction);
+  fileToolBar->addAction(saveProjectAction);
+  fileToolBar->addAction(renameProjectAction); // 添加重命名项目工具栏按钮
+  fileToolBar->addAction(compileImagesAction);
+  fileToolBar->addAction(probeHostsAction);
+
+  QToolBar *componentToolBar = addToolBar(tr("组件"));
+  componentToolBar->addAction(addComponentAction);
+  componentToolBar->addAction(deleteComponentAction); // 添加删除组件工具栏按钮
+  componentToolBar->addAction(moveComponentAction); // 添加移动组件工具栏按钮
+  componentToolBar->addAction(configureComponentAction);
+
+  QToolBar *editToolBar = addToolBar(tr("编辑"));
+  editToolBar->addAction(undoAction);
+  editToolBar->addAction(redoAction);
+}
+
+void MainWindow::createDockWindows() {
+  // 项目树视图
+  projectDock = new QDockWidget(tr("项目"), this);
+  projectDock->setAllowedAreas(Qt::LeftDockWidgetArea |
+                               Qt::RightDockWidgetArea);
+  projectTreeView = new QTreeView(projectDock);
+
+  // 为项目树视图添加上下文菜单
+  projectTreeView->setContextMenuPolicy(Qt::CustomContextMenu);
+  connect(projectTreeView, &QTreeView::customContextMenuRequested, this,
+          &MainWindow::showProjectContextMenu);
+  projectTreeView->setModel(projectManager->projectModel());
+  projectTreeView->setItemDelegate(
+      new ProjectTreeDelegate(componentManager, projectTreeView));
+
+  // 可以选中多个组件一起拖放移动，移动由组件管理器记录到撤销栈
+  projectTreeView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+  projectTreeView->setDragDropMode(QAbstractItemView::InternalMove);
+  projectTreeView->setDefaultDropAction(Qt::MoveAction);
+  projectTreeView->setDropIndicatorShown(true);
+
+  // 连接选择改变信号
+  connect(projectTreeView->selectionModel(),
+          &QItemSelectionModel::currentChanged, this,
+          &MainWindow::onProjectSelectionChanged);
+
+  projectDock->setWidget(projectTreeView);
+  addDockWidget(Qt::LeftDockWidgetArea, projectDock);
+
+  // 组件列表
+  componentDock = new QDockWidget(tr("组件库"), this);
+  componentDock->setAllowedAreas(Qt::LeftDockWidgetArea |
+                                 Qt::RightDockWidgetArea);
+  QListWidget *componentList = new QListWidget(componentDock);
+  componentDock->setWidget(componentList);
+  addDockWidget(Qt::LeftDockWidgetArea, componentDock);
+
+  // 属性编辑器
+  propertiesDock = new QDockWidget(tr("属性"), this);
+  propertiesDock->setAllowedAreas(Qt::LeftDockWidgetArea |
+                                  Qt::RightDockWidgetArea);
+  propertiesStack = new QStackedWidget(propertiesDock);
+  selectionLabel = new QLabel(propertiesStack);
+  selectionLabel->setAlignment(Qt::AlignCenter);
+  propertiesStack->addWidget(selectionLabel);
+  propertiesDock->setWidget(propertiesStack);
+  addDockWidget(Qt::RightDockWidgetArea, propertiesDock);
+
+  // 校验问题列表，双击定位到对应组件
+  problemsDock = new QDockWidget(tr("问题"), this);
+  problemsDock->setAllowedAreas(Qt::BottomDockWidgetArea |
+                                Qt::LeftDockWidgetArea |
+                                Qt::RightDockWidgetArea);
+  problemList = new QListWidget(problemsDock);
+  connect(problemList, &QListWidget::itemActivated, this,
+          [this](QListWidgetItem *item) {
+            QModelIndex index =
+                projectManager->projectModel()->indexForComponentId(
+                    item->data(Qt::UserRole).toULongLong());
+            if (index.isValid()) {
+              projectTreeView->setCurrentIndex(index);
+              projectTreeView->scrollTo(index);
+            }
+          });
+  problemsDock->setWidget(problemList);
+  addDockWidget(Qt::BottomDockWidgetArea, problemsDock);
+
+  // 查找和替换，与问题列表共用底部区域
+  findDock = new QDockWidget(tr("查找和替换"), this);
+  findDock->setAllowedAreas(Qt::BottomDockWidgetArea |
+                            Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
+  findPanel = new FindReplacePanel(projectManager->projectModel(),
+                                   componentManager->moduleRegistry(),
+                                   componentManager->undoStack(), findDock);
+  connect(findPanel, &FindReplacePanel::componentActivated, this,
+          [this](quint64 id) {
+            QModelIndex index =
+                projectManager->projectModel()->indexForComponentId(id);
+            if (index.isValid()) {
+              projectTreeView->setCurrentIndex(index);
+              projectTreeView->scrollTo(index);
+            }
+          });
+  findDock->setWidget(findPanel);
+  addDockWidget(Qt::BottomDockWidgetArea, findDock);
+  tabifyDockWidget(problemsDock, findDock);
+  problemsDock->raise();
+}
+
+void MainWindow::showFindPanel() {
+  findDock->show();
+  findDock->raise();
+  findPanel->activate(false);
+}
+
+void MainWindow::showReplacePanel() {
+  findDock->show();
+  findDock->raise();
+  findPanel->activate(true);
+}
+
+void MainWindow::refreshProblemList() {
+  // 问题很多时只列出前面一部分，避免列表本身拖慢界面
+  const int maxListedProblems = 1000;
+
+  QVector<ValidationProblem> problems = projectValidator->problems();
+  problemList->clear();
+  for (int i = 0; i < problems.size() && i < maxListedProblems; ++i) {
+    const ValidationProblem &problem = problems.at(i);
+    QListWidgetItem *item =
+        new QListWidgetItem(projectValidator->describe(problem), problemList);
+    item->setData(Qt::UserRole,
+                  QVariant::fromValue(problem.locations.first().componentId));
+  }
+  if (problems.size() > maxListedProblems) {
+    new QListWidgetItem(
+        tr("还有 %1 个问题未列出").arg(problems.size() - maxListedProblems),
+        problemList);
+  }
+
+  problemsDock->setWindowTitle(problems.isEmpty()
+                                   ? tr("问题")
+                                   : tr("问题 (%1)").arg(problems.size()));
+}
+
+void MainWindow::updateUndoActions() {
+  UndoStack *undoStack = componentManager->undoStack();
+  undoAction->setEnabled(undoStack->canUndo());
+  undoAction->setText(undoStack->canUndo()
+                          ? tr("撤销 %1").arg(undoStack->undoText())
+                          : tr("撤销"));
+  redoAction->setEnabled(undoStack->canRedo());
+  redoAction->setText(undoStack->canRedo()
+                          ? tr("重做 %1").arg(undoStack->redoText())
+                          : tr("重做"));
+}
+
+void MainWindow::goToSymbol() {
+  GoToSymbolDialog dialog(&projectValidator->symbolIndex(),
+                          projectManager->projectModel(), this);
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+
+  QModelIndex index = projectManager->projectModel()->indexForComponentId(
+      dialog.selectedComponentId());
+  if (index.isValid()) {
+    projectTreeView->setCurrentIndex(index);
+    projectTreeView->scrollTo(index);
+  }
+}
+
+void MainWindow::onProjectSelectionChanged(const QModelIndex &current,
+                                           const QModelIndex &previous) {
+  Q_UNUSED(previous);
+
+  if (!current.isValid()) {
+    selectionLabel->clear();
+    propertiesStack->setCurrentWidget(selectionLabel);
+    return;
+  }
+
+  // 同类组件共用一个面板，这里只把面板切换到新选中组件的模块
+  QWidget *configWidget = componentManager->getComponentConfigWidget(current);
+  if (!configWidget) {
+    // 如果没有配置界面，显示默认信息
+    QString name = projectManager->projectModel()->nodeName(current);
+    selectionLabel->setText(tr("选中项: %1").arg(name));
+    configWidget = selectionLabel;
+  }
+  if (propertiesStack->indexOf(configWidget) < 0) {
+    propertiesStack->addWidget(configWidget);
+  }
+  propertiesStack->setCurrentWidget(configWidget);
+}
+
+void MainWindow::newProject() {
+  if (projectManager->hasUnsavedChanges()) {
+    QMessageBox::StandardButton reply = QMessageBox::question(
+        this, tr("保存更改"), tr("是否保存当前项目的更改?"),
+        QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+
+    if (reply == QMessageBox::Yes) {
+      // 保存失败时不丢弃当前项目
+      if (!saveProject()) {
+        return;
+      }
+    } else if (reply == QMessageBox::Cancel) {
+      return;
+    }
+  }
+
+  NewProjectWizard wizard(this);
+  if (wizard.exec() == QDialog::Accepted) {
+    if (wizard.isImport()) {
+      startLoadProject(wizard.importPath());
+    } else {
+      projectManager->newProject(wizard.projectName(), wizard.projectPath());
+    }
+  }
+}
+
+void MainWindow::openProject() {
+  if (projectManager->hasUnsavedChanges()) {
+    QMessageBox::StandardButton reply = QMessageBox::question(
+        this, tr("保存更改"), tr("是否保存当前项目的更改?"),
+        QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+
+    if (reply == QMessageBox::Yes) {
+      // 保存失败时不丢弃当前项目
+      if (!saveProject()) {
+        return;
+      }
+    } else if (reply == QMessageBox::Cancel) {
+      return;
+    }
+  }
+
+  QString fileName = QFileDialog::getOpenFileName(
+      this, tr("打开项目"), "",
+      tr("项目文件 (*.xml *.tfl);;XML 项目文件 (*.xml);;二进制项目文件 "
+         "(*.tfl)"));
+
+  if (!fileName.isEmpty()) {
+    startLoadProject(fileName);
+  }
+}
+
+void MainWindow::startLoadProject(const QString &path) {
+  if (!loadProgressDialog) {
+    loadProgressDialog = new QProgressDialog(this);
+    loadProgressDialog->setWindowTitle(tr("打开项目"));
+    loadProgressDialog->setCancelButtonText(tr("取消"));
+    loadProgressDialog->setRange(0, 100);
+    loadProgressDialog->setWindowModality(Qt::WindowModal);
+    loadProgressDialog->setAutoClose(false);
+    loadProgressDialog->setAutoReset(false);
+    connect(projectManager, &ProjectManager::loadProgress, loadProgressDialog,
+            &QProgressDialog::setValue);
+    connect(loadProgressDialog, &QProgressDialog::canceled, projectManager,
+            &ProjectManager::cancelLoad);
+  }
+
+  loadProgressDialog->setLabelText(tr("正在加载: %1").arg(path));
+  loadProgressDialog->setValue(0);
+  loadProgressDialog->show();
+
+  statusBar()->showMessage(tr("正在加载项目..."));
+  projectManager->loadProjectAsync(path);
+}
+
+void MainWindow::onProjectLoadFinished(bool success,
+                                       const QString &errorString) {
+  if (loadProgressDialog) {
+    loadProgressDialog->hide();
+  }
+
+  if (success) {
+    statusBar()->showMessage(
+        tr("项目已加载: %1").arg(projectManager->currentProjectPath()), 3000);
+  } else {
+    statusBar()->showMessage(tr("项目加载失败: %1").arg(errorString), 3000);
+  }
+}
+
+bool MainWindow::saveProject() {
+  if (projectManager->currentProjectPath().isEmpty()) {
+    return saveProjectAs();
+  }
+  componentManager->storeConfigurations();
+  return writeProject(projectManager->currentProjectPath());
+}
+
+bool MainWindow::saveProjectAs() {
+  QString fileName = QFileDialog::getSaveFileName(
+      this, tr("保存项目"), "",
+      tr("XML 项目文件 (*.xml);;二进制项目文件 (*.tfl)"));
+
+  if (fileName.isEmpty()) {
+    return false;
+  }
+  componentManager->storeConfigurations();
+  return writeProject(fileName);
+}
+
+bool MainWindow::writeProject(const QString &path) {
+  QString errorString;
+  if (!projectManager->saveProject(path, &errorString)) {
+    QMessageBox::warning(this, tr("保存项目"),
+                         tr("无法保存项目 %1:\n%2").arg(path, errorString));
+    return false;
+  }
+  statusBar()->showMessage(tr("项目已保存: %1").arg(path), 3000);
+  return true;
+}
+
+void MainWindow::compileDownloadImages() {
+  QString directory = QFileDialog::getExistingDirectory(
+      this, tr("选择下载镜像的输出目录"), imageDirectory);
+  if (directory.isEmpty()) {
+    return;
+  }
+  imageDirectory = directory;
+
+  componentManager->storeConfigurations();
+  QString errorString;
+  int fileCount = ProjectExport::exportImages(
+      projectManager->projectModel()->tree(), directory, &imageCompiler,
+      &errorString);
+  if (fileCount < 0) {
+    QMessageBox::warning(this, tr("编译下载镜像"),
+                         tr("编译失败: %1").arg(errorString));
+    return;
+  }
+  statusBar()->showMessage(tr("已编译 %1 个主机的下载镜像，重新生成 %2 个")
+                               .arg(fileCount)
+                               .arg(imageCompiler.rebuiltCount()),
+                           3000);
+}
+
+// 按主机配置的地址轮询下属 DI/DO 模块的位值，再次调用时停止
+void MainWindow::toggleHostMonitor(const QModelIndex &index) {
+  ProjectModel *model = projectManager->projectModel();
+  if (!index.isValid() || model->nodeType(index) != "HostModule") {
+    return;
+  }
+  quint64 hostId = model->componentId(index);
+  if (HostIoMonitor *monitor = hostMonitors.take(hostId)) {
+    delete monitor;
+    statusBar()->showMessage(
+        tr("已停止监控主机: %1").arg(model->nodeName(index)), 3000);
+    return;
+  }
+
+  ModuleRegistry *registry = componentManager->moduleRegistry();
+  HostModule *hostModule = qobject_cast<HostModule *>(
+      registry->acquire(hostId, model->nodeType(index),
+                        model->nodeConfig(index), model->nodeName(index)));
+  if (!hostModule) {
+    return;
+  }
+  HostConfiguration config = hostModule->getConfiguration();
+  ControllerSimulator *simulator = hostSimulators.value(hostId);
+  if (simulator) {
+    config.ipAddress = simulator->address().toString();
+    config.port = simulator->modbusPort();
+  } else if (config.protocol != CommunicationProtocol::TCP) {
+    QMessageBox::warning(this, tr("开始监控"),
+                         tr("在线监控只支持 Modbus/TCP，请将主机的通信协议"
+                            "设置为 TCP"));
+    return;
+  }
+
+  bool ok;
+  int interval = QInputDialog::getInt(this, tr("开始监控"),
+                                      tr("轮询周期 (毫秒):"), 200, 10, 60000,
+                                      10, &ok);
+  if (!ok) {
+    return;
+  }
+
+  // DI 模块映射为离散输入，DO 模块映射为线圈，按树中顺序从 0 开始编址
+  HostIoMonitor *monitor = new HostIoMonitor(this);
+  for (int i = 0; i < model->rowCount(index); ++i) {
+    QModelIndex child = model->index(i, 0, index);
+    QString type = model->nodeType(child);
+    if (type == "DIModule" || type == "DOModule") {
+      monitor->addModule(registry->acquire(model->componentId(child), type,
+                                           model->nodeConfig(child),
+                                           model->nodeName(child)));
+    }
+  }
+  if (monitor->moduleCount() == 0) {
+    delete monitor;
+    QMessageBox::information(this, tr("开始监控"),
+                             tr("该主机下没有 DI 或 DO 模块"));
+    return;
+  }
+
+  QString hostName = model->nodeName(index);
+  connect(monitor, &HostIoMonitor::errorOccurred, this,
+          [this, hostName](const QString &errorString) {
+            statusBar()->showMessage(
+                tr("监控主机 %1 出错: %2").arg(hostName, errorString), 3000);
+          });
+  monitor->setEndpoint(config.ipAddress, static_cast<quint16>(config.port));
+  monitor->setPollInterval(interval);
+  monitor->start();
+  hostMonitors.insert(hostId, monitor);
+  statusBar()->showMessage(tr("开始监控主机 %1 (%2:%3)")
+                               .arg(hostName, config.ipAddress)
+                               .arg(config.port),
+                           3000);
+}
+
+// 按主机子树的当前配置在本机启动一个仿真器，再次调用时停止
+void MainWindow::toggleHostSimulator(const QModelIndex &index) {
+  ProjectModel *model = projectManager->projectModel();
+  if (!index.isValid() || model->nodeType(index) != "HostModule") {
+    return;
+  }
+  quint64 hostId = model->componentId(index);
+  QString hostName = model->nodeName(index);
+  if (ControllerSimulator *simulator = hostSimulators.take(hostId)) {
+    delete simulator;
+    statusBar()->showMessage(tr("已停止主机 %1 的仿真器").arg(hostName),
+                             3000);
+    return;
+  }
+
+  bool ok;
+  int eventRate = QInputDialog::getInt(this, tr("启动仿真器"),
+                                       tr("每秒产生的报警和故障事件数:"), 0,
+                                       0, 100000, 100, &ok);
+  if (!ok) {
+    return;
+  }
+
+  // 仿真器读取项目树中的配置段，先写回属性面板中的修改
+  componentManager->storeConfigurations();
+  ControllerSimulator *simulator = new ControllerSimulator(this);
+  simulator->load(model->tree(), model->tree().nodeForComponentId(hostId));
+  simulator->setEventRate(eventRate);
+  if (!simulator->listen()) {
+    QMessageBox::warning(this, tr("启动仿真器"),
+                         tr("无法监听: %1").arg(simulator->errorString()));
+    delete simulator;
+    return;
+  }
+  connect(simulator, &ControllerSimulator::configurationDownloaded, this,
+          [this](const QString &name) {
+            statusBar()->showMessage(tr("仿真器已接受主机 %1 的下载").arg(name),
+                                     3000);
+          });
+  connect(simulator, &ControllerSimulator::downloadRejected, this,
+          [this](const QString &errorString) {
+            statusBar()->showMessage(tr("仿真器拒绝下载: %1").arg(errorString),
+                                     3000);
+          });
+  hostSimulators.insert(hostId, simulator);
+
+  QMessageBox::information(
+      this, tr("启动仿真器"),
+      tr("主机 %1 的仿真器已启动\n\n"
+         "Modbus/TCP: %2:%3\n下载: %2:%4\n事件(UDP): %2:%5\n\n"
+         "之后开始监控该主机时将连接仿真器。")
+          .arg(hostName, simulator->address().toString())
+          .arg(simulator->modbusPort())
+          .arg(simulator->downloadPort())
+          .arg(simulator->eventPort()));
+}
+
+// 同时连接全部 TCP 主机，运行仿真器的主机连接仿真器
+void MainWindow::probeAllHosts() {
+  bool ok;
+  int timeout = QInputDialog::getInt(this, tr("探测全部主机"),
+                                     tr("每个主机的超时 (毫秒):"),
+                                     probeTimeout, 100, 60000, 100, &ok);
+  if (!ok) {
+    return;
+  }
+  probeTimeout = timeout;
+
+  componentManager->storeConfigurations();
+  ProjectModel *model = projectManager->projectModel();
+  const ProjectTree &tree = model->tree();
+  ModuleRegistry *registry = componentManager->moduleRegistry();
+  model->clearNodeStatuses();
+
+  QVector<HostProber::Target> targets;
+  QVector<int> stack;
+  if (!tree.isEmpty()) {
+    stack.append(tree.rootNode());
+  }
+  while (!stack.isEmpty()) {
+    // 逆序入栈，按项目树中的顺序开始探测
+    int node = stack.takeLast();
+    for (int row = tree.childCount(node) - 1; row >= 0; --row) {
+      stack.append(tree.childAt(node, row));
+    }
+    if (tree.type(node) != "HostModule") {
+      continue;
+    }
+
+    // 只读取地址和端口，未加载的主机临时解析配置段，不在注册表中创建模块
+    quint64 hostId = tree.componentId(node);
+    HostConfiguration config;
+    if (HostModule *loaded = registry->moduleAs<HostModule>(hostId)) {
+      config = loaded->getConfiguration();
+    } else {
+      QScopedPointer<QObject> module(ModuleRegistry::createModule(
+          tree.type(node), tree.config(node), tree.name(node)));
+      HostModule *hostModule = qobject_cast<HostModule *>(module.data());
+      if (!hostModule) {
+        continue;
+      }
+      config = hostModule->getConfiguration();
+    }
+    HostProber::Target target;
+    target.hostId = hostId;
+    target.address = config.ipAddress;
+    target.port = static_cast<quint16>(config.port);
+    if (ControllerSimulator *simulator = hostSimulators.value(hostId)) {
+      target.address = simulator->address().toString();
+      target.port = simulator->modbusPort();
+    } else if (config.protocol != CommunicationProtocol::TCP) {
+      model->setNodeStatus(hostId, tr("UDP，未探测"));
+      continue;
+    }
+    model->setNodeStatus(hostId, HostProber::statusText(HostProber::Pending));
+    targets.append(target);
+  }
+
+  if (targets.isEmpty()) {
+    statusBar()->showMessage(tr("项目中没有可探测的 TCP 主机"), 3000);
+    return;
+  }
+  probeHostsAction->setEnabled(false);
+  statusBar()->showMessage(tr("正在探测 %1 个主机...").arg(targets.size()));
+  hostProber.setTimeout(probeTimeout);
+  hostProber.start(targets);
+}
+
+void MainWindow::onHostProbeFinished(const HostProber::Result &result) {
+  QString status = HostProber::statusText(result.status);
+  if (result.status == HostProber::Reachable) {
+    status = tr("%1 %2 ms").arg(status).arg(result.latency, 0, 'f', 1);
+  }
+  projectManager->projectModel()->setNodeStatus(result.hostId, status);
+}
+
+void MainWindow::onProbeAllFinished() {
+  probeHostsAction->setEnabled(true);
+
+  int counts[HostProber::TimedOut + 1] = {0};
+  for (const HostProber::Result &result : hostProber.results()) {
+    ++counts[result.status];
+  }
+  QString message = tr("已探测 %1 个主机: 可达 %2，拒绝连接 %3，不可达 %4，"
+                       "超时 %5")
+                        .arg(hostProber.results().size())
+                        .arg(counts[HostProber::Reachable])
+                        .arg(counts[HostProber::Refused])
+                        .arg(counts[HostProber::Unreachable])
+                        .arg(counts[HostProber::TimedOut]);
+  HostProber::LatencySummary summary = hostProber.summary();
+  if (summary.count > 0) {
+    message += tr("；连接时间 最短 %1 ms，中位 %2 ms，P99 %3 ms")
+                   .arg(summary.minimum, 0, 'f', 1)
+                   .arg(summary.median, 0, 'f', 1)
+                   .arg(summary.p99, 0, 'f', 1);
+  }
+  statusBar()->showMessage(message);
+}
+
+void MainWindow::addComponent() { componentManager->showAddComponentDialog(); }
+
+void MainWindow::configureComponent() {
+  // 获取当前选中的项目
+  QModelIndex selectedIndex = projectTreeView->currentIndex();
+  if (!selectedIndex.isValid()) {
+    QMessageBox::information(this, tr("配置组件"), tr("请先选择一个组件"));
+    return;
+  }
+
+  componentManager->showConfigureComponentDialog(selectedIndex);
+}
+
+// 添加组件处理函数
+void MainWindow::onComponentAdded(const ComponentInfo &component,
+                                  int count) {
+  // 获取项目树视图的模型
+  ProjectModel *model = projectManager->projectModel();
+  if (!model) {
+    return;
+  }
+
+  // 如果项目为空，创建一个根节点
+  if (model->rowCount() == 0) {
+    ProjectTree tree;
+    tree.createRoot("新项目");
+    model->setTree(tree);
+  }
+
+  // 获取当前选中的项
+  QModelIndex selectedIndex = projectTreeView->currentIndex();
+  QModelIndex parentIndex;
+
+  if (selectedIndex.isValid()) {
+    parentIndex = selectedIndex;
+  } else {
+    parentIndex = model->rootIndex(); // 根节点
+  }
+
+  // 数量大于 1 时名称后附加序号
+  QStringList names;
+  if (count > 1) {
+    names.reserve(count);
+    for (int i = 1; i <= count; ++i) {
+      names.append(QString("%1 %2").arg(component.name).arg(i));
+    }
+  } else {
+    names.append(component.name);
+  }
+
+  // 根据组件层级添加到项目树中
+  QModelIndex targetIndex;
+  if (component.level == 1) {
+    // 第一层级 - 主机模块
+    // 如果选中的是根节点，直接添加到根节点下
+    // 如果选中的不是根节点，添加到根节点下
+    // 图标由模型按组件类型提供
+    targetIndex = model->rootIndex();
+  } else if (component.level == 2) {
+    // 第二层级 - 其他模块，需要添加到主机模块下
+    // 查找主机模块
+    QModelIndex hostIndex;
+
+    // 如果选中的是主机模块，直接添加到主机模块下
+    if (parentIndex.isValid() &&
+        model->nodeType(parentIndex) == "HostModule") {
+      hostIndex = parentIndex;
+    } else {
+      // 否则查找主机模块
+      QModelIndex rootIndex = model->rootIndex();
+      for (int i = 0; i < model->rowCount(rootIndex); ++i) {
+        QModelIndex child = model->index(i, 0, rootIndex);
+        if (model->nodeType(child) == "HostModule") {
+          hostIndex = child;
+          break;
+        }
+      }
+    }
+
+    if (!hostIndex.isValid()) {
+      // 如果没有主机模块，先创建一个
+      QMessageBox::warning(this, "添加组件", "请先添加主机模块！");
+      return;
+    }
+
+    targetIndex = hostIndex;
+  }
+  if (!targetIndex.isValid()) {
+    return;
+  }
+
+  // 整组一次插入，视图只展开新组件所在的父节点，不重新布局整棵树
+  componentManager->addComponents(targetIndex, names, component.type);
+  for (QModelIndex index = targetIndex; index.isValid();
+       index = index.parent()) {
+    projectTreeView->expand(index);
+  }
+
+  // 标记项目有未保存的更改
+  projectManager->setUnsavedChanges(true);
+
+  QString message = count > 1 ? QString("已添加 %1 个组件: %2")
+                                    .arg(count)
+                                    .arg(component.name)
+                              : QString("已添加组件: %1").arg(component.name);
+  statusBar()->showMessage(message, 3000);
+}
+
+void MainWindow::renameProject() {
+  ProjectModel *model = projectManager->projectModel();
+  if (model->rowCount() == 0) {
+    return;
+  }
+
+  bool ok;
+  QString newName = QInputDialog::getText(
+      this, tr("重命名项目"), tr("项目名称:"), QLineEdit::Normal,
+      model->nodeName(model->rootIndex()), &ok);
+  if (ok && !newName.isEmpty()) {
+    componentManager->renameComponent(model->rootIndex(), newName);
+    statusBar()->showMessage(tr("项目已重命名为: %1").arg(newName), 3000);
+  }
+}
+
+void MainWindow::deleteComponent() {
+  QModelIndex currentIndex = projectTreeView->currentIndex();
+  if (currentIndex.isValid() && currentIndex.parent().isValid()) {
+    componentManager->showDeleteComponentDialog(currentIndex);
+  } else {
+    QMessageBox::warning(this, tr("删除组件"), tr("请先选择要删除的组件"));
+  }
+}
+
+void MainWindow::moveComponent() {
+  QModelIndex currentIndex = projectTreeView->currentIndex();
+  if (currentIndex.isValid() && currentIndex.parent().isValid()) {
+    componentManager->showMoveComponentDialog(currentIndex);
+  } else {
+    QMessageBox::warning(this, tr("移动组件"), tr("请先选择要移动的组件"));
+  }
+}
+
+void MainWindow::onComponentDeleted(const QModelIndex &index) {
+  if (index.isValid() && index.parent().isValid()) {
+    // 从父项中移除该项，子树内容保存在撤销栈中
+    componentManager->deleteComponent(index);
+
+    projectManager->setUnsavedChanges(true);
+    statusBar()->showMessage(tr("组件已删除"), 3000);
+  }
+}
+
+void MainWindow::onComponentMoved(const QModelIndex &index,
+                                  const QModelIndex &newParent) {
+  if (index.isValid() && newParent.isValid() && index.parent().isValid()) {
+    // 组件连同子树一起移动，组件编号和模块都保持不变
+    QString itemText = projectManager->projectModel()->nodeName(index);
+    componentManager->moveComponent(index, newParent);
+
+    projectManager->setUnsavedChanges(true);
+    statusBar()->showMessage(tr("组件已移动: %1").arg(itemText), 3000);
+  }
+}
+
+void MainWindow::showProjectContextMenu(const QPoint &pos) {
+  QModelIndex index = projectTreeView->indexAt(pos);
+  if (index.isValid()) {
+    QMenu contextMenu(this);
+
+    // 如果是根节点，添加重命名项目选项
+    if (!index.parent().isValid()) {
+      QAction *renameAction = new QAction(tr("重命名项目"), this);
+      connect(renameAction, &QAction::triggered, this,
+              &MainWindow::renameProject);
+      contextMenu.addAction(renameAction);
+      contextMenu.addSeparator();
+    }
+
+    // 添加组件选项
+    QAction *addAction = new QAction(tr("添加组件"), this);
+    connect(addAction, &QAction::triggered, this, &MainWindow::addComponent);
+    contextMenu.addAction(addAction);
+
+    // 如果不是根节点，添加组件配置、删除和移动选项
+    if (index.parent().isValid()) {
+      QAction *configureAction = new QAction(tr("配置组件"), this);
+      connect(configureAction, &QAction::triggered, this, [this]() {
+        QModelIndex currentIndex = projectTreeView->currentIndex();
+        if (currentIndex.isValid()) {
+          componentManager->showConfigureComponentDialog(currentIndex);
+        }
+      });
+      contextMenu.addAction(configureAction);
+
+      QAction *deleteAction = new QAction(tr("删除组件"), this);
+      connect(deleteAction, &QAction::triggered, this, [this]() {
+        QModelIndex currentIndex = projectTreeView->currentIndex();
+        if (currentIndex.isValid()) {
+          componentManager->showDeleteComponentDialog(currentIndex);
+        }
+      });
+      contextMenu.addAction(deleteAction);
+
+      QAction *moveAction = new QAction(tr("移动组件"), this);
+      connect(moveAction, &QAction::triggered, this, [this]() {
+        QModelIndex currentIndex = projectTreeView->currentIndex();
+        if (currentIndex.isValid()) {
+          componentManager->showMoveComponentDialog(currentIndex);
+        }
+      });
+      contextMenu.addAction(moveAction);
+
+      // 主机可以连同下属模块按规则复制多份
+      if (projectManager->projectModel()->nodeType(index) == "HostModule") {
+        QAction *replicateAction = new QAction(tr("复制主机..."), this);
+        connect(replicateAction, &QAction::triggered, this, [this]() {
+          QModelIndex currentIndex = projectTreeView->currentIndex();
+          if (currentIndex.isValid()) {
+            componentManager->showReplicateDialog(currentIndex);
+          }
+        });
+        contextMenu.addAction(replicateAction);
+
+        quint64 hostId = projectManager->projectModel()->componentId(index);
+        QAction *monitorAction = new QAction(
+            hostMonitors.contains(hostId) ? tr("停止监控") : tr("开始监控"),
+            this);
+        connect(monitorAction, &QAction::triggered, this, [this]() {
+          toggleHostMonitor(projectTreeView->currentIndex());
+        });
+        contextMenu.addAction(monitorAction);
+
+        QAction *simulatorAction = new QAction(
+            hostSimulators.contains(hostId) ? tr("停止仿真器")
+                                            : tr("启动仿真器"),
+            this);
+        connect(simulatorAction, &QAction::triggered, this, [this]() {
+          toggleHostSimulator(projectTreeView->currentIndex());
+        });
+        contextMenu.addAction(simulatorAction);
+      }
+
+      // 添加上移和下移选项
+      contextMenu.addSeparator();
+
+      QAction *moveUpAction = new QAction(tr("上移"), this);
+      connect(moveUpAction, &QAction::triggered, this,
+              &MainWindow::moveComponentUp);
+      contextMenu.addAction(moveUpAction);
+
+      QAction *moveDownAction = new QAction(tr("下移"), this);
+      connect(moveDownAction, &QAction::triggered, this,
+              &MainWindow::moveComponentDown);
+      contextMenu.addAction(moveDownAction);
+    }
+
+    // 显示上下文菜单
+    contextMenu.exec(projectTreeView->viewport()->mapToGlobal(pos));
+  }
+}
+
+void MainWindow::setDefaultTheme() {
+  themeManager->applyTheme(ThemeManager::Default);
+  defaultThemeAction->setChecked(true);
+  atomOneThemeAction->setChecked(false);
+  solarizedLightThemeAction->setChecked(false);
+  statusBar()->showMessage(tr("已应用默认主题"), 3000);
+}
+
+void MainWindow::setAtomOneTheme() {
+  themeManager->applyTheme(ThemeManager::AtomOne);
+  defaultThemeAction->setChecked(false);
+  atomOneThemeAction->setChecked(true);
+  solarizedLightThemeAction->setChecked(false);
+  statusBar()->showMessage(tr("已应用ATOM ONE主题"), 3000);
+}
+
+void MainWindow::setSolarizedLightTheme() {
+  themeManager->applyTheme(ThemeManager::SolarizedLight);
+  defaultThemeAction->setChecked(false);
+  atomOneThemeAction->setChecked(false);
+  solarizedLightThemeAction->setChecked(true);
+  statusBar()->showMessage(tr("已应用Solarized Light主题"), 3000);
+}
+
+void MainWindow::changeTheme() {
+  // This method can either show a theme selection dialog
+  // or toggle between themes. For simplicity, I'll implement
+  // a basic theme rotation.
+
+  if (defaultThemeAction->isChecked()) {
+    setAtomOneTheme();
+  } else if (atomOneThemeAction->isChecked()) {
+    setSolarizedLightTheme();
+  } else {
+    setDefaultTheme();
+  }
+}
+
+void MainWindow::onComponentOrderChanged(const QModelIndex &index,
+                                         bool moveUp) {
+  if (index.isValid()) {
+    // 选中移动后的项
+    projectTreeView->setCurrentIndex(index);
+
+    // 标记项目有未保存的更改
+    projectManager->setUnsavedChanges(true);
+
+    QString direction = moveUp ? "上移" : "下移";
+    statusBar()->showMessage(
+        tr("组件已%1: %2")
+            .arg(direction)
+            .arg(projectManager->projectModel()->nodeName(index)),
+        3000);
+  }
+}
+
+void MainWindow::moveComponentUp() {
+  QModelIndex currentIndex = projectTreeView->currentIndex();
+  if (currentIndex.isValid() && currentIndex.parent().isValid()) {
+    componentManager->moveComponentUp(currentIndex);
+  } else {
+    QMessageBox::warning(this, tr("移动组件"), tr("请先选择要移动的组件"));
+  }
+}
+
+void MainWindow::moveComponentDown() {
+  QModelIndex currentIndex = projectTreeView->currentIndex();
+  if (currentIndex.isValid() && currentIndex.parent().isValid()) {
+    componentManager->moveComponentDown(currentIndex);
+  } else {
+    QMessageBox::warning(this, tr("移动组件"), tr("请先选择要移动的组件"));
+  }
+}
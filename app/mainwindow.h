@@ -0,0 +1,140 @@
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include "componentmanager.h"
+#include "controllersimulator.h"
+#include "downloadimagecompiler.h"
+#include "findreplacepanel.h"
+#include "hostiomonitor.h"
+#include "hostprober.h"
+#include "projectmanager.h"
+#include "projectvalidator.h"
+#include "thememanager.h"
+#include <QDockWidget>
+#include <QLabel>
+#include <QListWidget>
+#include <QMainWindow>
+#include <QMenuBar>
+#include <QProgressDialog>
+#include <QStackedWidget>
+#include <QStatusBar>
+#include <QToolBar>
+#include <QTreeView>
+
+
+class MainWindow : public QMainWindow {
+  Q_OBJECT
+
+public:
+  explicit MainWindow(QWidget *parent = nullptr);
+  ~MainWindow();
+
+private slots:
+  void newProject();
+  void openProject();
+  // 保存失败或取消时返回 false
+  bool saveProject();
+  bool saveProjectAs();
+  void renameProject(); // 添加重命名项目的槽函数
+  void addComponent();
+  void deleteComponent(); // 添加删除组件的槽函数
+  void moveComponent();   // 添加移动组件的槽函数
+  void configureComponent();
+  void onComponentAdded(const ComponentInfo &component, int count);
+  void onComponentDeleted(const QModelIndex &index);
+  void onComponentMoved(const QModelIndex &index, const QModelIndex &newParent);
+
+  void moveComponentUp();
+  void moveComponentDown();
+  void onComponentOrderChanged(const QModelIndex &index, bool moveUp);
+  void onProjectSelectionChanged(const QModelIndex &current,
+                                 const QModelIndex &previous);
+  void onProjectLoadFinished(bool success, const QString &errorString);
+  void refreshProblemList();
+  void goToSymbol();
+  void updateUndoActions();
+  void showFindPanel();
+  void showReplacePanel();
+  void compileDownloadImages();
+  void toggleHostMonitor(const QModelIndex &index);
+  void toggleHostSimulator(const QModelIndex &index);
+  void probeAllHosts();
+  void onHostProbeFinished(const HostProber::Result &result);
+  void onProbeAllFinished();
+
+private:
+  void showProjectContextMenu(const QPoint &pos);
+  void changeTheme();
+  void setDefaultTheme();
+  void setAtomOneTheme();
+  void setSolarizedLightTheme();
+  void setupUI();
+  void createActions();
+  void createMenus();
+  void createToolbars();
+  void createDockWindows();
+  void startLoadProject(const QString &path);
+  // 保存到 path，失败时提示错误
+  bool writeProject(const QString &path);
+
+  QTreeView *projectTreeView;
+  QDockWidget *projectDock;
+  QDockWidget *componentDock;
+  QDockWidget *propertiesDock;
+  // 属性面板按组件类型缓存在堆叠部件中，切换选中项时不重建
+  QStackedWidget *propertiesStack;
+  QLabel *selectionLabel;
+  QDockWidget *problemsDock;
+  QListWidget *problemList;
+  QDockWidget *findDock;
+  FindReplacePanel *findPanel;
+
+  ProjectManager *projectManager;
+  ComponentManager *componentManager;
+  ThemeManager *themeManager;
+  ProjectValidator *projectValidator;
+  QMenu *themeMenu;
+  QMenu *editMenu; // Add this line to declare editMenu
+  QAction *defaultThemeAction;
+  QAction *atomOneThemeAction;
+  QAction *solarizedLightThemeAction;
+
+  // Actions
+  QAction *newProjectAction;
+  QAction *openProjectAction;
+  QAction *saveProjectAction;
+  QAction *saveAsProjectAction;
+  QAction *renameProjectAction; // 添加重命名项目的动作
+  QAction *addComponentAction;
+  QAction *deleteComponentAction; // 添加删除组件的动作
+  QAction *moveComponentAction;   // 添加移动组件的动作
+  QAction *configureComponentAction;
+  QAction *exitAction;
+  QAction *moveUpAction;
+  QAction *moveDownAction;
+  QAction *goToSymbolAction;
+  QAction *undoAction;
+  QAction *redoAction;
+  QAction *findAction;
+  QAction *replaceAction;
+  QAction *compileImagesAction;
+  QAction *probeHostsAction;
+
+  // 下载镜像按主机缓存，再次编译时只重新生成修改过的主机
+  DownloadImageCompiler imageCompiler;
+  QString imageDirectory;
+
+  // 正在监控的主机，按组件编号索引，项目被替换时全部停止
+  QHash<quint64, HostIoMonitor *> hostMonitors;
+  // 在本机回环地址上运行的主机仿真器，监控这些主机时连接仿真器
+  QHash<quint64, ControllerSimulator *> hostSimulators;
+
+  // 并发探测全部主机，结果显示在项目树中
+  HostProber hostProber;
+  int probeTimeout;
+
+  // 后台加载项目时的进度对话框
+  QProgressDialog *loadProgressDialog;
+};
+
+#endif // MAINWINDOW_H
@@ -114,7 +114,7 @@ void ProjectInfoPage::browseDir() {
 void ProjectInfoPage::browseImport() {
   QString file = QFileDialog::getOpenFileName(this, tr("选择要导入的项目文件"),
                                               projectPathLineEdit->text(),
-                                              tr("XML 项目文件 (*.xml)"));
+                                              tr("项目文件 (*.xml *.tfl)"));
   if (!file.isEmpty()) {
     importPathLineEdit->setText(file);
   }
@@ -0,0 +1,33 @@
+#include "projecttreedelegate.h"
+#include "projectmodel.h"
+#include <QLineEdit>
+
+ProjectTreeDelegate::ProjectTreeDelegate(ComponentManager *manager,
+                                         QObject *parent)
+    : QStyledItemDelegate(parent), m_manager(manager) {}
+
+void ProjectTreeDelegate::setModelData(QWidget *editor,
+                                       QAbstractItemModel *model,
+                                       const QModelIndex &index) const {
+  QLineEdit *lineEdit = qobject_cast<QLineEdit *>(editor);
+  if (!lineEdit) {
+    QStyledItemDelegate::setModelData(editor, model, index);
+    return;
+  }
+
+  // 组件名称不能为空
+  QString name = lineEdit->text().trimmed();
+  if (!name.isEmpty()) {
+    m_manager->renameComponent(index, name);
+  }
+}
+
+void ProjectTreeDelegate::initStyleOption(QStyleOptionViewItem *option,
+                                          const QModelIndex &index) const {
+  QStyledItemDelegate::initStyleOption(option, index);
+  // 绘制和尺寸计算都经过这里，编辑时仍使用原名称
+  QString status = index.data(ProjectModel::StatusRole).toString();
+  if (!status.isEmpty()) {
+    option->text = QString("%1  [%2]").arg(option->text, status);
+  }
+}
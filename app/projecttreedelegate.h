@@ -0,0 +1,27 @@
+#ifndef PROJECTTREEDELEGATE_H
+#define PROJECTTREEDELEGATE_H
+
+#include "componentmanager.h"
+#include <QStyledItemDelegate>
+
+// 项目树的编辑代理，在树中直接重命名组件时经由撤销栈修改名称。
+// 组件有运行时状态时显示在名称之后。
+class ProjectTreeDelegate : public QStyledItemDelegate {
+  Q_OBJECT
+
+public:
+  explicit ProjectTreeDelegate(ComponentManager *manager,
+                               QObject *parent = nullptr);
+
+  void setModelData(QWidget *editor, QAbstractItemModel *model,
+                    const QModelIndex &index) const override;
+
+protected:
+  void initStyleOption(QStyleOptionViewItem *option,
+                       const QModelIndex &index) const override;
+
+private:
+  ComponentManager *m_manager;
+};
+
+#endif // PROJECTTREEDELEGATE_H
@@ -0,0 +1,83 @@
+#include "replicationdialog.h"
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QVBoxLayout>
+
+ReplicationDialog::ReplicationDialog(const QString &sourceName,
+                                     QWidget *parent)
+    : QDialog(parent) {
+  setWindowTitle("复制主机");
+  setMinimumWidth(400);
+
+  ReplicationRules defaults;
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addWidget(new QLabel(
+      QString("将 \"%1\" 及其下属模块复制多份:").arg(sourceName), this));
+
+  QFormLayout *formLayout = new QFormLayout();
+  m_copiesSpinBox = new QSpinBox(this);
+  m_copiesSpinBox->setRange(1, 999);
+  m_copiesSpinBox->setValue(defaults.copies);
+  formLayout->addRow("副本数量:", m_copiesSpinBox);
+
+  m_namePatternEdit = new QLineEdit(defaults.namePattern, this);
+  formLayout->addRow("名称规则:", m_namePatternEdit);
+
+  m_variablePatternEdit = new QLineEdit(defaults.variablePattern, this);
+  formLayout->addRow("变量名规则:", m_variablePatternEdit);
+
+  m_ipIncrementSpinBox = new QSpinBox(this);
+  m_ipIncrementSpinBox->setRange(0, 255);
+  m_ipIncrementSpinBox->setValue(defaults.ipIncrement);
+  formLayout->addRow("IP地址递增:", m_ipIncrementSpinBox);
+
+  m_panelIncrementSpinBox = new QSpinBox(this);
+  m_panelIncrementSpinBox->setRange(0, 999);
+  m_panelIncrementSpinBox->setValue(defaults.panelIncrement);
+  formLayout->addRow("盘号递增:", m_panelIncrementSpinBox);
+
+  m_cardIncrementSpinBox = new QSpinBox(this);
+  m_cardIncrementSpinBox->setRange(0, 999);
+  m_cardIncrementSpinBox->setValue(defaults.cardIncrement);
+  formLayout->addRow("卡号递增:", m_cardIncrementSpinBox);
+
+  m_addressOffsetSpinBox = new QSpinBox(this);
+  m_addressOffsetSpinBox->setRange(-999, 999);
+  m_addressOffsetSpinBox->setValue(defaults.addressOffset);
+  formLayout->addRow("设备地址偏移:", m_addressOffsetSpinBox);
+  layout->addLayout(formLayout);
+
+  QLabel *hintLabel =
+      new QLabel("规则中 {name} 代表原名称，{n} 代表副本序号(从 1 开始)；"
+                 "第 n 个副本的编号在原值上加 n 倍的递增值。",
+                 this);
+  hintLabel->setWordWrap(true);
+  layout->addWidget(hintLabel);
+
+  QDialogButtonBox *buttonBox =
+      new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+  layout->addWidget(buttonBox);
+  connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+  connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+ReplicationRules ReplicationDialog::rules() const {
+  ReplicationRules rules;
+  rules.copies = m_copiesSpinBox->value();
+  rules.namePattern = m_namePatternEdit->text();
+  rules.variablePattern = m_variablePatternEdit->text();
+  rules.ipIncrement = m_ipIncrementSpinBox->value();
+  rules.panelIncrement = m_panelIncrementSpinBox->value();
+  rules.cardIncrement = m_cardIncrementSpinBox->value();
+  rules.addressOffset = m_addressOffsetSpinBox->value();
+
+  // 空规则保持原名称
+  if (rules.namePattern.trimmed().isEmpty()) {
+    rules.namePattern = "{name}";
+  }
+  if (rules.variablePattern.trimmed().isEmpty()) {
+    rules.variablePattern = "{name}";
+  }
+  return rules;
+}
@@ -0,0 +1,29 @@
+#ifndef REPLICATIONDIALOG_H
+#define REPLICATIONDIALOG_H
+
+#include "projectreplicator.h"
+#include <QDialog>
+#include <QLineEdit>
+#include <QSpinBox>
+
+// 复制主机对话框，编辑副本数量和编号、命名规则
+class ReplicationDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  explicit ReplicationDialog(const QString &sourceName,
+                             QWidget *parent = nullptr);
+
+  ReplicationRules rules() const;
+
+private:
+  QSpinBox *m_copiesSpinBox;
+  QLineEdit *m_namePatternEdit;
+  QLineEdit *m_variablePatternEdit;
+  QSpinBox *m_ipIncrementSpinBox;
+  QSpinBox *m_panelIncrementSpinBox;
+  QSpinBox *m_cardIncrementSpinBox;
+  QSpinBox *m_addressOffsetSpinBox;
+};
+
+#endif // REPLICATIONDIALOG_H
@@ -0,0 +1,76 @@
+#include "searchresultmodel.h"
+#include "loopmodule.h"
+
+SearchResultModel::SearchResultModel(ProjectModel *projectModel,
+                                     QObject *parent)
+    : QAbstractListModel(parent), m_projectModel(projectModel) {}
+
+int SearchResultModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : m_matches.size();
+}
+
+QVariant SearchResultModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= m_matches.size()) {
+    return QVariant();
+  }
+
+  const SearchMatch &match = m_matches.at(index.row());
+  if (role == Qt::DisplayRole) {
+    return describe(match);
+  } else if (role == Qt::ToolTipRole) {
+    return match.text;
+  } else if (role == Qt::UserRole) {
+    return QVariant::fromValue(match.location.componentId);
+  }
+  return QVariant();
+}
+
+const SearchMatch &SearchResultModel::match(int row) const {
+  return m_matches.at(row);
+}
+
+void SearchResultModel::appendMatches(const QVector<SearchMatch> &matches) {
+  if (matches.isEmpty()) {
+    return;
+  }
+  beginInsertRows(QModelIndex(), m_matches.size(),
+                  m_matches.size() + matches.size() - 1);
+  m_matches += matches;
+  endInsertRows();
+}
+
+void SearchResultModel::clear() {
+  beginResetModel();
+  m_matches.clear();
+  endResetModel();
+}
+
+QString SearchResultModel::describe(const SearchMatch &match) const {
+  QString place = m_projectModel->nodeName(
+      m_projectModel->indexForComponentId(match.location.componentId));
+
+  switch (match.target) {
+  case SearchMatch::ComponentName:
+    return QString("%1    [组件名称]").arg(place);
+  case SearchMatch::LoopDeviceField:
+    return QString("%1 通道 %2 设备 %3 %4: %5")
+        .arg(place)
+        .arg(match.location.channel + 1)
+        .arg(match.location.index + 1)
+        .arg(LoopModule::deviceFieldLabels().value(match.field))
+        .arg(match.text);
+  case SearchMatch::BitName:
+    return QString("%1 通道 %2 位 %3 变量名: %4")
+        .arg(place)
+        .arg(match.location.channel + 1)
+        .arg(match.location.index)
+        .arg(match.text);
+  case SearchMatch::BitDescription:
+    return QString("%1 通道 %2 位 %3 描述: %4")
+        .arg(place)
+        .arg(match.location.channel + 1)
+        .arg(match.location.index)
+        .arg(match.text);
+  }
+  return match.text;
+}
@@ -0,0 +1,37 @@
+#ifndef SEARCHRESULTMODEL_H
+#define SEARCHRESULTMODEL_H
+
+#include "projectmodel.h"
+#include "projectsearch.h"
+#include <QAbstractListModel>
+#include <QVector>
+
+// 查找结果列表模型
+//
+// 结果按批追加，显示文本在视图请求时才生成，配合 QListView 的统一行高
+// 只为可见行取数据。
+class SearchResultModel : public QAbstractListModel {
+  Q_OBJECT
+
+public:
+  explicit SearchResultModel(ProjectModel *projectModel,
+                             QObject *parent = nullptr);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override;
+
+  const SearchMatch &match(int row) const;
+
+public slots:
+  void appendMatches(const QVector<SearchMatch> &matches);
+  void clear();
+
+private:
+  QString describe(const SearchMatch &match) const;
+
+  ProjectModel *m_projectModel;
+  QVector<SearchMatch> m_matches;
+};
+
+#endif // SEARCHRESULTMODEL_H
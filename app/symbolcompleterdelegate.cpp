@@ -0,0 +1,45 @@
+#include "symbolcompleterdelegate.h"
+#include <QCompleter>
+#include <QLineEdit>
+#include <QStringListModel>
+
+namespace {
+// 每次补全最多列出的候选项
+const int kMaxCompletions = 50;
+} // namespace
+
+SymbolCompleterDelegate::SymbolCompleterDelegate(const SymbolIndex *index,
+                                                 QObject *parent)
+    : QStyledItemDelegate(parent), m_symbolIndex(index) {}
+
+QWidget *SymbolCompleterDelegate::createEditor(
+    QWidget *parent, const QStyleOptionViewItem &option,
+    const QModelIndex &index) const {
+  QWidget *editor = QStyledItemDelegate::createEditor(parent, option, index);
+  if (QLineEdit *lineEdit = qobject_cast<QLineEdit *>(editor)) {
+    installCompleter(lineEdit, m_symbolIndex);
+  }
+  return editor;
+}
+
+void SymbolCompleterDelegate::installCompleter(QLineEdit *editor,
+                                               const SymbolIndex *index) {
+  if (!index) {
+    return;
+  }
+
+  QStringListModel *model = new QStringListModel(editor);
+  QCompleter *completer = new QCompleter(model, editor);
+  completer->setCaseSensitivity(Qt::CaseSensitive);
+  // 候选项已按前缀筛选并排序
+  completer->setModelSorting(QCompleter::CaseSensitivelySortedModel);
+  editor->setCompleter(completer);
+
+  QObject::connect(editor, &QLineEdit::textEdited, completer,
+                   [model, index](const QString &text) {
+                     model->setStringList(
+                         text.isEmpty()
+                             ? QStringList()
+                             : index->completions(text, kMaxCompletions));
+                   });
+}
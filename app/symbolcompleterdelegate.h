@@ -0,0 +1,30 @@
+#ifndef SYMBOLCOMPLETERDELEGATE_H
+#define SYMBOLCOMPLETERDELEGATE_H
+
+#include "symbolindex.h"
+#include <QStyledItemDelegate>
+
+class QLineEdit;
+
+// 变量名列的编辑代理
+//
+// 编辑时使用带自动补全的行编辑器，候选项在每次输入后按前缀从项目符号
+// 索引中查询，不会把全部变量名放进补全模型。
+class SymbolCompleterDelegate : public QStyledItemDelegate {
+  Q_OBJECT
+
+public:
+  explicit SymbolCompleterDelegate(const SymbolIndex *index,
+                                   QObject *parent = nullptr);
+
+  QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option,
+                        const QModelIndex &index) const override;
+
+  // 为任意行编辑器安装同样的自动补全
+  static void installCompleter(QLineEdit *editor, const SymbolIndex *index);
+
+private:
+  const SymbolIndex *m_symbolIndex;
+};
+
+#endif // SYMBOLCOMPLETERDELEGATE_H
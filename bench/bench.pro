@@ -0,0 +1,18 @@
+# 性能基准：生成指定规模的合成项目，计时加载、保存、属性面板、设备表格、
+# 校验和查找，结果以 JSON 输出。默认使用离屏平台，不需要显示器。
+QT += core gui widgets
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = controlleride-bench
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../app/app.pri)
+
+SOURCES += \
+    main.cpp \
+    syntheticproject.cpp
+
+HEADERS += \
+    syntheticproject.h
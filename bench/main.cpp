@@ -0,0 +1,606 @@
+#include "componentmanager.h"
+#include "controllersimulator.h"
+#include "downloadimagecompiler.h"
+#include "hostiomonitor.h"
+#include "loopdevicetablemodel.h"
+#include "loopmodule.h"
+#include "projectbinaryformat.h"
+#include "projectmanager.h"
+#include "projectsearch.h"
+#include "projectvalidator.h"
+#include "syntheticproject.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStackedWidget>
+#include <QTableView>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+// 经仿真器计时的轮询次数和等待上限
+const int kSimulatorPolls = 20;
+const int kSimulatorTimeout = 10000;
+// 每次加载后抽查的节点数
+const int kSampledNodes = 1000;
+
+QTextStream &standardError() {
+  static QTextStream stream(stderr);
+  return stream;
+}
+
+// 结束一行并立即输出。全局的 endl 自 Qt 5.15 起弃用，Qt 6 中已移除
+QTextStream &endLine(QTextStream &stream) {
+  stream << '\n';
+  stream.flush();
+  return stream;
+}
+
+// 一项操作多次运行的耗时(毫秒)
+class Measurement {
+public:
+  explicit Measurement(const QString &name) : m_name(name), m_operations(0) {}
+
+  void start() { m_timer.start(); }
+  void stop() { m_samples.append(m_timer.nsecsElapsed() / 1e6); }
+
+  // 每次运行处理的对象数(面板、表格、匹配等)，用于换算单次耗时
+  void setOperations(int operations) { m_operations = operations; }
+  void setValue(const QString &key, int value) { m_values[key] = value; }
+
+  QJsonObject toJson() const {
+    QVector<double> samples = m_samples;
+    std::sort(samples.begin(), samples.end());
+
+    QJsonObject object = m_values;
+    object["name"] = m_name;
+    object["iterations"] = samples.size();
+    if (!samples.isEmpty()) {
+      object["minMs"] = samples.first();
+      object["medianMs"] = samples.at(samples.size() / 2);
+      object["maxMs"] = samples.last();
+    }
+    if (m_operations > 0) {
+      object["operations"] = m_operations;
+    }
+    return object;
+  }
+
+private:
+  QString m_name;
+  QElapsedTimer m_timer;
+  QVector<double> m_samples;
+  int m_operations;
+  QJsonObject m_values;
+};
+
+// 按先序列出项目中有模块的组件
+QVector<QModelIndex> moduleIndexes(ProjectModel *model) {
+  QVector<QModelIndex> indexes;
+  QVector<QModelIndex> stack;
+  stack.append(model->rootIndex());
+  while (!stack.isEmpty()) {
+    QModelIndex index = stack.takeLast();
+    if (ModuleRegistry::supportsType(model->nodeType(index))) {
+      indexes.append(index);
+    }
+    for (int row = model->rowCount(index) - 1; row >= 0; --row) {
+      stack.append(model->index(row, 0, index));
+    }
+  }
+  return indexes;
+}
+
+// 按先序列出项目树的节点
+QVector<int> preorderNodes(const ProjectTree &tree) {
+  QVector<int> nodes;
+  nodes.reserve(tree.nodeCount());
+  QVector<int> stack;
+  if (!tree.isEmpty()) {
+    stack.append(tree.rootNode());
+  }
+  while (!stack.isEmpty()) {
+    int node = stack.takeLast();
+    nodes.append(node);
+    for (int row = tree.childCount(node) - 1; row >= 0; --row) {
+      stack.append(tree.childAt(node, row));
+    }
+  }
+  return nodes;
+}
+
+// 按先序比较两棵项目树的结构、名称、类型、配置段和组件编号，返回第一处
+// 差异的描述，相同时返回空字符串。节点数总是比较，节点内容每隔 stride 个
+// 节点抽查一次
+QString treeDifference(const ProjectTree &expected, const ProjectTree &actual,
+                       int stride = 1) {
+  const QVector<int> expectedNodes = preorderNodes(expected);
+  const QVector<int> actualNodes = preorderNodes(actual);
+  if (expectedNodes.size() != actualNodes.size()) {
+    return QString("节点数 %1，应为 %2")
+        .arg(actualNodes.size())
+        .arg(expectedNodes.size());
+  }
+
+  for (int i = 0; i < expectedNodes.size(); i += stride) {
+    int e = expectedNodes.at(i);
+    int a = actualNodes.at(i);
+    // 先序排列相同且每个节点的子节点数相同，结构即相同
+    QString field;
+    if (actual.childCount(a) != expected.childCount(e)) {
+      field = "子节点数";
+    } else if (actual.name(a) != expected.name(e)) {
+      field = "名称";
+    } else if (actual.type(a) != expected.type(e)) {
+      field = "类型";
+    } else if (actual.config(a) != expected.config(e)) {
+      field = "配置段";
+    } else if (actual.componentId(a) != expected.componentId(e)) {
+      field = "组件编号";
+    }
+    if (!field.isEmpty()) {
+      return QString("第 %1 个节点 %2 的%3不同")
+          .arg(i)
+          .arg(expected.name(e), field);
+    }
+  }
+  return QString();
+}
+
+// 驱动与界面相同的管理类，依次计时各项操作
+class Benchmark {
+public:
+  Benchmark(const ProjectTree &expected, const QString &xmlPath,
+            const QString &binaryPath, const QString &outputDirectory,
+            const QString &searchPattern)
+      : m_expected(expected), m_xmlPath(xmlPath), m_binaryPath(binaryPath),
+        m_outputDirectory(outputDirectory), m_searchPattern(searchPattern),
+        m_components(m_manager.projectModel()), m_loadXml("load-xml"),
+        m_saveXml("save-xml"), m_loadBinary("load-binary"),
+        m_saveBinary("save-binary"), m_selectPanel("select-panel"),
+        m_populateTable("populate-table"), m_validate("validate"),
+        m_search("search"), m_compileImages("compile-images"),
+        m_recompileImages("recompile-images"), m_monitorPoll("monitor-poll"),
+        m_downloadImage("download-image") {
+    m_panels.resize(1024, 768);
+    m_panels.show();
+    m_table.resize(1024, 768);
+    m_table.show();
+  }
+
+  ~Benchmark() { m_table.setModel(nullptr); }
+
+  bool runIteration() {
+    return loadAndSave(m_xmlPath, &m_loadXml, &m_saveXml) &&
+           loadAndSave(m_binaryPath, &m_loadBinary, &m_saveBinary) &&
+           selectPanels() && populateTables() && validate() && search() &&
+           compileImages() && simulateHost();
+  }
+
+  QJsonArray results() const {
+    QJsonArray array;
+    const Measurement *measurements[] = {
+        &m_loadXml,     &m_saveXml,       &m_loadBinary, &m_saveBinary,
+        &m_selectPanel, &m_populateTable, &m_validate,   &m_search,
+        &m_compileImages, &m_recompileImages, &m_monitorPoll,
+        &m_downloadImage};
+    for (const Measurement *measurement : measurements) {
+      array.append(measurement->toJson());
+    }
+    return array;
+  }
+
+private:
+  bool loadAndSave(const QString &path, Measurement *load, Measurement *save) {
+    QString errorString;
+    load->start();
+    bool ok = m_manager.loadProject(path, &errorString);
+    load->stop();
+    if (!ok) {
+      standardError() << QString("无法加载项目 %1: %2").arg(path, errorString)
+                      << endLine;
+      return false;
+    }
+    // 计时之外抽查加载结果，加载器出错时中止而不是计时损坏的项目
+    const ProjectTree &tree = m_manager.projectModel()->tree();
+    QString difference = treeDifference(
+        m_expected, tree, qMax(1, m_expected.nodeCount() / kSampledNodes));
+    if (!difference.isEmpty()) {
+      standardError() << QString("项目 %1 加载后不一致: %2")
+                             .arg(path, difference)
+                      << endLine;
+      return false;
+    }
+    m_components.clearModules();
+
+    // 刚加载的项目没有修改，保存的是完整的项目文件
+    QString savePath =
+        QDir(m_outputDirectory).filePath(QFileInfo(path).fileName());
+    save->start();
+    ok = m_manager.saveProject(savePath, &errorString);
+    save->stop();
+    if (!ok) {
+      standardError() << QString("无法保存项目 %1: %2")
+                             .arg(savePath, errorString)
+                      << endLine;
+      return false;
+    }
+    return true;
+  }
+
+  // 依次选中每个模块并绘制其属性面板，模块从配置段重新创建
+  bool selectPanels() {
+    m_components.clearModules();
+    const QVector<QModelIndex> indexes =
+        moduleIndexes(m_manager.projectModel());
+
+    m_selectPanel.start();
+    for (const QModelIndex &index : indexes) {
+      QWidget *panel = m_components.getComponentConfigWidget(index);
+      if (m_panels.indexOf(panel) < 0) {
+        m_panels.addWidget(panel);
+      }
+      m_panels.setCurrentWidget(panel);
+      m_panels.repaint();
+    }
+    m_selectPanel.stop();
+    m_selectPanel.setOperations(indexes.size());
+    return true;
+  }
+
+  // 在设备表格中逐个显示每个回路通道
+  bool populateTables() {
+    ProjectModel *model = m_manager.projectModel();
+    ModuleRegistry *registry = m_components.moduleRegistry();
+    QVector<LoopModule *> modules;
+    for (const QModelIndex &index : moduleIndexes(model)) {
+      if (model->nodeType(index) == "LoopModule") {
+        modules.append(qobject_cast<LoopModule *>(registry->acquire(
+            model->componentId(index), "LoopModule", model->nodeConfig(index),
+            model->nodeName(index))));
+      }
+    }
+
+    int channelCount = 0;
+    m_populateTable.start();
+    for (LoopModule *module : modules) {
+      LoopDeviceTableModel tableModel(module);
+      m_table.setModel(&tableModel);
+      for (int channel = 0; channel < module->getChannelCount(); ++channel) {
+        tableModel.setChannel(channel);
+        m_table.viewport()->repaint();
+        ++channelCount;
+      }
+      m_table.setModel(nullptr);
+    }
+    m_populateTable.stop();
+    m_populateTable.setOperations(channelCount);
+    return true;
+  }
+
+  bool validate() {
+    m_validate.start();
+    ProjectValidator validator(m_manager.projectModel(),
+                               m_components.moduleRegistry());
+    validator.validateNow();
+    m_validate.stop();
+    m_validate.setValue("problems", validator.problemCount());
+    return true;
+  }
+
+  bool search() {
+    SearchQuery query;
+    query.pattern = m_searchPattern;
+
+    ProjectSearch search(m_manager.projectModel(),
+                         m_components.moduleRegistry(),
+                         m_components.undoStack());
+    QEventLoop loop;
+    QObject::connect(&search, &ProjectSearch::finished, &loop,
+                     &QEventLoop::quit);
+
+    m_search.start();
+    search.start(query);
+    if (search.isRunning()) {
+      loop.exec();
+    }
+    m_search.stop();
+    m_search.setValue("matches", search.matchCount());
+    return true;
+  }
+
+  // 全部主机编译一次，再修改一个回路后重新编译
+  bool compileImages() {
+    ProjectModel *model = m_manager.projectModel();
+    m_imageCompiler.clear();
+    m_compileImages.start();
+    int hostCount = m_imageCompiler.compile(model->tree()).size();
+    m_compileImages.stop();
+    m_compileImages.setOperations(hostCount);
+
+    QModelIndex loop;
+    for (const QModelIndex &index : moduleIndexes(model)) {
+      if (model->nodeType(index) == "LoopModule") {
+        loop = index;
+        break;
+      }
+    }
+    QString name = model->nodeName(loop);
+    if (loop.isValid()) {
+      model->setNodeName(loop, name + "*");
+    }
+    m_recompileImages.start();
+    m_imageCompiler.compile(model->tree());
+    m_recompileImages.stop();
+    m_recompileImages.setValue("rebuilt", m_imageCompiler.rebuiltCount());
+    if (loop.isValid()) {
+      model->setNodeName(loop, name);
+    }
+    return true;
+  }
+
+  // 第一个主机的仿真器运行在本机回环地址上，计时监控连续轮询下属
+  // DI/DO 模块，以及向仿真器下载该主机的镜像
+  bool simulateHost() {
+    ProjectModel *model = m_manager.projectModel();
+    const ProjectTree &tree = model->tree();
+    int hostNode = tree.firstChild(tree.rootNode());
+    ControllerSimulator simulator;
+    if (!simulator.load(tree, hostNode) || !simulator.listen()) {
+      standardError() << QString("无法启动仿真器: %1")
+                             .arg(simulator.errorString())
+                      << endLine;
+      return false;
+    }
+
+    QModelIndex host = model->indexForComponentId(tree.componentId(hostNode));
+    ModuleRegistry *registry = m_components.moduleRegistry();
+    HostIoMonitor monitor;
+    for (int row = 0; row < model->rowCount(host); ++row) {
+      QModelIndex child = model->index(row, 0, host);
+      monitor.addModule(registry->acquire(
+          model->componentId(child), model->nodeType(child),
+          model->nodeConfig(child), model->nodeName(child)));
+    }
+
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    timeout.setInterval(kSimulatorTimeout);
+    QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+    if (monitor.moduleCount() > 0) {
+      QObject::connect(&monitor, &HostIoMonitor::pollFinished, &loop,
+                       [&monitor, &loop](int) {
+                         if (monitor.completedPolls() >= kSimulatorPolls) {
+                           loop.quit();
+                         }
+                       });
+      monitor.setEndpoint(simulator.address().toString(),
+                          simulator.modbusPort());
+      monitor.setPollInterval(1);
+      m_monitorPoll.start();
+      monitor.start();
+      timeout.start();
+      loop.exec();
+      m_monitorPoll.stop();
+      monitor.stop();
+      if (monitor.completedPolls() < kSimulatorPolls) {
+        standardError() << "仿真器轮询超时" << endLine;
+        return false;
+      }
+      m_monitorPoll.setOperations(kSimulatorPolls);
+      m_monitorPoll.setValue("requests",
+                             static_cast<int>(simulator.requestCount()));
+    }
+
+    QByteArray image = DownloadImage::encode(
+        DownloadImage::content(DownloadImage::source(tree, hostNode)));
+    QTcpSocket socket;
+    QObject::connect(&socket, &QTcpSocket::readyRead, &loop,
+                     [&socket, &loop]() {
+                       if (socket.bytesAvailable() >= 8) {
+                         loop.quit();
+                       }
+                     });
+    m_downloadImage.start();
+    socket.connectToHost(simulator.address(), simulator.downloadPort());
+    socket.write(image);
+    timeout.start();
+    loop.exec();
+    m_downloadImage.stop();
+    if (!socket.read(4).startsWith("TFDA")) {
+      standardError() << "仿真器未接受下载镜像" << endLine;
+      return false;
+    }
+    m_downloadImage.setValue("bytes", image.size());
+    return true;
+  }
+
+  const ProjectTree &m_expected;
+  QString m_xmlPath;
+  QString m_binaryPath;
+  QString m_outputDirectory;
+  QString m_searchPattern;
+
+  ProjectManager m_manager;
+  ComponentManager m_components;
+  // 面板由容器接管，容器先于 ComponentManager 销毁
+  QStackedWidget m_panels;
+  QTableView m_table;
+  DownloadImageCompiler m_imageCompiler;
+
+  Measurement m_loadXml;
+  Measurement m_saveXml;
+  Measurement m_loadBinary;
+  Measurement m_saveBinary;
+  Measurement m_selectPanel;
+  Measurement m_populateTable;
+  Measurement m_validate;
+  Measurement m_search;
+  Measurement m_compileImages;
+  Measurement m_recompileImages;
+  Measurement m_monitorPoll;
+  Measurement m_downloadImage;
+};
+
+int intOption(const QCommandLineParser &parser, const QString &name,
+              int minimum, bool *ok) {
+  bool valid = false;
+  int value = parser.value(name).toInt(&valid);
+  if (!valid || value < minimum) {
+    standardError() << QString("无效的参数 --%1: %2")
+                           .arg(name, parser.value(name))
+                    << endLine;
+    *ok = false;
+  }
+  return value;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  // 默认不需要显示器，界面组件在离屏平台上创建和绘制
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+  QApplication app(argc, argv);
+  QApplication::setApplicationName("controlleride-bench");
+
+  SyntheticProjectSize size;
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "ControllerIDE 性能基准\n\n"
+      "按指定规模生成项目，计时加载、保存、选中组件显示属性面板、设备表格\n"
+      "填充、校验、查找、下载镜像编译以及经仿真器的轮询和下载，结果以 JSON\n"
+      "输出。");
+  parser.addHelpOption();
+  parser.addOptions({
+      {"hosts", "主机数", "n", QString::number(size.hosts)},
+      {"loops", "每个主机的回路模块数", "n",
+       QString::number(size.loopsPerHost)},
+      {"channels", "每个回路的通道数", "n",
+       QString::number(size.channelsPerLoop)},
+      {"devices", "每个回路通道的设备数", "n",
+       QString::number(size.devicesPerChannel)},
+      {"di", "每个主机的 DI 模块数", "n",
+       QString::number(size.diModulesPerHost)},
+      {"do", "每个主机的 DO 模块数", "n",
+       QString::number(size.doModulesPerHost)},
+      {"io-channels", "DI/DO 模块的通道数(8、16 或 32)", "n",
+       QString::number(size.ioChannels)},
+      {"iterations", "每项操作的运行次数", "n", "3"},
+      {"search", "查找的文本", "text", "_D1"},
+      {{"o", "output"}, "结果写入文件，默认输出到标准输出", "file"},
+  });
+  parser.process(app);
+
+  bool ok = true;
+  size.hosts = intOption(parser, "hosts", 1, &ok);
+  size.loopsPerHost = intOption(parser, "loops", 0, &ok);
+  size.channelsPerLoop = intOption(parser, "channels", 1, &ok);
+  size.devicesPerChannel = intOption(parser, "devices", 0, &ok);
+  size.diModulesPerHost = intOption(parser, "di", 0, &ok);
+  size.doModulesPerHost = intOption(parser, "do", 0, &ok);
+  size.ioChannels = intOption(parser, "io-channels", 8, &ok);
+  int iterations = intOption(parser, "iterations", 1, &ok);
+  if (size.ioChannels != 8 && size.ioChannels != 16 && size.ioChannels != 32) {
+    standardError() << "DI/DO 模块的通道数只能是 8、16 或 32" << endLine;
+    ok = false;
+  }
+  if (!ok) {
+    return 2;
+  }
+
+  QTemporaryDir workDirectory;
+  QDir dir(workDirectory.path());
+  if (!workDirectory.isValid() || !dir.mkpath("saved")) {
+    standardError() << "无法创建临时目录" << endLine;
+    return 2;
+  }
+
+  // 生成的项目先以两种格式写入临时目录，加载计时从文件开始
+  QElapsedTimer timer;
+  timer.start();
+  QString xmlPath = dir.filePath("synthetic.xml");
+  QString binaryPath = dir.filePath("synthetic.tfl");
+  const ProjectTree generated = SyntheticProject::generate(size);
+  {
+    // 二进制文件由重新加载的 XML 项目保存，随后读回并与生成的项目比较，
+    // 检查 XML -> tfl -> 加载的完整往返
+    ProjectManager manager;
+    manager.projectModel()->setTree(generated);
+    QString errorString;
+    bool saved = manager.saveProject(xmlPath, &errorString) &&
+                 manager.loadProject(xmlPath, &errorString) &&
+                 manager.saveProject(binaryPath, &errorString);
+    if (!saved) {
+      standardError() << QString("无法写入生成的项目: %1").arg(errorString)
+                      << endLine;
+      return 2;
+    }
+
+    ProjectTree loaded;
+    if (!ProjectBinaryFormat::read(binaryPath, &loaded, &errorString)) {
+      standardError() << QString("无法读回二进制项目: %1").arg(errorString)
+                      << endLine;
+      return 2;
+    }
+    QString difference = treeDifference(generated, loaded);
+    if (!difference.isEmpty()) {
+      standardError() << QString("二进制项目往返后不一致: %1")
+                             .arg(difference)
+                      << endLine;
+      return 2;
+    }
+  }
+  standardError() << QString("已生成项目: %1 个组件，%2 个设备，用时 %3 ms")
+                         .arg(size.componentCount())
+                         .arg(size.deviceCount())
+                         .arg(timer.elapsed())
+                  << endLine;
+
+  Benchmark benchmark(generated, xmlPath, binaryPath, dir.filePath("saved"),
+                      parser.value("search"));
+  for (int i = 0; i < iterations; ++i) {
+    if (!benchmark.runIteration()) {
+      return 2;
+    }
+  }
+
+  QJsonObject project = size.toJson();
+  project["xmlBytes"] = QFileInfo(xmlPath).size();
+  project["binaryBytes"] = QFileInfo(binaryPath).size();
+
+  QJsonObject report;
+  report["qtVersion"] = QString(qVersion());
+  report["timestamp"] =
+      QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+  report["project"] = project;
+  report["results"] = benchmark.results();
+  QByteArray json = QJsonDocument(report).toJson();
+
+  if (!parser.isSet("output")) {
+    QFile output;
+    output.open(stdout, QIODevice::WriteOnly);
+    output.write(json);
+    return 0;
+  }
+  QFile output(parser.value("output"));
+  if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size()) {
+    standardError() << QString("无法写入 %1: %2")
+                           .arg(output.fileName(), output.errorString())
+                    << endLine;
+    return 2;
+  }
+  return 0;
+}
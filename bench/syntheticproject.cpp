@@ -0,0 +1,131 @@
+#include "syntheticproject.h"
+#include "dimodule.h"
+#include "domodule.h"
+#include "hostmodule.h"
+#include "loopmodule.h"
+#include "moduleregistry.h"
+#include <QVector>
+
+namespace {
+QByteArray hostConfig(int host) {
+  HostModule module;
+  HostConfiguration config = module.getConfiguration();
+  config.hostName = QString("Controller%1").arg(host + 1);
+  config.ipAddress =
+      QString("10.%1.%2.10").arg((host >> 8) & 0xff).arg(host & 0xff);
+  module.setConfiguration(config);
+  return ModuleRegistry::serialize(&module);
+}
+
+QByteArray loopConfig(const SyntheticProjectSize &size, int host, int loop) {
+  const QStringList types = LoopModule::deviceTypes();
+
+  LoopModule module;
+  module.beginUpdate();
+  module.setChannelCount(size.channelsPerLoop);
+  for (int channel = 0; channel < size.channelsPerLoop; ++channel) {
+    QVector<LoopDevice> devices(size.devicesPerChannel);
+    for (int i = 0; i < devices.size(); ++i) {
+      LoopDevice &device = devices[i];
+      device.type = types.at(i % types.size());
+      device.serialNumber = QString("SN%1%2%3%4")
+                                .arg(host, 3, 10, QLatin1Char('0'))
+                                .arg(loop, 2, 10, QLatin1Char('0'))
+                                .arg(channel, 2, 10, QLatin1Char('0'))
+                                .arg(i, 5, 10, QLatin1Char('0'));
+      device.address = i + 1;
+      device.personalityCode = QString("PC%1").arg(i % 16);
+      device.panelNumber = host + 1;
+      device.cardNumber = loop + 1;
+      device.description = QString("%1 %2").arg(device.type).arg(i + 1);
+      device.identifier = QString("D%1").arg(i + 1);
+      device.variableName = QString("H%1_L%2_C%3_D%4")
+                                .arg(host + 1)
+                                .arg(loop + 1)
+                                .arg(channel + 1)
+                                .arg(i + 1);
+    }
+    module.setDevices(channel, devices);
+  }
+  module.endUpdate();
+  return ModuleRegistry::serialize(&module);
+}
+
+// DI 和 DO 模块的位变量结构相同
+template <typename Module, typename BitVariable>
+QByteArray ioConfig(const SyntheticProjectSize &size, const QString &prefix,
+                    int host, int index) {
+  Module module;
+  module.beginUpdate();
+  module.setChannelCount(size.ioChannels);
+  for (int channel = 0; channel < module.getChannelCount(); ++channel) {
+    for (int bit = 0; bit < 8; ++bit) {
+      BitVariable variable;
+      variable.name = QString("H%1_%2%3_C%4_B%5")
+                          .arg(host + 1)
+                          .arg(prefix)
+                          .arg(index + 1)
+                          .arg(channel + 1)
+                          .arg(bit);
+      variable.description = QString("%1 通道%2 位%3")
+                                 .arg(prefix)
+                                 .arg(channel + 1)
+                                 .arg(bit);
+      module.setBitVariable(channel, bit, variable);
+    }
+  }
+  module.endUpdate();
+  return ModuleRegistry::serialize(&module);
+}
+} // namespace
+
+int SyntheticProjectSize::componentCount() const {
+  return hosts * (1 + loopsPerHost + diModulesPerHost + doModulesPerHost);
+}
+
+int SyntheticProjectSize::deviceCount() const {
+  return hosts * loopsPerHost * channelsPerLoop * devicesPerChannel;
+}
+
+int SyntheticProjectSize::bitVariableCount() const {
+  return hosts * (diModulesPerHost + doModulesPerHost) * ioChannels * 8;
+}
+
+QJsonObject SyntheticProjectSize::toJson() const {
+  QJsonObject object;
+  object["hosts"] = hosts;
+  object["loopsPerHost"] = loopsPerHost;
+  object["channelsPerLoop"] = channelsPerLoop;
+  object["devicesPerChannel"] = devicesPerChannel;
+  object["diModulesPerHost"] = diModulesPerHost;
+  object["doModulesPerHost"] = doModulesPerHost;
+  object["ioChannels"] = ioChannels;
+  object["components"] = componentCount();
+  object["devices"] = deviceCount();
+  object["bitVariables"] = bitVariableCount();
+  return object;
+}
+
+ProjectTree SyntheticProject::generate(const SyntheticProjectSize &size) {
+  ProjectTree tree;
+  tree.reserve(size.componentCount() + 1);
+  int root = tree.createRoot("Synthetic");
+
+  for (int host = 0; host < size.hosts; ++host) {
+    int hostNode = tree.appendNode(root, QString("主机%1").arg(host + 1),
+                                   "HostModule", hostConfig(host));
+    for (int loop = 0; loop < size.loopsPerHost; ++loop) {
+      tree.appendNode(hostNode, QString("回路%1").arg(loop + 1), "LoopModule",
+                      loopConfig(size, host, loop));
+    }
+    for (int i = 0; i < size.diModulesPerHost; ++i) {
+      tree.appendNode(hostNode, QString("DI模块%1").arg(i + 1), "DIModule",
+                      ioConfig<DIModule, DIBitVariable>(size, "DI", host, i));
+    }
+    for (int i = 0; i < size.doModulesPerHost; ++i) {
+      tree.appendNode(hostNode, QString("DO模块%1").arg(i + 1), "DOModule",
+                      ioConfig<DOModule, DOBitVariable>(size, "DO", host, i));
+    }
+  }
+  return tree;
+}
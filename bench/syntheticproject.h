@@ -0,0 +1,38 @@
+#ifndef SYNTHETICPROJECT_H
+#define SYNTHETICPROJECT_H
+
+#include "projecttree.h"
+#include <QJsonObject>
+#include <QString>
+
+// 合成项目的规模
+struct SyntheticProjectSize {
+  int hosts;
+  int loopsPerHost;
+  int channelsPerLoop;
+  int devicesPerChannel;
+  int diModulesPerHost;
+  int doModulesPerHost;
+  int ioChannels; // DI/DO 模块的通道数，只能是 8、16 或 32
+
+  SyntheticProjectSize()
+      : hosts(4), loopsPerHost(4), channelsPerLoop(2), devicesPerChannel(250),
+        diModulesPerHost(4), doModulesPerHost(4), ioChannels(32) {}
+
+  int componentCount() const;
+  int deviceCount() const;
+  int bitVariableCount() const;
+  QJsonObject toJson() const;
+};
+
+// 按规模生成项目树
+//
+// 每个主机下依次是回路、DI 和 DO 模块，配置段由模块序列化得到，与界面
+// 保存的内容一致。主机 IP、回路地址和变量名互不重复，生成的项目没有
+// 校验问题。
+class SyntheticProject {
+public:
+  static ProjectTree generate(const SyntheticProjectSize &size);
+};
+
+#endif // SYNTHETICPROJECT_H
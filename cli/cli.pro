@@ -0,0 +1,18 @@
+# 命令行工具：加载、校验和导出项目，不创建 QApplication，不加载主题和图标
+QT = core
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = controlleride-cli
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../core/core.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,242 @@
+#include "controllersimulator.h"
+#include "downloadimagecompiler.h"
+#include "moduleregistry.h"
+#include "projectexport.h"
+#include "projectmanager.h"
+#include "projectvalidator.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QTimer>
+
+namespace {
+// 进程退出码
+enum ExitCode {
+  ExitSuccess = 0,
+  ExitProblemsFound = 1, // 校验发现问题
+  ExitFailure = 2        // 参数错误、项目无法加载或导出失败
+};
+
+QTextStream &standardOutput() {
+  static QTextStream stream(stdout);
+  return stream;
+}
+
+QTextStream &standardError() {
+  static QTextStream stream(stderr);
+  return stream;
+}
+
+// 结束一行并立即输出。全局的 endl 自 Qt 5.15 起弃用，Qt 6 中已移除
+QTextStream &endLine(QTextStream &stream) {
+  stream << '\n';
+  stream.flush();
+  return stream;
+}
+
+int validateProject(ProjectManager *manager) {
+  ModuleRegistry registry;
+  ProjectValidator validator(manager->projectModel(), &registry);
+  validator.validateNow();
+
+  const QVector<ValidationProblem> problems = validator.problems();
+  for (const ValidationProblem &problem : problems) {
+    standardOutput() << validator.describe(problem) << endLine;
+  }
+  standardError() << QString("发现 %1 个问题").arg(problems.size()) << endLine;
+  return problems.isEmpty() ? ExitSuccess : ExitProblemsFound;
+}
+
+int exportProject(ProjectManager *manager, const QString &command,
+                  const QString &directory) {
+  const ProjectTree &tree = manager->projectModel()->tree();
+  QString errorString;
+  int fileCount = -1;
+  if (command == "export-devices") {
+    fileCount = ProjectExport::exportDevices(tree, directory, &errorString);
+  } else if (command == "export-modules") {
+    fileCount = ProjectExport::exportModules(tree, directory, &errorString);
+  } else {
+    DownloadImageCompiler compiler;
+    fileCount =
+        ProjectExport::exportImages(tree, directory, &compiler, &errorString);
+  }
+  if (fileCount < 0) {
+    standardError() << QString("导出失败: %1").arg(errorString) << endLine;
+    return ExitFailure;
+  }
+  standardError() << QString("已导出 %1 个文件到 %2").arg(fileCount).arg(
+                         directory)
+                  << endLine;
+  return ExitSuccess;
+}
+
+// 按名称查找主机，重名时取先序中的第一个
+int findHost(const ProjectTree &tree, const QString &name) {
+  QVector<int> stack;
+  if (!tree.isEmpty()) {
+    stack.append(tree.rootNode());
+  }
+  while (!stack.isEmpty()) {
+    int node = stack.takeLast();
+    if (tree.type(node) == "HostModule" && tree.name(node) == name) {
+      return node;
+    }
+    // 逆序入栈，先访问靠前的子节点
+    for (int row = tree.childCount(node) - 1; row >= 0; --row) {
+      stack.append(tree.childAt(node, row));
+    }
+  }
+  return -1;
+}
+
+int portOption(const QCommandLineParser &parser, const QString &name,
+               bool *ok) {
+  bool valid = false;
+  int port = parser.value(name).toInt(&valid);
+  if (!valid || port < 0 || port > 0xffff) {
+    standardError() << QString("无效的参数 --%1: %2")
+                           .arg(name, parser.value(name))
+                    << endLine;
+    *ok = false;
+  }
+  return port;
+}
+
+// 运行仿真器直到进程被终止，或运行 --duration 秒后输出统计并退出
+int simulateHost(QCoreApplication *app, ProjectManager *manager,
+                 const QString &hostName, const QCommandLineParser &parser) {
+  const ProjectTree &tree = manager->projectModel()->tree();
+  int hostNode = findHost(tree, hostName);
+  if (hostNode < 0) {
+    standardError() << QString("项目中没有主机 %1").arg(hostName) << endLine;
+    return ExitFailure;
+  }
+
+  bool ok = true;
+  QHostAddress address(parser.value("address"));
+  int modbusPort = portOption(parser, "modbus-port", &ok);
+  int downloadPort = portOption(parser, "download-port", &ok);
+  int eventPort = portOption(parser, "event-port", &ok);
+  int eventRate = parser.value("event-rate").toInt();
+  int duration = parser.value("duration").toInt();
+  if (address.isNull()) {
+    standardError() << QString("无效的参数 --address: %1")
+                           .arg(parser.value("address"))
+                    << endLine;
+    ok = false;
+  }
+  if (!ok || eventRate < 0 || duration < 0) {
+    return ExitFailure;
+  }
+
+  ControllerSimulator simulator;
+  simulator.load(tree, hostNode);
+  simulator.setSeed(parser.value("seed").toUInt());
+  simulator.setEventRate(eventRate);
+  if (!simulator.listen(address, static_cast<quint16>(modbusPort),
+                        static_cast<quint16>(downloadPort),
+                        static_cast<quint16>(eventPort))) {
+    standardError() << QString("无法监听: %1").arg(simulator.errorString())
+                    << endLine;
+    return ExitFailure;
+  }
+  QObject::connect(&simulator, &ControllerSimulator::configurationDownloaded,
+                   [](const QString &name) {
+                     standardError() << QString("已接受主机 %1 的下载").arg(
+                                            name)
+                                     << endLine;
+                   });
+  QObject::connect(&simulator, &ControllerSimulator::downloadRejected,
+                   [](const QString &errorString) {
+                     standardError()
+                         << QString("拒绝下载: %1").arg(errorString) << endLine;
+                   });
+
+  QString host = simulator.address().toString();
+  standardError() << QString("主机 %1: %2 个回路设备、%3 个 DI 位、%4 个 DO 位")
+                         .arg(hostName)
+                         .arg(simulator.deviceCount())
+                         .arg(simulator.inputCount())
+                         .arg(simulator.coilCount())
+                  << endLine
+                  << QString("Modbus/TCP %1:%2，下载 %1:%3，事件(UDP) %1:%4")
+                         .arg(host)
+                         .arg(simulator.modbusPort())
+                         .arg(simulator.downloadPort())
+                         .arg(simulator.eventPort())
+                  << endLine;
+
+  if (duration > 0) {
+    QTimer::singleShot(duration * 1000, app, &QCoreApplication::quit);
+  }
+  app->exec();
+  standardOutput() << QString("Modbus 请求 %1 个，事件 %2 个，下载 %3 次")
+                          .arg(simulator.requestCount())
+                          .arg(simulator.eventCount())
+                          .arg(simulator.downloadCount())
+                   << endLine;
+  return ExitSuccess;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  // 只使用 QtCore，不创建 QApplication，也不加载主题和图标
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("controlleride-cli");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "ControllerIDE 命令行工具\n\n"
+      "命令:\n"
+      "  validate <项目>               校验项目，发现问题时退出码为 1\n"
+      "  export-devices <项目> <目录>  每个回路通道导出一个设备列表(CSV)\n"
+      "  export-modules <项目> <目录>  每个模块导出一个 JSON 文件\n"
+      "  compile-images <项目> <目录>  每个主机编译一个下载镜像\n"
+      "  simulate <项目> <主机>        在本机模拟该主机的控制器");
+  parser.addHelpOption();
+  parser.addOptions({
+      {"address", "仿真器监听的地址", "address", "127.0.0.1"},
+      {"modbus-port", "仿真器的 Modbus/TCP 端口", "port", "1502"},
+      {"download-port", "仿真器接收下载的端口", "port", "1503"},
+      {"event-port", "仿真器的事件(UDP)端口", "port", "1504"},
+      {"event-rate", "仿真器每秒产生的事件数", "count", "0"},
+      {"seed", "仿真器随机事件的种子", "seed", "1"},
+      {"duration", "仿真器运行的秒数，0 为一直运行", "seconds", "0"},
+  });
+  parser.addPositionalArgument("command",
+                               "validate、export-devices、export-modules、"
+                               "compile-images 或 simulate");
+  parser.addPositionalArgument("project", "项目文件(.xml 或 .tfl)");
+  parser.addPositionalArgument("directory", "导出目录或主机名称",
+                               "[directory|host]");
+  parser.process(app);
+
+  const QStringList arguments = parser.positionalArguments();
+  QString command = arguments.value(0);
+  bool isExport = command == "export-devices" ||
+                  command == "export-modules" || command == "compile-images";
+  bool hasThirdArgument = isExport || command == "simulate";
+  if ((command != "validate" && !hasThirdArgument) ||
+      arguments.size() != (hasThirdArgument ? 3 : 2)) {
+    standardError() << parser.helpText();
+    return ExitFailure;
+  }
+
+  ProjectManager manager;
+  QString errorString;
+  if (!manager.loadProject(arguments.at(1), &errorString)) {
+    standardError() << QString("无法加载项目 %1: %2")
+                           .arg(arguments.at(1), errorString)
+                    << endLine;
+    return ExitFailure;
+  }
+
+  if (command == "validate") {
+    return validateProject(&manager);
+  }
+  if (command == "simulate") {
+    return simulateHost(&app, &manager, arguments.at(2), parser);
+  }
+  return exportProject(&manager, command, arguments.at(2));
+}
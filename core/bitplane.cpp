@@ -0,0 +1,144 @@
+#include "bitplane.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BITPLANE_USE_SSE2
+#endif
+
+namespace {
+bool inRange(int channel, int bit) {
+  return channel >= 0 && channel < BitPlane::MaxChannels && bit >= 0 &&
+         bit < BitPlane::BitsPerChannel;
+}
+
+int bitIndex(int channel, int bit) {
+  return channel * BitPlane::BitsPerChannel + bit;
+}
+} // namespace
+
+BitPlane::BitPlane() { clear(); }
+
+bool BitPlane::bit(int channel, int bit) const {
+  if (!inRange(channel, bit)) {
+    return false;
+  }
+  int index = bitIndex(channel, bit);
+  return (m_words[index / 64] >> (index % 64)) & 1;
+}
+
+void BitPlane::setBit(int channel, int bit, bool value) {
+  if (!inRange(channel, bit)) {
+    return;
+  }
+  int index = bitIndex(channel, bit);
+  quint64 mask = quint64(1) << (index % 64);
+  if (value) {
+    m_words[index / 64] |= mask;
+  } else {
+    m_words[index / 64] &= ~mask;
+  }
+}
+
+quint8 BitPlane::channelBits(int channel) const {
+  if (!inRange(channel, 0)) {
+    return 0;
+  }
+  int index = bitIndex(channel, 0);
+  return static_cast<quint8>(m_words[index / 64] >> (index % 64));
+}
+
+void BitPlane::setChannelBits(int channel, quint8 bits) {
+  if (!inRange(channel, 0)) {
+    return;
+  }
+  int index = bitIndex(channel, 0);
+  quint64 &word = m_words[index / 64];
+  word = (word & ~(quint64(0xff) << (index % 64))) |
+         (quint64(bits) << (index % 64));
+}
+
+void BitPlane::truncate(int channelCount) {
+  int first = bitIndex(qBound(0, channelCount, int(MaxChannels)), 0);
+  for (int word = 0; word < WordCount; ++word) {
+    int begin = word * 64;
+    if (first <= begin) {
+      m_words[word] = 0;
+    } else if (first < begin + 64) {
+      m_words[word] &= (quint64(1) << (first - begin)) - 1;
+    }
+  }
+}
+
+void BitPlane::clear() { memset(m_words, 0, sizeof(m_words)); }
+
+int BitPlane::count() const {
+  int total = 0;
+  for (int word = 0; word < WordCount; ++word) {
+    total += qPopulationCount(m_words[word]);
+  }
+  return total;
+}
+
+bool BitPlane::operator==(const BitPlane &other) const {
+  return memcmp(m_words, other.m_words, sizeof(m_words)) == 0;
+}
+
+void BitPlane::difference(const BitPlane &before, const BitPlane &after,
+                          quint64 *result) {
+#ifdef BITPLANE_USE_SSE2
+  for (int word = 0; word < WordCount; word += 2) {
+    __m128i a = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(before.m_words + word));
+    __m128i b = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(after.m_words + word));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(result + word),
+                     _mm_xor_si128(a, b));
+  }
+#else
+  for (int word = 0; word < WordCount; ++word) {
+    result[word] = before.m_words[word] ^ after.m_words[word];
+  }
+#endif
+}
+
+int BitPlane::changedCount(const BitPlane &before, const BitPlane &after) {
+  quint64 changed[WordCount];
+  difference(before, after, changed);
+  int total = 0;
+  for (int word = 0; word < WordCount; ++word) {
+    total += qPopulationCount(changed[word]);
+  }
+  return total;
+}
+
+QVector<BitEdge> BitPlane::edges(const BitPlane &before,
+                                 const BitPlane &after) {
+  quint64 changed[WordCount];
+  difference(before, after, changed);
+  // 没有变化时不分配
+  int changedBits = 0;
+  for (int word = 0; word < WordCount; ++word) {
+    changedBits += qPopulationCount(changed[word]);
+  }
+
+  QVector<BitEdge> result;
+  if (changedBits == 0) {
+    return result;
+  }
+  result.reserve(changedBits);
+  for (int word = 0; word < WordCount; ++word) {
+    // 每次取出最低的变化位
+    for (quint64 bits = changed[word]; bits != 0; bits &= bits - 1) {
+      int index = word * 64 + qCountTrailingZeroBits(bits);
+      BitEdge edge;
+      edge.channel = index / BitsPerChannel;
+      edge.bit = index % BitsPerChannel;
+      edge.rising = (after.m_words[word] >> (index % 64)) & 1;
+      result.append(edge);
+    }
+  }
+  return result;
+}
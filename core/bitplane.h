@@ -0,0 +1,58 @@
+#ifndef BITPLANE_H
+#define BITPLANE_H
+
+#include <QVector>
+#include <QtGlobal>
+
+// 两个快照之间变化的一个位
+struct BitEdge {
+  int channel;
+  int bit;
+  bool rising; // 由 0 变为 1
+};
+
+// DI/DO 模块中全部位的值
+//
+// 最多 32 个通道、每通道 8 位，按 "通道 * 8 + 位" 的顺序紧凑保存在 4 个
+// 64 位字中，每个字覆盖 8 个通道。比较两个快照时先对整块做异或(支持
+// SSE2 时每次处理 128 位)，再逐字计数并取出变化的位，不需要逐位访问。
+class BitPlane {
+public:
+  enum {
+    MaxChannels = 32,
+    BitsPerChannel = 8,
+    WordCount = MaxChannels * BitsPerChannel / 64
+  };
+
+  BitPlane();
+
+  // 超出范围的通道和位读取为 0，写入被忽略
+  bool bit(int channel, int bit) const;
+  void setBit(int channel, int bit, bool value);
+  quint8 channelBits(int channel) const;
+  void setChannelBits(int channel, quint8 bits);
+
+  // 清除第 channelCount 个及之后通道的位
+  void truncate(int channelCount);
+  void clear();
+
+  // 值为 1 的位数
+  int count() const;
+  const quint64 *words() const { return m_words; }
+
+  bool operator==(const BitPlane &other) const;
+  bool operator!=(const BitPlane &other) const { return !(*this == other); }
+
+  // 两个快照之间变化的位数
+  static int changedCount(const BitPlane &before, const BitPlane &after);
+  // 两个快照之间变化的全部位，按通道和位的顺序排列
+  static QVector<BitEdge> edges(const BitPlane &before, const BitPlane &after);
+
+private:
+  static void difference(const BitPlane &before, const BitPlane &after,
+                         quint64 *result);
+
+  quint64 m_words[WordCount];
+};
+
+#endif // BITPLANE_H
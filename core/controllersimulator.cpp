@@ -0,0 +1,572 @@
+#include "controllersimulator.h"
+#include "modbustcpclient.h"
+#include <QTcpSocket>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+// Modbus/TCP 的 MBAP 头和 PDU 限制
+const int kMbapHeaderSize = 7;
+const int kMaxFrameLength = 254;
+const int kMaxReadBits = 2000;
+const int kMaxReadRegisters = 125;
+const int kMaxWriteBits = 1968;
+const int kMaxWriteRegisters = 123;
+
+// Modbus 异常码
+const quint8 kIllegalFunction = 0x01;
+const quint8 kIllegalDataAddress = 0x02;
+const quint8 kIllegalDataValue = 0x03;
+
+// 下载镜像文件头中 imageSize 的位置，超过上限的镜像直接拒绝
+const int kImageSizeOffset = 8;
+const int kImagePrefixSize = 12;
+const quint32 kMaxImageSize = 64 * 1024 * 1024;
+
+const char kEventMagic[4] = {'T', 'F', 'E', 'V'};
+const char kSubscribeMagic[4] = {'T', 'F', 'E', 'S'};
+const char kUnsubscribeMagic[4] = {'T', 'F', 'E', 'U'};
+const int kEventHeaderSize = 12;
+const int kEventRecordSize = 16;
+// 每个数据报最多的事件数，数据报不超过以太网 MTU
+const int kMaxEventsPerDatagram = 88;
+const int kEventInterval = 10;
+
+void appendBigEndian16(QByteArray &buffer, quint16 value) {
+  uchar bytes[2];
+  qToBigEndian<quint16>(value, bytes);
+  buffer.append(reinterpret_cast<const char *>(bytes), 2);
+}
+
+quint16 readBigEndian16(const char *data) {
+  return qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(data));
+}
+
+void appendUInt16(QByteArray &buffer, quint16 value) {
+  uchar bytes[2];
+  qToLittleEndian<quint16>(value, bytes);
+  buffer.append(reinterpret_cast<const char *>(bytes), 2);
+}
+
+void appendUInt32(QByteArray &buffer, quint32 value) {
+  uchar bytes[4];
+  qToLittleEndian<quint32>(value, bytes);
+  buffer.append(reinterpret_cast<const char *>(bytes), 4);
+}
+
+quint32 readUInt32(const char *data) {
+  return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(data));
+}
+
+QByteArray exceptionResponse(quint8 function, quint8 code) {
+  QByteArray response;
+  response.append(static_cast<char>(function | 0x80));
+  response.append(static_cast<char>(code));
+  return response;
+}
+
+// 位按 Modbus 的顺序打包，每字节从最低位开始
+QByteArray packBits(const QVector<quint8> &bits, int address, int count) {
+  QByteArray packed((count + 7) / 8, '\0');
+  for (int i = 0; i < count; ++i) {
+    if (bits.at(address + i)) {
+      packed[i / 8] = static_cast<char>(packed.at(i / 8) | (1 << (i % 8)));
+    }
+  }
+  return packed;
+}
+} // namespace
+
+ControllerSimulator::ControllerSimulator(QObject *parent)
+    : QObject(parent), m_pendingEventCount(0), m_eventRate(0),
+      m_rateStart(0), m_scheduledEvents(0), m_random(0x9e3779b9),
+      m_sequence(0), m_requestCount(0), m_eventCount(0), m_downloadCount(0) {
+  m_eventTimer.setInterval(kEventInterval);
+  connect(&m_eventTimer, &QTimer::timeout, this,
+          &ControllerSimulator::generateEvents);
+  connect(&m_modbusServer, &QTcpServer::newConnection, this,
+          &ControllerSimulator::onModbusConnection);
+  connect(&m_downloadServer, &QTcpServer::newConnection, this,
+          &ControllerSimulator::onDownloadConnection);
+  connect(&m_eventSocket, &QUdpSocket::readyRead, this,
+          &ControllerSimulator::onEventDatagrams);
+}
+
+ControllerSimulator::~ControllerSimulator() { close(); }
+
+bool ControllerSimulator::load(const ProjectTree &tree, int hostNode) {
+  if (!tree.isValidNode(hostNode) || tree.type(hostNode) != "HostModule") {
+    return false;
+  }
+  setContent(DownloadImage::content(DownloadImage::source(tree, hostNode)));
+  return true;
+}
+
+void ControllerSimulator::setContent(const DownloadImageContent &content) {
+  m_content = content;
+  m_devices.clear();
+  m_inputSources.clear();
+  m_inputs.clear();
+  m_coils.clear();
+
+  for (int loop = 0; loop < content.loops.size(); ++loop) {
+    const DownloadImageContent::Loop &loopContent = content.loops.at(loop);
+    for (int channel = 0; channel < loopContent.channels.size(); ++channel) {
+      for (const LoopDevice &device : loopContent.channels.at(channel)) {
+        EventSource source;
+        source.unit = static_cast<quint16>(loop);
+        source.channel = static_cast<quint16>(channel);
+        source.point =
+            static_cast<quint16>(qBound(0, device.address, 0xffff));
+        m_devices.append(source);
+      }
+    }
+  }
+  m_deviceStates = QVector<quint16>(m_devices.size(), DeviceNormal);
+
+  int inputModule = 0;
+  for (const DownloadImageContent::IoModule &module : content.ioModules) {
+    QVector<quint8> &bits = module.isOutput ? m_coils : m_inputs;
+    for (int i = 0; i < module.bits.size(); ++i) {
+      bits.append(module.bits.at(i).value ? 1 : 0);
+      if (!module.isOutput) {
+        EventSource source;
+        source.unit = static_cast<quint16>(inputModule);
+        source.channel = static_cast<quint16>(i / 8);
+        source.point = static_cast<quint16>(i % 8);
+        m_inputSources.append(source);
+      }
+    }
+    if (!module.isOutput) {
+      ++inputModule;
+    }
+  }
+}
+
+const DownloadImageContent &ControllerSimulator::content() const {
+  return m_content;
+}
+
+bool ControllerSimulator::listen(const QHostAddress &address,
+                                 quint16 modbusPort, quint16 downloadPort,
+                                 quint16 eventPort) {
+  close();
+  if (!m_modbusServer.listen(address, modbusPort)) {
+    m_errorString = QString("Modbus 端口: %1").arg(
+        m_modbusServer.errorString());
+    close();
+    return false;
+  }
+  if (!m_downloadServer.listen(address, downloadPort)) {
+    m_errorString = QString("下载端口: %1").arg(
+        m_downloadServer.errorString());
+    close();
+    return false;
+  }
+  if (!m_eventSocket.bind(address, eventPort)) {
+    m_errorString = QString("事件端口: %1").arg(m_eventSocket.errorString());
+    close();
+    return false;
+  }
+
+  m_errorString.clear();
+  m_eventClock.start();
+  m_rateStart = 0;
+  m_scheduledEvents = 0;
+  m_eventTimer.start();
+  return true;
+}
+
+void ControllerSimulator::close() {
+  m_eventTimer.stop();
+  m_modbusServer.close();
+  m_downloadServer.close();
+  m_eventSocket.close();
+  m_subscribers.clear();
+  m_pendingEvents.clear();
+  m_pendingEventCount = 0;
+
+  // 客户端连接是服务器的子对象，这里先断开，避免析构时再发出信号
+  QList<QTcpSocket *> sockets = m_buffers.keys();
+  m_buffers.clear();
+  for (QTcpSocket *socket : sockets) {
+    socket->disconnect(this);
+    socket->abort();
+    socket->deleteLater();
+  }
+}
+
+bool ControllerSimulator::isListening() const {
+  return m_modbusServer.isListening();
+}
+
+QString ControllerSimulator::errorString() const { return m_errorString; }
+
+QHostAddress ControllerSimulator::address() const {
+  return m_modbusServer.serverAddress();
+}
+
+quint16 ControllerSimulator::modbusPort() const {
+  return m_modbusServer.serverPort();
+}
+
+quint16 ControllerSimulator::downloadPort() const {
+  return m_downloadServer.serverPort();
+}
+
+quint16 ControllerSimulator::eventPort() const {
+  return m_eventSocket.localPort();
+}
+
+int ControllerSimulator::eventRate() const { return m_eventRate; }
+
+void ControllerSimulator::setEventRate(int eventsPerSecond) {
+  m_eventRate = qMax(0, eventsPerSecond);
+  // 从现在起按新速率计数，不补发之前的事件
+  m_rateStart = m_eventClock.isValid() ? m_eventClock.elapsed() : 0;
+  m_scheduledEvents = 0;
+}
+
+void ControllerSimulator::setSeed(quint32 seed) {
+  // xorshift 的状态不能为 0
+  m_random = seed ? seed : 0x9e3779b9;
+}
+
+int ControllerSimulator::deviceCount() const { return m_devices.size(); }
+
+int ControllerSimulator::inputCount() const { return m_inputs.size(); }
+
+int ControllerSimulator::coilCount() const { return m_coils.size(); }
+
+ControllerSimulator::DeviceState
+ControllerSimulator::deviceState(int index) const {
+  return static_cast<DeviceState>(m_deviceStates.at(index));
+}
+
+void ControllerSimulator::setDeviceState(int index, DeviceState state) {
+  if (m_deviceStates.at(index) == state) {
+    return;
+  }
+  m_deviceStates[index] = static_cast<quint16>(state);
+  appendEvent(DeviceEvent, m_devices.at(index), static_cast<quint8>(state));
+}
+
+bool ControllerSimulator::input(int address) const {
+  return m_inputs.at(address) != 0;
+}
+
+void ControllerSimulator::setInput(int address, bool value) {
+  if ((m_inputs.at(address) != 0) == value) {
+    return;
+  }
+  m_inputs[address] = value ? 1 : 0;
+  appendEvent(InputEvent, m_inputSources.at(address), value ? 1 : 0);
+}
+
+bool ControllerSimulator::coil(int address) const {
+  return m_coils.at(address) != 0;
+}
+
+qint64 ControllerSimulator::requestCount() const { return m_requestCount; }
+
+qint64 ControllerSimulator::eventCount() const { return m_eventCount; }
+
+int ControllerSimulator::downloadCount() const { return m_downloadCount; }
+
+int ControllerSimulator::subscriberCount() const {
+  return m_subscribers.size();
+}
+
+void ControllerSimulator::onModbusConnection() {
+  while (QTcpSocket *socket = m_modbusServer.nextPendingConnection()) {
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_buffers.insert(socket, QByteArray());
+    connect(socket, &QTcpSocket::readyRead, this,
+            [this, socket]() { processModbus(socket); });
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+      m_buffers.remove(socket);
+      socket->deleteLater();
+    });
+  }
+}
+
+void ControllerSimulator::onDownloadConnection() {
+  while (QTcpSocket *socket = m_downloadServer.nextPendingConnection()) {
+    m_buffers.insert(socket, QByteArray());
+    connect(socket, &QTcpSocket::readyRead, this,
+            [this, socket]() { processDownload(socket); });
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+      m_buffers.remove(socket);
+      socket->deleteLater();
+    });
+  }
+}
+
+void ControllerSimulator::processModbus(QTcpSocket *socket) {
+  QByteArray &buffer = m_buffers[socket];
+  buffer.append(socket->readAll());
+
+  // 流水线中的多个请求一次处理，响应合并为一次写入
+  QByteArray responses;
+  int offset = 0;
+  while (buffer.size() - offset >= kMbapHeaderSize) {
+    const char *frame = buffer.constData() + offset;
+    quint16 length = readBigEndian16(frame + 4);
+    if (readBigEndian16(frame + 2) != 0 || length < 2 ||
+        length > kMaxFrameLength) {
+      // 帧边界已无法确定，只能断开
+      buffer.clear();
+      socket->abort();
+      return;
+    }
+    if (buffer.size() - offset < 6 + length) {
+      break;
+    }
+
+    QByteArray response = handleModbusPdu(
+        QByteArray(frame + kMbapHeaderSize, length - 1));
+    responses.append(frame, 4);
+    appendBigEndian16(responses, static_cast<quint16>(response.size() + 1));
+    responses.append(frame[6]);
+    responses.append(response);
+    ++m_requestCount;
+    offset += 6 + length;
+  }
+  buffer.remove(0, offset);
+  if (!responses.isEmpty()) {
+    socket->write(responses);
+  }
+}
+
+QByteArray ControllerSimulator::handleModbusPdu(const QByteArray &pdu) {
+  const char *data = pdu.constData();
+  quint8 function = static_cast<quint8>(data[0]);
+  if (pdu.size() < 5) {
+    return exceptionResponse(function, kIllegalDataValue);
+  }
+  int address = readBigEndian16(data + 1);
+  int count = readBigEndian16(data + 3);
+
+  QByteArray response;
+  response.append(static_cast<char>(function));
+  switch (function) {
+  case ModbusTcpClient::ReadCoils:
+  case ModbusTcpClient::ReadDiscreteInputs: {
+    const QVector<quint8> &bits =
+        function == ModbusTcpClient::ReadCoils ? m_coils : m_inputs;
+    if (count < 1 || count > kMaxReadBits) {
+      return exceptionResponse(function, kIllegalDataValue);
+    }
+    if (address + count > bits.size()) {
+      return exceptionResponse(function, kIllegalDataAddress);
+    }
+    QByteArray packed = packBits(bits, address, count);
+    response.append(static_cast<char>(packed.size()));
+    response.append(packed);
+    return response;
+  }
+  case ModbusTcpClient::ReadHoldingRegisters:
+  case ModbusTcpClient::ReadInputRegisters:
+    if (count < 1 || count > kMaxReadRegisters) {
+      return exceptionResponse(function, kIllegalDataValue);
+    }
+    if (address + count > m_deviceStates.size()) {
+      return exceptionResponse(function, kIllegalDataAddress);
+    }
+    response.append(static_cast<char>(count * 2));
+    for (int i = 0; i < count; ++i) {
+      appendBigEndian16(response, m_deviceStates.at(address + i));
+    }
+    return response;
+  case ModbusTcpClient::WriteMultipleCoils: {
+    int byteCount = (count + 7) / 8;
+    if (count < 1 || count > kMaxWriteBits || pdu.size() < 6 ||
+        static_cast<quint8>(data[5]) != byteCount ||
+        pdu.size() < 6 + byteCount) {
+      return exceptionResponse(function, kIllegalDataValue);
+    }
+    if (address + count > m_coils.size()) {
+      return exceptionResponse(function, kIllegalDataAddress);
+    }
+    for (int i = 0; i < count; ++i) {
+      m_coils[address + i] = (data[6 + i / 8] >> (i % 8)) & 1;
+    }
+    response.append(data + 1, 4);
+    return response;
+  }
+  case ModbusTcpClient::WriteMultipleRegisters: {
+    int byteCount = count * 2;
+    if (count < 1 || count > kMaxWriteRegisters || pdu.size() < 6 ||
+        static_cast<quint8>(data[5]) != byteCount ||
+        pdu.size() < 6 + byteCount) {
+      return exceptionResponse(function, kIllegalDataValue);
+    }
+    if (address + count > m_deviceStates.size()) {
+      return exceptionResponse(function, kIllegalDataAddress);
+    }
+    // 先检查全部值，不接受部分写入
+    for (int i = 0; i < count; ++i) {
+      if (readBigEndian16(data + 6 + i * 2) > DeviceFault) {
+        return exceptionResponse(function, kIllegalDataValue);
+      }
+    }
+    for (int i = 0; i < count; ++i) {
+      setDeviceState(address + i, static_cast<DeviceState>(
+                                      readBigEndian16(data + 6 + i * 2)));
+    }
+    response.append(data + 1, 4);
+    return response;
+  }
+  default:
+    return exceptionResponse(function, kIllegalFunction);
+  }
+}
+
+void ControllerSimulator::processDownload(QTcpSocket *socket) {
+  QByteArray &buffer = m_buffers[socket];
+  buffer.append(socket->readAll());
+  if (buffer.size() < kImagePrefixSize) {
+    return;
+  }
+
+  quint32 imageSize = readUInt32(buffer.constData() + kImageSizeOffset);
+  QString errorString;
+  DownloadImageContent content;
+  if (memcmp(buffer.constData(), "TFDI", 4) != 0) {
+    errorString = "不是有效的下载镜像";
+  } else if (imageSize > kMaxImageSize) {
+    errorString = QString("镜像过大: %1 字节").arg(imageSize);
+  } else if (static_cast<quint32>(buffer.size()) < imageSize) {
+    return;
+  } else {
+    buffer.truncate(static_cast<int>(imageSize));
+    DownloadImage::decode(buffer, &content, &errorString);
+  }
+
+  QByteArray reply;
+  if (errorString.isEmpty()) {
+    reply.append("TFDA", 4);
+    appendUInt32(reply, DownloadImage::crc32(buffer.constData(),
+                                             buffer.size()));
+  } else {
+    reply.append("TFDN", 4);
+    appendUInt32(reply, 0);
+  }
+  // 一个连接只接受一个镜像，回复写完后断开
+  buffer.clear();
+  socket->write(reply);
+  socket->disconnectFromHost();
+
+  if (errorString.isEmpty()) {
+    setContent(content);
+    ++m_downloadCount;
+    emit configurationDownloaded(content.network.hostName);
+  } else {
+    emit downloadRejected(errorString);
+  }
+}
+
+void ControllerSimulator::onEventDatagrams() {
+  while (m_eventSocket.hasPendingDatagrams()) {
+    QByteArray datagram(
+        static_cast<int>(qMax<qint64>(0, m_eventSocket.pendingDatagramSize())),
+        '\0');
+    QHostAddress sender;
+    quint16 senderPort = 0;
+    qint64 size = m_eventSocket.readDatagram(datagram.data(), datagram.size(),
+                                             &sender, &senderPort);
+    if (size < 4) {
+      continue;
+    }
+    QPair<QHostAddress, quint16> subscriber(sender, senderPort);
+    if (memcmp(datagram.constData(), kSubscribeMagic, 4) == 0) {
+      if (!m_subscribers.contains(subscriber)) {
+        m_subscribers.append(subscriber);
+      }
+    } else if (memcmp(datagram.constData(), kUnsubscribeMagic, 4) == 0) {
+      m_subscribers.removeAll(subscriber);
+    }
+  }
+}
+
+void ControllerSimulator::generateEvents() {
+  int sourceCount = m_devices.size() + m_inputSources.size();
+  if (m_eventRate > 0 && sourceCount > 0) {
+    qint64 due = (m_eventClock.elapsed() - m_rateStart) * m_eventRate / 1000;
+    // 定时器被阻塞后最多补发一秒的事件
+    qint64 count = qMin<qint64>(due - m_scheduledEvents, m_eventRate);
+    m_scheduledEvents = due;
+    for (qint64 i = 0; i < count; ++i) {
+      int target = static_cast<int>(nextRandom() % sourceCount);
+      if (target < m_devices.size()) {
+        // 正常的设备约四分之一进入故障，其余进入报警
+        DeviceState state = DeviceNormal;
+        if (m_deviceStates.at(target) == DeviceNormal) {
+          state = nextRandom() % 4 == 0 ? DeviceFault : DeviceAlarm;
+        }
+        setDeviceState(target, state);
+      } else {
+        int address = target - m_devices.size();
+        setInput(address, !input(address));
+      }
+    }
+  }
+  flushEvents();
+}
+
+void ControllerSimulator::appendEvent(EventKind kind,
+                                      const EventSource &source,
+                                      quint8 state) {
+  ++m_eventCount;
+  ++m_sequence;
+  if (m_subscribers.isEmpty()) {
+    return;
+  }
+
+  appendUInt32(m_pendingEvents, m_sequence);
+  appendUInt32(m_pendingEvents,
+               static_cast<quint32>(m_eventClock.isValid()
+                                        ? m_eventClock.elapsed()
+                                        : 0));
+  m_pendingEvents.append(static_cast<char>(kind));
+  m_pendingEvents.append(static_cast<char>(state));
+  appendUInt16(m_pendingEvents, source.unit);
+  appendUInt16(m_pendingEvents, source.channel);
+  appendUInt16(m_pendingEvents, source.point);
+  ++m_pendingEventCount;
+}
+
+void ControllerSimulator::flushEvents() {
+  if (m_pendingEventCount == 0) {
+    return;
+  }
+
+  const char *records = m_pendingEvents.constData();
+  for (int first = 0; first < m_pendingEventCount;
+       first += kMaxEventsPerDatagram) {
+    int count = qMin(kMaxEventsPerDatagram, m_pendingEventCount - first);
+    QByteArray datagram;
+    datagram.reserve(kEventHeaderSize + count * kEventRecordSize);
+    datagram.append(kEventMagic, 4);
+    appendUInt16(datagram, EventVersion);
+    appendUInt16(datagram, static_cast<quint16>(count));
+    // 记录以序号开头，订阅之前的事件没有记录，序号不一定从 1 连续
+    const char *record = records + first * kEventRecordSize;
+    appendUInt32(datagram, readUInt32(record));
+    datagram.append(record, count * kEventRecordSize);
+    for (const QPair<QHostAddress, quint16> &subscriber : m_subscribers) {
+      m_eventSocket.writeDatagram(datagram, subscriber.first,
+                                  subscriber.second);
+    }
+  }
+  m_pendingEvents.clear();
+  m_pendingEventCount = 0;
+}
+
+quint32 ControllerSimulator::nextRandom() {
+  // xorshift32，只用于产生可重复的测试负载
+  m_random ^= m_random << 13;
+  m_random ^= m_random >> 17;
+  m_random ^= m_random << 5;
+  return m_random;
+}
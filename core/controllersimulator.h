@@ -0,0 +1,150 @@
+#ifndef CONTROLLERSIMULATOR_H
+#define CONTROLLERSIMULATOR_H
+
+#include "downloadimage.h"
+#include "projecttree.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QTcpServer>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QVector>
+
+class QTcpSocket;
+
+// 控制器仿真器
+//
+// 按主机子树或下载镜像的内容模拟一台控制器，在没有实际控制器时测试在线
+// 监控、下载和事件接收。三个端口都只监听指定的地址，默认为本机回环地址：
+//
+//   Modbus/TCP  DI 模块的位为离散输入，DO 模块的位为线圈，按模块顺序从
+//               地址 0 开始连续编址，与 HostIoMonitor 相同。回路设备按回路、
+//               通道和设备的顺序各占一个寄存器，值为 DeviceState，可作为
+//               保持寄存器或输入寄存器读取，写入保持寄存器可以复位或注入
+//               状态。支持功能码 1、2、3、4、15 和 16。
+//   下载(TCP)   客户端发送一个完整的下载镜像，校验通过后替换当前配置，回复
+//               "TFDA" 和镜像的 CRC-32，失败时回复 "TFDN" 和 0，随后断开。
+//   事件(UDP)   向事件端口发送 "TFES" 订阅事件流，"TFEU" 取消订阅。每个
+//               数据报为 12 字节的头 {magic "TFEV", version, count,
+//               firstSequence} 加 count 条 16 字节的记录 {sequence,
+//               timestamp, kind, state, unit, channel, point}，timestamp
+//               为开始监听后的毫秒数。
+//
+// 下载和事件中的整数为小端序，Modbus 为大端序。
+class ControllerSimulator : public QObject {
+  Q_OBJECT
+
+public:
+  enum DeviceState { DeviceNormal = 0, DeviceAlarm = 1, DeviceFault = 2 };
+
+  // 事件记录的 kind 字段
+  enum EventKind {
+    DeviceEvent = 1, // unit 为回路，channel 为通道，point 为设备地址
+    InputEvent = 2   // unit 为 DI 模块，channel 为通道，point 为位
+  };
+
+  static const quint16 EventVersion = 1;
+
+  explicit ControllerSimulator(QObject *parent = nullptr);
+  ~ControllerSimulator();
+
+  // 按主机子树的当前配置段加载，返回 false 表示 hostNode 不是主机
+  bool load(const ProjectTree &tree, int hostNode);
+  void setContent(const DownloadImageContent &content);
+  const DownloadImageContent &content() const;
+
+  // 端口为 0 时由系统分配，之后通过 modbusPort() 等获取
+  bool listen(const QHostAddress &address = QHostAddress::LocalHost,
+              quint16 modbusPort = 0, quint16 downloadPort = 0,
+              quint16 eventPort = 0);
+  void close();
+  bool isListening() const;
+  QString errorString() const;
+  QHostAddress address() const;
+  quint16 modbusPort() const;
+  quint16 downloadPort() const;
+  quint16 eventPort() const;
+
+  // 每秒随机产生的事件数，0 为不产生。事件随机选择一个回路设备或 DI 位：
+  // 正常的设备进入报警或故障，异常的设备恢复正常，DI 位取反。
+  int eventRate() const;
+  void setEventRate(int eventsPerSecond);
+  // 随机序列的种子，相同的种子和速率产生相同的事件序列
+  void setSeed(quint32 seed);
+
+  int deviceCount() const;
+  int inputCount() const;
+  int coilCount() const;
+  DeviceState deviceState(int index) const;
+  void setDeviceState(int index, DeviceState state);
+  bool input(int address) const;
+  void setInput(int address, bool value);
+  bool coil(int address) const;
+
+  // 累计处理的 Modbus 请求、产生的事件和接受的下载
+  qint64 requestCount() const;
+  qint64 eventCount() const;
+  int downloadCount() const;
+  int subscriberCount() const;
+
+signals:
+  void configurationDownloaded(const QString &hostName);
+  void downloadRejected(const QString &errorString);
+
+private slots:
+  void onModbusConnection();
+  void onDownloadConnection();
+  void onEventDatagrams();
+  void generateEvents();
+
+private:
+  // 回路设备和 DI 位在事件记录中的位置
+  struct EventSource {
+    quint16 unit;
+    quint16 channel;
+    quint16 point;
+  };
+
+  void processModbus(QTcpSocket *socket);
+  QByteArray handleModbusPdu(const QByteArray &pdu);
+  void processDownload(QTcpSocket *socket);
+  void appendEvent(EventKind kind, const EventSource &source, quint8 state);
+  void flushEvents();
+  quint32 nextRandom();
+
+  DownloadImageContent m_content;
+  QVector<EventSource> m_devices;
+  QVector<quint16> m_deviceStates;
+  QVector<EventSource> m_inputSources;
+  QVector<quint8> m_inputs;
+  QVector<quint8> m_coils;
+
+  QTcpServer m_modbusServer;
+  QTcpServer m_downloadServer;
+  QUdpSocket m_eventSocket;
+  QHash<QTcpSocket *, QByteArray> m_buffers;
+  QList<QPair<QHostAddress, quint16>> m_subscribers;
+  QString m_errorString;
+
+  QTimer m_eventTimer;
+  QElapsedTimer m_eventClock;
+  QByteArray m_pendingEvents; // 尚未发送的事件记录
+  int m_pendingEventCount;
+  int m_eventRate;
+  qint64 m_rateStart; // 设置速率时 m_eventClock 的读数，事件时间戳不受影响
+  qint64 m_scheduledEvents; // 按速率自 m_rateStart 起应产生的事件数
+  quint32 m_random;
+  quint32 m_sequence;
+
+  qint64 m_requestCount;
+  qint64 m_eventCount;
+  int m_downloadCount;
+};
+
+#endif // CONTROLLERSIMULATOR_H
@@ -0,0 +1,14 @@
+# 链接 core 静态库，由 app、cli 和 bench 引用
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+QT += network concurrent
+
+win32:CONFIG(release, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/release
+else:win32:CONFIG(debug, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/debug
+else: CORE_LIB_DIR = $$OUT_PWD/../core
+
+LIBS += -L$$CORE_LIB_DIR -lcontrolleride-core
+
+win32-msvc*: PRE_TARGETDEPS += $$CORE_LIB_DIR/controlleride-core.lib
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/libcontrolleride-core.a
@@ -0,0 +1,63 @@
+# 不依赖 QtGui/QtWidgets，命令行工具和构建服务器也可以使用
+TEMPLATE = lib
+TARGET = controlleride-core
+CONFIG += staticlib c++11
+
+QT = core network concurrent
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    bitplane.cpp \
+    controllersimulator.cpp \
+    dimodule.cpp \
+    domodule.cpp \
+    downloadimage.cpp \
+    downloadimagecompiler.cpp \
+    hostiomonitor.cpp \
+    hostmodule.cpp \
+    hostprober.cpp \
+    loopdevicecsv.cpp \
+    loopmodule.cpp \
+    modbustcpclient.cpp \
+    moduleregistry.cpp \
+    projectbinaryformat.cpp \
+    projectcommands.cpp \
+    projectexport.cpp \
+    projectloader.cpp \
+    projectmanager.cpp \
+    projectmodel.cpp \
+    projectreplicator.cpp \
+    projectsearch.cpp \
+    projecttree.cpp \
+    projectvalidator.cpp \
+    symbolindex.cpp \
+    undostack.cpp
+
+HEADERS += \
+    bitplane.h \
+    controllersimulator.h \
+    dimodule.h \
+    domodule.h \
+    downloadimage.h \
+    downloadimagecompiler.h \
+    hostiomonitor.h \
+    hostmodule.h \
+    hostprober.h \
+    loopdevicecsv.h \
+    loopmodule.h \
+    modbustcpclient.h \
+    moduleregistry.h \
+    moduleupdateguard.h \
+    projectbinaryformat.h \
+    projectcommands.h \
+    projectexport.h \
+    projectloader.h \
+    projectmanager.h \
+    projectmodel.h \
+    projectreplicator.h \
+    projectsearch.h \
+    projecttree.h \
+    projectvalidator.h \
+    symbolindex.h \
+    undostack.h
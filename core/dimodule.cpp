@@ -1,11 +1,14 @@
 #include "dimodule.h"
+#include "moduleupdateguard.h"
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 
 DIModule::DIModule(QObject *parent)
-    : QObject(parent), m_channelCount(8)
+    : QObject(parent), m_channelCount(8), m_updateDepth(0),
+      m_changedDuringUpdate(false), m_countChangedDuringUpdate(false),
+      m_firstChangedChannel(-1), m_lastChangedChannel(-1)
 {
     // 默认初始化为8个通道
     m_channels.resize(m_channelCount);
@@ -18,22 +21,101 @@ DIModule::~DIModule()
 {
 }
 
+void DIModule::beginUpdate()
+{
+    ++m_updateDepth;
+}
+
+void DIModule::endUpdate()
+{
+    if (m_updateDepth == 0 || --m_updateDepth > 0) {
+        return;
+    }
+    
+    // 期间的修改合并为一次通道数量通知和一个通道范围
+    if (m_countChangedDuringUpdate) {
+        m_countChangedDuringUpdate = false;
+        emit channelCountChanged(m_channelCount);
+    }
+    if (m_firstChangedChannel >= 0) {
+        // 之后减少的通道不再报告
+        int first = m_firstChangedChannel;
+        int last = qMin(m_lastChangedChannel, m_channelCount - 1);
+        m_firstChangedChannel = -1;
+        m_lastChangedChannel = -1;
+        if (first <= last) {
+            emit channelsChanged(first, last);
+        }
+    }
+    
+    if (m_changedDuringUpdate) {
+        m_changedDuringUpdate = false;
+        emit dataChanged();
+    }
+}
+
+bool DIModule::isUpdating() const
+{
+    return m_updateDepth > 0;
+}
+
+void DIModule::notifyChanged()
+{
+    if (m_updateDepth > 0) {
+        m_changedDuringUpdate = true;
+    } else {
+        emit dataChanged();
+    }
+}
+
+void DIModule::notifyChannels(int firstChannel, int lastChannel)
+{
+    if (m_updateDepth == 0) {
+        emit channelsChanged(firstChannel, lastChannel);
+        return;
+    }
+    
+    if (m_firstChangedChannel < 0) {
+        m_firstChangedChannel = firstChannel;
+        m_lastChangedChannel = lastChannel;
+    } else {
+        m_firstChangedChannel = qMin(m_firstChangedChannel, firstChannel);
+        m_lastChangedChannel = qMax(m_lastChangedChannel, lastChannel);
+    }
+}
+
+void DIModule::notifyChannelCount()
+{
+    if (m_updateDepth > 0) {
+        m_countChangedDuringUpdate = true;
+    } else {
+        emit channelCountChanged(m_channelCount);
+    }
+}
+
 void DIModule::setChannelCount(int count)
 {
     // 只允许8、16或32个通道
     if (count != 8 && count != 16 && count != 32) {
         return;
     }
+    if (count == m_channelCount) {
+        return;
+    }
     
     m_channelCount = count;
     
     // 调整通道数量
     m_channels.resize(m_channelCount);
+    m_values.truncate(m_channelCount);
     
     // 确保每个通道都有正确的编号
     for (int i = 0; i < m_channelCount; ++i) {
         m_channels[i].channelNumber = i;
     }
+    
+    notifyChannelCount();
+    notifyChanged();
 }
 
 int DIModule::getChannelCount() const
@@ -53,7 +135,13 @@ void DIModule::setBitVariable(int channelNumber, int bitNumber, const DIBitVaria
 {
     if (channelNumber >= 0 && channelNumber < m_channelCount && 
         bitNumber >= 0 && bitNumber < 8) {
-        m_channels[channelNumber].bits[bitNumber] = variable;
+        DIBitVariable &target = m_channels[channelNumber].bits[bitNumber];
+        target.name = variable.name;
+        target.description = variable.description;
+        target.isGlobal = variable.isGlobal;
+        m_values.setBit(channelNumber, bitNumber, variable.value != 0);
+        notifyChannels(channelNumber, channelNumber);
+        notifyChanged();
     }
 }
 
@@ -61,12 +149,66 @@ DIBitVariable DIModule::getBitVariable(int channelNumber, int bitNumber) const
 {
     if (channelNumber >= 0 && channelNumber < m_channelCount && 
         bitNumber >= 0 && bitNumber < 8) {
-        return m_channels[channelNumber].bits[bitNumber];
+        DIBitVariable variable = m_channels[channelNumber].bits[bitNumber];
+        variable.value = m_values.bit(channelNumber, bitNumber) ? 1 : 0;
+        return variable;
     }
     return DIBitVariable();
 }
 
+bool DIModule::bitValue(int channelNumber, int bitNumber) const
+{
+    return channelNumber < m_channelCount &&
+           m_values.bit(channelNumber, bitNumber);
+}
+
+const BitPlane &DIModule::values() const
+{
+    return m_values;
+}
+
+void DIModule::setValues(const BitPlane &values)
+{
+    BitPlane next = values;
+    next.truncate(m_channelCount);
+    QVector<BitEdge> edges = BitPlane::edges(m_values, next);
+    if (edges.isEmpty()) {
+        return;
+    }
+    m_values = next;
+    emit valuesChanged(edges);
+}
+
 void DIModule::saveConfiguration(const QString &filePath)
+{
+    // 保存到文件
+    QJsonDocument doc(toJson());
+    QFile file(filePath);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(doc.toJson());
+        file.close();
+    }
+}
+
+void DIModule::loadConfiguration(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    
+    QByteArray data = file.readAll();
+    file.close();
+    
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (doc.isNull() || !doc.isObject()) {
+        return;
+    }
+    
+    fromJson(doc.object());
+}
+
+QJsonObject DIModule::toJson() const
 {
     QJsonObject rootObj;
     
@@ -86,7 +228,7 @@ void DIModule::saveConfiguration(const QString &filePath)
             bitObj["name"] = m_channels[i].bits[j].name;
             bitObj["description"] = m_channels[i].bits[j].description;
             bitObj["isGlobal"] = m_channels[i].bits[j].isGlobal;
-            bitObj["value"] = m_channels[i].bits[j].value;  // 保存位值
+            bitObj["value"] = m_values.bit(i, j) ? 1 : 0;  // 保存位值
             bitsArray.append(bitObj);
         }
         
@@ -95,32 +237,13 @@ void DIModule::saveConfiguration(const QString &filePath)
     }
     
     rootObj["channels"] = channelsArray;
-    
-    // 保存到文件
-    QJsonDocument doc(rootObj);
-    QFile file(filePath);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(doc.toJson());
-        file.close();
-    }
+    return rootObj;
 }
 
-void DIModule::loadConfiguration(const QString &filePath)
+void DIModule::fromJson(const QJsonObject &rootObj)
 {
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        return;
-    }
-    
-    QByteArray data = file.readAll();
-    file.close();
-    
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isNull() || !doc.isObject()) {
-        return;
-    }
-    
-    QJsonObject rootObj = doc.object();
+    // 逐位写入配置，结束时只通知一次
+    ModuleUpdateGuard<DIModule> guard(this);
     
     // 读取通道数量
     if (rootObj.contains("channelCount")) {
@@ -0,0 +1,100 @@
+#ifndef DOMODULE_H
+#define DOMODULE_H
+
+#include "bitplane.h"
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QMap>
+
+// 定义DO模块的位变量结构
+struct DOBitVariable {
+    QString name;       // 变量名称
+    QString description; // 变量描述
+    bool isGlobal;      // 是否为全局变量
+    int value;          // 位的值，0或1，模块内保存在位平面中
+    
+    DOBitVariable() : isGlobal(true), value(0) {}  // 默认构造函数，初始化值为0
+};
+
+// 定义DO模块的通道结构，只保存名称等配置，bits 中的 value 不使用，
+// 位的值由 DOModule::bitValue() 读取
+struct DOChannel {
+    int channelNumber;  // 通道编号
+    QVector<DOBitVariable> bits; // 8位变量
+    
+    DOChannel() {
+        // 初始化8位变量
+        bits.resize(8);
+    }
+};
+
+// DO模块类
+class DOModule : public QObject
+{
+    Q_OBJECT
+    
+public:
+    explicit DOModule(QObject *parent = nullptr);
+    ~DOModule();
+    
+    // 批量修改：beginUpdate() 与最外层 endUpdate() 之间的修改只在结束时
+    // 通知一次，先发出 channelCountChanged() 和覆盖全部修改通道的
+    // channelsChanged()，再发出一次 dataChanged()，可以嵌套调用
+    void beginUpdate();
+    void endUpdate();
+    bool isUpdating() const;
+    
+    // 设置通道数量（8、16或32）
+    void setChannelCount(int count);
+    int getChannelCount() const;
+    
+    // 获取指定通道
+    DOChannel* getChannel(int channelNumber);
+    
+    // 设置位变量
+    void setBitVariable(int channelNumber, int bitNumber, const DOBitVariable &variable);
+    DOBitVariable getBitVariable(int channelNumber, int bitNumber) const;
+    
+    // 位的值与名称、描述分开保存，全部位紧凑存放在一个位平面中
+    bool bitValue(int channelNumber, int bitNumber) const;
+    const BitPlane &values() const;
+    // 写入监控或仿真得到的实时值，只在有位变化时发出 valuesChanged()，
+    // 不发出 dataChanged()，也不视为配置修改
+    void setValues(const BitPlane &values);
+    
+    // 保存和加载配置
+    void saveConfiguration(const QString &filePath);
+    void loadConfiguration(const QString &filePath);
+    
+    // 与项目文件中保存的配置段相互转换
+    QJsonObject toJson() const;
+    void fromJson(const QJsonObject &rootObj);
+    
+signals:
+    void dataChanged();
+    // 以下范围通知在 dataChanged() 之前发出
+    void channelCountChanged(int count);
+    // firstChannel 到 lastChannel 之间有位变量被修改
+    void channelsChanged(int firstChannel, int lastChannel);
+    // 实时值变化，edges 为变化的位
+    void valuesChanged(const QVector<BitEdge> &edges);
+    
+private:
+    // 批量修改期间只记录有变化，结束时统一通知
+    void notifyChanged();
+    void notifyChannels(int firstChannel, int lastChannel);
+    void notifyChannelCount();
+    
+    int m_channelCount;  // 通道数量
+    QVector<DOChannel> m_channels; // 通道列表
+    BitPlane m_values;   // 全部位的值
+    int m_updateDepth;   // 批量修改嵌套层数
+    bool m_changedDuringUpdate; // 批量修改期间是否有变化
+    bool m_countChangedDuringUpdate; // 批量修改期间通道数量是否改变
+    int m_firstChangedChannel;  // 批量修改期间修改的通道范围，没有时为 -1
+    int m_lastChangedChannel;
+};
+
+#endif // DOMODULE_H
\ No newline at end of file
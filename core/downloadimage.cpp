@@ -0,0 +1,574 @@
+#include "downloadimage.h"
+#include "dimodule.h"
+#include "domodule.h"
+#include "hostmodule.h"
+#include "moduleregistry.h"
+#include <QCryptographicHash>
+#include <QHash>
+#include <QHostAddress>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+const char kMagic[4] = {'T', 'F', 'D', 'I'};
+const int kSectionCount = 7;
+const int kHeaderSize = 24;
+const int kSectionEntrySize = 16;
+
+const int kNetworkRecordSize = 32;
+const int kLoopRecordSize = 16;
+const int kLoopChannelRecordSize = 8;
+const int kLoopDeviceRecordSize = 32;
+const int kIoModuleRecordSize = 12;
+const int kIoBitRecordSize = 12;
+
+// 记录中的标志位
+const quint8 kDhcpFlag = 0x1;
+const quint8 kInitializedFlag = 0x1;
+const quint8 kMappingSupportedFlag = 0x2;
+const quint8 kGlobalFlag = 0x1;
+
+void appendUInt8(QByteArray &buffer, quint8 value) {
+  buffer.append(static_cast<char>(value));
+}
+
+void appendUInt16(QByteArray &buffer, quint16 value) {
+  uchar bytes[2];
+  qToLittleEndian<quint16>(value, bytes);
+  buffer.append(reinterpret_cast<const char *>(bytes), 2);
+}
+
+void appendUInt32(QByteArray &buffer, quint32 value) {
+  uchar bytes[4];
+  qToLittleEndian<quint32>(value, bytes);
+  buffer.append(reinterpret_cast<const char *>(bytes), 4);
+}
+
+void appendUInt64(QByteArray &buffer, quint64 value) {
+  uchar bytes[8];
+  qToLittleEndian<quint64>(value, bytes);
+  buffer.append(reinterpret_cast<const char *>(bytes), 8);
+}
+
+quint16 readUInt16(const char *data) {
+  return qFromLittleEndian<quint16>(reinterpret_cast<const uchar *>(data));
+}
+
+quint32 readUInt32(const char *data) {
+  return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(data));
+}
+
+quint64 readUInt64(const char *data) {
+  return qFromLittleEndian<quint64>(reinterpret_cast<const uchar *>(data));
+}
+
+int alignedSize(int size) { return (size + 3) & ~3; }
+
+quint16 clampUInt16(int value) {
+  return static_cast<quint16>(qBound(0, value, 0xffff));
+}
+
+// 编码时使用的字符串池，相同的字符串只保存一次
+class StringPool {
+public:
+  StringPool() : m_data(1, '\0') {}
+
+  quint32 intern(const QString &value) {
+    if (value.isEmpty()) {
+      return 0;
+    }
+    QHash<QString, quint32>::const_iterator it = m_offsets.constFind(value);
+    if (it != m_offsets.constEnd()) {
+      return it.value();
+    }
+    quint32 offset = static_cast<quint32>(m_data.size());
+    m_data.append(value.toUtf8());
+    m_data.append('\0');
+    m_offsets.insert(value, offset);
+    return offset;
+  }
+
+  const QByteArray &data() const { return m_data; }
+
+private:
+  QByteArray m_data;
+  QHash<QString, quint32> m_offsets;
+};
+
+// 解码时按偏移读取字符串池
+class StringReader {
+public:
+  explicit StringReader(const QByteArray &pool) : m_pool(pool) {}
+
+  bool read(quint32 offset, QString *value) const {
+    if (offset >= static_cast<quint32>(m_pool.size())) {
+      return false;
+    }
+    const char *begin = m_pool.constData() + offset;
+    const void *end = memchr(begin, '\0', m_pool.size() - offset);
+    if (!end) {
+      return false;
+    }
+    *value = QString::fromUtf8(begin, static_cast<const char *>(end) - begin);
+    return true;
+  }
+
+private:
+  const QByteArray &m_pool;
+};
+
+quint32 ipv4Address(const QString &text) {
+  QHostAddress address;
+  if (address.setAddress(text) &&
+      address.protocol() == QAbstractSocket::IPv4Protocol) {
+    return address.toIPv4Address();
+  }
+  return 0;
+}
+
+DownloadImageContent::Loop loopContent(const QString &name,
+                                       const LoopModule *module) {
+  DownloadImageContent::Loop loop;
+  loop.name = name;
+  loop.mode = static_cast<quint8>(module->getLoopMode());
+  loop.initialized = module->isInitialized();
+  loop.mappingSupported = module->isMappingSupported();
+
+  int channelCount = qBound(0, module->getChannelCount(), 0xffff);
+  loop.channels.resize(channelCount);
+  for (int channel = 0; channel < channelCount; ++channel) {
+    const LoopChannelDevices &devices = module->channelDevices(channel);
+    QVector<LoopDevice> &target = loop.channels[channel];
+    target.reserve(devices.size());
+    for (int row = 0; row < devices.size(); ++row) {
+      LoopDevice device = devices.device(row);
+      device.address = clampUInt16(device.address);
+      device.panelNumber = clampUInt16(device.panelNumber);
+      device.cardNumber = clampUInt16(device.cardNumber);
+      target.append(device);
+    }
+  }
+  return loop;
+}
+
+// DI 和 DO 模块的位变量结构相同
+template <typename Module>
+DownloadImageContent::IoModule ioContent(const QString &name,
+                                         const Module *module, bool isOutput) {
+  DownloadImageContent::IoModule ioModule;
+  ioModule.name = name;
+  ioModule.isOutput = isOutput;
+  ioModule.bits.reserve(module->getChannelCount() * 8);
+  for (int channel = 0; channel < module->getChannelCount(); ++channel) {
+    for (int bit = 0; bit < 8; ++bit) {
+      auto variable = module->getBitVariable(channel, bit);
+      DownloadImageContent::BitVariable target;
+      target.name = variable.name;
+      target.description = variable.description;
+      target.isGlobal = variable.isGlobal;
+      target.value = variable.value != 0 ? 1 : 0;
+      ioModule.bits.append(target);
+    }
+  }
+  return ioModule;
+}
+
+void addField(QCryptographicHash &hash, const QByteArray &data) {
+  QByteArray length;
+  appendUInt32(length, static_cast<quint32>(data.size()));
+  hash.addData(length);
+  hash.addData(data);
+}
+
+void setError(QString *errorString, const QString &message) {
+  if (errorString) {
+    *errorString = message;
+  }
+}
+
+// 段表中的一项，解码时使用
+struct Section {
+  quint32 offset;
+  quint32 size;
+};
+
+bool readRecords(const Section &section, int recordSize, int *count) {
+  if (section.size % recordSize != 0) {
+    return false;
+  }
+  *count = static_cast<int>(section.size / recordSize);
+  return true;
+}
+} // namespace
+
+DownloadImageSource DownloadImage::source(const ProjectTree &tree,
+                                          int hostNode) {
+  DownloadImageSource source;
+  source.hostId = tree.componentId(hostNode);
+  source.hostName = tree.name(hostNode);
+  source.hostConfig = tree.config(hostNode);
+
+  QVector<int> stack;
+  stack.append(hostNode);
+  while (!stack.isEmpty()) {
+    int node = stack.takeLast();
+    QString type = tree.type(node);
+    if (type == "LoopModule" || type == "DIModule" || type == "DOModule") {
+      DownloadImageSource::Component component;
+      component.type = type;
+      component.name = tree.name(node);
+      component.config = tree.config(node);
+      source.components.append(component);
+    } else if (type == "HostModule" && node != hostNode) {
+      continue;
+    }
+
+    // 逆序入栈，出栈顺序与项目树一致
+    QVector<int> children;
+    for (int child = tree.firstChild(node); child >= 0;
+         child = tree.nextSibling(child)) {
+      children.append(child);
+    }
+    for (int i = children.size() - 1; i >= 0; --i) {
+      stack.append(children.at(i));
+    }
+  }
+  return source;
+}
+
+QByteArray DownloadImage::contentHash(const DownloadImageSource &source) {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  QByteArray header;
+  appendUInt16(header, CurrentVersion);
+  appendUInt64(header, source.hostId);
+  hash.addData(header);
+  addField(hash, source.hostName.toUtf8());
+  addField(hash, source.hostConfig);
+  for (const DownloadImageSource::Component &component : source.components) {
+    addField(hash, component.type.toUtf8());
+    addField(hash, component.name.toUtf8());
+    addField(hash, component.config);
+  }
+  return hash.result();
+}
+
+DownloadImageContent DownloadImage::content(const DownloadImageSource &source) {
+  DownloadImageContent content;
+
+  QObject *module = ModuleRegistry::createModule(
+      "HostModule", source.hostConfig, source.hostName);
+  HostConfiguration config =
+      qobject_cast<HostModule *>(module)->getConfiguration();
+  delete module;
+
+  DownloadImageContent::Network &network = content.network;
+  network.componentId = source.hostId;
+  network.hostName = config.hostName;
+  network.description = config.description;
+  network.ipAddress = ipv4Address(config.ipAddress);
+  network.subnetMask = ipv4Address(config.subnetMask);
+  network.gateway = ipv4Address(config.gateway);
+  network.port = clampUInt16(config.port);
+  network.protocol = config.protocol == CommunicationProtocol::UDP ? 1 : 0;
+  network.dhcpEnabled = config.dhcpEnabled;
+
+  for (const DownloadImageSource::Component &component : source.components) {
+    module = ModuleRegistry::createModule(component.type, component.config,
+                                          component.name);
+    if (LoopModule *loopModule = qobject_cast<LoopModule *>(module)) {
+      content.loops.append(loopContent(component.name, loopModule));
+    } else if (DIModule *diModule = qobject_cast<DIModule *>(module)) {
+      content.ioModules.append(ioContent(component.name, diModule, false));
+    } else if (DOModule *doModule = qobject_cast<DOModule *>(module)) {
+      content.ioModules.append(ioContent(component.name, doModule, true));
+    }
+    delete module;
+  }
+  return content;
+}
+
+QByteArray DownloadImage::encode(const DownloadImageContent &content) {
+  StringPool strings;
+  QByteArray sections[kSectionCount];
+  QByteArray &network = sections[NetworkSection - 1];
+  QByteArray &loops = sections[LoopSection - 1];
+  QByteArray &channels = sections[LoopChannelSection - 1];
+  QByteArray &devices = sections[LoopDeviceSection - 1];
+  QByteArray &ioModules = sections[IoModuleSection - 1];
+  QByteArray &ioBits = sections[IoBitSection - 1];
+
+  const DownloadImageContent::Network &host = content.network;
+  appendUInt64(network, host.componentId);
+  appendUInt32(network, host.ipAddress);
+  appendUInt32(network, host.subnetMask);
+  appendUInt32(network, host.gateway);
+  appendUInt16(network, host.port);
+  appendUInt8(network, host.protocol);
+  appendUInt8(network, host.dhcpEnabled ? kDhcpFlag : 0);
+  appendUInt32(network, strings.intern(host.hostName));
+  appendUInt32(network, strings.intern(host.description));
+
+  quint32 channelIndex = 0;
+  quint32 deviceIndex = 0;
+  for (const DownloadImageContent::Loop &loop : content.loops) {
+    quint8 flags = (loop.initialized ? kInitializedFlag : 0) |
+                   (loop.mappingSupported ? kMappingSupportedFlag : 0);
+    appendUInt32(loops, strings.intern(loop.name));
+    appendUInt8(loops, loop.mode);
+    appendUInt8(loops, flags);
+    appendUInt16(loops, static_cast<quint16>(loop.channels.size()));
+    appendUInt32(loops, channelIndex);
+    appendUInt32(loops, 0);
+
+    for (const QVector<LoopDevice> &channel : loop.channels) {
+      appendUInt32(channels, deviceIndex);
+      appendUInt32(channels, static_cast<quint32>(channel.size()));
+      for (const LoopDevice &device : channel) {
+        appendUInt16(devices, clampUInt16(device.address));
+        appendUInt16(devices, clampUInt16(device.panelNumber));
+        appendUInt16(devices, clampUInt16(device.cardNumber));
+        appendUInt16(devices, 0);
+        appendUInt32(devices, strings.intern(device.type));
+        appendUInt32(devices, strings.intern(device.serialNumber));
+        appendUInt32(devices, strings.intern(device.personalityCode));
+        appendUInt32(devices, strings.intern(device.description));
+        appendUInt32(devices, strings.intern(device.identifier));
+        appendUInt32(devices, strings.intern(device.variableName));
+      }
+      deviceIndex += static_cast<quint32>(channel.size());
+    }
+    channelIndex += static_cast<quint32>(loop.channels.size());
+  }
+
+  quint32 bitIndex = 0;
+  for (const DownloadImageContent::IoModule &ioModule : content.ioModules) {
+    appendUInt32(ioModules, strings.intern(ioModule.name));
+    appendUInt8(ioModules, ioModule.isOutput ? 1 : 0);
+    appendUInt8(ioModules, 0);
+    appendUInt16(ioModules, static_cast<quint16>(ioModule.bits.size() / 8));
+    appendUInt32(ioModules, bitIndex);
+
+    for (const DownloadImageContent::BitVariable &bit : ioModule.bits) {
+      appendUInt32(ioBits, strings.intern(bit.name));
+      appendUInt32(ioBits, strings.intern(bit.description));
+      appendUInt8(ioBits, bit.isGlobal ? kGlobalFlag : 0);
+      appendUInt8(ioBits, bit.value);
+      appendUInt16(ioBits, 0);
+    }
+    bitIndex += static_cast<quint32>(ioModule.bits.size());
+  }
+  sections[StringSection - 1] = strings.data();
+
+  // 段表和各段的位置只取决于各段的长度
+  QByteArray table;
+  QByteArray body;
+  int offset = kHeaderSize + kSectionCount * kSectionEntrySize;
+  for (int i = 0; i < kSectionCount; ++i) {
+    const QByteArray &section = sections[i];
+    appendUInt32(table, static_cast<quint32>(i + 1));
+    appendUInt32(table, static_cast<quint32>(offset));
+    appendUInt32(table, static_cast<quint32>(section.size()));
+    appendUInt32(table, crc32(section.constData(), section.size()));
+
+    body.append(section);
+    body.append(alignedSize(section.size()) - section.size(), '\0');
+    offset += alignedSize(section.size());
+  }
+
+  QByteArray image;
+  image.reserve(offset);
+  image.append(kMagic, 4);
+  appendUInt16(image, CurrentVersion);
+  appendUInt16(image, kSectionCount);
+  appendUInt32(image, static_cast<quint32>(offset));
+  appendUInt32(image, crc32(table.constData(), table.size()));
+  appendUInt32(image, 0);
+  appendUInt32(image, crc32(image.constData(), image.size()));
+  image.append(table);
+  image.append(body);
+  return image;
+}
+
+bool DownloadImage::decode(const QByteArray &image,
+                           DownloadImageContent *content,
+                           QString *errorString) {
+  const char *data = image.constData();
+  if (image.size() < kHeaderSize || memcmp(data, kMagic, 4) != 0) {
+    setError(errorString, "不是有效的下载镜像");
+    return false;
+  }
+  quint16 version = readUInt16(data + 4);
+  if (version != CurrentVersion) {
+    setError(errorString, QString("不支持的镜像版本: %1").arg(version));
+    return false;
+  }
+  if (readUInt32(data + 20) != crc32(data, 20)) {
+    setError(errorString, "镜像已损坏: 文件头校验失败");
+    return false;
+  }
+  quint16 sectionCount = readUInt16(data + 6);
+  int tableSize = sectionCount * kSectionEntrySize;
+  if (readUInt32(data + 8) != static_cast<quint32>(image.size()) ||
+      sectionCount != kSectionCount || image.size() < kHeaderSize + tableSize) {
+    setError(errorString, "镜像已损坏: 长度不符");
+    return false;
+  }
+  if (readUInt32(data + 12) != crc32(data + kHeaderSize, tableSize)) {
+    setError(errorString, "镜像已损坏: 段表校验失败");
+    return false;
+  }
+
+  Section sections[kSectionCount];
+  for (int i = 0; i < kSectionCount; ++i) {
+    const char *entry = data + kHeaderSize + i * kSectionEntrySize;
+    Section &section = sections[i];
+    section.offset = readUInt32(entry + 4);
+    section.size = readUInt32(entry + 8);
+    if (readUInt32(entry) != static_cast<quint32>(i + 1) ||
+        section.offset % 4 != 0 ||
+        section.offset > static_cast<quint32>(image.size()) ||
+        section.size > image.size() - section.offset) {
+      setError(errorString, QString("镜像已损坏: 段 %1 越界").arg(i + 1));
+      return false;
+    }
+    if (readUInt32(entry + 12) !=
+        crc32(data + section.offset, static_cast<int>(section.size))) {
+      setError(errorString, QString("镜像已损坏: 段 %1 校验失败").arg(i + 1));
+      return false;
+    }
+  }
+
+  int loopCount = 0;
+  int channelCount = 0;
+  int deviceCount = 0;
+  int ioModuleCount = 0;
+  int bitCount = 0;
+  const Section &stringSection = sections[StringSection - 1];
+  if (sections[NetworkSection - 1].size != kNetworkRecordSize ||
+      stringSection.size == 0 ||
+      data[stringSection.offset + stringSection.size - 1] != '\0' ||
+      !readRecords(sections[LoopSection - 1], kLoopRecordSize, &loopCount) ||
+      !readRecords(sections[LoopChannelSection - 1], kLoopChannelRecordSize,
+                   &channelCount) ||
+      !readRecords(sections[LoopDeviceSection - 1], kLoopDeviceRecordSize,
+                   &deviceCount) ||
+      !readRecords(sections[IoModuleSection - 1], kIoModuleRecordSize,
+                   &ioModuleCount) ||
+      !readRecords(sections[IoBitSection - 1], kIoBitRecordSize, &bitCount)) {
+    setError(errorString, "镜像已损坏: 记录长度不符");
+    return false;
+  }
+
+  QByteArray pool = QByteArray::fromRawData(
+      data + stringSection.offset, static_cast<int>(stringSection.size));
+  StringReader strings(pool);
+  bool ok = true;
+  DownloadImageContent result;
+
+  const char *record = data + sections[NetworkSection - 1].offset;
+  DownloadImageContent::Network &network = result.network;
+  network.componentId = readUInt64(record);
+  network.ipAddress = readUInt32(record + 8);
+  network.subnetMask = readUInt32(record + 12);
+  network.gateway = readUInt32(record + 16);
+  network.port = readUInt16(record + 20);
+  network.protocol = static_cast<quint8>(record[22]);
+  network.dhcpEnabled = (static_cast<quint8>(record[23]) & kDhcpFlag) != 0;
+  ok = strings.read(readUInt32(record + 24), &network.hostName) &&
+       strings.read(readUInt32(record + 28), &network.description);
+
+  const char *loops = data + sections[LoopSection - 1].offset;
+  const char *channels = data + sections[LoopChannelSection - 1].offset;
+  const char *devices = data + sections[LoopDeviceSection - 1].offset;
+  result.loops.resize(loopCount);
+  for (int i = 0; ok && i < loopCount; ++i) {
+    record = loops + i * kLoopRecordSize;
+    DownloadImageContent::Loop &loop = result.loops[i];
+    quint8 flags = static_cast<quint8>(record[5]);
+    loop.mode = static_cast<quint8>(record[4]);
+    loop.initialized = (flags & kInitializedFlag) != 0;
+    loop.mappingSupported = (flags & kMappingSupportedFlag) != 0;
+    quint32 loopChannels = readUInt16(record + 6);
+    quint32 firstChannel = readUInt32(record + 8);
+    ok = strings.read(readUInt32(record), &loop.name) &&
+         firstChannel <= static_cast<quint32>(channelCount) &&
+         loopChannels <= channelCount - firstChannel;
+
+    loop.channels.resize(ok ? static_cast<int>(loopChannels) : 0);
+    for (int c = 0; ok && c < loop.channels.size(); ++c) {
+      record = channels + (firstChannel + c) * kLoopChannelRecordSize;
+      quint32 firstDevice = readUInt32(record);
+      quint32 count = readUInt32(record + 4);
+      ok = firstDevice <= static_cast<quint32>(deviceCount) &&
+           count <= deviceCount - firstDevice;
+
+      QVector<LoopDevice> &target = loop.channels[c];
+      target.resize(ok ? static_cast<int>(count) : 0);
+      for (int d = 0; ok && d < target.size(); ++d) {
+        record = devices + (firstDevice + d) * kLoopDeviceRecordSize;
+        LoopDevice &device = target[d];
+        device.address = readUInt16(record);
+        device.panelNumber = readUInt16(record + 2);
+        device.cardNumber = readUInt16(record + 4);
+        ok = strings.read(readUInt32(record + 8), &device.type) &&
+             strings.read(readUInt32(record + 12), &device.serialNumber) &&
+             strings.read(readUInt32(record + 16), &device.personalityCode) &&
+             strings.read(readUInt32(record + 20), &device.description) &&
+             strings.read(readUInt32(record + 24), &device.identifier) &&
+             strings.read(readUInt32(record + 28), &device.variableName);
+      }
+    }
+  }
+
+  const char *ioModules = data + sections[IoModuleSection - 1].offset;
+  const char *bits = data + sections[IoBitSection - 1].offset;
+  result.ioModules.resize(ok ? ioModuleCount : 0);
+  for (int i = 0; ok && i < ioModuleCount; ++i) {
+    record = ioModules + i * kIoModuleRecordSize;
+    DownloadImageContent::IoModule &ioModule = result.ioModules[i];
+    ioModule.isOutput = record[4] != 0;
+    quint32 moduleBits = readUInt16(record + 6) * 8u;
+    quint32 firstBit = readUInt32(record + 8);
+    ok = strings.read(readUInt32(record), &ioModule.name) &&
+         firstBit <= static_cast<quint32>(bitCount) &&
+         moduleBits <= bitCount - firstBit;
+
+    ioModule.bits.resize(ok ? static_cast<int>(moduleBits) : 0);
+    for (int b = 0; ok && b < ioModule.bits.size(); ++b) {
+      record = bits + (firstBit + b) * kIoBitRecordSize;
+      DownloadImageContent::BitVariable &bit = ioModule.bits[b];
+      bit.isGlobal = (static_cast<quint8>(record[8]) & kGlobalFlag) != 0;
+      bit.value = static_cast<quint8>(record[9]);
+      ok = strings.read(readUInt32(record), &bit.name) &&
+           strings.read(readUInt32(record + 4), &bit.description);
+    }
+  }
+
+  if (!ok) {
+    setError(errorString, "镜像已损坏: 记录引用越界");
+    return false;
+  }
+  *content = result;
+  return true;
+}
+
+quint32 DownloadImage::crc32(const char *data, int size) {
+  // 按字节查表，表在首次使用时生成
+  static const QVector<quint32> table = [] {
+    QVector<quint32> values(256);
+    for (quint32 i = 0; i < 256; ++i) {
+      quint32 value = i;
+      for (int bit = 0; bit < 8; ++bit) {
+        value = (value & 1) ? (value >> 1) ^ 0xedb88320u : value >> 1;
+      }
+      values[static_cast<int>(i)] = value;
+    }
+    return values;
+  }();
+
+  quint32 crc = 0xffffffffu;
+  for (int i = 0; i < size; ++i) {
+    crc = table.at((crc ^ static_cast<uchar>(data[i])) & 0xff) ^ (crc >> 8);
+  }
+  return crc ^ 0xffffffffu;
+}
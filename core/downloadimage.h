@@ -0,0 +1,111 @@
+#ifndef DOWNLOADIMAGE_H
+#define DOWNLOADIMAGE_H
+
+#include "loopmodule.h"
+#include "projecttree.h"
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// 主机子树的快照：主机和下属模块的类型、名称和配置段，可在工作线程中编译
+struct DownloadImageSource {
+  struct Component {
+    QString type;
+    QString name;
+    QByteArray config;
+  };
+
+  quint64 hostId;
+  QString hostName;
+  QByteArray hostConfig;
+  QVector<Component> components; // 回路、DI 和 DO 模块，按先序排列
+};
+
+// 下载镜像中的内容，字段与镜像中的定长记录一一对应
+struct DownloadImageContent {
+  struct Network {
+    quint64 componentId;
+    QString hostName;
+    QString description;
+    quint32 ipAddress; // IPv4 地址，无效地址为 0
+    quint32 subnetMask;
+    quint32 gateway;
+    quint16 port;
+    quint8 protocol; // 0 为 TCP，1 为 UDP
+    bool dhcpEnabled;
+  };
+
+  struct Loop {
+    QString name;
+    quint8 mode; // LoopMode 的值
+    bool initialized;
+    bool mappingSupported;
+    // 每个通道的设备，地址、盘号和卡号为 0 到 65535
+    QVector<QVector<LoopDevice>> channels;
+  };
+
+  struct BitVariable {
+    QString name;
+    QString description;
+    bool isGlobal;
+    quint8 value;
+  };
+
+  struct IoModule {
+    QString name;
+    bool isOutput; // DO 模块为 true
+    QVector<BitVariable> bits; // 每个通道 8 位，按通道顺序排列
+  };
+
+  Network network;
+  QVector<Loop> loops;
+  QVector<IoModule> ioModules;
+};
+
+// 控制器下载镜像
+//
+// 每个主机子树编译为一个确定的定长布局镜像，相同的配置总是得到逐字节
+// 相同的结果。所有整数为小端序，各段按 4 字节对齐，不足补零：
+//
+//   文件头     magic "TFDI", version, sectionCount, imageSize,
+//              sectionTableCrc, reserved, headerCrc (24 字节)
+//   段表       每段 {type, offset, size, crc}，共 sectionCount 项
+//   Network      主机网络配置，一条 32 字节记录
+//   Strings      UTF-8 字符串池，以 '\0' 结尾，偏移 0 为空字符串
+//   Loops        {name, mode, flags, channelCount, firstChannel, reserved}
+//   LoopChannels {firstDevice, deviceCount}
+//   LoopDevices  {address, panel, card, reserved, 6 个字符串偏移}
+//   IoModules    {name, kind, reserved, channelCount, firstBit}
+//   IoBits       {name, description, flags, value, reserved}
+//
+// 记录中的字符串字段均为字符串池中的偏移。CRC 为 CRC-32 (IEEE 802.3)。
+class DownloadImage {
+public:
+  static const quint16 CurrentVersion = 1;
+
+  enum SectionType {
+    NetworkSection = 1,
+    StringSection,
+    LoopSection,
+    LoopChannelSection,
+    LoopDeviceSection,
+    IoModuleSection,
+    IoBitSection
+  };
+
+  // 记录主机子树的快照，其中嵌套的主机子树不属于该主机
+  static DownloadImageSource source(const ProjectTree &tree, int hostNode);
+  // 快照内容的哈希值，内容相同时镜像相同
+  static QByteArray contentHash(const DownloadImageSource &source);
+
+  // 解析快照中的配置段，可在工作线程中调用
+  static DownloadImageContent content(const DownloadImageSource &source);
+  static QByteArray encode(const DownloadImageContent &content);
+  // 校验文件头、段表和各段的 CRC 以及记录之间的引用，失败时返回 false
+  static bool decode(const QByteArray &image, DownloadImageContent *content,
+                     QString *errorString = nullptr);
+
+  static quint32 crc32(const char *data, int size);
+};
+
+#endif // DOWNLOADIMAGE_H
@@ -0,0 +1,87 @@
+#include "downloadimagecompiler.h"
+#include <QtConcurrent>
+
+namespace {
+QByteArray compileSource(const DownloadImageSource &source) {
+  return DownloadImage::encode(DownloadImage::content(source));
+}
+
+// 按先序列出全部主机节点，主机下不再查找嵌套的主机
+QVector<int> hostNodes(const ProjectTree &tree) {
+  QVector<int> hosts;
+  QVector<int> stack;
+  if (!tree.isEmpty()) {
+    stack.append(tree.rootNode());
+  }
+  while (!stack.isEmpty()) {
+    int node = stack.takeLast();
+    if (tree.type(node) == "HostModule") {
+      hosts.append(node);
+      continue;
+    }
+    QVector<int> children;
+    for (int child = tree.firstChild(node); child >= 0;
+         child = tree.nextSibling(child)) {
+      children.append(child);
+    }
+    for (int i = children.size() - 1; i >= 0; --i) {
+      stack.append(children.at(i));
+    }
+  }
+  return hosts;
+}
+} // namespace
+
+DownloadImageCompiler::DownloadImageCompiler() : m_rebuiltCount(0) {}
+
+QVector<HostImage> DownloadImageCompiler::compile(const ProjectTree &tree) {
+  QVector<HostImage> images;
+  QVector<DownloadImageSource> sources;
+  QVector<int> rebuildPositions;
+  QHash<quint64, CacheEntry> cache;
+
+  for (int node : hostNodes(tree)) {
+    DownloadImageSource source = DownloadImage::source(tree, node);
+    QByteArray hash = DownloadImage::contentHash(source);
+
+    HostImage image;
+    image.hostId = source.hostId;
+    image.hostName = source.hostName;
+    image.rebuilt = false;
+
+    QHash<quint64, CacheEntry>::const_iterator it =
+        m_cache.constFind(source.hostId);
+    if (it != m_cache.constEnd() && it->contentHash == hash) {
+      image.image = it->image;
+    } else {
+      image.rebuilt = true;
+      rebuildPositions.append(images.size());
+      sources.append(source);
+    }
+    CacheEntry &entry = cache[source.hostId];
+    entry.contentHash = hash;
+    entry.image = image.image;
+    images.append(image);
+  }
+
+  QList<QByteArray> rebuilt =
+      QtConcurrent::blockingMapped<QList<QByteArray>>(sources, compileSource);
+  for (int i = 0; i < rebuilt.size(); ++i) {
+    HostImage &image = images[rebuildPositions.at(i)];
+    image.image = rebuilt.at(i);
+    cache[image.hostId].image = image.image;
+  }
+
+  m_cache = cache;
+  m_rebuiltCount = rebuilt.size();
+  return images;
+}
+
+int DownloadImageCompiler::rebuiltCount() const { return m_rebuiltCount; }
+
+int DownloadImageCompiler::cachedCount() const { return m_cache.size(); }
+
+void DownloadImageCompiler::clear() {
+  m_cache.clear();
+  m_rebuiltCount = 0;
+}
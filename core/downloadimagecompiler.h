@@ -0,0 +1,47 @@
+#ifndef DOWNLOADIMAGECOMPILER_H
+#define DOWNLOADIMAGECOMPILER_H
+
+#include "downloadimage.h"
+#include "projecttree.h"
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// 一个主机的下载镜像
+struct HostImage {
+  quint64 hostId;
+  QString hostName;
+  QByteArray image;
+  bool rebuilt; // 本次编译重新生成，而不是取自缓存
+};
+
+// 下载镜像编译器
+//
+// 按主机的组件编号缓存镜像和主机子树的内容哈希。每次编译只在主线程中
+// 记录各主机子树的快照并计算哈希，内容变化的主机在全局线程池中并行重新
+// 生成，其余主机直接使用缓存的镜像。项目中已不存在的主机从缓存中移除。
+class DownloadImageCompiler {
+public:
+  DownloadImageCompiler();
+
+  // 编译项目中的全部主机，按项目树中的先序排列。界面中已修改的模块
+  // 应先写回项目树。
+  QVector<HostImage> compile(const ProjectTree &tree);
+
+  // 最近一次编译中重新生成的镜像数
+  int rebuiltCount() const;
+  int cachedCount() const;
+  void clear();
+
+private:
+  struct CacheEntry {
+    QByteArray contentHash;
+    QByteArray image;
+  };
+
+  QHash<quint64, CacheEntry> m_cache;
+  int m_rebuiltCount;
+};
+
+#endif // DOWNLOADIMAGECOMPILER_H
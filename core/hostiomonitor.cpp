@@ -0,0 +1,189 @@
+#include "hostiomonitor.h"
+#include "bitplane.h"
+#include "dimodule.h"
+#include "domodule.h"
+
+HostIoMonitor::HostIoMonitor(QObject *parent)
+    : QObject(parent), m_port(502), m_nextInputAddress(0),
+      m_nextCoilAddress(0), m_completedPolls(0), m_skippedPolls(0),
+      m_lastPollTime(0) {
+  m_pollTimer.setInterval(200);
+  connect(&m_pollTimer, &QTimer::timeout, this, &HostIoMonitor::poll);
+  connect(&m_client, &ModbusTcpClient::readFinished, this,
+          &HostIoMonitor::onReadFinished);
+  connect(&m_client, &ModbusTcpClient::requestFailed, this,
+          &HostIoMonitor::onRequestFailed);
+  connect(&m_client, &ModbusTcpClient::errorOccurred, this,
+          &HostIoMonitor::errorOccurred);
+  // 连接建立后立即轮询一次，不等下一个周期
+  connect(&m_client, &ModbusTcpClient::connected, this, &HostIoMonitor::poll);
+}
+
+HostIoMonitor::~HostIoMonitor() { stop(); }
+
+bool HostIoMonitor::addModule(QObject *module) {
+  Binding binding;
+  binding.module = module;
+  if (DIModule *diModule = qobject_cast<DIModule *>(module)) {
+    binding.function = ModbusTcpClient::ReadDiscreteInputs;
+    binding.address = m_nextInputAddress;
+    binding.count = diModule->getChannelCount() * BitPlane::BitsPerChannel;
+    m_nextInputAddress += binding.count;
+  } else if (DOModule *doModule = qobject_cast<DOModule *>(module)) {
+    binding.function = ModbusTcpClient::ReadCoils;
+    binding.address = m_nextCoilAddress;
+    binding.count = doModule->getChannelCount() * BitPlane::BitsPerChannel;
+    m_nextCoilAddress += binding.count;
+  } else {
+    return false;
+  }
+  m_bindings.append(binding);
+
+  QVector<ModbusTcpClient::ReadRange> ranges;
+  for (const Binding &existing : m_bindings) {
+    ModbusTcpClient::ReadRange range;
+    range.function = existing.function;
+    range.address = existing.address;
+    range.count = existing.count;
+    ranges.append(range);
+  }
+  m_requests = ModbusTcpClient::mergeReads(ranges);
+  return true;
+}
+
+int HostIoMonitor::moduleCount() const { return m_bindings.size(); }
+
+QString HostIoMonitor::host() const { return m_host; }
+
+quint16 HostIoMonitor::port() const { return m_port; }
+
+void HostIoMonitor::setEndpoint(const QString &host, quint16 port) {
+  m_host = host;
+  m_port = port;
+  if (isRunning()) {
+    m_outstanding.clear();
+    m_client.connectToHost(m_host, m_port);
+  }
+}
+
+int HostIoMonitor::pollInterval() const { return m_pollTimer.interval(); }
+
+void HostIoMonitor::setPollInterval(int milliseconds) {
+  m_pollTimer.setInterval(qMax(1, milliseconds));
+}
+
+ModbusTcpClient *HostIoMonitor::client() { return &m_client; }
+
+void HostIoMonitor::start() {
+  if (isRunning()) {
+    return;
+  }
+  m_pollTimer.start();
+  m_client.connectToHost(m_host, m_port);
+}
+
+void HostIoMonitor::stop() {
+  m_pollTimer.stop();
+  m_outstanding.clear();
+  m_client.disconnectFromHost();
+}
+
+bool HostIoMonitor::isRunning() const { return m_pollTimer.isActive(); }
+
+int HostIoMonitor::completedPolls() const { return m_completedPolls; }
+
+int HostIoMonitor::skippedPolls() const { return m_skippedPolls; }
+
+int HostIoMonitor::lastPollTime() const { return m_lastPollTime; }
+
+void HostIoMonitor::poll() {
+  if (!isRunning()) {
+    return;
+  }
+  if (m_client.state() == QAbstractSocket::UnconnectedState) {
+    m_client.connectToHost(m_host, m_port);
+    return;
+  }
+  if (!m_client.isConnected() || m_requests.isEmpty()) {
+    return;
+  }
+  if (!m_outstanding.isEmpty()) {
+    ++m_skippedPolls;
+    return;
+  }
+
+  m_pollClock.start();
+  m_results = QVector<QVector<quint16>>(m_requests.size());
+  for (int i = 0; i < m_requests.size(); ++i) {
+    m_outstanding.insert(m_client.read(m_requests.at(i)), i);
+  }
+}
+
+void HostIoMonitor::onReadFinished(quint16 transactionId,
+                                   const ModbusTcpClient::ReadRange &range,
+                                   const QVector<quint16> &values) {
+  Q_UNUSED(range);
+  QHash<quint16, int>::iterator it = m_outstanding.find(transactionId);
+  if (it == m_outstanding.end()) {
+    return;
+  }
+  m_results[it.value()] = values;
+  m_outstanding.erase(it);
+  if (m_outstanding.isEmpty()) {
+    finishPoll();
+  }
+}
+
+void HostIoMonitor::onRequestFailed(quint16 transactionId,
+                                    const QString &errorString) {
+  if (m_outstanding.remove(transactionId) == 0) {
+    return;
+  }
+  emit errorOccurred(errorString);
+  // 失败的请求没有结果，对应的模块保持原值
+  if (m_outstanding.isEmpty()) {
+    finishPoll();
+  }
+}
+
+void HostIoMonitor::finishPoll() {
+  for (const Binding &binding : m_bindings) {
+    if (!binding.module) {
+      continue;
+    }
+
+    // 模块的地址段完整地落在某个合并后的请求内
+    const QVector<quint16> *values = nullptr;
+    int offset = 0;
+    for (int i = 0; i < m_requests.size(); ++i) {
+      const ModbusTcpClient::ReadRange &request = m_requests.at(i);
+      if (request.function == binding.function &&
+          binding.address >= request.address &&
+          binding.address + binding.count <=
+              request.address + request.count) {
+        values = &m_results.at(i);
+        offset = binding.address - request.address;
+        break;
+      }
+    }
+    if (!values || values->size() < offset + binding.count) {
+      continue;
+    }
+
+    BitPlane plane;
+    for (int i = 0; i < binding.count; ++i) {
+      plane.setBit(i / BitPlane::BitsPerChannel, i % BitPlane::BitsPerChannel,
+                   values->at(offset + i) != 0);
+    }
+    if (DIModule *diModule = qobject_cast<DIModule *>(binding.module)) {
+      diModule->setValues(plane);
+    } else if (DOModule *doModule = qobject_cast<DOModule *>(binding.module)) {
+      doModule->setValues(plane);
+    }
+  }
+
+  m_results.clear();
+  m_lastPollTime = static_cast<int>(m_pollClock.elapsed());
+  ++m_completedPolls;
+  emit pollFinished(m_lastPollTime);
+}
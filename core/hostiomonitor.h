@@ -0,0 +1,93 @@
+#ifndef HOSTIOMONITOR_H
+#define HOSTIOMONITOR_H
+
+#include "modbustcpclient.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+// 主机 DI/DO 实时值监控
+//
+// 按固定周期通过 Modbus/TCP 读取主机下 DI 模块的离散输入和 DO 模块的线圈，
+// 读到的值写入模块的位平面(setValues)，由模块报告变化的位。模块按添加顺序
+// 连续编址，每个模块占用 "通道数 * 8" 个地址；相邻模块的读取合并为尽量少的
+// 请求，一次轮询的全部请求同时在途。上一次轮询未完成时跳过本次轮询，连接
+// 断开后在下一次轮询时重连。
+class HostIoMonitor : public QObject {
+  Q_OBJECT
+
+public:
+  explicit HostIoMonitor(QObject *parent = nullptr);
+  ~HostIoMonitor();
+
+  // 添加 DIModule 或 DOModule，地址按模块当前的通道数分配。其他类型的
+  // 对象返回 false。
+  bool addModule(QObject *module);
+  int moduleCount() const;
+
+  QString host() const;
+  quint16 port() const;
+  void setEndpoint(const QString &host, quint16 port = 502);
+
+  int pollInterval() const;
+  void setPollInterval(int milliseconds);
+
+  ModbusTcpClient *client();
+
+  void start();
+  void stop();
+  bool isRunning() const;
+
+  // 统计：完成的轮询数、因上一次未完成而跳过的轮询数、最近一次轮询的耗时
+  int completedPolls() const;
+  int skippedPolls() const;
+  int lastPollTime() const;
+
+signals:
+  void pollFinished(int elapsedMilliseconds);
+  void errorOccurred(const QString &errorString);
+
+private slots:
+  void poll();
+  void onReadFinished(quint16 transactionId,
+                      const ModbusTcpClient::ReadRange &range,
+                      const QVector<quint16> &values);
+  void onRequestFailed(quint16 transactionId, const QString &errorString);
+
+private:
+  // 一个模块占用的地址段
+  struct Binding {
+    QPointer<QObject> module;
+    ModbusTcpClient::FunctionCode function;
+    int address;
+    int count;
+  };
+
+  void finishPoll();
+
+  ModbusTcpClient m_client;
+  QTimer m_pollTimer;
+  QString m_host;
+  quint16 m_port;
+
+  QVector<Binding> m_bindings;
+  int m_nextInputAddress;
+  int m_nextCoilAddress;
+  // 合并后的请求，添加模块后重新计算
+  QVector<ModbusTcpClient::ReadRange> m_requests;
+
+  // 当前轮询中在途的请求(事务编号 -> 请求下标)和已收到的结果
+  QHash<quint16, int> m_outstanding;
+  QVector<QVector<quint16>> m_results;
+  QElapsedTimer m_pollClock;
+
+  int m_completedPolls;
+  int m_skippedPolls;
+  int m_lastPollTime;
+};
+
+#endif // HOSTIOMONITOR_H
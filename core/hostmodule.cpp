@@ -26,6 +26,7 @@ HostConfiguration HostModule::getConfiguration() const
 void HostModule::setConfiguration(const HostConfiguration &config)
 {
     m_configuration = config;
+    emit dataChanged();
 }
 
 bool HostModule::isValidIPAddress(const QString &ip) const
@@ -41,20 +42,8 @@ bool HostModule::isValidPort(int port) const
 
 void HostModule::saveConfiguration(const QString &filePath)
 {
-    QJsonObject rootObj;
-    
-    // 保存主机配置
-    rootObj["hostName"] = m_configuration.hostName;
-    rootObj["ipAddress"] = m_configuration.ipAddress;
-    rootObj["port"] = m_configuration.port;
-    rootObj["protocol"] = (m_configuration.protocol == CommunicationProtocol::TCP) ? "TCP" : "UDP";
-    rootObj["subnetMask"] = m_configuration.subnetMask;
-    rootObj["gateway"] = m_configuration.gateway;
-    rootObj["description"] = m_configuration.description;
-    rootObj["dhcpEnabled"] = m_configuration.dhcpEnabled;
-    
     // 保存到文件
-    QJsonDocument doc(rootObj);
+    QJsonDocument doc(toJson());
     QFile file(filePath);
     if (file.open(QIODevice::WriteOnly)) {
         file.write(doc.toJson());
@@ -77,8 +66,28 @@ void HostModule::loadConfiguration(const QString &filePath)
         return;
     }
     
-    QJsonObject rootObj = doc.object();
+    fromJson(doc.object());
+}
+
+QJsonObject HostModule::toJson() const
+{
+    QJsonObject rootObj;
+    
+    // 保存主机配置
+    rootObj["hostName"] = m_configuration.hostName;
+    rootObj["ipAddress"] = m_configuration.ipAddress;
+    rootObj["port"] = m_configuration.port;
+    rootObj["protocol"] = (m_configuration.protocol == CommunicationProtocol::TCP) ? "TCP" : "UDP";
+    rootObj["subnetMask"] = m_configuration.subnetMask;
+    rootObj["gateway"] = m_configuration.gateway;
+    rootObj["description"] = m_configuration.description;
+    rootObj["dhcpEnabled"] = m_configuration.dhcpEnabled;
     
+    return rootObj;
+}
+
+void HostModule::fromJson(const QJsonObject &rootObj)
+{
     // 读取主机配置
     if (rootObj.contains("hostName")) {
         m_configuration.hostName = rootObj["hostName"].toString();
@@ -105,12 +114,12 @@ void HostModule::loadConfiguration(const QString &filePath)
     if (rootObj.contains("dhcpEnabled")) {
         m_configuration.dhcpEnabled = rootObj["dhcpEnabled"].toBool();
     }
+    
+    emit dataChanged();
 }
 
 bool HostModule::testConnection() const
 {
-    // 这里可以实现实际的网络连接测试
-    // 暂时返回true作为示例
     return isValidIPAddress(m_configuration.ipAddress) && isValidPort(m_configuration.port);
 }
 
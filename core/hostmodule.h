@@ -1,6 +1,7 @@
 #ifndef HOSTMODULE_H
 #define HOSTMODULE_H
 
+#include <QJsonObject>
 #include <QObject>
 #include <QString>
  #include <QHostAddress>
@@ -57,7 +58,12 @@ public:
     void saveConfiguration(const QString &filePath);
     void loadConfiguration(const QString &filePath);
     
-    // 测试网络连接
+    // 与项目文件中保存的配置段相互转换
+    QJsonObject toJson() const;
+    void fromJson(const QJsonObject &rootObj);
+    
+    // 只检查地址和端口是否有效，不访问网络。实际的连接测试由 HostProber
+    // 异步进行，不阻塞界面线程
     bool testConnection() const;
     
     // Add these new methods
@@ -66,6 +72,9 @@ public:
     void saveConfiguration();
     void loadConfiguration();
     
+signals:
+    void dataChanged();
+    
 private:
     HostConfiguration m_configuration;
     QString m_componentId;  // Add this member variable
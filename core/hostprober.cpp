@@ -0,0 +1,210 @@
+#include "hostprober.h"
+#include <QTcpSocket>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// 检查超时的间隔
+const int kTimeoutInterval = 20;
+} // namespace
+
+HostProber::HostProber(QObject *parent)
+    : QObject(parent), m_nextTarget(0), m_finishedCount(0), m_timeout(2000),
+      m_maxConcurrent(256) {
+  m_timeoutTimer.setInterval(kTimeoutInterval);
+  connect(&m_timeoutTimer, &QTimer::timeout, this,
+          &HostProber::checkTimeouts);
+}
+
+HostProber::~HostProber() { cancel(); }
+
+int HostProber::timeout() const { return m_timeout; }
+
+void HostProber::setTimeout(int milliseconds) {
+  m_timeout = qMax(1, milliseconds);
+}
+
+int HostProber::maxConcurrent() const { return m_maxConcurrent; }
+
+void HostProber::setMaxConcurrent(int count) {
+  m_maxConcurrent = qMax(1, count);
+}
+
+void HostProber::start(const QVector<Target> &targets) {
+  cancel();
+  m_targets = targets;
+  m_results.clear();
+  m_results.reserve(targets.size());
+  for (const Target &target : targets) {
+    Result result;
+    result.hostId = target.hostId;
+    result.status = Pending;
+    result.latency = 0;
+    m_results.append(result);
+  }
+  m_nextTarget = 0;
+  m_finishedCount = 0;
+  m_clock.start();
+
+  if (m_targets.isEmpty()) {
+    emit finished();
+    return;
+  }
+  m_timeoutTimer.start();
+  startPending();
+}
+
+void HostProber::cancel() {
+  m_timeoutTimer.stop();
+  QList<QTcpSocket *> sockets = m_active.keys();
+  m_active.clear();
+  for (QTcpSocket *socket : sockets) {
+    closeSocket(socket);
+  }
+  m_nextTarget = m_targets.size();
+}
+
+bool HostProber::isRunning() const { return m_timeoutTimer.isActive(); }
+
+const QVector<HostProber::Result> &HostProber::results() const {
+  return m_results;
+}
+
+int HostProber::finishedCount() const { return m_finishedCount; }
+
+HostProber::LatencySummary HostProber::summary() const {
+  QVector<double> latencies;
+  for (const Result &result : m_results) {
+    if (result.status == Reachable) {
+      latencies.append(result.latency);
+    }
+  }
+  return summarize(latencies);
+}
+
+HostProber::LatencySummary HostProber::summarize(QVector<double> latencies) {
+  LatencySummary summary;
+  summary.count = latencies.size();
+  summary.minimum = 0;
+  summary.median = 0;
+  summary.p99 = 0;
+  if (latencies.isEmpty()) {
+    return summary;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  summary.minimum = latencies.first();
+  summary.median = latencies.at(latencies.size() / 2);
+  // 最近秩法：不小于 99% 样本的最小值
+  int rank = static_cast<int>(std::ceil(latencies.size() * 0.99));
+  summary.p99 = latencies.at(qMax(1, rank) - 1);
+  return summary;
+}
+
+QString HostProber::statusText(Status status) {
+  switch (status) {
+  case Pending:
+    return "等待探测";
+  case Connecting:
+    return "正在连接";
+  case Reachable:
+    return "可达";
+  case Refused:
+    return "拒绝连接";
+  case Unreachable:
+    return "不可达";
+  case TimedOut:
+    return "超时";
+  }
+  return QString();
+}
+
+void HostProber::startPending() {
+  while (m_active.size() < m_maxConcurrent &&
+         m_nextTarget < m_targets.size()) {
+    int index = m_nextTarget++;
+    Target target = m_targets.at(index);
+
+    QTcpSocket *socket = new QTcpSocket(this);
+    Probe probe;
+    probe.index = index;
+    probe.start = m_clock.nsecsElapsed();
+    m_active.insert(socket, probe);
+    m_results[index].status = Connecting;
+
+    connect(socket, &QTcpSocket::connected, this, [this, socket]() {
+      finishProbe(socket, Reachable, QString());
+    });
+    // 拒绝连接说明主机在线，其他错误都视为不可达
+    auto onError = [this, socket](QAbstractSocket::SocketError error) {
+      finishProbe(socket,
+                  error == QAbstractSocket::ConnectionRefusedError
+                      ? Refused
+                      : Unreachable,
+                  socket->errorString());
+    };
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    connect(socket, &QAbstractSocket::errorOccurred, this, onError);
+#else
+    connect(socket,
+            QOverload<QAbstractSocket::SocketError>::of(
+                &QAbstractSocket::error),
+            this, onError);
+#endif
+
+    emit hostStarted(target.hostId);
+    socket->connectToHost(target.address, target.port);
+  }
+}
+
+void HostProber::finishProbe(QTcpSocket *socket, Status status,
+                             const QString &errorString) {
+  QHash<QTcpSocket *, Probe>::iterator it = m_active.find(socket);
+  if (it == m_active.end()) {
+    return;
+  }
+  Probe probe = it.value();
+  m_active.erase(it);
+  closeSocket(socket);
+
+  Result &result = m_results[probe.index];
+  result.status = status;
+  result.latency = (m_clock.nsecsElapsed() - probe.start) / 1e6;
+  result.errorString = errorString;
+  ++m_finishedCount;
+  // 接收方可能重新开始探测，传出副本
+  Result finishedResult = result;
+  emit hostFinished(finishedResult);
+
+  // 结果处理中可能已取消或重新开始
+  if (!isRunning()) {
+    return;
+  }
+  startPending();
+  if (m_active.isEmpty() && m_nextTarget >= m_targets.size()) {
+    m_timeoutTimer.stop();
+    emit finished();
+  }
+}
+
+void HostProber::closeSocket(QTcpSocket *socket) {
+  // 先断开信号，abort() 不再报告错误
+  socket->disconnect(this);
+  socket->abort();
+  socket->deleteLater();
+}
+
+void HostProber::checkTimeouts() {
+  qint64 deadline = m_clock.nsecsElapsed() - qint64(m_timeout) * 1000000;
+  QList<QTcpSocket *> expired;
+  for (QHash<QTcpSocket *, Probe>::const_iterator it = m_active.constBegin();
+       it != m_active.constEnd(); ++it) {
+    if (it.value().start <= deadline) {
+      expired.append(it.key());
+    }
+  }
+  for (QTcpSocket *socket : expired) {
+    finishProbe(socket, TimedOut,
+                QString("%1 ms 内未建立连接").arg(m_timeout));
+  }
+}
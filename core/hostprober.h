@@ -0,0 +1,103 @@
+#ifndef HOSTPROBER_H
+#define HOSTPROBER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+class QTcpSocket;
+
+// 并发探测一组主机的 TCP 端口
+//
+// 所有连接都是非阻塞的，最多 maxConcurrent 个同时进行，其余排队。每个主机
+// 的超时从它开始连接时计算，不受排队时间影响。连接建立即视为可达，并记录
+// 从发起连接到建立所用的时间，随后立即断开。
+class HostProber : public QObject {
+  Q_OBJECT
+
+public:
+  enum Status {
+    Pending,     // 排队等待
+    Connecting,  // 正在连接
+    Reachable,   // 连接已建立
+    Refused,     // 主机在线，但端口拒绝连接
+    Unreachable, // 地址无法解析或网络不可达
+    TimedOut     // 超时未建立连接
+  };
+
+  struct Target {
+    quint64 hostId;
+    QString address;
+    quint16 port;
+  };
+
+  struct Result {
+    quint64 hostId;
+    Status status;
+    double latency; // 毫秒，只对 Reachable 有效
+    QString errorString;
+  };
+
+  // 连接时间的统计，只包含可达的主机
+  struct LatencySummary {
+    int count;
+    double minimum;
+    double median;
+    double p99;
+  };
+
+  explicit HostProber(QObject *parent = nullptr);
+  ~HostProber();
+
+  int timeout() const;
+  void setTimeout(int milliseconds);
+  int maxConcurrent() const;
+  void setMaxConcurrent(int count);
+
+  // 开始新一轮探测，正在进行的探测被取消
+  void start(const QVector<Target> &targets);
+  void cancel();
+  bool isRunning() const;
+
+  // 按 start() 时的顺序排列
+  const QVector<Result> &results() const;
+  int finishedCount() const;
+  LatencySummary summary() const;
+
+  static LatencySummary summarize(QVector<double> latencies);
+  static QString statusText(Status status);
+
+signals:
+  void hostStarted(quint64 hostId);
+  void hostFinished(const HostProber::Result &result);
+  void finished();
+
+private slots:
+  void checkTimeouts();
+
+private:
+  struct Probe {
+    int index;
+    qint64 start; // m_clock 的纳秒读数
+  };
+
+  void startPending();
+  void finishProbe(QTcpSocket *socket, Status status,
+                   const QString &errorString);
+  void closeSocket(QTcpSocket *socket);
+
+  QVector<Target> m_targets;
+  QVector<Result> m_results;
+  QHash<QTcpSocket *, Probe> m_active;
+  int m_nextTarget;
+  int m_finishedCount;
+  int m_timeout;
+  int m_maxConcurrent;
+  QTimer m_timeoutTimer;
+  QElapsedTimer m_clock;
+};
+
+#endif // HOSTPROBER_H
@@ -0,0 +1,321 @@
+#include "loopdevicecsv.h"
+#include <QFile>
+#include <QFuture>
+#include <QList>
+#include <QtConcurrent>
+
+namespace {
+// Import hands blocks of about this size to the worker threads
+const qint64 kReadBlockSize = 1 << 20;
+// Export writes the buffer out after this many rows
+const int kWriteChunkRows = 4096;
+const char kUtf8Bom[] = "\xEF\xBB\xBF";
+
+struct Block {
+  QByteArray data;
+  int firstLine;
+  bool startOfFile;
+};
+
+struct BlockResult {
+  QVector<LoopDevice> devices;
+  QVector<LoopDeviceCsv::RowError> errors;
+};
+
+void appendField(QByteArray &buffer, const QString &value) {
+  QByteArray utf8 = value.toUtf8();
+  bool needsQuotes = false;
+  for (char c : utf8) {
+    if (c == ',' || c == '"' || c == '\n' || c == '\r') {
+      needsQuotes = true;
+      break;
+    }
+  }
+
+  if (!needsQuotes) {
+    buffer.append(utf8);
+    return;
+  }
+  buffer.append('"');
+  buffer.append(utf8.replace("\"", "\"\""));
+  buffer.append('"');
+}
+
+void appendRow(QByteArray &buffer, const LoopChannelDevices &devices,
+               int row) {
+  appendField(buffer, devices.type(row));
+  buffer.append(',');
+  appendField(buffer, devices.serialNumber(row));
+  buffer.append(',');
+  buffer.append(QByteArray::number(devices.address(row)));
+  buffer.append(',');
+  appendField(buffer, devices.personalityCode(row));
+  buffer.append(',');
+  buffer.append(QByteArray::number(devices.panelNumber(row)));
+  buffer.append(',');
+  buffer.append(QByteArray::number(devices.cardNumber(row)));
+  buffer.append(',');
+  appendField(buffer, devices.description(row));
+  buffer.append(',');
+  appendField(buffer, devices.identifier(row));
+  buffer.append(',');
+  appendField(buffer, devices.variableName(row));
+  buffer.append("\r\n");
+}
+
+// Reads one record starting at pos. Quoted fields may contain commas,
+// doubled quotes and line breaks; line counts the physical lines consumed.
+void readRecord(const QByteArray &data, int &pos, int &line,
+                QVector<QByteArray> &fields) {
+  fields.clear();
+  QByteArray field;
+  bool inQuotes = false;
+  const int size = data.size();
+
+  while (pos < size) {
+    char c = data.at(pos++);
+    if (inQuotes) {
+      if (c == '"') {
+        if (pos < size && data.at(pos) == '"') {
+          field.append('"');
+          ++pos;
+        } else {
+          inQuotes = false;
+        }
+        continue;
+      }
+      if (c == '\n') {
+        ++line;
+      }
+      field.append(c);
+    } else if (c == '"') {
+      inQuotes = true;
+    } else if (c == ',') {
+      fields.append(field);
+      field.clear();
+    } else if (c == '\n') {
+      ++line;
+      break;
+    } else if (c != '\r') {
+      field.append(c);
+    }
+  }
+  fields.append(field);
+}
+
+bool parseNumber(const QByteArray &field, int *value) {
+  QByteArray trimmed = field.trimmed();
+  if (trimmed.isEmpty()) {
+    *value = 0;
+    return true;
+  }
+  bool ok = false;
+  *value = trimmed.toInt(&ok);
+  return ok;
+}
+
+BlockResult parseBlock(const Block &block) {
+  BlockResult result;
+  const QStringList types = LoopModule::deviceTypes();
+  QVector<QByteArray> fields;
+
+  int pos = 0;
+  if (block.startOfFile && block.data.startsWith(kUtf8Bom)) {
+    pos = 3;
+  }
+
+  int line = block.firstLine;
+  bool firstRecord = block.startOfFile;
+  while (pos < block.data.size()) {
+    int recordLine = line;
+    readRecord(block.data, pos, line, fields);
+
+    // Blank lines are ignored
+    if (fields.size() == 1 && fields.at(0).trimmed().isEmpty()) {
+      continue;
+    }
+
+    if (fields.size() != LoopDevice::FieldCount) {
+      if (!firstRecord) {
+        result.errors.append({recordLine, QString("应为%1列，实际为%2列")
+                                              .arg(LoopDevice::FieldCount)
+                                              .arg(fields.size())});
+      }
+      firstRecord = false;
+      continue;
+    }
+
+    LoopDevice device;
+    bool addressOk = parseNumber(fields.at(LoopDevice::AddressField),
+                                 &device.address);
+    // A header row is recognized by its non-numeric address column
+    if (firstRecord && !addressOk) {
+      firstRecord = false;
+      continue;
+    }
+    firstRecord = false;
+
+    QString type =
+        QString::fromUtf8(fields.at(LoopDevice::TypeField)).trimmed();
+    int typeIndex = types.indexOf(type);
+    if (typeIndex < 0) {
+      result.errors.append({recordLine, QString("未知的设备类型 \"%1\"")
+                                            .arg(type)});
+      continue;
+    }
+    if (!addressOk || device.address <= 0) {
+      QString address =
+          QString::fromUtf8(fields.at(LoopDevice::AddressField));
+      result.errors.append(
+          {recordLine, QString("地址 \"%1\" 无效").arg(address)});
+      continue;
+    }
+    if (!parseNumber(fields.at(LoopDevice::PanelNumberField),
+                     &device.panelNumber)) {
+      result.errors.append({recordLine, QString("盘号无效")});
+      continue;
+    }
+    if (!parseNumber(fields.at(LoopDevice::CardNumberField),
+                     &device.cardNumber)) {
+      result.errors.append({recordLine, QString("卡号无效")});
+      continue;
+    }
+
+    // Share the type name with every other device of that type
+    device.type = types.at(typeIndex);
+    device.serialNumber =
+        QString::fromUtf8(fields.at(LoopDevice::SerialNumberField));
+    device.personalityCode =
+        QString::fromUtf8(fields.at(LoopDevice::PersonalityCodeField));
+    device.description =
+        QString::fromUtf8(fields.at(LoopDevice::DescriptionField));
+    device.identifier =
+        QString::fromUtf8(fields.at(LoopDevice::IdentifierField));
+    device.variableName =
+        QString::fromUtf8(fields.at(LoopDevice::VariableNameField));
+    result.devices.append(device);
+  }
+
+  return result;
+}
+} // namespace
+
+bool LoopDeviceCsv::write(QIODevice *device, const LoopChannelDevices &devices,
+                          QString *errorString) {
+  QByteArray buffer(kUtf8Bom);
+  const QStringList labels = LoopModule::deviceFieldLabels();
+  for (int i = 0; i < labels.size(); ++i) {
+    if (i > 0) {
+      buffer.append(',');
+    }
+    appendField(buffer, labels.at(i));
+  }
+  buffer.append("\r\n");
+
+  for (int row = 0; row <= devices.size(); ++row) {
+    if (row == devices.size() || (row > 0 && row % kWriteChunkRows == 0)) {
+      if (device->write(buffer) != buffer.size()) {
+        if (errorString) {
+          *errorString = device->errorString();
+        }
+        return false;
+      }
+      buffer.clear();
+    }
+    if (row < devices.size()) {
+      appendRow(buffer, devices, row);
+    }
+  }
+  return true;
+}
+
+bool LoopDeviceCsv::read(QIODevice *device, ImportResult *result,
+                         QString *errorString) {
+  result->devices.clear();
+  result->errors.clear();
+
+  // Cut the input at record boundaries as it is read and parse each block
+  // in the background. Only quote state is tracked here.
+  QList<QFuture<BlockResult>> futures;
+  QByteArray pending;
+  bool inQuotes = false;
+  bool startOfFile = true;
+  int line = 1;
+  bool readFailed = false;
+
+  for (;;) {
+    QByteArray chunk = device->read(kReadBlockSize);
+    if (chunk.isEmpty()) {
+      readFailed = !device->atEnd();
+      break;
+    }
+
+    int scanFrom = pending.size();
+    pending.append(chunk);
+
+    int cut = -1;
+    for (int i = scanFrom; i < pending.size(); ++i) {
+      char c = pending.at(i);
+      if (c == '"') {
+        inQuotes = !inQuotes;
+      } else if (c == '\n' && !inQuotes) {
+        cut = i;
+      }
+    }
+    if (cut < 0) {
+      continue;
+    }
+
+    Block block;
+    block.data = pending.left(cut + 1);
+    block.firstLine = line;
+    block.startOfFile = startOfFile;
+    line += block.data.count('\n');
+    startOfFile = false;
+    pending.remove(0, cut + 1);
+    futures.append(QtConcurrent::run(parseBlock, block));
+  }
+
+  if (!readFailed && !pending.isEmpty()) {
+    Block block;
+    block.data = pending;
+    block.firstLine = line;
+    block.startOfFile = startOfFile;
+    futures.append(QtConcurrent::run(parseBlock, block));
+  }
+
+  if (readFailed) {
+    for (QFuture<BlockResult> &future : futures) {
+      future.waitForFinished();
+    }
+    if (errorString) {
+      *errorString = device->errorString();
+    }
+    return false;
+  }
+
+  // Blocks are joined in file order so rows and errors keep their order
+  int deviceCount = 0;
+  for (QFuture<BlockResult> &future : futures) {
+    deviceCount += future.result().devices.size();
+  }
+  result->devices.reserve(deviceCount);
+  for (QFuture<BlockResult> &future : futures) {
+    const BlockResult &blockResult = future.result();
+    result->devices += blockResult.devices;
+    result->errors += blockResult.errors;
+  }
+  return true;
+}
+
+LoopDeviceCsv::FileImport LoopDeviceCsv::readFile(const QString &path) {
+  FileImport import;
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    import.ok = false;
+    import.errorString = file.errorString();
+    return import;
+  }
+  import.ok = read(&file, &import.result, &import.errorString);
+  return import;
+}
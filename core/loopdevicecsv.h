@@ -0,0 +1,48 @@
+#ifndef LOOPDEVICECSV_H
+#define LOOPDEVICECSV_H
+
+#include "loopmodule.h"
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+
+// CSV import/export of loop device lists.
+//
+// Files carry the nine device fields in table column order, UTF-8 encoded,
+// with a header row. Export streams the channel in fixed-size chunks. Import
+// reads the file in blocks cut at record boundaries and parses and validates
+// the blocks on the global thread pool; invalid rows are skipped and
+// reported with their line number.
+class LoopDeviceCsv {
+public:
+  struct RowError {
+    int line;
+    QString message;
+  };
+
+  struct ImportResult {
+    QVector<LoopDevice> devices;
+    QVector<RowError> errors;
+  };
+
+  static bool write(QIODevice *device, const LoopChannelDevices &devices,
+                    QString *errorString = nullptr);
+
+  // Fails only when the device cannot be read; row problems end up in
+  // result->errors
+  static bool read(QIODevice *device, ImportResult *result,
+                   QString *errorString = nullptr);
+
+  // Outcome of readFile(); errorString is set when ok is false
+  struct FileImport {
+    bool ok;
+    QString errorString;
+    ImportResult result;
+  };
+
+  // Opens and reads path. Meant to run off the GUI thread, e.g. through
+  // QtConcurrent::run(), since read() waits for all of its blocks.
+  static FileImport readFile(const QString &path);
+};
+
+#endif // LOOPDEVICECSV_H
@@ -0,0 +1,590 @@
+#include "loopmodule.h"
+#include "moduleupdateguard.h"
+#include <QJsonArray>
+
+LoopModule::LoopModule(QObject *parent)
+    : QObject(parent), m_channelCount(1) // Default to 1 channel
+      ,
+      m_loopMode(LoopMode::ClassB) // Default to Class B
+      ,
+      m_isInitialized(false), m_isMappingSupported(false), m_updateDepth(0),
+      m_changedDuringUpdate(false) {}
+
+LoopModule::~LoopModule() {}
+
+void LoopModule::beginUpdate() { ++m_updateDepth; }
+
+void LoopModule::endUpdate() {
+  if (m_updateDepth == 0 || --m_updateDepth > 0) {
+    return;
+  }
+
+  // Replay the collected changes as one notification per channel
+  QMap<int, PendingDevices> pending;
+  pending.swap(m_pendingDevices);
+  for (auto it = pending.constBegin(); it != pending.constEnd(); ++it) {
+    if (it.value().reset) {
+      emit devicesReset(it.key());
+    } else {
+      emit devicesChanged(it.key(), it.value().firstIndex,
+                          it.value().lastIndex);
+    }
+  }
+
+  if (m_changedDuringUpdate) {
+    m_changedDuringUpdate = false;
+    emit dataChanged();
+  }
+}
+
+bool LoopModule::isUpdating() const { return m_updateDepth > 0; }
+
+void LoopModule::notifyChanged() {
+  if (m_updateDepth > 0) {
+    m_changedDuringUpdate = true;
+  } else {
+    emit dataChanged();
+  }
+}
+
+void LoopModule::notifyDevices(DeviceChange change, int channelIndex,
+                               int firstIndex, int lastIndex) {
+  if (m_updateDepth == 0) {
+    switch (change) {
+    case DevicesInserted:
+      emit devicesInserted(channelIndex, firstIndex, lastIndex);
+      break;
+    case DevicesRemoved:
+      emit devicesRemoved(channelIndex, firstIndex, lastIndex);
+      break;
+    case DevicesChanged:
+      emit devicesChanged(channelIndex, firstIndex, lastIndex);
+      break;
+    case DevicesReset:
+      emit devicesReset(channelIndex);
+      break;
+    }
+    return;
+  }
+
+  // Rows shifted during the update turn the channel into a reset; plain
+  // edits widen the channel's changed range
+  auto it = m_pendingDevices.find(channelIndex);
+  if (it == m_pendingDevices.end()) {
+    PendingDevices devices;
+    devices.reset = change != DevicesChanged;
+    devices.firstIndex = firstIndex;
+    devices.lastIndex = lastIndex;
+    m_pendingDevices.insert(channelIndex, devices);
+  } else if (change != DevicesChanged) {
+    it.value().reset = true;
+  } else {
+    it.value().firstIndex = qMin(it.value().firstIndex, firstIndex);
+    it.value().lastIndex = qMax(it.value().lastIndex, lastIndex);
+  }
+}
+
+int LoopModule::getChannelCount() const { return m_channelCount; }
+
+void LoopModule::setChannelCount(int count) {
+  if (m_channelCount != count) {
+    m_channelCount = count;
+    notifyChanged();
+  }
+}
+
+LoopMode LoopModule::getLoopMode() const { return m_loopMode; }
+
+void LoopModule::setLoopMode(LoopMode mode) {
+  if (m_loopMode != mode) {
+    m_loopMode = mode;
+    notifyChanged();
+  }
+}
+
+bool LoopModule::isInitialized() const { return m_isInitialized; }
+
+void LoopModule::setInitialized(bool initialized) {
+  if (m_isInitialized != initialized) {
+    m_isInitialized = initialized;
+    notifyChanged();
+  }
+}
+
+bool LoopModule::isMappingSupported() const { return m_isMappingSupported; }
+
+void LoopModule::setMappingSupported(bool supported) {
+  if (m_isMappingSupported != supported) {
+    m_isMappingSupported = supported;
+    notifyChanged();
+  }
+}
+
+QStringList LoopModule::deviceTypes() {
+  return QStringList() << "烟温复合探测器"
+                       << "手动报警按钮"
+                       << "输入输出模块"
+                       << "声光报警器";
+}
+
+QStringList LoopModule::deviceFieldLabels() {
+  static const QStringList labels = QStringList() << "类型"
+                                                  << "序列号"
+                                                  << "地址"
+                                                  << "个性代码"
+                                                  << "盘号"
+                                                  << "卡号"
+                                                  << "设备说明"
+                                                  << "设备标识"
+                                                  << "变量名";
+  return labels;
+}
+
+const LoopChannelDevices &LoopModule::channelDevices(int channelIndex) const {
+  static const LoopChannelDevices emptyChannel;
+  auto it = m_devices.constFind(channelIndex);
+  return it != m_devices.constEnd() ? it.value() : emptyChannel;
+}
+
+int LoopModule::deviceCount(int channelIndex) const {
+  return channelDevices(channelIndex).size();
+}
+
+LoopDevice LoopModule::deviceAt(int channelIndex, int deviceIndex) const {
+  const LoopChannelDevices &devices = channelDevices(channelIndex);
+  if (deviceIndex < 0 || deviceIndex >= devices.size()) {
+    return LoopDevice();
+  }
+  return devices.device(deviceIndex);
+}
+
+int LoopModule::deviceRowForAddress(int channelIndex, int address) const {
+  return channelDevices(channelIndex).rowForAddress(address);
+}
+
+QList<LoopDevice> LoopModule::getDevices(int channelIndex) const {
+  const LoopChannelDevices &devices = channelDevices(channelIndex);
+  QList<LoopDevice> list;
+  list.reserve(devices.size());
+  for (int i = 0; i < devices.size(); ++i) {
+    list.append(devices.device(i));
+  }
+  return list;
+}
+
+template <typename Container>
+void LoopModule::assignDevices(int channelIndex, const Container &devices) {
+  LoopChannelDevices &channel = m_devices[channelIndex];
+  channel.clear();
+  channel.reserve(devices.size());
+  for (const LoopDevice &device : devices) {
+    channel.append(device);
+  }
+  notifyDevices(DevicesReset, channelIndex, 0, -1);
+  notifyChanged();
+}
+
+void LoopModule::setDevices(int channelIndex,
+                            const QList<LoopDevice> &devices) {
+  assignDevices(channelIndex, devices);
+}
+
+void LoopModule::setDevices(int channelIndex,
+                            const QVector<LoopDevice> &devices) {
+  assignDevices(channelIndex, devices);
+}
+
+void LoopModule::addDevice(int channelIndex, const LoopDevice &device) {
+  LoopChannelDevices &channel = m_devices[channelIndex];
+  channel.append(device);
+  notifyDevices(DevicesInserted, channelIndex, channel.size() - 1,
+                channel.size() - 1);
+  notifyChanged();
+}
+
+void LoopModule::removeDevice(int channelIndex, int deviceIndex) {
+  removeDevices(channelIndex, deviceIndex, 1);
+}
+
+void LoopModule::removeDevices(int channelIndex, int firstIndex, int count) {
+  auto it = m_devices.find(channelIndex);
+  if (it == m_devices.end() || firstIndex < 0 || count <= 0 ||
+      firstIndex + count > it.value().size()) {
+    return;
+  }
+
+  it.value().remove(firstIndex, count);
+  notifyDevices(DevicesRemoved, channelIndex, firstIndex,
+                firstIndex + count - 1);
+  notifyChanged();
+}
+
+void LoopModule::replaceDevices(int channelIndex, int firstIndex, int count,
+                                const QVector<LoopDevice> &devices) {
+  if (firstIndex < 0 || count < 0 || (count == 0 && devices.isEmpty())) {
+    return;
+  }
+  auto it = m_devices.constFind(channelIndex);
+  int size = it == m_devices.constEnd() ? 0 : it.value().size();
+  if (firstIndex + count > size) {
+    return;
+  }
+  LoopChannelDevices &channel = m_devices[channelIndex];
+
+  if (count == devices.size()) {
+    for (int i = 0; i < count; ++i) {
+      channel.set(firstIndex + i, devices.at(i));
+    }
+    notifyDevices(DevicesChanged, channelIndex, firstIndex,
+                  firstIndex + count - 1);
+    notifyChanged();
+    return;
+  }
+
+  if (count > 0) {
+    channel.remove(firstIndex, count);
+    notifyDevices(DevicesRemoved, channelIndex, firstIndex,
+                  firstIndex + count - 1);
+  }
+  if (!devices.isEmpty()) {
+    channel.insert(firstIndex, devices);
+    notifyDevices(DevicesInserted, channelIndex, firstIndex,
+                  firstIndex + devices.size() - 1);
+  }
+  notifyChanged();
+}
+
+void LoopModule::updateDevice(int channelIndex, int deviceIndex,
+                              const LoopDevice &device) {
+  auto it = m_devices.find(channelIndex);
+  if (it != m_devices.end() && deviceIndex >= 0 &&
+      deviceIndex < it.value().size()) {
+    it.value().set(deviceIndex, device);
+    notifyDevices(DevicesChanged, channelIndex, deviceIndex, deviceIndex);
+    notifyChanged();
+  }
+}
+
+bool LoopModule::setDeviceValue(int channelIndex, int deviceIndex, int field,
+                                const QVariant &value) {
+  auto it = m_devices.find(channelIndex);
+  if (it == m_devices.end() || deviceIndex < 0 ||
+      deviceIndex >= it.value().size()) {
+    return false;
+  }
+
+  if (it.value().setValue(deviceIndex, field, value)) {
+    notifyDevices(DevicesChanged, channelIndex, deviceIndex, deviceIndex);
+    notifyChanged();
+  }
+  return true;
+}
+
+void LoopModule::copyFrom(const LoopModule *other) {
+  if (other == this) {
+    return;
+  }
+
+  ModuleUpdateGuard<LoopModule> guard(this);
+  QList<int> channels = m_devices.keys();
+  m_channelCount = other->m_channelCount;
+  m_loopMode = other->m_loopMode;
+  m_isInitialized = other->m_isInitialized;
+  m_isMappingSupported = other->m_isMappingSupported;
+  m_devices = other->m_devices;
+
+  // Channels that were dropped as well as the new ones are reset
+  channels += m_devices.keys();
+  for (int channel : channels) {
+    notifyDevices(DevicesReset, channel, 0, -1);
+  }
+  notifyChanged();
+}
+
+QJsonObject LoopModule::toJson() const {
+  QJsonObject rootObj;
+  rootObj["channelCount"] = m_channelCount;
+  rootObj["loopMode"] = static_cast<int>(m_loopMode);
+  rootObj["initialized"] = m_isInitialized;
+  rootObj["mappingSupported"] = m_isMappingSupported;
+
+  QJsonArray channelsArray;
+  for (auto it = m_devices.constBegin(); it != m_devices.constEnd(); ++it) {
+    const LoopChannelDevices &devices = it.value();
+    QJsonArray devicesArray;
+    for (int i = 0; i < devices.size(); ++i) {
+      QJsonObject deviceObj;
+      deviceObj["type"] = devices.type(i);
+      deviceObj["serialNumber"] = devices.serialNumber(i);
+      deviceObj["address"] = devices.address(i);
+      deviceObj["personalityCode"] = devices.personalityCode(i);
+      deviceObj["panelNumber"] = devices.panelNumber(i);
+      deviceObj["cardNumber"] = devices.cardNumber(i);
+      deviceObj["description"] = devices.description(i);
+      deviceObj["identifier"] = devices.identifier(i);
+      deviceObj["variableName"] = devices.variableName(i);
+      devicesArray.append(deviceObj);
+    }
+
+    QJsonObject channelObj;
+    channelObj["channel"] = it.key();
+    channelObj["devices"] = devicesArray;
+    channelsArray.append(channelObj);
+  }
+  rootObj["channels"] = channelsArray;
+
+  return rootObj;
+}
+
+void LoopModule::fromJson(const QJsonObject &rootObj) {
+  ModuleUpdateGuard<LoopModule> guard(this);
+
+  if (rootObj.contains("channelCount")) {
+    m_channelCount = rootObj["channelCount"].toInt();
+  }
+  if (rootObj.contains("loopMode")) {
+    m_loopMode = static_cast<LoopMode>(rootObj["loopMode"].toInt());
+  }
+  m_isInitialized = rootObj["initialized"].toBool();
+  m_isMappingSupported = rootObj["mappingSupported"].toBool();
+
+  QList<int> resetChannels = m_devices.keys();
+  m_devices.clear();
+
+  // Devices of one loop share a handful of type names; keep one copy each
+  QHash<QString, QString> typeNames;
+  QJsonArray channelsArray = rootObj["channels"].toArray();
+  for (const QJsonValue &channelValue : channelsArray) {
+    QJsonObject channelObj = channelValue.toObject();
+    QJsonArray devicesArray = channelObj["devices"].toArray();
+    int channelIndex = channelObj["channel"].toInt();
+
+    LoopChannelDevices &devices = m_devices[channelIndex];
+    devices.clear();
+    devices.reserve(devicesArray.size());
+    for (const QJsonValue &deviceValue : devicesArray) {
+      QJsonObject deviceObj = deviceValue.toObject();
+      LoopDevice device;
+      device.type = deviceObj["type"].toString();
+      auto typeIt = typeNames.constFind(device.type);
+      if (typeIt != typeNames.constEnd()) {
+        device.type = typeIt.value();
+      } else {
+        typeNames.insert(device.type, device.type);
+      }
+      device.serialNumber = deviceObj["serialNumber"].toString();
+      device.address = deviceObj["address"].toInt();
+      device.personalityCode = deviceObj["personalityCode"].toString();
+      device.panelNumber = deviceObj["panelNumber"].toInt();
+      device.cardNumber = deviceObj["cardNumber"].toInt();
+      device.description = deviceObj["description"].toString();
+      device.identifier = deviceObj["identifier"].toString();
+      device.variableName = deviceObj["variableName"].toString();
+      devices.append(device);
+    }
+
+    if (!resetChannels.contains(channelIndex)) {
+      resetChannels.append(channelIndex);
+    }
+  }
+
+  for (int channelIndex : resetChannels) {
+    notifyDevices(DevicesReset, channelIndex, 0, -1);
+  }
+  notifyChanged();
+}
+
+LoopChannelDevices::LoopChannelDevices() : m_addressIndexValid(true) {}
+
+LoopDevice LoopChannelDevices::device(int row) const {
+  LoopDevice device;
+  device.type = m_types.at(row);
+  device.serialNumber = m_serialNumbers.at(row);
+  device.address = m_addresses.at(row);
+  device.personalityCode = m_personalityCodes.at(row);
+  device.panelNumber = m_panelNumbers.at(row);
+  device.cardNumber = m_cardNumbers.at(row);
+  device.description = m_descriptions.at(row);
+  device.identifier = m_identifiers.at(row);
+  device.variableName = m_variableNames.at(row);
+  return device;
+}
+
+QVariant LoopChannelDevices::value(int row, int field) const {
+  if (row < 0 || row >= size()) {
+    return QVariant();
+  }
+
+  switch (field) {
+  case LoopDevice::TypeField:
+    return m_types.at(row);
+  case LoopDevice::SerialNumberField:
+    return m_serialNumbers.at(row);
+  case LoopDevice::AddressField:
+    return m_addresses.at(row);
+  case LoopDevice::PersonalityCodeField:
+    return m_personalityCodes.at(row);
+  case LoopDevice::PanelNumberField:
+    return m_panelNumbers.at(row);
+  case LoopDevice::CardNumberField:
+    return m_cardNumbers.at(row);
+  case LoopDevice::DescriptionField:
+    return m_descriptions.at(row);
+  case LoopDevice::IdentifierField:
+    return m_identifiers.at(row);
+  case LoopDevice::VariableNameField:
+    return m_variableNames.at(row);
+  default:
+    return QVariant();
+  }
+}
+
+int LoopChannelDevices::rowForAddress(int address) const {
+  if (!m_addressIndexValid) {
+    m_addressIndex.clear();
+    m_addressIndex.reserve(m_addresses.size());
+    // Walk backwards so the first row wins for duplicate addresses
+    for (int row = m_addresses.size() - 1; row >= 0; --row) {
+      m_addressIndex.insert(m_addresses.at(row), row);
+    }
+    m_addressIndexValid = true;
+  }
+  return m_addressIndex.value(address, -1);
+}
+
+void LoopChannelDevices::reserve(int size) {
+  m_types.reserve(size);
+  m_serialNumbers.reserve(size);
+  m_addresses.reserve(size);
+  m_personalityCodes.reserve(size);
+  m_panelNumbers.reserve(size);
+  m_cardNumbers.reserve(size);
+  m_descriptions.reserve(size);
+  m_identifiers.reserve(size);
+  m_variableNames.reserve(size);
+}
+
+void LoopChannelDevices::append(const LoopDevice &device) {
+  int row = m_addresses.size();
+  m_types.append(device.type);
+  m_serialNumbers.append(device.serialNumber);
+  m_addresses.append(device.address);
+  m_personalityCodes.append(device.personalityCode);
+  m_panelNumbers.append(device.panelNumber);
+  m_cardNumbers.append(device.cardNumber);
+  m_descriptions.append(device.description);
+  m_identifiers.append(device.identifier);
+  m_variableNames.append(device.variableName);
+
+  // Appending never shifts rows, so the index can be kept current
+  if (m_addressIndexValid && !m_addressIndex.contains(device.address)) {
+    m_addressIndex.insert(device.address, row);
+  }
+}
+
+void LoopChannelDevices::insert(int row, const QVector<LoopDevice> &devices) {
+  if (row == size()) {
+    reserve(size() + devices.size());
+    for (const LoopDevice &device : devices) {
+      append(device);
+    }
+    return;
+  }
+
+  // Open the gap once per column, then fill it
+  int count = devices.size();
+  m_types.insert(row, count, QString());
+  m_serialNumbers.insert(row, count, QString());
+  m_addresses.insert(row, count, 0);
+  m_personalityCodes.insert(row, count, QString());
+  m_panelNumbers.insert(row, count, 0);
+  m_cardNumbers.insert(row, count, 0);
+  m_descriptions.insert(row, count, QString());
+  m_identifiers.insert(row, count, QString());
+  m_variableNames.insert(row, count, QString());
+  for (int i = 0; i < count; ++i) {
+    set(row + i, devices.at(i));
+  }
+  m_addressIndexValid = false;
+}
+
+void LoopChannelDevices::remove(int row, int count) {
+  m_types.remove(row, count);
+  m_serialNumbers.remove(row, count);
+  m_addresses.remove(row, count);
+  m_personalityCodes.remove(row, count);
+  m_panelNumbers.remove(row, count);
+  m_cardNumbers.remove(row, count);
+  m_descriptions.remove(row, count);
+  m_identifiers.remove(row, count);
+  m_variableNames.remove(row, count);
+  m_addressIndexValid = false;
+}
+
+void LoopChannelDevices::set(int row, const LoopDevice &device) {
+  if (m_addresses.at(row) != device.address) {
+    m_addressIndexValid = false;
+  }
+  m_types[row] = device.type;
+  m_serialNumbers[row] = device.serialNumber;
+  m_addresses[row] = device.address;
+  m_personalityCodes[row] = device.personalityCode;
+  m_panelNumbers[row] = device.panelNumber;
+  m_cardNumbers[row] = device.cardNumber;
+  m_descriptions[row] = device.description;
+  m_identifiers[row] = device.identifier;
+  m_variableNames[row] = device.variableName;
+}
+
+// Assigns value to column[row] and reports whether it changed
+template <typename T>
+static bool assignValue(QVector<T> &column, int row, const T &value) {
+  if (column.at(row) == value) {
+    return false;
+  }
+  column[row] = value;
+  return true;
+}
+
+bool LoopChannelDevices::setValue(int row, int field, const QVariant &value) {
+  switch (field) {
+  case LoopDevice::TypeField:
+    return assignValue(m_types, row, value.toString());
+  case LoopDevice::SerialNumberField:
+    return assignValue(m_serialNumbers, row, value.toString());
+  case LoopDevice::AddressField:
+    if (!assignValue(m_addresses, row, value.toInt())) {
+      return false;
+    }
+    m_addressIndexValid = false;
+    return true;
+  case LoopDevice::PersonalityCodeField:
+    return assignValue(m_personalityCodes, row, value.toString());
+  case LoopDevice::PanelNumberField:
+    return assignValue(m_panelNumbers, row, value.toInt());
+  case LoopDevice::CardNumberField:
+    return assignValue(m_cardNumbers, row, value.toInt());
+  case LoopDevice::DescriptionField:
+    return assignValue(m_descriptions, row, value.toString());
+  case LoopDevice::IdentifierField:
+    return assignValue(m_identifiers, row, value.toString());
+  case LoopDevice::VariableNameField:
+    return assignValue(m_variableNames, row, value.toString());
+  default:
+    return false;
+  }
+}
+
+void LoopChannelDevices::clear() {
+  m_types.clear();
+  m_serialNumbers.clear();
+  m_addresses.clear();
+  m_personalityCodes.clear();
+  m_panelNumbers.clear();
+  m_cardNumbers.clear();
+  m_descriptions.clear();
+  m_identifiers.clear();
+  m_variableNames.clear();
+  m_addressIndex.clear();
+  m_addressIndexValid = true;
+}
@@ -0,0 +1,226 @@
+#ifndef LOOPMODULE_H
+#define LOOPMODULE_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+
+// Loop Device Node Structure
+struct LoopDevice {
+  // Field numbers used for per-field access
+  enum Field {
+    TypeField,
+    SerialNumberField,
+    AddressField,
+    PersonalityCodeField,
+    PanelNumberField,
+    CardNumberField,
+    DescriptionField,
+    IdentifierField,
+    VariableNameField,
+    FieldCount
+  };
+
+  QString type; // Device Type (e.g., Smoke/Heat Detector, Manual Call Point)
+  QString serialNumber;    // Device Serial Number
+  int address;             // Device Address
+  QString personalityCode; // Personality Code
+  int panelNumber;         // Panel Number
+  int cardNumber;          // Card Number
+  QString description;     // Device Description
+  QString identifier;      // Device Identifier
+  QString variableName;    // Variable Name
+
+  // Default constructor
+  LoopDevice() : address(0), panelNumber(0), cardNumber(0) {}
+};
+
+// Column-wise storage of the devices on one loop channel.
+//
+// Each field is kept in its own vector so scanning one field (addresses,
+// types) touches contiguous memory. Readers get const access to the columns
+// without copying devices; rows are only assembled on request.
+class LoopChannelDevices {
+public:
+  LoopChannelDevices();
+
+  int size() const { return m_addresses.size(); }
+  bool isEmpty() const { return m_addresses.isEmpty(); }
+
+  // Row accessors; row must be in range
+  const QString &type(int row) const { return m_types.at(row); }
+  const QString &serialNumber(int row) const {
+    return m_serialNumbers.at(row);
+  }
+  int address(int row) const { return m_addresses.at(row); }
+  const QString &personalityCode(int row) const {
+    return m_personalityCodes.at(row);
+  }
+  int panelNumber(int row) const { return m_panelNumbers.at(row); }
+  int cardNumber(int row) const { return m_cardNumbers.at(row); }
+  const QString &description(int row) const { return m_descriptions.at(row); }
+  const QString &identifier(int row) const { return m_identifiers.at(row); }
+  const QString &variableName(int row) const {
+    return m_variableNames.at(row);
+  }
+
+  // Whole columns
+  const QVector<QString> &types() const { return m_types; }
+  const QVector<int> &addresses() const { return m_addresses; }
+
+  LoopDevice device(int row) const;
+  // Returns an invalid QVariant for out-of-range rows or fields
+  QVariant value(int row, int field) const;
+
+  // First row using the address, or -1
+  int rowForAddress(int address) const;
+
+private:
+  friend class LoopModule;
+
+  void reserve(int size);
+  void append(const LoopDevice &device);
+  void insert(int row, const QVector<LoopDevice> &devices);
+  void remove(int row, int count);
+  void set(int row, const LoopDevice &device);
+  bool setValue(int row, int field, const QVariant &value);
+  void clear();
+
+  QVector<QString> m_types;
+  QVector<QString> m_serialNumbers;
+  QVector<int> m_addresses;
+  QVector<QString> m_personalityCodes;
+  QVector<int> m_panelNumbers;
+  QVector<int> m_cardNumbers;
+  QVector<QString> m_descriptions;
+  QVector<QString> m_identifiers;
+  QVector<QString> m_variableNames;
+
+  // Address to first row, rebuilt lazily after rows shift
+  mutable QHash<int, int> m_addressIndex;
+  mutable bool m_addressIndexValid;
+};
+
+// Loop Mode Enum
+enum class LoopMode { ClassA, ClassB, ClassA_Plus_B };
+
+class LoopModule : public QObject {
+  Q_OBJECT
+
+public:
+  explicit LoopModule(QObject *parent = nullptr);
+  ~LoopModule();
+
+  // Batched edits: changes made between beginUpdate() and the outermost
+  // endUpdate() are reported once, as devicesChanged() or devicesReset() per
+  // touched channel followed by a single dataChanged(). Calls may nest.
+  void beginUpdate();
+  void endUpdate();
+  bool isUpdating() const;
+
+  // Channel Count
+  int getChannelCount() const;
+  void setChannelCount(int count);
+
+  // Loop Mode
+  LoopMode getLoopMode() const;
+  void setLoopMode(LoopMode mode);
+
+  // Initialization and Mapping
+  bool isInitialized() const;
+  void setInitialized(bool initialized);
+
+  bool isMappingSupported() const;
+  void setMappingSupported(bool supported);
+
+  // Device types offered by the configuration editors
+  static QStringList deviceTypes();
+  // Display labels of the device fields, in LoopDevice::Field order
+  static QStringList deviceFieldLabels();
+
+  // Device Management
+  // Read-only view of a channel's devices; empty for unknown channels. The
+  // reference is invalidated by any change to the module, including device
+  // edits, setChannelCount(), copyFrom() and fromJson(). Copy it to keep it
+  // across such calls; the columns are implicitly shared, so a copy is cheap.
+  const LoopChannelDevices &channelDevices(int channelIndex) const;
+  int deviceCount(int channelIndex) const;
+  // Out-of-range indexes return an empty device
+  LoopDevice deviceAt(int channelIndex, int deviceIndex) const;
+  int deviceRowForAddress(int channelIndex, int address) const;
+  QList<LoopDevice> getDevices(int channelIndex) const;
+  void setDevices(int channelIndex, const QList<LoopDevice> &devices);
+  void setDevices(int channelIndex, const QVector<LoopDevice> &devices);
+  void addDevice(int channelIndex, const LoopDevice &device);
+  void removeDevice(int channelIndex, int deviceIndex);
+  void removeDevices(int channelIndex, int firstIndex, int count);
+  // Replaces count rows starting at firstIndex with devices; the counts may
+  // differ, so this covers insertion, removal and in-place edits
+  void replaceDevices(int channelIndex, int firstIndex, int count,
+                      const QVector<LoopDevice> &devices);
+  void updateDevice(int channelIndex, int deviceIndex,
+                    const LoopDevice &device);
+  bool setDeviceValue(int channelIndex, int deviceIndex, int field,
+                      const QVariant &value);
+
+  // Replaces the settings and all devices with those of other. The device
+  // storage is implicitly shared, so this is constant time until either
+  // module is edited; editors use it to fill their working copy.
+  void copyFrom(const LoopModule *other);
+
+  // Conversion to/from the configuration section stored in the project file
+  QJsonObject toJson() const;
+  void fromJson(const QJsonObject &rootObj);
+
+signals:
+  void dataChanged();
+
+  // Range notifications, emitted before dataChanged()
+  void devicesInserted(int channelIndex, int firstIndex, int lastIndex);
+  void devicesRemoved(int channelIndex, int firstIndex, int lastIndex);
+  void devicesChanged(int channelIndex, int firstIndex, int lastIndex);
+  // The channel's device list was replaced as a whole
+  void devicesReset(int channelIndex);
+
+private:
+  enum DeviceChange {
+    DevicesInserted,
+    DevicesRemoved,
+    DevicesChanged,
+    DevicesReset
+  };
+
+  // Changes to one channel collected during an update
+  struct PendingDevices {
+    bool reset;
+    int firstIndex;
+    int lastIndex;
+  };
+
+  template <typename Container>
+  void assignDevices(int channelIndex, const Container &devices);
+  void notifyChanged();
+  void notifyDevices(DeviceChange change, int channelIndex, int firstIndex,
+                     int lastIndex);
+
+  int m_channelCount;
+  LoopMode m_loopMode;
+  bool m_isInitialized;
+  bool m_isMappingSupported;
+
+  // Map channel index to its devices
+  QMap<int, LoopChannelDevices> m_devices;
+
+  int m_updateDepth;
+  bool m_changedDuringUpdate;
+  QMap<int, PendingDevices> m_pendingDevices;
+};
+
+#endif // LOOPMODULE_H
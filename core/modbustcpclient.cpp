@@ -0,0 +1,379 @@
+#include "modbustcpclient.h"
+#include <QPair>
+#include <QtEndian>
+#include <algorithm>
+
+namespace {
+// MBAP 头：事务编号、协议编号(0)、后续长度、单元编号
+const int kHeaderSize = 7;
+// 后续长度包括单元编号和最长 253 字节的 PDU
+const int kMaxFrameLength = 254;
+const int kMaxWriteCoils = 1968;
+const int kMaxWriteRegisters = 123;
+
+void appendUInt16(QByteArray &buffer, quint16 value) {
+  uchar bytes[2];
+  qToBigEndian<quint16>(value, bytes);
+  buffer.append(reinterpret_cast<const char *>(bytes), 2);
+}
+
+quint16 readUInt16(const char *data) {
+  return qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(data));
+}
+
+bool isBitFunction(ModbusTcpClient::FunctionCode function) {
+  return function == ModbusTcpClient::ReadCoils ||
+         function == ModbusTcpClient::ReadDiscreteInputs;
+}
+
+bool rangeValid(int address, int count, int maxCount) {
+  return address >= 0 && count >= 1 && count <= maxCount &&
+         address + count <= 0x10000;
+}
+
+bool rangeLess(const ModbusTcpClient::ReadRange &a,
+               const ModbusTcpClient::ReadRange &b) {
+  if (a.function != b.function) {
+    return a.function < b.function;
+  }
+  return a.address < b.address;
+}
+} // namespace
+
+ModbusTcpClient::ModbusTcpClient(QObject *parent)
+    : QObject(parent), m_nextTransactionId(1), m_unitId(1), m_maxInFlight(4),
+      m_timeout(1000) {
+  m_clock.start();
+  m_timeoutTimer.setInterval(50);
+  connect(&m_timeoutTimer, &QTimer::timeout, this,
+          &ModbusTcpClient::checkTimeouts);
+
+  connect(&m_socket, &QTcpSocket::connected, this, [this]() {
+    // 请求都很短，立即发送，不等待合并
+    m_socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    emit connected();
+    sendPending();
+  });
+  connect(&m_socket, &QTcpSocket::readyRead, this,
+          &ModbusTcpClient::onReadyRead);
+  connect(&m_socket, &QTcpSocket::disconnected, this,
+          &ModbusTcpClient::onDisconnected);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+  connect(&m_socket, &QAbstractSocket::errorOccurred, this,
+          &ModbusTcpClient::onSocketError);
+#else
+  connect(&m_socket,
+          QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::error),
+          this, &ModbusTcpClient::onSocketError);
+#endif
+}
+
+ModbusTcpClient::~ModbusTcpClient() {
+  // 析构时不再报告未完成的请求
+  m_socket.disconnect(this);
+  m_socket.abort();
+}
+
+void ModbusTcpClient::connectToHost(const QString &host, quint16 port) {
+  disconnectFromHost();
+  m_socket.connectToHost(host, port);
+}
+
+void ModbusTcpClient::disconnectFromHost() {
+  if (m_socket.state() == QAbstractSocket::UnconnectedState) {
+    return;
+  }
+  m_socket.abort();
+  // 已连接的套接字会发出 disconnected，正在连接的不会
+  failAll("连接已断开");
+  m_buffer.clear();
+}
+
+bool ModbusTcpClient::isConnected() const {
+  return m_socket.state() == QAbstractSocket::ConnectedState;
+}
+
+QAbstractSocket::SocketState ModbusTcpClient::state() const {
+  return m_socket.state();
+}
+
+quint8 ModbusTcpClient::unitId() const { return m_unitId; }
+
+void ModbusTcpClient::setUnitId(quint8 unitId) { m_unitId = unitId; }
+
+int ModbusTcpClient::maxInFlight() const { return m_maxInFlight; }
+
+void ModbusTcpClient::setMaxInFlight(int count) {
+  m_maxInFlight = qMax(1, count);
+  sendPending();
+}
+
+int ModbusTcpClient::timeout() const { return m_timeout; }
+
+void ModbusTcpClient::setTimeout(int milliseconds) {
+  m_timeout = qMax(1, milliseconds);
+}
+
+int ModbusTcpClient::pendingCount() const {
+  return m_queue.size() + m_inFlight.size();
+}
+
+quint16 ModbusTcpClient::read(const ReadRange &range) {
+  QByteArray pdu;
+  pdu.append(static_cast<char>(range.function));
+  appendUInt16(pdu, static_cast<quint16>(range.address));
+  appendUInt16(pdu, static_cast<quint16>(range.count));
+
+  bool valid = range.function >= ReadCoils &&
+               range.function <= ReadInputRegisters &&
+               rangeValid(range.address, range.count,
+                          maxReadCount(range.function));
+  return enqueue(valid ? range.function : FunctionCode(0), range.address,
+                 range.count, pdu);
+}
+
+quint16 ModbusTcpClient::writeCoils(int address,
+                                    const QVector<quint16> &values) {
+  QByteArray bits((values.size() + 7) / 8, '\0');
+  for (int i = 0; i < values.size(); ++i) {
+    if (values.at(i)) {
+      bits[i / 8] = static_cast<char>(bits.at(i / 8) | (1 << (i % 8)));
+    }
+  }
+
+  QByteArray pdu;
+  pdu.append(static_cast<char>(WriteMultipleCoils));
+  appendUInt16(pdu, static_cast<quint16>(address));
+  appendUInt16(pdu, static_cast<quint16>(values.size()));
+  pdu.append(static_cast<char>(bits.size()));
+  pdu.append(bits);
+
+  bool valid = rangeValid(address, values.size(), kMaxWriteCoils);
+  return enqueue(valid ? WriteMultipleCoils : FunctionCode(0), address,
+                 values.size(), pdu);
+}
+
+quint16 ModbusTcpClient::writeRegisters(int address,
+                                        const QVector<quint16> &values) {
+  QByteArray pdu;
+  pdu.append(static_cast<char>(WriteMultipleRegisters));
+  appendUInt16(pdu, static_cast<quint16>(address));
+  appendUInt16(pdu, static_cast<quint16>(values.size()));
+  pdu.append(static_cast<char>(values.size() * 2));
+  for (quint16 value : values) {
+    appendUInt16(pdu, value);
+  }
+
+  bool valid = rangeValid(address, values.size(), kMaxWriteRegisters);
+  return enqueue(valid ? WriteMultipleRegisters : FunctionCode(0), address,
+                 values.size(), pdu);
+}
+
+int ModbusTcpClient::maxReadCount(FunctionCode function) {
+  return isBitFunction(function) ? 2000 : 125;
+}
+
+QVector<ModbusTcpClient::ReadRange>
+ModbusTcpClient::mergeReads(QVector<ReadRange> ranges, int maxGap) {
+  std::sort(ranges.begin(), ranges.end(), rangeLess);
+
+  QVector<ReadRange> merged;
+  for (const ReadRange &range : ranges) {
+    if (range.count <= 0) {
+      continue;
+    }
+    if (!merged.isEmpty()) {
+      ReadRange &last = merged.last();
+      int end = qMax(last.address + last.count, range.address + range.count);
+      if (last.function == range.function &&
+          range.address <= last.address + last.count + qMax(0, maxGap) &&
+          end - last.address <= maxReadCount(range.function)) {
+        last.count = end - last.address;
+        continue;
+      }
+    }
+    merged.append(range);
+  }
+  return merged;
+}
+
+quint16 ModbusTcpClient::enqueue(FunctionCode function, int address,
+                                 int count, const QByteArray &pdu) {
+  // 跳过仍在途的编号，编号回绕后不会与未完成的请求混淆
+  while (m_nextTransactionId == 0 ||
+         m_inFlight.contains(m_nextTransactionId)) {
+    ++m_nextTransactionId;
+  }
+  quint16 transactionId = m_nextTransactionId++;
+
+  if (function == 0) {
+    // 参数无效的请求不发送，与其他失败一样异步报告
+    QTimer::singleShot(0, this, [this, transactionId]() {
+      emit requestFailed(transactionId, "请求的地址或数量超出范围");
+    });
+    return transactionId;
+  }
+
+  Request request;
+  request.transactionId = transactionId;
+  request.range.function = function;
+  request.range.address = address;
+  request.range.count = count;
+  request.pdu = pdu;
+  request.deadline = 0;
+  m_queue.enqueue(request);
+  sendPending();
+  return transactionId;
+}
+
+void ModbusTcpClient::sendPending() {
+  if (!isConnected()) {
+    return;
+  }
+
+  while (!m_queue.isEmpty() && m_inFlight.size() < m_maxInFlight) {
+    Request request = m_queue.dequeue();
+    request.deadline = m_clock.elapsed() + m_timeout;
+
+    QByteArray frame;
+    frame.reserve(kHeaderSize + request.pdu.size());
+    appendUInt16(frame, request.transactionId);
+    appendUInt16(frame, 0);
+    appendUInt16(frame, static_cast<quint16>(request.pdu.size() + 1));
+    frame.append(static_cast<char>(m_unitId));
+    frame.append(request.pdu);
+    m_socket.write(frame);
+
+    m_inFlight.insert(request.transactionId, request);
+  }
+
+  if (!m_inFlight.isEmpty() && !m_timeoutTimer.isActive()) {
+    m_timeoutTimer.start();
+  }
+}
+
+void ModbusTcpClient::onReadyRead() {
+  m_buffer.append(m_socket.readAll());
+
+  // 先取出全部完整的帧，处理响应时接收方可能断开连接并清空缓冲区
+  QVector<QPair<quint16, QByteArray>> frames;
+  int position = 0;
+  while (m_buffer.size() - position >= kHeaderSize) {
+    const char *header = m_buffer.constData() + position;
+    int length = readUInt16(header + 4);
+    if (readUInt16(header + 2) != 0 || length < 2 ||
+        length > kMaxFrameLength) {
+      // 无法再确定帧边界，断开连接
+      m_buffer.clear();
+      emit errorOccurred("收到无效的 Modbus/TCP 帧");
+      disconnectFromHost();
+      return;
+    }
+    if (m_buffer.size() - position < 6 + length) {
+      break;
+    }
+    frames.append(qMakePair(readUInt16(header),
+                            m_buffer.mid(position + kHeaderSize, length - 1)));
+    position += 6 + length;
+  }
+  m_buffer.remove(0, position);
+
+  for (const QPair<quint16, QByteArray> &frame : frames) {
+    // 超时后迟到的响应找不到对应的请求，直接丢弃
+    QHash<quint16, Request>::iterator it = m_inFlight.find(frame.first);
+    if (it != m_inFlight.end()) {
+      Request request = it.value();
+      m_inFlight.erase(it);
+      handleResponse(request, frame.second);
+    }
+  }
+
+  sendPending();
+}
+
+void ModbusTcpClient::handleResponse(const Request &request,
+                                     const QByteArray &pdu) {
+  quint8 function = static_cast<quint8>(pdu.at(0));
+  if (function & 0x80) {
+    int code = pdu.size() > 1 ? static_cast<quint8>(pdu.at(1)) : 0;
+    emit requestFailed(request.transactionId,
+                       QString("Modbus 异常码 %1").arg(code));
+    return;
+  }
+  if (function != request.range.function) {
+    emit requestFailed(request.transactionId, "响应的功能码与请求不符");
+    return;
+  }
+
+  if (function == WriteMultipleCoils || function == WriteMultipleRegisters) {
+    emit writeFinished(request.transactionId);
+    return;
+  }
+
+  const ReadRange &range = request.range;
+  bool bits = isBitFunction(range.function);
+  int byteCount = bits ? (range.count + 7) / 8 : range.count * 2;
+  if (pdu.size() != byteCount + 2 ||
+      static_cast<quint8>(pdu.at(1)) != byteCount) {
+    emit requestFailed(request.transactionId, "响应的长度与请求不符");
+    return;
+  }
+
+  const char *data = pdu.constData() + 2;
+  QVector<quint16> values(range.count);
+  for (int i = 0; i < range.count; ++i) {
+    values[i] = bits ? (static_cast<quint8>(data[i / 8]) >> (i % 8)) & 1
+                     : readUInt16(data + i * 2);
+  }
+  emit readFinished(request.transactionId, range, values);
+}
+
+void ModbusTcpClient::onDisconnected() {
+  m_buffer.clear();
+  failAll("连接已断开");
+  emit disconnected();
+}
+
+void ModbusTcpClient::onSocketError(QAbstractSocket::SocketError error) {
+  Q_UNUSED(error);
+  emit errorOccurred(m_socket.errorString());
+}
+
+void ModbusTcpClient::checkTimeouts() {
+  qint64 now = m_clock.elapsed();
+  QVector<quint16> expired;
+  for (QHash<quint16, Request>::const_iterator it = m_inFlight.constBegin();
+       it != m_inFlight.constEnd(); ++it) {
+    if (it->deadline <= now) {
+      expired.append(it.key());
+    }
+  }
+  std::sort(expired.begin(), expired.end());
+
+  for (quint16 transactionId : expired) {
+    m_inFlight.remove(transactionId);
+    emit requestFailed(transactionId, "请求超时");
+  }
+  if (m_inFlight.isEmpty()) {
+    m_timeoutTimer.stop();
+  }
+  sendPending();
+}
+
+void ModbusTcpClient::failAll(const QString &errorString) {
+  QVector<quint16> transactionIds;
+  for (const Request &request : m_queue) {
+    transactionIds.append(request.transactionId);
+  }
+  for (QHash<quint16, Request>::const_iterator it = m_inFlight.constBegin();
+       it != m_inFlight.constEnd(); ++it) {
+    transactionIds.append(it.key());
+  }
+  m_queue.clear();
+  m_inFlight.clear();
+  m_timeoutTimer.stop();
+
+  for (quint16 transactionId : transactionIds) {
+    emit requestFailed(transactionId, errorString);
+  }
+}
@@ -0,0 +1,112 @@
+#ifndef MODBUSTCPCLIENT_H
+#define MODBUSTCPCLIENT_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QVector>
+
+// 异步 Modbus/TCP 客户端
+//
+// 请求按调用顺序排队，最多 maxInFlight 个同时在途，响应按 MBAP 头中的
+// 事务编号与请求对应，不要求按发送顺序返回。超时未响应的请求报告失败，
+// 之后迟到的响应被丢弃。连接断开时排队和在途的请求全部报告失败。
+class ModbusTcpClient : public QObject {
+  Q_OBJECT
+
+public:
+  enum FunctionCode {
+    ReadCoils = 0x01,
+    ReadDiscreteInputs = 0x02,
+    ReadHoldingRegisters = 0x03,
+    ReadInputRegisters = 0x04,
+    WriteMultipleCoils = 0x0f,
+    WriteMultipleRegisters = 0x10
+  };
+
+  // 一段连续地址的读取
+  struct ReadRange {
+    FunctionCode function;
+    int address;
+    int count;
+  };
+
+  explicit ModbusTcpClient(QObject *parent = nullptr);
+  ~ModbusTcpClient();
+
+  void connectToHost(const QString &host, quint16 port = 502);
+  void disconnectFromHost();
+  bool isConnected() const;
+  QAbstractSocket::SocketState state() const;
+
+  quint8 unitId() const;
+  void setUnitId(quint8 unitId);
+  int maxInFlight() const;
+  void setMaxInFlight(int count);
+  int timeout() const;
+  void setTimeout(int milliseconds);
+
+  // 排队和在途的请求数
+  int pendingCount() const;
+
+  // 返回请求的事务编号，结果通过 readFinished() 或 requestFailed() 报告。
+  // 线圈和离散输入的每个值为 0 或 1。
+  quint16 read(const ReadRange &range);
+  quint16 writeCoils(int address, const QVector<quint16> &values);
+  quint16 writeRegisters(int address, const QVector<quint16> &values);
+
+  // 单个请求最多读取的数量
+  static int maxReadCount(FunctionCode function);
+  // 将同类且地址相邻或重叠的读取合并为尽量少的请求，结果按功能码和地址
+  // 排序。maxGap 大于 0 时，间隔不超过 maxGap 的读取也会合并。
+  static QVector<ReadRange> mergeReads(QVector<ReadRange> ranges,
+                                       int maxGap = 0);
+
+signals:
+  void connected();
+  void disconnected();
+  void readFinished(quint16 transactionId,
+                    const ModbusTcpClient::ReadRange &range,
+                    const QVector<quint16> &values);
+  void writeFinished(quint16 transactionId);
+  void requestFailed(quint16 transactionId, const QString &errorString);
+  void errorOccurred(const QString &errorString);
+
+private slots:
+  void onReadyRead();
+  void onDisconnected();
+  void onSocketError(QAbstractSocket::SocketError error);
+  void checkTimeouts();
+
+private:
+  struct Request {
+    quint16 transactionId;
+    ReadRange range;
+    QByteArray pdu;
+    qint64 deadline; // 发送时按 m_clock 计算
+  };
+
+  quint16 enqueue(FunctionCode function, int address, int count,
+                  const QByteArray &pdu);
+  void sendPending();
+  void handleResponse(const Request &request, const QByteArray &pdu);
+  void failAll(const QString &errorString);
+
+  QTcpSocket m_socket;
+  QTimer m_timeoutTimer;
+  QElapsedTimer m_clock;
+  QByteArray m_buffer;
+  QQueue<Request> m_queue;
+  QHash<quint16, Request> m_inFlight;
+  quint16 m_nextTransactionId;
+  quint8 m_unitId;
+  int m_maxInFlight;
+  int m_timeout;
+};
+
+#endif // MODBUSTCPCLIENT_H
@@ -0,0 +1,160 @@
+#include "moduleregistry.h"
+#include "dimodule.h"
+#include "domodule.h"
+#include "hostmodule.h"
+#include "loopmodule.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+
+ModuleRegistry::ModuleRegistry(QObject *parent) : QObject(parent) {}
+
+ModuleRegistry::~ModuleRegistry() {}
+
+template <typename T> T *ModuleRegistry::watchModule(T *module, quint64 id) {
+  // 配置修改后记录下来，保存项目前统一写回项目树
+  connect(module, &T::dataChanged, this, [this, id]() {
+    m_modified.insert(id);
+    emit moduleChanged(id);
+  });
+  return module;
+}
+
+bool ModuleRegistry::supportsType(const QString &type) {
+  return type == "DIModule" || type == "DOModule" || type == "HostModule" ||
+         type == "LoopModule";
+}
+
+QObject *ModuleRegistry::module(quint64 id) const {
+  return m_modules.value(id, nullptr);
+}
+
+bool ModuleRegistry::contains(quint64 id) const {
+  return m_modules.contains(id);
+}
+
+int ModuleRegistry::count() const { return m_modules.size(); }
+
+QObject *ModuleRegistry::acquire(quint64 id, const QString &type,
+                                 const QByteArray &config,
+                                 const QString &name) {
+  if (id == 0) {
+    return nullptr;
+  }
+
+  QHash<quint64, QObject *>::const_iterator it = m_modules.constFind(id);
+  if (it != m_modules.constEnd()) {
+    return it.value();
+  }
+
+  QObject *module = createModule(type, config, name, this);
+  if (!module) {
+    return nullptr;
+  }
+
+  if (DIModule *diModule = qobject_cast<DIModule *>(module)) {
+    watchModule(diModule, id);
+  } else if (DOModule *doModule = qobject_cast<DOModule *>(module)) {
+    watchModule(doModule, id);
+  } else if (HostModule *hostModule = qobject_cast<HostModule *>(module)) {
+    watchModule(hostModule, id);
+  } else if (LoopModule *loopModule = qobject_cast<LoopModule *>(module)) {
+    watchModule(loopModule, id);
+  }
+
+  m_modules.insert(id, module);
+  return module;
+}
+
+QObject *ModuleRegistry::createModule(const QString &type,
+                                      const QByteArray &rawConfig,
+                                      const QString &name, QObject *parent) {
+  QJsonObject config;
+  if (!rawConfig.isEmpty()) {
+    config = QJsonDocument::fromJson(rawConfig).object();
+  }
+
+  if (type == "DIModule") {
+    DIModule *diModule = new DIModule(parent);
+    if (!config.isEmpty()) {
+      diModule->fromJson(config);
+    }
+    return diModule;
+  } else if (type == "DOModule") {
+    DOModule *doModule = new DOModule(parent);
+    if (!config.isEmpty()) {
+      doModule->fromJson(config);
+    }
+    return doModule;
+  } else if (type == "HostModule") {
+    HostModule *hostModule = new HostModule(parent);
+    if (!config.isEmpty()) {
+      hostModule->fromJson(config);
+    } else {
+      // 没有保存的配置时使用组件名称作为主机名
+      HostConfiguration hostConfig = hostModule->getConfiguration();
+      hostConfig.hostName = name;
+      hostModule->setConfiguration(hostConfig);
+    }
+    return hostModule;
+  } else if (type == "LoopModule") {
+    LoopModule *loopModule = new LoopModule(parent);
+    if (!config.isEmpty()) {
+      loopModule->fromJson(config);
+    }
+    return loopModule;
+  }
+
+  return nullptr;
+}
+
+bool ModuleRegistry::isModified(quint64 id) const {
+  return m_modified.contains(id);
+}
+
+QList<quint64> ModuleRegistry::modifiedIds() const {
+  return m_modified.values();
+}
+
+void ModuleRegistry::clearModified(quint64 id) { m_modified.remove(id); }
+
+QByteArray ModuleRegistry::configuration(quint64 id) const {
+  QObject *module = m_modules.value(id, nullptr);
+  if (!module) {
+    return QByteArray();
+  }
+  return serialize(module);
+}
+
+QByteArray ModuleRegistry::serialize(const QObject *module) {
+  QJsonObject config;
+  if (const DIModule *diModule = qobject_cast<const DIModule *>(module)) {
+    config = diModule->toJson();
+  } else if (const DOModule *doModule =
+                 qobject_cast<const DOModule *>(module)) {
+    config = doModule->toJson();
+  } else if (const HostModule *hostModule =
+                 qobject_cast<const HostModule *>(module)) {
+    config = hostModule->toJson();
+  } else if (const LoopModule *loopModule =
+                 qobject_cast<const LoopModule *>(module)) {
+    config = loopModule->toJson();
+  }
+
+  return QJsonDocument(config).toJson(QJsonDocument::Compact);
+}
+
+void ModuleRegistry::release(quint64 id) {
+  QObject *module = m_modules.take(id);
+  if (module) {
+    module->deleteLater();
+  }
+  m_modified.remove(id);
+}
+
+void ModuleRegistry::clear() {
+  for (QObject *module : m_modules) {
+    module->deleteLater();
+  }
+  m_modules.clear();
+  m_modified.clear();
+}
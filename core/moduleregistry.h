@@ -0,0 +1,67 @@
+#ifndef MODULEREGISTRY_H
+#define MODULEREGISTRY_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+// 组件模块注册表
+//
+// 每个组件按其组件编号对应一个独立的模块实例(DIModule、HostModule 等)，
+// 首次访问时根据保存的配置段创建，删除组件时显式释放。组件编号保存在
+// 项目树中，节点移动或重建后不会失效。
+class ModuleRegistry : public QObject {
+  Q_OBJECT
+
+public:
+  explicit ModuleRegistry(QObject *parent = nullptr);
+  ~ModuleRegistry();
+
+  // 判断该类型的组件是否有对应的模块
+  static bool supportsType(const QString &type);
+
+  QObject *module(quint64 id) const;
+  bool contains(quint64 id) const;
+  int count() const;
+
+  // 按类型和配置段创建一个不受注册表管理的模块，可在工作线程中调用
+  static QObject *createModule(const QString &type, const QByteArray &config,
+                               const QString &name = QString(),
+                               QObject *parent = nullptr);
+
+  // 获取组件对应的模块，不存在时按类型和配置段创建
+  QObject *acquire(quint64 id, const QString &type, const QByteArray &config,
+                   const QString &name = QString());
+
+  template <typename T> T *moduleAs(quint64 id) const {
+    return qobject_cast<T *>(module(id));
+  }
+
+  // 配置被修改但尚未写回项目树的组件
+  bool isModified(quint64 id) const;
+  QList<quint64> modifiedIds() const;
+  void clearModified(quint64 id);
+
+  // 将模块当前的配置序列化为配置段(JSON)
+  QByteArray configuration(quint64 id) const;
+  // 同上，用于不受注册表管理的模块，可在工作线程中调用
+  static QByteArray serialize(const QObject *module);
+
+  // 释放组件对应的模块，属性面板可能仍引用该模块，因此延迟删除
+  void release(quint64 id);
+  void clear();
+
+signals:
+  void moduleChanged(quint64 id);
+
+private:
+  template <typename T> T *watchModule(T *module, quint64 id);
+
+  QHash<quint64, QObject *> m_modules;
+  QSet<quint64> m_modified;
+};
+
+#endif // MODULEREGISTRY_H
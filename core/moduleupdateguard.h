@@ -0,0 +1,22 @@
+#ifndef MODULEUPDATEGUARD_H
+#define MODULEUPDATEGUARD_H
+
+// 模块批量修改的作用域守卫
+//
+// 构造时调用 beginUpdate()，析构时调用 endUpdate()，适用于 LoopModule、
+// DIModule、DOModule 等提供批量修改接口的模块。
+template <typename Module> class ModuleUpdateGuard {
+public:
+  explicit ModuleUpdateGuard(Module *module) : m_module(module) {
+    m_module->beginUpdate();
+  }
+  ~ModuleUpdateGuard() { m_module->endUpdate(); }
+
+  ModuleUpdateGuard(const ModuleUpdateGuard &) = delete;
+  ModuleUpdateGuard &operator=(const ModuleUpdateGuard &) = delete;
+
+private:
+  Module *m_module;
+};
+
+#endif // MODULEUPDATEGUARD_H
@@ -0,0 +1,389 @@
+#include "projectbinaryformat.h"
+#include "projectloader.h"
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+const char kMagic[4] = {'T', 'F', 'L', 'P'};
+const quint32 kHeaderSize = 40;
+const quint32 kStringIndexEntrySize = 8;
+const quint32 kConfigIndexEntrySize = 8;
+const quint32 kNodeRecordSize = 24;
+const quint32 kComponentIdSize = 8;
+
+// 每处理多少个节点检查一次取消和进度
+const int kProgressInterval = 4096;
+
+struct NodeRecord {
+  qint32 parent;
+  qint32 firstChild;
+  qint32 nextSibling;
+  quint32 nameId;
+  quint32 typeId;
+  quint32 flags;
+};
+
+// 写入时使用的字符串表，相同的字符串只保存一次
+class StringTable {
+public:
+  quint32 intern(const QString &value) {
+    QHash<QString, quint32>::const_iterator it = m_ids.constFind(value);
+    if (it != m_ids.constEnd()) {
+      return it.value();
+    }
+    quint32 id = static_cast<quint32>(m_strings.size());
+    m_ids.insert(value, id);
+    m_strings.append(value);
+    return id;
+  }
+
+  const QVector<QString> &strings() const { return m_strings; }
+
+private:
+  QHash<QString, quint32> m_ids;
+  QVector<QString> m_strings;
+};
+
+void appendUInt16(QByteArray &buffer, quint16 value) {
+  uchar bytes[2];
+  qToLittleEndian<quint16>(value, bytes);
+  buffer.append(reinterpret_cast<const char *>(bytes), 2);
+}
+
+void appendUInt32(QByteArray &buffer, quint32 value) {
+  uchar bytes[4];
+  qToLittleEndian<quint32>(value, bytes);
+  buffer.append(reinterpret_cast<const char *>(bytes), 4);
+}
+
+void appendUInt64(QByteArray &buffer, quint64 value) {
+  uchar bytes[8];
+  qToLittleEndian<quint64>(value, bytes);
+  buffer.append(reinterpret_cast<const char *>(bytes), 8);
+}
+
+quint16 readUInt16(const uchar *data) {
+  return qFromLittleEndian<quint16>(data);
+}
+
+quint32 readUInt32(const uchar *data) {
+  return qFromLittleEndian<quint32>(data);
+}
+
+quint64 readUInt64(const uchar *data) {
+  return qFromLittleEndian<quint64>(data);
+}
+
+void collectNodes(const ProjectTree &tree, int node, qint32 parent,
+                  QVector<NodeRecord> &nodes, QVector<QByteArray> &configs,
+                  QVector<quint64> &ids, StringTable &strings) {
+  qint32 index = nodes.size();
+
+  // 项目树中可能残留已不再使用的名称，这里重新建立紧凑的字符串表
+  NodeRecord record;
+  record.parent = parent;
+  record.firstChild = -1;
+  record.nextSibling = -1;
+  record.nameId = strings.intern(tree.name(node));
+  record.typeId = strings.intern(tree.type(node));
+  record.flags = 0;
+  nodes.append(record);
+  configs.append(tree.config(node));
+  ids.append(tree.componentId(node));
+
+  qint32 previous = -1;
+  for (int child = tree.firstChild(node); child >= 0;
+       child = tree.nextSibling(child)) {
+    qint32 childIndex = nodes.size();
+    if (previous < 0) {
+      nodes[index].firstChild = childIndex;
+    } else {
+      nodes[previous].nextSibling = childIndex;
+    }
+    previous = childIndex;
+
+    collectNodes(tree, child, index, nodes, configs, ids, strings);
+  }
+}
+
+void setError(QString *errorString, const QString &message) {
+  if (errorString) {
+    *errorString = message;
+  }
+}
+
+bool rangeValid(quint64 offset, quint64 length, quint64 size) {
+  return offset <= size && length <= size - offset;
+}
+
+// 读取字符串表中的第 id 个字符串，超出文件范围时返回 false
+bool readString(const uchar *data, quint64 fileSize, quint32 stringIndexOffset,
+                quint32 stringDataOffset, quint32 id, QString *value) {
+  const uchar *entry = data + stringIndexOffset + id * kStringIndexEntrySize;
+  quint32 offset = readUInt32(entry);
+  quint32 length = readUInt32(entry + 4);
+  if (!rangeValid(quint64(stringDataOffset) + offset, length, fileSize)) {
+    return false;
+  }
+  *value = QString::fromUtf8(
+      reinterpret_cast<const char *>(data + stringDataOffset + offset),
+      static_cast<int>(length));
+  return true;
+}
+
+bool parseImage(const uchar *data, qint64 size, ProjectTree *tree,
+                QString *errorString, ProjectLoader *loader) {
+  const quint64 fileSize = static_cast<quint64>(size);
+  if (fileSize < kHeaderSize || memcmp(data, kMagic, 4) != 0) {
+    setError(errorString, "不是有效的二进制项目文件");
+    return false;
+  }
+
+  quint16 version = readUInt16(data + 4);
+  quint16 headerSize = readUInt16(data + 6);
+  if (version != ProjectBinaryFormat::CurrentVersion) {
+    setError(errorString, QString("不支持的文件版本: %1").arg(version));
+    return false;
+  }
+
+  quint32 nodeCount = readUInt32(data + 8);
+  quint32 stringCount = readUInt32(data + 12);
+  quint32 stringIndexOffset = readUInt32(data + 16);
+  quint32 stringDataOffset = readUInt32(data + 20);
+  quint32 nodeTableOffset = readUInt32(data + 24);
+  quint32 configIndexOffset = readUInt32(data + 28);
+  quint32 configDataOffset = readUInt32(data + 32);
+  quint32 componentIdOffset = readUInt32(data + 36);
+
+  if (headerSize < kHeaderSize || nodeCount == 0 ||
+      !rangeValid(stringIndexOffset,
+                  quint64(stringCount) * kStringIndexEntrySize, fileSize) ||
+      !rangeValid(nodeTableOffset, quint64(nodeCount) * kNodeRecordSize,
+                  fileSize) ||
+      !rangeValid(configIndexOffset,
+                  quint64(nodeCount) * kConfigIndexEntrySize, fileSize) ||
+      !rangeValid(componentIdOffset, quint64(nodeCount) * kComponentIdSize,
+                  fileSize) ||
+      stringDataOffset > fileSize || configDataOffset > fileSize) {
+    setError(errorString, "项目文件已损坏");
+    return false;
+  }
+
+  // createRoot() 会清空整个项目树，包括字符串表和类型表，所以先按根节点
+  // 的记录创建根节点，再登记文件中的字符串
+  quint32 rootNameId = readUInt32(data + nodeTableOffset + 12);
+  QString rootName;
+  if (rootNameId >= stringCount ||
+      !readString(data, fileSize, stringIndexOffset, stringDataOffset,
+                  rootNameId, &rootName)) {
+    setError(errorString, "项目文件已损坏");
+    return false;
+  }
+  QVector<qint32> nodes(static_cast<int>(nodeCount), -1);
+  nodes[0] = tree->createRoot(rootName);
+  tree->reserve(static_cast<int>(nodeCount));
+
+  // 文件中的字符串直接登记到项目树的字符串表，节点之间共享同一个 QString
+  QVector<quint32> nameIds(static_cast<int>(stringCount));
+  for (quint32 i = 0; i < stringCount; ++i) {
+    QString value;
+    if (!readString(data, fileSize, stringIndexOffset, stringDataOffset, i,
+                    &value)) {
+      tree->clear();
+      setError(errorString, "项目文件已损坏");
+      return false;
+    }
+    nameIds[static_cast<int>(i)] = tree->internString(value);
+  }
+
+  // 类型编号只在首次用到时登记
+  QVector<int> typeIds(static_cast<int>(stringCount), -1);
+
+  for (quint32 i = 0; i < nodeCount; ++i) {
+    const uchar *record = data + nodeTableOffset + i * kNodeRecordSize;
+    qint32 parent = static_cast<qint32>(readUInt32(record));
+    quint32 nameId = readUInt32(record + 12);
+    quint32 typeId = readUInt32(record + 16);
+
+    // 节点按先序保存，父节点一定出现在子节点之前
+    bool valid = nameId < stringCount && typeId < stringCount &&
+                 (i == 0 ? parent == -1
+                         : parent >= 0 && quint32(parent) < i);
+    if (!valid) {
+      tree->clear();
+      setError(errorString, "项目文件已损坏");
+      return false;
+    }
+
+    // 配置段拷贝到项目树中，不在加载时解析
+    QByteArray config;
+    const uchar *entry = data + configIndexOffset + i * kConfigIndexEntrySize;
+    quint32 offset = readUInt32(entry);
+    quint32 length = readUInt32(entry + 4);
+    if (length > 0) {
+      if (!rangeValid(quint64(configDataOffset) + offset, length, fileSize)) {
+        tree->clear();
+        setError(errorString, "项目文件已损坏");
+        return false;
+      }
+      config = QByteArray(
+          reinterpret_cast<const char *>(data + configDataOffset + offset),
+          static_cast<int>(length));
+    }
+
+    if (i == 0) {
+      tree->setConfig(nodes[0], config);
+    } else {
+      int &type = typeIds[int(typeId)];
+      if (type < 0) {
+        type = tree->internType(tree->stringAt(nameIds[int(typeId)]));
+      }
+      nodes[int(i)] = tree->appendNode(nodes[parent], nameIds[int(nameId)],
+                                       quint16(type), config);
+    }
+
+    // 与前面节点重复的编号被拒绝，节点保留新分配的编号
+    tree->setComponentId(
+        nodes[int(i)],
+        readUInt64(data + componentIdOffset + i * kComponentIdSize));
+
+    if (loader && (i % kProgressInterval) == 0) {
+      if (loader->isCanceled()) {
+        tree->clear();
+        return false;
+      }
+      loader->reportProgress(i, nodeCount);
+    }
+  }
+
+  return true;
+}
+} // namespace
+
+bool ProjectBinaryFormat::write(QIODevice *device, const ProjectTree &tree,
+                                QString *errorString) {
+  if (tree.isEmpty()) {
+    setError(errorString, "项目为空");
+    return false;
+  }
+
+  QVector<NodeRecord> nodes;
+  QVector<QByteArray> configs;
+  QVector<quint64> ids;
+  StringTable strings;
+  nodes.reserve(tree.nodeCount());
+  configs.reserve(tree.nodeCount());
+  ids.reserve(tree.nodeCount());
+  collectNodes(tree, tree.rootNode(), -1, nodes, configs, ids, strings);
+
+  // 字符串索引和数据
+  QByteArray stringIndex;
+  QByteArray stringData;
+  const QVector<QString> &values = strings.strings();
+  stringIndex.reserve(values.size() * int(kStringIndexEntrySize));
+  for (const QString &value : values) {
+    QByteArray utf8 = value.toUtf8();
+    appendUInt32(stringIndex, static_cast<quint32>(stringData.size()));
+    appendUInt32(stringIndex, static_cast<quint32>(utf8.size()));
+    stringData.append(utf8);
+  }
+  // 保持节点表4字节对齐
+  while (stringData.size() % 4 != 0) {
+    stringData.append('\0');
+  }
+
+  QByteArray nodeTable;
+  nodeTable.reserve(nodes.size() * int(kNodeRecordSize));
+  for (const NodeRecord &node : nodes) {
+    appendUInt32(nodeTable, static_cast<quint32>(node.parent));
+    appendUInt32(nodeTable, static_cast<quint32>(node.firstChild));
+    appendUInt32(nodeTable, static_cast<quint32>(node.nextSibling));
+    appendUInt32(nodeTable, node.nameId);
+    appendUInt32(nodeTable, node.typeId);
+    appendUInt32(nodeTable, node.flags);
+  }
+
+  QByteArray configIndex;
+  QByteArray configData;
+  configIndex.reserve(configs.size() * int(kConfigIndexEntrySize));
+  for (const QByteArray &config : configs) {
+    appendUInt32(configIndex, static_cast<quint32>(configData.size()));
+    appendUInt32(configIndex, static_cast<quint32>(config.size()));
+    configData.append(config);
+  }
+
+  quint32 stringIndexOffset = kHeaderSize;
+  quint32 stringDataOffset = stringIndexOffset + stringIndex.size();
+  quint32 nodeTableOffset = stringDataOffset + stringData.size();
+  QByteArray idTable;
+  idTable.reserve(ids.size() * int(kComponentIdSize));
+  for (quint64 id : ids) {
+    appendUInt64(idTable, id);
+  }
+
+  // 编号表紧跟在节点表之后
+  quint32 componentIdOffset = nodeTableOffset + nodeTable.size();
+  quint32 configIndexOffset = componentIdOffset + idTable.size();
+  quint32 configDataOffset = configIndexOffset + configIndex.size();
+
+  QByteArray header;
+  header.append(kMagic, 4);
+  appendUInt16(header, CurrentVersion);
+  appendUInt16(header, static_cast<quint16>(kHeaderSize));
+  appendUInt32(header, static_cast<quint32>(nodes.size()));
+  appendUInt32(header, static_cast<quint32>(values.size()));
+  appendUInt32(header, stringIndexOffset);
+  appendUInt32(header, stringDataOffset);
+  appendUInt32(header, nodeTableOffset);
+  appendUInt32(header, configIndexOffset);
+  appendUInt32(header, configDataOffset);
+  appendUInt32(header, componentIdOffset);
+
+  if (device->write(header) != header.size() ||
+      device->write(stringIndex) != stringIndex.size() ||
+      device->write(stringData) != stringData.size() ||
+      device->write(nodeTable) != nodeTable.size() ||
+      device->write(idTable) != idTable.size() ||
+      device->write(configIndex) != configIndex.size() ||
+      device->write(configData) != configData.size()) {
+    setError(errorString, device->errorString());
+    return false;
+  }
+
+  return true;
+}
+
+bool ProjectBinaryFormat::read(const QString &path, ProjectTree *tree,
+                               QString *errorString, ProjectLoader *loader) {
+  tree->clear();
+
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    setError(errorString, file.errorString());
+    return false;
+  }
+
+  qint64 size = file.size();
+  if (size <= 0) {
+    setError(errorString, "不是有效的二进制项目文件");
+    return false;
+  }
+
+  bool ok = false;
+  uchar *data = file.map(0, size);
+  if (data) {
+    ok = parseImage(data, size, tree, errorString, loader);
+    file.unmap(data);
+  } else {
+    // 不支持内存映射的文件系统上退回到整体读取
+    QByteArray buffer = file.readAll();
+    ok = parseImage(reinterpret_cast<const uchar *>(buffer.constData()),
+                    buffer.size(), tree, errorString, loader);
+  }
+
+  file.close();
+  return ok;
+}
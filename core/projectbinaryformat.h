@@ -0,0 +1,40 @@
+#ifndef PROJECTBINARYFORMAT_H
+#define PROJECTBINARYFORMAT_H
+
+#include "projecttree.h"
+#include <QIODevice>
+#include <QString>
+
+class ProjectLoader;
+
+// 二进制项目文件格式 (.tfl)
+//
+// 文件由固定长度的文件头、字符串索引、字符串数据、节点表、编号表和配置段
+// 组成，所有整数均为小端序。重复出现的名称和类型(如 "LoopModule")在字符串
+// 表中只存一份，节点按先序排列并以定长记录保存。
+//
+//   文件头   magic "TFLP", version, headerSize, 各段的数量与偏移，共40字节
+//   字符串   {offset, length} 索引数组 + UTF-8 数据
+//   节点表   {parent, firstChild, nextSibling, nameId, typeId, flags}
+//   编号表   每个节点一个64位组件编号
+//   配置段   每个节点一个 {offset, length} 索引 + 原始配置数据
+//
+// 读取不是按需分页加载：文件只是映射后一次性完整解码，每个字符串都转换为
+// QString，每个节点的配置段都拷贝为独立的 QByteArray，加载耗时和内存都与
+// 文件大小成正比，映射只省去把整个文件读入缓冲区。与 XML 相比省去的是
+// 文本解析和重复字符串，配置段在加载时不解析。
+class ProjectBinaryFormat {
+public:
+  static const quint16 CurrentVersion = 1;
+
+  // 将项目树写入设备
+  static bool write(QIODevice *device, const ProjectTree &tree,
+                    QString *errorString = nullptr);
+
+  // 完整解码项目文件到 tree，失败或取消时 tree 为空
+  static bool read(const QString &path, ProjectTree *tree,
+                   QString *errorString = nullptr,
+                   ProjectLoader *loader = nullptr);
+};
+
+#endif // PROJECTBINARYFORMAT_H
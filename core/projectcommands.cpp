@@ -0,0 +1,525 @@
+#include "projectcommands.h"
+#include <QSet>
+
+namespace {
+qint64 deviceCost(const LoopDevice &device) {
+  // 类型名在模块间共享，不计入
+  return sizeof(LoopDevice) +
+         2 * (device.serialNumber.size() + device.personalityCode.size() +
+              device.description.size() + device.identifier.size() +
+              device.variableName.size());
+}
+
+bool sameRow(const LoopChannelDevices &a, int rowA,
+             const LoopChannelDevices &b, int rowB) {
+  return a.address(rowA) == b.address(rowB) &&
+         a.type(rowA) == b.type(rowB) &&
+         a.serialNumber(rowA) == b.serialNumber(rowB) &&
+         a.personalityCode(rowA) == b.personalityCode(rowB) &&
+         a.panelNumber(rowA) == b.panelNumber(rowB) &&
+         a.cardNumber(rowA) == b.cardNumber(rowB) &&
+         a.description(rowA) == b.description(rowB) &&
+         a.identifier(rowA) == b.identifier(rowB) &&
+         a.variableName(rowA) == b.variableName(rowB);
+}
+
+// 按先序读回 index 子树中各节点的组件编号，content 为 true 时同时读回
+// 名称和配置段，返回下一个节点在 nodes 中的位置
+int readBack(const ProjectModel *model, const QModelIndex &index,
+             QVector<ProjectModel::NodeSpec> *nodes, int position,
+             bool content) {
+  ProjectModel::NodeSpec &node = (*nodes)[position];
+  node.componentId = model->componentId(index);
+  if (content) {
+    node.name = model->nodeName(index);
+    node.config = model->nodeConfig(index);
+  }
+
+  int childCount = node.childCount;
+  ++position;
+  for (int row = 0; row < childCount && position < nodes->size(); ++row) {
+    position =
+        readBack(model, model->index(row, 0, index), nodes, position, content);
+  }
+  return position;
+}
+
+QVector<LoopDevice> deviceRange(const LoopChannelDevices &devices, int first,
+                                int count) {
+  QVector<LoopDevice> rows;
+  rows.reserve(count);
+  for (int row = first; row < first + count; ++row) {
+    rows.append(devices.device(row));
+  }
+  return rows;
+}
+} // namespace
+
+// ComponentSubtree
+
+bool ComponentSubtree::isEmpty() const { return nodes.isEmpty(); }
+
+qint64 ComponentSubtree::memoryCost() const {
+  qint64 cost = 0;
+  for (const Node &node : nodes) {
+    cost += sizeof(Node) + 2 * (node.name.size() + node.type.size()) +
+            node.config.size();
+  }
+  return cost;
+}
+
+ComponentSubtree ComponentSubtree::capture(const ProjectModel *model,
+                                           const QModelIndex &index) {
+  ComponentSubtree subtree;
+  if (index.isValid()) {
+    captureNode(model, index, &subtree.nodes);
+  }
+  return subtree;
+}
+
+void ComponentSubtree::captureNode(const ProjectModel *model,
+                                   const QModelIndex &index,
+                                   QVector<Node> *nodes) {
+  Node node;
+  node.name = model->nodeName(index);
+  node.type = model->nodeType(index);
+  node.config = model->nodeConfig(index);
+  node.componentId = model->componentId(index);
+  node.childCount = model->rowCount(index);
+  nodes->append(node);
+
+  for (int row = 0; row < node.childCount; ++row) {
+    captureNode(model, model->index(row, 0, index), nodes);
+  }
+}
+
+QModelIndex ComponentSubtree::restore(ProjectModel *model,
+                                      const QModelIndex &parent,
+                                      int row) const {
+  if (nodes.isEmpty()) {
+    return QModelIndex();
+  }
+  restoreNode(model, parent, row, 0);
+  return model->indexForComponentId(nodes.first().componentId);
+}
+
+int ComponentSubtree::restoreNode(ProjectModel *model,
+                                  const QModelIndex &parent, int row,
+                                  int position) const {
+  const Node &node = nodes.at(position);
+  QModelIndex index =
+      model->insertNode(parent, row, node.name, node.type, node.config);
+  if (node.componentId != 0) {
+    model->setComponentId(index, node.componentId);
+  }
+
+  ++position;
+  for (int child = 0; child < node.childCount; ++child) {
+    position = restoreNode(model, index, -1, position);
+  }
+  return position;
+}
+
+// SubtreeCommand
+
+SubtreeCommand::SubtreeCommand(const QString &text)
+    : UndoCommand(text), m_parentId(0), m_row(-1), m_componentId(0) {}
+
+qint64 SubtreeCommand::memoryCost() const {
+  return sizeof(*this) + m_subtree.memoryCost();
+}
+
+void SubtreeCommand::insertSubtree(UndoStack *stack) {
+  ProjectModel *model = stack->model();
+  QModelIndex parent = model->indexForComponentId(m_parentId);
+  if (!parent.isValid()) {
+    return;
+  }
+
+  QModelIndex index = m_subtree.restore(model, parent, m_row);
+  m_componentId = model->componentId(index);
+  m_row = index.row();
+  // 模块在下次访问时按恢复的配置段重新创建
+  m_subtree = ComponentSubtree();
+}
+
+void SubtreeCommand::removeSubtree(UndoStack *stack) {
+  ProjectModel *model = stack->model();
+  QModelIndex index = model->indexForComponentId(m_componentId);
+  if (!index.isValid()) {
+    return;
+  }
+
+  // 先写回模块中的修改，子树快照中才有最新的配置
+  stack->releaseModules(index);
+  m_parentId = model->componentId(index.parent());
+  m_row = index.row();
+  m_subtree = ComponentSubtree::capture(model, index);
+  model->removeNode(index);
+}
+
+// AddComponentCommand
+
+AddComponentCommand::AddComponentCommand(const QModelIndex &parent,
+                                         const QString &name,
+                                         const QString &type,
+                                         const ProjectModel *model)
+    : SubtreeCommand(QString("添加组件 %1").arg(name)) {
+  m_parentId = model->componentId(parent);
+  ComponentSubtree::Node node;
+  node.name = name;
+  node.type = type;
+  // 首次执行时由项目树分配组件编号
+  node.componentId = 0;
+  node.childCount = 0;
+  m_subtree.nodes.append(node);
+}
+
+void AddComponentCommand::redo(UndoStack *stack) { insertSubtree(stack); }
+
+void AddComponentCommand::undo(UndoStack *stack) { removeSubtree(stack); }
+
+quint64 AddComponentCommand::componentId() const { return m_componentId; }
+
+// AddComponentsCommand
+
+AddComponentsCommand::AddComponentsCommand(
+    const QString &text, const QModelIndex &parent, int row,
+    const QVector<ProjectModel::NodeSpec> &nodes, const ProjectModel *model)
+    : UndoCommand(text), m_parentId(model->componentId(parent)), m_row(row),
+      m_nodes(nodes) {}
+
+void AddComponentsCommand::redo(UndoStack *stack) {
+  ProjectModel *model = stack->model();
+  QModelIndex parent = model->indexForComponentId(m_parentId);
+  if (!parent.isValid()) {
+    return;
+  }
+
+  m_row = model->insertNodes(parent, m_row, m_nodes);
+  int position = 0;
+  for (int row = m_row; position < m_nodes.size(); ++row) {
+    position = readBack(model, model->index(row, 0, parent), &m_nodes,
+                        position, false);
+  }
+  // 模块在下次访问时按项目树中的配置段重新创建
+  for (ProjectModel::NodeSpec &node : m_nodes) {
+    node.config = QByteArray();
+  }
+}
+
+void AddComponentsCommand::undo(UndoStack *stack) {
+  ProjectModel *model = stack->model();
+  QModelIndex first = model->indexForComponentId(firstComponentId());
+  if (!first.isValid()) {
+    return;
+  }
+
+  // 之后的命令都已撤销，新组件仍连续排列在原来的位置
+  QModelIndex parent = first.parent();
+  m_parentId = model->componentId(parent);
+  m_row = first.row();
+  int count = ProjectModel::topLevelCount(m_nodes);
+  int position = 0;
+  for (int i = 0; i < count; ++i) {
+    QModelIndex index = model->index(m_row + i, 0, parent);
+    // 先写回模块中的修改，重做时才能恢复最新的配置
+    stack->releaseModules(index);
+    position = readBack(model, index, &m_nodes, position, true);
+  }
+  model->removeNodes(parent, m_row, count);
+}
+
+qint64 AddComponentsCommand::memoryCost() const {
+  qint64 cost = sizeof(*this);
+  for (const ProjectModel::NodeSpec &node : m_nodes) {
+    cost += sizeof(ProjectModel::NodeSpec) +
+            2 * (node.name.size() + node.type.size()) + node.config.size();
+  }
+  return cost;
+}
+
+quint64 AddComponentsCommand::firstComponentId() const {
+  return m_nodes.isEmpty() ? 0 : m_nodes.first().componentId;
+}
+
+// DeleteComponentCommand
+
+DeleteComponentCommand::DeleteComponentCommand(const QModelIndex &index,
+                                               const ProjectModel *model)
+    : SubtreeCommand(QString("删除组件 %1").arg(model->nodeName(index))) {
+  m_componentId = model->componentId(index);
+}
+
+void DeleteComponentCommand::redo(UndoStack *stack) { removeSubtree(stack); }
+
+void DeleteComponentCommand::undo(UndoStack *stack) { insertSubtree(stack); }
+
+// MoveComponentCommand
+
+MoveComponentCommand::MoveComponentCommand(const QString &text,
+                                           const QModelIndex &index,
+                                           const QModelIndex &newParent,
+                                           int row, const ProjectModel *model)
+    : UndoCommand(text), m_componentId(model->componentId(index)),
+      m_newParentId(model->componentId(newParent)), m_newRow(row),
+      m_oldParentId(0), m_oldRow(-1) {}
+
+void MoveComponentCommand::redo(UndoStack *stack) {
+  ProjectModel *model = stack->model();
+  QModelIndex index = model->indexForComponentId(m_componentId);
+  QModelIndex newParent = model->indexForComponentId(m_newParentId);
+  if (!index.isValid() || !newParent.isValid()) {
+    return;
+  }
+
+  m_oldParentId = model->componentId(index.parent());
+  m_oldRow = index.row();
+  model->moveNode(index, newParent, m_newRow);
+}
+
+void MoveComponentCommand::undo(UndoStack *stack) {
+  ProjectModel *model = stack->model();
+  QModelIndex index = model->indexForComponentId(m_componentId);
+  QModelIndex oldParent = model->indexForComponentId(m_oldParentId);
+  if (!index.isValid() || !oldParent.isValid()) {
+    return;
+  }
+
+  // moveNode 的目标行按移动前计算，同一父节点下向后移动时要跳过自身
+  int row = m_oldRow;
+  if (index.parent() == oldParent && index.row() < m_oldRow) {
+    ++row;
+  }
+  model->moveNode(index, oldParent, row);
+}
+
+qint64 MoveComponentCommand::memoryCost() const { return sizeof(*this); }
+
+// MoveComponentsCommand
+
+MoveComponentsCommand::MoveComponentsCommand(
+    const QString &text, const QList<quint64> &componentIds,
+    const QModelIndex &newParent, int row, const ProjectModel *model)
+    : UndoCommand(text) {
+  quint64 parentId = model->componentId(newParent);
+
+  // 插入位置之后第一个不参与移动的兄弟节点作为定位点
+  QSet<quint64> moving;
+  for (quint64 id : componentIds) {
+    moving.insert(id);
+  }
+  quint64 beforeId = 0;
+  if (row >= 0) {
+    for (int i = row; i < model->rowCount(newParent); ++i) {
+      quint64 id = model->componentId(model->index(i, 0, newParent));
+      if (!moving.contains(id)) {
+        beforeId = id;
+        break;
+      }
+    }
+  }
+
+  for (quint64 id : componentIds) {
+    Placement placement = {id, parentId, beforeId};
+    m_moves.append(placement);
+  }
+}
+
+void MoveComponentsCommand::redo(UndoStack *stack) {
+  m_undoMoves = apply(stack->model(), m_moves);
+}
+
+void MoveComponentsCommand::undo(UndoStack *stack) {
+  apply(stack->model(), m_undoMoves);
+}
+
+qint64 MoveComponentsCommand::memoryCost() const {
+  return sizeof(*this) +
+         sizeof(Placement) * (m_moves.size() + m_undoMoves.size());
+}
+
+QVector<MoveComponentsCommand::Placement>
+MoveComponentsCommand::apply(ProjectModel *model,
+                             const QVector<Placement> &placements) {
+  const ProjectTree &tree = model->tree();
+  QVector<ProjectModel::NodeMove> moves;
+  moves.reserve(placements.size());
+  for (const Placement &placement : placements) {
+    ProjectModel::NodeMove move = {
+        tree.nodeForComponentId(placement.componentId),
+        tree.nodeForComponentId(placement.parentId),
+        placement.beforeId != 0 ? tree.nodeForComponentId(placement.beforeId)
+                                : -1};
+    if (move.node >= 0 && move.parent >= 0) {
+      moves.append(move);
+    }
+  }
+
+  QVector<Placement> undoPlacements;
+  for (const ProjectModel::NodeMove &move : model->moveNodes(moves)) {
+    Placement placement = {tree.componentId(move.node),
+                           tree.componentId(move.parent),
+                           move.before >= 0 ? tree.componentId(move.before)
+                                            : 0};
+    undoPlacements.append(placement);
+  }
+  return undoPlacements;
+}
+
+// RenameComponentCommand
+
+RenameComponentCommand::RenameComponentCommand(const QModelIndex &index,
+                                               const QString &newName,
+                                               const ProjectModel *model)
+    : UndoCommand(QString("重命名 %1").arg(model->nodeName(index))),
+      m_componentId(model->componentId(index)),
+      m_oldName(model->nodeName(index)), m_newName(newName) {}
+
+void RenameComponentCommand::redo(UndoStack *stack) {
+  ProjectModel *model = stack->model();
+  model->setNodeName(model->indexForComponentId(m_componentId), m_newName);
+}
+
+void RenameComponentCommand::undo(UndoStack *stack) {
+  ProjectModel *model = stack->model();
+  model->setNodeName(model->indexForComponentId(m_componentId), m_oldName);
+}
+
+qint64 RenameComponentCommand::memoryCost() const {
+  return sizeof(*this) + 2 * (m_oldName.size() + m_newName.size());
+}
+
+// LoopSettings
+
+LoopSettings LoopSettings::of(const LoopModule *module) {
+  LoopSettings settings;
+  settings.channelCount = module->getChannelCount();
+  settings.loopMode = module->getLoopMode();
+  settings.initialized = module->isInitialized();
+  settings.mappingSupported = module->isMappingSupported();
+  return settings;
+}
+
+void LoopSettings::applyTo(LoopModule *module) const {
+  module->setChannelCount(channelCount);
+  module->setLoopMode(loopMode);
+  module->setInitialized(initialized);
+  module->setMappingSupported(mappingSupported);
+}
+
+bool LoopSettings::operator==(const LoopSettings &other) const {
+  return channelCount == other.channelCount && loopMode == other.loopMode &&
+         initialized == other.initialized &&
+         mappingSupported == other.mappingSupported;
+}
+
+bool LoopSettings::operator!=(const LoopSettings &other) const {
+  return !(*this == other);
+}
+
+// LoopModuleCommand
+
+LoopModuleCommand::LoopModuleCommand(const QString &text, quint64 componentId)
+    : UndoCommand(text), m_componentId(componentId), m_hasSettings(false) {}
+
+void LoopModuleCommand::setSettings(const LoopSettings &oldSettings,
+                                    const LoopSettings &newSettings) {
+  m_hasSettings = oldSettings != newSettings;
+  m_oldSettings = oldSettings;
+  m_newSettings = newSettings;
+}
+
+void LoopModuleCommand::addSplice(int channel, int first,
+                                  const QVector<LoopDevice> &oldRows,
+                                  const QVector<LoopDevice> &newRows) {
+  if (oldRows.isEmpty() && newRows.isEmpty()) {
+    return;
+  }
+
+  if (!m_splices.isEmpty()) {
+    Splice &last = m_splices.last();
+    if (last.channel == channel && last.oldRows.size() == last.newRows.size() &&
+        oldRows.size() == newRows.size() &&
+        last.first + last.newRows.size() == first) {
+      last.oldRows += oldRows;
+      last.newRows += newRows;
+      return;
+    }
+  }
+
+  Splice splice = {channel, first, oldRows, newRows};
+  m_splices.append(splice);
+}
+
+void LoopModuleCommand::addChannelDiff(int channel,
+                                       const LoopChannelDevices &before,
+                                       const LoopChannelDevices &after) {
+  int prefix = 0;
+  int common = qMin(before.size(), after.size());
+  while (prefix < common && sameRow(before, prefix, after, prefix)) {
+    ++prefix;
+  }
+
+  int suffix = 0;
+  while (suffix < common - prefix &&
+         sameRow(before, before.size() - 1 - suffix, after,
+                 after.size() - 1 - suffix)) {
+    ++suffix;
+  }
+
+  addSplice(channel, prefix,
+            deviceRange(before, prefix, before.size() - prefix - suffix),
+            deviceRange(after, prefix, after.size() - prefix - suffix));
+}
+
+bool LoopModuleCommand::isEmpty() const {
+  return !m_hasSettings && m_splices.isEmpty();
+}
+
+void LoopModuleCommand::redo(UndoStack *stack) {
+  LoopModule *module = qobject_cast<LoopModule *>(stack->module(m_componentId));
+  if (!module) {
+    return;
+  }
+
+  ModuleUpdateGuard<LoopModule> guard(module);
+  if (m_hasSettings) {
+    m_newSettings.applyTo(module);
+  }
+  for (const Splice &splice : m_splices) {
+    module->replaceDevices(splice.channel, splice.first, splice.oldRows.size(),
+                           splice.newRows);
+  }
+}
+
+void LoopModuleCommand::undo(UndoStack *stack) {
+  LoopModule *module = qobject_cast<LoopModule *>(stack->module(m_componentId));
+  if (!module) {
+    return;
+  }
+
+  ModuleUpdateGuard<LoopModule> guard(module);
+  for (int i = m_splices.size() - 1; i >= 0; --i) {
+    const Splice &splice = m_splices.at(i);
+    module->replaceDevices(splice.channel, splice.first, splice.newRows.size(),
+                           splice.oldRows);
+  }
+  if (m_hasSettings) {
+    m_oldSettings.applyTo(module);
+  }
+}
+
+qint64 LoopModuleCommand::memoryCost() const {
+  qint64 cost = sizeof(*this);
+  for (const Splice &splice : m_splices) {
+    cost += sizeof(Splice);
+    for (const LoopDevice &device : splice.oldRows) {
+      cost += deviceCost(device);
+    }
+    for (const LoopDevice &device : splice.newRows) {
+      cost += deviceCost(device);
+    }
+  }
+  return cost;
+}
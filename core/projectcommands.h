@@ -0,0 +1,358 @@
+#ifndef PROJECTCOMMANDS_H
+#define PROJECTCOMMANDS_H
+
+#include "dimodule.h"
+#include "domodule.h"
+#include "loopmodule.h"
+#include "moduleupdateguard.h"
+#include "undostack.h"
+#include <QVector>
+
+// 可合并命令的 mergeId
+enum ProjectCommandId { BitVariablesCommandId = 1 };
+
+// 组件子树的内容，按先序保存，用于删除后恢复和撤销添加后重做
+class ComponentSubtree {
+public:
+  bool isEmpty() const;
+  qint64 memoryCost() const;
+
+  // 读取 index 及其全部子节点
+  static ComponentSubtree capture(const ProjectModel *model,
+                                  const QModelIndex &index);
+  // 插入到 parent 的第 row 行，组件编号与保存时相同，返回子树根节点
+  QModelIndex restore(ProjectModel *model, const QModelIndex &parent,
+                      int row) const;
+
+  struct Node {
+    QString name;
+    QString type;
+    QByteArray config;
+    quint64 componentId;
+    int childCount;
+  };
+  QVector<Node> nodes;
+
+private:
+  static void captureNode(const ProjectModel *model, const QModelIndex &index,
+                          QVector<Node> *nodes);
+  int restoreNode(ProjectModel *model, const QModelIndex &parent, int row,
+                  int position) const;
+};
+
+// 添加和删除组件的公共部分：在某个父组件下插入或移除一棵子树
+class SubtreeCommand : public UndoCommand {
+public:
+  qint64 memoryCost() const override;
+
+protected:
+  explicit SubtreeCommand(const QString &text);
+
+  void insertSubtree(UndoStack *stack);
+  void removeSubtree(UndoStack *stack);
+
+  quint64 m_parentId;
+  int m_row;
+  quint64 m_componentId;
+  ComponentSubtree m_subtree;
+};
+
+class AddComponentCommand : public SubtreeCommand {
+public:
+  AddComponentCommand(const QModelIndex &parent, const QString &name,
+                      const QString &type, const ProjectModel *model);
+
+  void redo(UndoStack *stack) override;
+  void undo(UndoStack *stack) override;
+
+  quint64 componentId() const;
+};
+
+// 一次添加多个组件或子树，例如按数量添加同类模块、复制主机。整组只引起
+// 一次行插入通知，作为一步撤销。
+class AddComponentsCommand : public UndoCommand {
+public:
+  // nodes 按先序排列且组件编号为 0，row 为 -1 时追加到 parent 末尾
+  AddComponentsCommand(const QString &text, const QModelIndex &parent, int row,
+                       const QVector<ProjectModel::NodeSpec> &nodes,
+                       const ProjectModel *model);
+
+  void redo(UndoStack *stack) override;
+  void undo(UndoStack *stack) override;
+  qint64 memoryCost() const override;
+
+  // 第一个新组件的编号，执行前为 0
+  quint64 firstComponentId() const;
+
+private:
+  quint64 m_parentId;
+  int m_row;
+  // 首次执行后保存分配的组件编号，撤销时保存最新的名称和配置段
+  QVector<ProjectModel::NodeSpec> m_nodes;
+};
+
+class DeleteComponentCommand : public SubtreeCommand {
+public:
+  DeleteComponentCommand(const QModelIndex &index, const ProjectModel *model);
+
+  void redo(UndoStack *stack) override;
+  void undo(UndoStack *stack) override;
+};
+
+// 移动组件(连同子树)，也用于上移和下移
+class MoveComponentCommand : public UndoCommand {
+public:
+  // row 与 ProjectModel::moveNode 的含义相同
+  MoveComponentCommand(const QString &text, const QModelIndex &index,
+                       const QModelIndex &newParent, int row,
+                       const ProjectModel *model);
+
+  void redo(UndoStack *stack) override;
+  void undo(UndoStack *stack) override;
+  qint64 memoryCost() const override;
+
+private:
+  quint64 m_componentId;
+  quint64 m_newParentId;
+  int m_newRow;
+  quint64 m_oldParentId;
+  int m_oldRow;
+};
+
+// 一次移动多个组件，例如拖放多个选中的组件。作为一条命令撤销和重做。
+class MoveComponentsCommand : public UndoCommand {
+public:
+  // componentIds 按放置后的顺序排列，row 为 -1 时追加到 newParent 末尾
+  MoveComponentsCommand(const QString &text,
+                        const QList<quint64> &componentIds,
+                        const QModelIndex &newParent, int row,
+                        const ProjectModel *model);
+
+  void redo(UndoStack *stack) override;
+  void undo(UndoStack *stack) override;
+  qint64 memoryCost() const override;
+
+private:
+  // 以组件编号保存的 ProjectModel::NodeMove，节点被删除后恢复时编号不变
+  struct Placement {
+    quint64 componentId;
+    quint64 parentId;
+    quint64 beforeId;
+  };
+
+  static QVector<Placement>
+  apply(ProjectModel *model, const QVector<Placement> &placements);
+
+  QVector<Placement> m_moves;
+  QVector<Placement> m_undoMoves;
+};
+
+class RenameComponentCommand : public UndoCommand {
+public:
+  RenameComponentCommand(const QModelIndex &index, const QString &newName,
+                         const ProjectModel *model);
+
+  void redo(UndoStack *stack) override;
+  void undo(UndoStack *stack) override;
+  qint64 memoryCost() const override;
+
+private:
+  quint64 m_componentId;
+  QString m_oldName;
+  QString m_newName;
+};
+
+// 回路模块的参数
+struct LoopSettings {
+  int channelCount;
+  LoopMode loopMode;
+  bool initialized;
+  bool mappingSupported;
+
+  static LoopSettings of(const LoopModule *module);
+  void applyTo(LoopModule *module) const;
+  bool operator==(const LoopSettings &other) const;
+  bool operator!=(const LoopSettings &other) const;
+};
+
+// 回路模块的修改
+//
+// 设备列表的变化保存为若干段替换：某通道从 first 开始的 oldRows 被替换为
+// newRows。逐行编辑只记录改动的行，批量导入只记录新增的行，撤销时每段
+// 只需一次 replaceDevices()。
+class LoopModuleCommand : public UndoCommand {
+public:
+  LoopModuleCommand(const QString &text, quint64 componentId);
+
+  void setSettings(const LoopSettings &oldSettings,
+                   const LoopSettings &newSettings);
+  // 记录一段替换，与上一段相邻的等长替换会合并
+  void addSplice(int channel, int first, const QVector<LoopDevice> &oldRows,
+                 const QVector<LoopDevice> &newRows);
+  // 比较通道修改前后的设备列表，去掉首尾相同的行后记录中间的差异
+  void addChannelDiff(int channel, const LoopChannelDevices &before,
+                      const LoopChannelDevices &after);
+  bool isEmpty() const;
+
+  void redo(UndoStack *stack) override;
+  void undo(UndoStack *stack) override;
+  qint64 memoryCost() const override;
+
+private:
+  struct Splice {
+    int channel;
+    int first;
+    QVector<LoopDevice> oldRows;
+    QVector<LoopDevice> newRows;
+  };
+
+  quint64 m_componentId;
+  bool m_hasSettings;
+  LoopSettings m_oldSettings;
+  LoopSettings m_newSettings;
+  QVector<Splice> m_splices;
+};
+
+// DI/DO 位变量的修改，连续编辑同一个位时合并为一条命令
+template <typename Module, typename Variable>
+class BitVariablesCommand : public UndoCommand {
+public:
+  BitVariablesCommand(const QString &text, quint64 componentId)
+      : UndoCommand(text), m_componentId(componentId) {}
+
+  void addChange(int channel, int bit, const Variable &oldValue,
+                 const Variable &newValue) {
+    Change change = {channel, bit, oldValue, newValue};
+    m_changes.append(change);
+  }
+  bool isEmpty() const { return m_changes.isEmpty(); }
+
+  void redo(UndoStack *stack) override {
+    Module *module = qobject_cast<Module *>(stack->module(m_componentId));
+    if (!module) {
+      return;
+    }
+    ModuleUpdateGuard<Module> guard(module);
+    for (const Change &change : m_changes) {
+      module->setBitVariable(change.channel, change.bit, change.newValue);
+    }
+  }
+
+  void undo(UndoStack *stack) override {
+    Module *module = qobject_cast<Module *>(stack->module(m_componentId));
+    if (!module) {
+      return;
+    }
+    ModuleUpdateGuard<Module> guard(module);
+    for (int i = m_changes.size() - 1; i >= 0; --i) {
+      const Change &change = m_changes.at(i);
+      module->setBitVariable(change.channel, change.bit, change.oldValue);
+    }
+  }
+
+  qint64 memoryCost() const override {
+    qint64 cost = sizeof(*this);
+    for (const Change &change : m_changes) {
+      cost += sizeof(Change) +
+              2 * (change.oldValue.name.size() +
+                   change.oldValue.description.size() +
+                   change.newValue.name.size() +
+                   change.newValue.description.size());
+    }
+    return cost;
+  }
+
+  int mergeId() const override { return BitVariablesCommandId; }
+
+  bool mergeWith(const UndoCommand *other) override {
+    const BitVariablesCommand *command =
+        dynamic_cast<const BitVariablesCommand *>(other);
+    if (!command || command->m_componentId != m_componentId ||
+        m_changes.size() != 1 || command->m_changes.size() != 1) {
+      return false;
+    }
+    Change &last = m_changes.last();
+    const Change &change = command->m_changes.first();
+    if (change.channel != last.channel || change.bit != last.bit) {
+      return false;
+    }
+    last.newValue = change.newValue;
+    return true;
+  }
+
+private:
+  struct Change {
+    int channel;
+    int bit;
+    Variable oldValue;
+    Variable newValue;
+  };
+
+  quint64 m_componentId;
+  QVector<Change> m_changes;
+};
+
+typedef BitVariablesCommand<DIModule, DIBitVariable> DIBitVariablesCommand;
+typedef BitVariablesCommand<DOModule, DOBitVariable> DOBitVariablesCommand;
+
+// DI/DO 通道数量的修改
+//
+// 减少通道时模块会丢弃多出通道的位变量，这里在构造时保存下来，撤销时先恢复
+// 通道数量再写回，之后对这些通道的位变量命令也能正常撤销。
+template <typename Module, typename Variable>
+class ChannelCountCommand : public UndoCommand {
+public:
+  ChannelCountCommand(const QString &text, quint64 componentId,
+                      const Module *module, int newCount)
+      : UndoCommand(text), m_componentId(componentId),
+        m_oldCount(module->getChannelCount()), m_newCount(newCount) {
+    for (int channel = m_newCount; channel < m_oldCount; ++channel) {
+      for (int bit = 0; bit < 8; ++bit) {
+        m_droppedBits.append(module->getBitVariable(channel, bit));
+      }
+    }
+  }
+
+  bool isEmpty() const { return m_oldCount == m_newCount; }
+
+  void redo(UndoStack *stack) override {
+    Module *module = qobject_cast<Module *>(stack->module(m_componentId));
+    if (!module) {
+      return;
+    }
+    ModuleUpdateGuard<Module> guard(module);
+    module->setChannelCount(m_newCount);
+  }
+
+  void undo(UndoStack *stack) override {
+    Module *module = qobject_cast<Module *>(stack->module(m_componentId));
+    if (!module) {
+      return;
+    }
+    ModuleUpdateGuard<Module> guard(module);
+    module->setChannelCount(m_oldCount);
+    for (int i = 0; i < m_droppedBits.size(); ++i) {
+      module->setBitVariable(m_newCount + i / 8, i % 8, m_droppedBits.at(i));
+    }
+  }
+
+  qint64 memoryCost() const override {
+    qint64 cost = sizeof(*this);
+    for (const Variable &variable : m_droppedBits) {
+      cost += sizeof(Variable) +
+              2 * (variable.name.size() + variable.description.size());
+    }
+    return cost;
+  }
+
+private:
+  quint64 m_componentId;
+  int m_oldCount;
+  int m_newCount;
+  QVector<Variable> m_droppedBits; // 按通道和位的顺序排列
+};
+
+typedef ChannelCountCommand<DIModule, DIBitVariable> DIChannelCountCommand;
+typedef ChannelCountCommand<DOModule, DOBitVariable> DOChannelCountCommand;
+
+#endif // PROJECTCOMMANDS_H
@@ -0,0 +1,205 @@
+#include "projectexport.h"
+#include "downloadimagecompiler.h"
+#include "loopdevicecsv.h"
+#include "loopmodule.h"
+#include "moduleregistry.h"
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+namespace {
+// 组件名称中不能出现在文件名里的字符替换为下划线
+QString fileNamePart(const QString &name) {
+  QString result = name.trimmed();
+  for (QChar &c : result) {
+    if (c.isSpace() || QString("\\/:*?\"<>|").contains(c)) {
+      c = QLatin1Char('_');
+    }
+  }
+  return result.isEmpty() ? QString("_") : result;
+}
+
+// 按先序列出全部节点
+QVector<int> preorderNodes(const ProjectTree &tree) {
+  QVector<int> nodes;
+  nodes.reserve(tree.nodeCount());
+  QVector<int> stack;
+  if (!tree.isEmpty()) {
+    stack.append(tree.rootNode());
+  }
+  while (!stack.isEmpty()) {
+    int node = stack.takeLast();
+    nodes.append(node);
+    // 逆序入栈，出栈顺序与项目树一致
+    QVector<int> children;
+    for (int child = tree.firstChild(node); child >= 0;
+         child = tree.nextSibling(child)) {
+      children.append(child);
+    }
+    for (int i = children.size() - 1; i >= 0; --i) {
+      stack.append(children.at(i));
+    }
+  }
+  return nodes;
+}
+
+bool writeFile(const QString &path, const QByteArray &data,
+               QString *errorString) {
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() ||
+      !file.commit()) {
+    if (errorString) {
+      *errorString = QString("%1: %2").arg(path, file.errorString());
+    }
+    return false;
+  }
+  return true;
+}
+
+bool makeDirectory(const QString &directory, QString *errorString) {
+  if (QDir().mkpath(directory)) {
+    return true;
+  }
+  if (errorString) {
+    *errorString = QString("无法创建目录 %1").arg(directory);
+  }
+  return false;
+}
+} // namespace
+
+int ProjectExport::exportDevices(const ProjectTree &tree,
+                                 const QString &directory,
+                                 QString *errorString) {
+  if (!makeDirectory(directory, errorString)) {
+    return -1;
+  }
+
+  QDir dir(directory);
+  int fileCount = 0;
+  for (int node : preorderNodes(tree)) {
+    if (tree.type(node) != "LoopModule") {
+      continue;
+    }
+
+    // 文件名以所属主机开头，不同主机下的同名回路不会冲突
+    QString hostName;
+    for (int ancestor = tree.parentNode(node); ancestor >= 0;
+         ancestor = tree.parentNode(ancestor)) {
+      if (tree.type(ancestor) == "HostModule") {
+        hostName = tree.name(ancestor);
+        break;
+      }
+    }
+
+    QObject *module = ModuleRegistry::createModule(
+        tree.type(node), tree.config(node), tree.name(node));
+    LoopModule *loopModule = qobject_cast<LoopModule *>(module);
+    bool ok = true;
+    for (int channel = 0; ok && channel < loopModule->getChannelCount();
+         ++channel) {
+      const LoopChannelDevices &devices = loopModule->channelDevices(channel);
+      if (devices.isEmpty()) {
+        continue;
+      }
+
+      QString fileName = QString("%1_%2_ch%3.csv")
+                             .arg(fileNamePart(hostName))
+                             .arg(fileNamePart(tree.name(node)))
+                             .arg(channel + 1);
+      QSaveFile file(dir.filePath(fileName));
+      QString writeError;
+      ok = file.open(QIODevice::WriteOnly) &&
+           LoopDeviceCsv::write(&file, devices, &writeError) && file.commit();
+      if (!ok) {
+        if (errorString) {
+          *errorString = QString("%1: %2").arg(
+              file.fileName(),
+              writeError.isEmpty() ? file.errorString() : writeError);
+        }
+      } else {
+        ++fileCount;
+      }
+    }
+    delete module;
+    if (!ok) {
+      return -1;
+    }
+  }
+  return fileCount;
+}
+
+int ProjectExport::exportModules(const ProjectTree &tree,
+                                 const QString &directory,
+                                 QString *errorString) {
+  if (!makeDirectory(directory, errorString)) {
+    return -1;
+  }
+
+  QDir dir(directory);
+  int fileCount = 0;
+  for (int node : preorderNodes(tree)) {
+    QString type = tree.type(node);
+    if (!ModuleRegistry::supportsType(type)) {
+      continue;
+    }
+
+    // 重新序列化一次，没有保存配置的模块导出默认配置
+    QObject *module =
+        ModuleRegistry::createModule(type, tree.config(node), tree.name(node));
+    QJsonObject config =
+        QJsonDocument::fromJson(ModuleRegistry::serialize(module)).object();
+    delete module;
+
+    QJsonObject rootObj;
+    rootObj["componentId"] = QString::number(tree.componentId(node));
+    rootObj["name"] = tree.name(node);
+    rootObj["type"] = type;
+    rootObj["config"] = config;
+
+    QString fileName = QString("%1_%2.json")
+                           .arg(tree.componentId(node))
+                           .arg(fileNamePart(tree.name(node)));
+    if (!writeFile(dir.filePath(fileName), QJsonDocument(rootObj).toJson(),
+                   errorString)) {
+      return -1;
+    }
+    ++fileCount;
+  }
+  return fileCount;
+}
+
+int ProjectExport::exportImages(const ProjectTree &tree,
+                                const QString &directory,
+                                DownloadImageCompiler *compiler,
+                                QString *errorString) {
+  if (!makeDirectory(directory, errorString)) {
+    return -1;
+  }
+
+  QDir dir(directory);
+  int fileCount = 0;
+  for (const HostImage &image : compiler->compile(tree)) {
+    QString fileName = QString("%1_%2.bin")
+                           .arg(image.hostId)
+                           .arg(fileNamePart(image.hostName));
+
+    // 往返检查：镜像必须能解码，且解码结果重新编码后逐字节相同
+    DownloadImageContent content;
+    QString decodeError;
+    if (!DownloadImage::decode(image.image, &content, &decodeError) ||
+        DownloadImage::encode(content) != image.image) {
+      if (errorString) {
+        *errorString =
+            QString("%1: 镜像往返检查失败 %2").arg(fileName, decodeError);
+      }
+      return -1;
+    }
+
+    if (!writeFile(dir.filePath(fileName), image.image, errorString)) {
+      return -1;
+    }
+    ++fileCount;
+  }
+  return fileCount;
+}
@@ -0,0 +1,33 @@
+#ifndef PROJECTEXPORT_H
+#define PROJECTEXPORT_H
+
+#include "projecttree.h"
+#include <QString>
+
+class DownloadImageCompiler;
+
+// 项目内容导出
+//
+// 按项目树中保存的配置段导出，界面中已修改的模块应先写回项目树。导出时
+// 临时创建模块解析配置段，与界面使用的解析逻辑一致。
+class ProjectExport {
+public:
+  // 每个有设备的回路通道导出一个 CSV 文件，文件名为
+  // "<主机>_<回路>_ch<通道>.csv"。返回导出的文件数，失败时返回 -1。
+  static int exportDevices(const ProjectTree &tree, const QString &directory,
+                           QString *errorString = nullptr);
+
+  // 每个模块导出一个 JSON 文件，文件名为 "<组件编号>_<名称>.json"，
+  // 内容包括组件编号、名称、类型和完整的模块配置
+  static int exportModules(const ProjectTree &tree, const QString &directory,
+                           QString *errorString = nullptr);
+
+  // 每个主机导出一个下载镜像，文件名为 "<组件编号>_<主机名>.bin"。镜像
+  // 由 compiler 编译，内容未变的主机使用其缓存；写入前解码并重新编码，
+  // 结果不一致时视为失败。
+  static int exportImages(const ProjectTree &tree, const QString &directory,
+                          DownloadImageCompiler *compiler,
+                          QString *errorString = nullptr);
+};
+
+#endif // PROJECTEXPORT_H
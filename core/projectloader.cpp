@@ -0,0 +1,158 @@
+#include "projectloader.h"
+#include "projectbinaryformat.h"
+#include <QFile>
+#include <QFileInfo>
+
+namespace {
+// 每解析多少个元素检查一次进度，避免频繁发射信号
+const int kProgressInterval = 256;
+} // namespace
+
+ProjectLoader::ProjectLoader(const QString &path, QObject *parent)
+    : QThread(parent), m_path(path), m_canceled(0), m_lastPercent(-1),
+      m_elementCounter(0) {}
+
+ProjectLoader::~ProjectLoader() {
+  cancel();
+  wait();
+}
+
+QString ProjectLoader::path() const { return m_path; }
+
+void ProjectLoader::cancel() { m_canceled.storeRelease(1); }
+
+bool ProjectLoader::isCanceled() const { return m_canceled.loadAcquire() != 0; }
+
+ProjectTree ProjectLoader::takeResult() {
+  ProjectTree result = m_result;
+  m_result.clear();
+  return result;
+}
+
+QString ProjectLoader::errorString() const { return m_errorString; }
+
+bool ProjectLoader::isBinaryProjectFile(const QString &path) {
+  return QFileInfo(path).suffix().compare("tfl", Qt::CaseInsensitive) == 0;
+}
+
+void ProjectLoader::run() {
+  if (isBinaryProjectFile(m_path)) {
+    bool ok =
+        ProjectBinaryFormat::read(m_path, &m_result, &m_errorString, this);
+    if (ok && !isCanceled()) {
+      emit progressChanged(100);
+    }
+    return;
+  }
+
+  QFile file(m_path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    m_errorString = file.errorString();
+    return;
+  }
+
+  bool ok = parse(&file, &m_result, &m_errorString, this);
+  file.close();
+
+  if (ok && !isCanceled()) {
+    emit progressChanged(100);
+  }
+}
+
+void ProjectLoader::reportProgress(qint64 done, qint64 total) {
+  if (total <= 0) {
+    return;
+  }
+
+  int percent = static_cast<int>(done * 100 / total);
+  if (percent != m_lastPercent) {
+    m_lastPercent = percent;
+    emit progressChanged(percent);
+  }
+}
+
+bool ProjectLoader::parse(QIODevice *device, ProjectTree *tree,
+                          QString *errorString, ProjectLoader *loader) {
+  QXmlStreamReader reader(device);
+  tree->clear();
+
+  while (!reader.atEnd()) {
+    if (loader && loader->isCanceled()) {
+      break;
+    }
+
+    if (reader.readNextStartElement()) {
+      if (reader.name().toString() == "Project" && tree->isEmpty()) {
+        QString projectName = reader.attributes().value("name").toString();
+        int rootNode = tree->createRoot(projectName);
+
+        while (reader.readNextStartElement()) {
+          parseComponent(reader, tree, rootNode, loader, device);
+        }
+      }
+    }
+  }
+
+  if (loader && loader->isCanceled()) {
+    tree->clear();
+    return false;
+  }
+
+  if (reader.hasError() && tree->isEmpty()) {
+    if (errorString) {
+      *errorString = reader.errorString();
+    }
+    return false;
+  }
+
+  if (tree->isEmpty()) {
+    if (errorString) {
+      *errorString = "文件中没有找到项目节点";
+    }
+    return false;
+  }
+
+  return true;
+}
+
+void ProjectLoader::parseComponent(QXmlStreamReader &reader, ProjectTree *tree,
+                                   int parentNode, ProjectLoader *loader,
+                                   QIODevice *device) {
+  if (loader) {
+    if (loader->isCanceled()) {
+      // 取消时直接中断解析，外层循环会检测到取消状态
+      reader.raiseError("canceled");
+      return;
+    }
+    if (++loader->m_elementCounter % kProgressInterval == 0) {
+      loader->reportProgress(device->pos(), device->size());
+    }
+  }
+
+  if (reader.name().toString() == "Component") {
+    QString name = reader.attributes().value("name").toString();
+    QString type = reader.attributes().value("type").toString();
+
+    // 图标等依赖GUI的资源由模型按类型提供，这里只记录名称和类型
+    int node = tree->appendNode(parentNode, name, type);
+
+    // 旧版本的项目文件没有组件编号，使用新分配的编号。编号与前面的节点
+    // 重复时 setComponentId() 拒绝修改，节点同样保留新分配的编号
+    bool hasId = false;
+    quint64 id = reader.attributes().value("id").toULongLong(&hasId);
+    if (hasId) {
+      tree->setComponentId(node, id);
+    }
+
+    while (reader.readNextStartElement()) {
+      if (reader.name().toString() == "Config") {
+        // 只保存原始配置段，选中或配置该组件时才创建模块对象
+        tree->setConfig(node, reader.readElementText().toUtf8());
+      } else {
+        parseComponent(reader, tree, node, loader, device);
+      }
+    }
+  } else {
+    reader.skipCurrentElement();
+  }
+}
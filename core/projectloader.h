@@ -0,0 +1,61 @@
+#ifndef PROJECTLOADER_H
+#define PROJECTLOADER_H
+
+#include "projecttree.h"
+#include <QAtomicInt>
+#include <QIODevice>
+#include <QString>
+#include <QThread>
+#include <QXmlStreamReader>
+
+// 后台项目加载器
+// 在工作线程中解析项目文件，构建一棵尚未挂到任何模型上的独立项目树，
+// 完成后由 ProjectManager 在GUI线程中一次性替换到模型中。
+class ProjectLoader : public QThread {
+  Q_OBJECT
+
+public:
+  explicit ProjectLoader(const QString &path, QObject *parent = nullptr);
+  ~ProjectLoader();
+
+  QString path() const;
+
+  // 请求取消加载，可在任意线程调用
+  void cancel();
+  bool isCanceled() const;
+
+  // 加载成功后取走解析结果，失败或取消时返回空树
+  ProjectTree takeResult();
+  QString errorString() const;
+
+  // 报告已处理的数据量，只在百分比变化时发出信号
+  void reportProgress(qint64 done, qint64 total);
+
+  // 同步解析接口，loader 为空时不报告进度也不可取消
+  static bool parse(QIODevice *device, ProjectTree *tree, QString *errorString,
+                    ProjectLoader *loader = nullptr);
+
+  // 根据扩展名判断是否为二进制项目文件
+  static bool isBinaryProjectFile(const QString &path);
+
+signals:
+  // 加载进度，取值 0-100
+  void progressChanged(int percent);
+
+protected:
+  void run() override;
+
+private:
+  static void parseComponent(QXmlStreamReader &reader, ProjectTree *tree,
+                             int parentNode, ProjectLoader *loader,
+                             QIODevice *device);
+
+  QString m_path;
+  QAtomicInt m_canceled;
+  ProjectTree m_result;
+  QString m_errorString;
+  int m_lastPercent;
+  int m_elementCounter;
+};
+
+#endif // PROJECTLOADER_H
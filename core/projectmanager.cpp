@@ -0,0 +1,361 @@
+#include "projectmanager.h"
+#include "projectbinaryformat.h"
+#include "projectloader.h"
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+namespace {
+void setError(QString *errorString, const QString &message) {
+  if (errorString) {
+    *errorString = message;
+  }
+}
+} // namespace
+
+ProjectManager::ProjectManager(QObject *parent)
+    : QObject(parent), m_loader(nullptr), m_hasUnsavedChanges(false) {
+  m_model = new ProjectModel(this);
+  m_model->setHeaderLabel("项目结构");
+
+  // 跟踪每个主机子树的修改，保存时只重新序列化变化的部分
+  connect(m_model, &QAbstractItemModel::dataChanged, this,
+          &ProjectManager::onDataChanged);
+  connect(m_model, &QAbstractItemModel::rowsInserted, this,
+          &ProjectManager::onRowsInserted);
+  connect(m_model, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+          &ProjectManager::onRowsAboutToBeRemoved);
+  connect(m_model, &QAbstractItemModel::rowsAboutToBeMoved, this,
+          &ProjectManager::onRowsAboutToBeMoved);
+  connect(m_model, &QAbstractItemModel::layoutAboutToBeChanged, this,
+          &ProjectManager::onLayoutAboutToBeChanged);
+  connect(m_model, &QAbstractItemModel::modelReset, this,
+          &ProjectManager::onModelReset);
+}
+
+ProjectManager::~ProjectManager() {}
+
+bool ProjectManager::hasUnsavedChanges() const { return m_hasUnsavedChanges; }
+
+void ProjectManager::setUnsavedChanges(bool unsaved) {
+  m_hasUnsavedChanges = unsaved;
+}
+
+QString ProjectManager::currentProjectPath() const {
+  return m_currentProjectPath;
+}
+
+void ProjectManager::newProject(const QString &name, const QString &path) {
+  if (!path.isEmpty()) {
+    m_currentProjectPath = path + "/" + name + ".xml";
+  } else {
+    m_currentProjectPath.clear();
+  }
+  m_hasUnsavedChanges = true;
+
+  ProjectTree tree;
+  tree.createRoot(name);
+  m_model->setTree(tree);
+}
+
+bool ProjectManager::loadProject(const QString &path, QString *errorString) {
+  abandonLoad();
+
+  if (ProjectLoader::isBinaryProjectFile(path)) {
+    ProjectTree tree;
+    if (!ProjectBinaryFormat::read(path, &tree, errorString)) {
+      return false;
+    }
+    installProject(tree, path);
+    return true;
+  }
+
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    setError(errorString, file.errorString());
+    return false;
+  }
+
+  ProjectTree tree;
+  bool ok = ProjectLoader::parse(&file, &tree, errorString);
+  file.close();
+  if (!ok) {
+    return false;
+  }
+
+  installProject(tree, path);
+  return true;
+}
+
+void ProjectManager::loadProjectAsync(const QString &path) {
+  // 同一时间只保留一个加载任务，被替换的任务由新任务报告结果
+  abandonLoad();
+
+  m_loader = new ProjectLoader(path, this);
+  connect(m_loader, &ProjectLoader::progressChanged, this,
+          &ProjectManager::loadProgress);
+  connect(m_loader, &QThread::finished, this,
+          &ProjectManager::onLoaderFinished);
+  m_loader->start();
+}
+
+void ProjectManager::cancelLoad() {
+  if (abandonLoad()) {
+    emit loadFinished(false, "加载已取消");
+  }
+}
+
+bool ProjectManager::abandonLoad() {
+  if (!m_loader) {
+    return false;
+  }
+  // 已取消的加载器在线程结束后释放，结果会被丢弃
+  m_loader->cancel();
+  m_loader = nullptr;
+  return true;
+}
+
+bool ProjectManager::isLoading() const { return m_loader != nullptr; }
+
+void ProjectManager::onLoaderFinished() {
+  ProjectLoader *loader = qobject_cast<ProjectLoader *>(sender());
+  if (!loader) {
+    return;
+  }
+  loader->deleteLater();
+
+  if (loader != m_loader) {
+    // 已被取消或替换的加载任务
+    return;
+  }
+  m_loader = nullptr;
+
+  ProjectTree tree = loader->takeResult();
+  if (tree.isEmpty()) {
+    emit loadFinished(false, loader->errorString());
+    return;
+  }
+
+  installProject(tree, loader->path());
+  emit loadFinished(true, QString());
+}
+
+void ProjectManager::installProject(const ProjectTree &tree,
+                                    const QString &path) {
+  // 整棵树在后台构建完成，这里只做一次替换
+  m_model->setTree(tree);
+
+  m_currentProjectPath = path;
+  m_hasUnsavedChanges = false;
+}
+
+bool ProjectManager::saveProject(const QString &path, QString *errorString) {
+  // 先写入临时文件，提交时再原子替换，避免中途崩溃损坏原文件
+  QSaveFile file(path);
+
+  // 根据扩展名选择保存格式，XML 格式保留用于交换
+  bool binary = ProjectLoader::isBinaryProjectFile(path);
+  QIODevice::OpenMode mode = QIODevice::WriteOnly;
+  if (!binary) {
+    mode |= QIODevice::Text;
+  }
+  if (!file.open(mode)) {
+    setError(errorString, file.errorString());
+    return false;
+  }
+
+  // 写入前丢弃重命名和删除留下的旧名称
+  m_model->compactStrings();
+  QString writeError;
+  bool ok = binary ? ProjectBinaryFormat::write(&file, m_model->tree(),
+                                                &writeError)
+                   : writeXmlProject(&file);
+  if (!ok) {
+    setError(errorString,
+             writeError.isEmpty() ? file.errorString() : writeError);
+    file.cancelWriting();
+    return false;
+  }
+
+  if (!file.commit()) {
+    setError(errorString, file.errorString());
+    return false;
+  }
+  m_currentProjectPath = path;
+  m_hasUnsavedChanges = false;
+  return true;
+}
+
+bool ProjectManager::writeXmlProject(QIODevice *device) {
+  const ProjectTree &tree = m_model->tree();
+  if (tree.isEmpty()) {
+    QXmlStreamWriter writer(device);
+    writer.writeStartDocument();
+    writer.writeEndDocument();
+    return !writer.hasError();
+  }
+
+  // 文件头只包含项目名称，每次重新生成
+  QByteArray header;
+  {
+    QXmlStreamWriter writer(&header);
+    writer.setAutoFormatting(true);
+    writer.writeStartDocument();
+    writer.writeStartElement("Project");
+    writer.writeAttribute("name", tree.name(tree.rootNode()));
+    writer.writeCharacters(QString()); // 闭合开始标签
+  }
+
+  if (device->write(header) != header.size()) {
+    return false;
+  }
+
+  // 未修改的主机子树直接写出缓存的片段
+  for (int hostNode = tree.firstChild(tree.rootNode()); hostNode >= 0;
+       hostNode = tree.nextSibling(hostNode)) {
+    QHash<int, QByteArray>::const_iterator it =
+        m_fragmentCache.constFind(hostNode);
+    if (it == m_fragmentCache.constEnd()) {
+      it = m_fragmentCache.insert(hostNode, serializeSubtree(hostNode));
+    }
+
+    if (device->write(it.value()) != it.value().size()) {
+      return false;
+    }
+  }
+
+  QByteArray footer("\n</Project>\n");
+  return device->write(footer) == footer.size();
+}
+
+QByteArray ProjectManager::serializeSubtree(int node) {
+  // 每个片段单独起一行，拼接后仍保持可读的缩进
+  QByteArray fragment("\n");
+  QXmlStreamWriter writer(&fragment);
+  writer.setAutoFormatting(true);
+  saveItemToXml(writer, m_model->tree(), node);
+  return fragment;
+}
+
+int ProjectManager::hostNodeFor(const QModelIndex &index) const {
+  const ProjectTree &tree = m_model->tree();
+  int node = m_model->nodeForIndex(index);
+  if (node < 0 || node == tree.rootNode()) {
+    // 项目根节点本身不属于任何主机子树
+    return -1;
+  }
+
+  while (tree.parentNode(node) != tree.rootNode()) {
+    node = tree.parentNode(node);
+  }
+  return node;
+}
+
+void ProjectManager::markComponentDirty(const QModelIndex &index) {
+  int hostNode = hostNodeFor(index);
+  if (hostNode >= 0) {
+    m_fragmentCache.remove(hostNode);
+  }
+}
+
+void ProjectManager::onDataChanged(const QModelIndex &topLeft,
+                                   const QModelIndex &bottomRight,
+                                   const QVector<int> &roles) {
+  Q_UNUSED(bottomRight);
+  // 运行时状态只用于显示，不写入项目文件，不影响缓存
+  bool displayOnly = !roles.isEmpty();
+  for (int role : roles) {
+    if (role != ProjectModel::StatusRole && role != Qt::ToolTipRole) {
+      displayOnly = false;
+      break;
+    }
+  }
+  if (displayOnly) {
+    return;
+  }
+  // 模型每次只修改一个节点
+  markComponentDirty(topLeft);
+}
+
+void ProjectManager::onRowsInserted(const QModelIndex &parent, int first,
+                                    int last) {
+  Q_UNUSED(first);
+  Q_UNUSED(last);
+  // 直接插入到根节点下的是新主机，没有缓存，无需处理
+  markComponentDirty(parent);
+}
+
+void ProjectManager::onRowsAboutToBeRemoved(const QModelIndex &parent,
+                                            int first, int last) {
+  if (!parent.isValid()) {
+    m_fragmentCache.clear();
+    return;
+  }
+
+  if (!parent.parent().isValid()) {
+    // 删除主机本身时丢弃其缓存，防止之后的新节点复用同一编号
+    for (int row = first; row <= last; ++row) {
+      m_fragmentCache.remove(
+          m_model->nodeForIndex(m_model->index(row, 0, parent)));
+    }
+    return;
+  }
+
+  markComponentDirty(parent);
+}
+
+void ProjectManager::onRowsAboutToBeMoved(const QModelIndex &sourceParent,
+                                          int sourceStart, int sourceEnd,
+                                          const QModelIndex &destinationParent,
+                                          int destinationRow) {
+  Q_UNUSED(sourceStart);
+  Q_UNUSED(sourceEnd);
+  Q_UNUSED(destinationRow);
+  // 主机之间调整顺序时片段本身不变，写出时按新的顺序拼接
+  markComponentDirty(sourceParent);
+  markComponentDirty(destinationParent);
+}
+
+void ProjectManager::onLayoutAboutToBeChanged(
+    const QList<QPersistentModelIndex> &parents,
+    QAbstractItemModel::LayoutChangeHint hint) {
+  Q_UNUSED(hint);
+  // parents 为布局变化涉及的父节点
+  for (const QPersistentModelIndex &parent : parents) {
+    markComponentDirty(parent);
+  }
+}
+
+void ProjectManager::onModelReset() { m_fragmentCache.clear(); }
+
+ProjectModel *ProjectManager::projectModel() { return m_model; }
+
+void ProjectManager::renameProject(const QString &newName) {
+  if (m_model->rowCount() > 0) {
+    m_model->setNodeName(m_model->rootIndex(), newName);
+    m_hasUnsavedChanges = true;
+  }
+}
+
+void ProjectManager::saveItemToXml(QXmlStreamWriter &writer,
+                                   const ProjectTree &tree, int node) {
+  writer.writeStartElement("Component");
+  writer.writeAttribute("name", tree.name(node));
+  writer.writeAttribute("type", tree.type(node));
+  writer.writeAttribute("id", QString::number(tree.componentId(node)));
+
+  // 配置段原样写回，未被打开过的组件不需要解析
+  QByteArray config = tree.config(node);
+  if (!config.isEmpty()) {
+    writer.writeStartElement("Config");
+    writer.writeCDATA(QString::fromUtf8(config));
+    writer.writeEndElement();
+  }
+
+  for (int child = tree.firstChild(node); child >= 0;
+       child = tree.nextSibling(child)) {
+    saveItemToXml(writer, tree, child);
+  }
+
+  writer.writeEndElement();
+}
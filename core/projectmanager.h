@@ -0,0 +1,79 @@
+#ifndef PROJECTMANAGER_H
+#define PROJECTMANAGER_H
+
+#include "projectmodel.h"
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+class ProjectLoader;
+
+class ProjectManager : public QObject {
+  Q_OBJECT
+
+public:
+  explicit ProjectManager(QObject *parent = nullptr);
+  ~ProjectManager();
+
+  bool hasUnsavedChanges() const;
+  void setUnsavedChanges(bool unsaved);
+  QString currentProjectPath() const;
+
+  void newProject(const QString &name, const QString &path = QString());
+  // 在当前线程加载项目，失败时项目保持不变
+  bool loadProject(const QString &path, QString *errorString = nullptr);
+  // 在后台线程加载项目，完成后发出 loadFinished 信号
+  void loadProjectAsync(const QString &path);
+  // 用户取消后台加载，发出 loadFinished(false, ...)
+  void cancelLoad();
+  bool isLoading() const;
+  // 保存成功后 path 成为当前项目路径，失败时原文件保持不变
+  bool saveProject(const QString &path, QString *errorString = nullptr);
+  void renameProject(const QString &newName);
+
+  ProjectModel *projectModel();
+
+  // 标记节点所在的主机子树已修改，下次保存时重新序列化
+  void markComponentDirty(const QModelIndex &index);
+
+signals:
+  void loadProgress(int percent);
+  void loadFinished(bool success, const QString &errorString);
+
+private slots:
+  void onLoaderFinished();
+  void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                     const QVector<int> &roles);
+  void onRowsInserted(const QModelIndex &parent, int first, int last);
+  void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+  void onRowsAboutToBeMoved(const QModelIndex &sourceParent, int sourceStart,
+                            int sourceEnd, const QModelIndex &destinationParent,
+                            int destinationRow);
+  void onLayoutAboutToBeChanged(
+      const QList<QPersistentModelIndex> &parents,
+      QAbstractItemModel::LayoutChangeHint hint);
+  void onModelReset();
+
+private:
+  void saveItemToXml(QXmlStreamWriter &writer, const ProjectTree &tree,
+                     int node);
+  bool writeXmlProject(QIODevice *device);
+  QByteArray serializeSubtree(int node);
+  int hostNodeFor(const QModelIndex &index) const;
+  void installProject(const ProjectTree &tree, const QString &path);
+  // 丢弃正在进行的后台加载，不发出 loadFinished，返回是否有加载被丢弃
+  bool abandonLoad();
+
+  ProjectModel *m_model;
+  ProjectLoader *m_loader;
+  QString m_currentProjectPath;
+  bool m_hasUnsavedChanges;
+
+  // 每个主机子树已序列化的 XML 片段，按主机节点编号索引
+  QHash<int, QByteArray> m_fragmentCache;
+};
+
+#endif // PROJECTMANAGER_H
@@ -0,0 +1,620 @@
+#include "projectmodel.h"
+#include <QDataStream>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+const char kComponentMimeType[] = "application/x-controlleride-components";
+
+// 节点从根开始的行号路径，按字典序比较即为在树中的先后顺序
+QVector<int> nodePath(const ProjectTree &tree, int node) {
+  QVector<int> path;
+  for (; node >= 0; node = tree.parentNode(node)) {
+    path.prepend(tree.rowOf(node));
+  }
+  return path;
+}
+
+// 与 ProjectTree::moveNodeBefore() 的检查相同，不能执行的移动被跳过
+bool isValidMove(const ProjectTree &tree, const ProjectModel::NodeMove &move) {
+  if (!tree.isValidNode(move.node) || !tree.isValidNode(move.parent) ||
+      move.node == tree.rootNode() || move.before == move.node) {
+    return false;
+  }
+  if (move.before >= 0 && (!tree.isValidNode(move.before) ||
+                           tree.parentNode(move.before) != move.parent)) {
+    return false;
+  }
+  for (int ancestor = move.parent; ancestor >= 0;
+       ancestor = tree.parentNode(ancestor)) {
+    if (ancestor == move.node) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+ProjectModel::ProjectModel(QObject *parent) : QAbstractItemModel(parent) {}
+
+QModelIndex ProjectModel::index(int row, int column,
+                                const QModelIndex &parent) const {
+  if (column != 0 || row < 0) {
+    return QModelIndex();
+  }
+
+  if (!parent.isValid()) {
+    if (row != 0 || m_tree.isEmpty()) {
+      return QModelIndex();
+    }
+    return createIndex(0, 0, quintptr(m_tree.rootNode()));
+  }
+
+  int child = m_tree.childAt(nodeForIndex(parent), row);
+  if (child < 0) {
+    return QModelIndex();
+  }
+  return createIndex(row, 0, quintptr(child));
+}
+
+QModelIndex ProjectModel::parent(const QModelIndex &child) const {
+  int parentNode = m_tree.parentNode(nodeForIndex(child));
+  if (parentNode < 0) {
+    return QModelIndex();
+  }
+  return createIndex(m_tree.rowOf(parentNode), 0, quintptr(parentNode));
+}
+
+int ProjectModel::rowCount(const QModelIndex &parent) const {
+  if (parent.column() > 0) {
+    return 0;
+  }
+
+  if (!parent.isValid()) {
+    return m_tree.isEmpty() ? 0 : 1;
+  }
+  return m_tree.childCount(nodeForIndex(parent));
+}
+
+int ProjectModel::columnCount(const QModelIndex &parent) const {
+  Q_UNUSED(parent);
+  return 1;
+}
+
+QVariant ProjectModel::data(const QModelIndex &index, int role) const {
+  int node = nodeForIndex(index);
+  if (node < 0) {
+    return QVariant();
+  }
+
+  switch (role) {
+  case Qt::DisplayRole:
+  case Qt::EditRole:
+    return m_tree.name(node);
+  case Qt::DecorationRole:
+    return decorationFor(node);
+  case TypeRole:
+    return m_tree.type(node);
+  case ConfigRole:
+    return m_tree.config(node);
+  case ComponentIdRole:
+    return QVariant::fromValue(m_tree.componentId(node));
+  case StatusRole:
+  case Qt::ToolTipRole: {
+    QString status = m_statuses.value(m_tree.componentId(node));
+    return status.isEmpty() ? QVariant() : QVariant(status);
+  }
+  default:
+    return QVariant();
+  }
+}
+
+bool ProjectModel::setData(const QModelIndex &index, const QVariant &value,
+                           int role) {
+  int node = nodeForIndex(index);
+  if (node < 0) {
+    return false;
+  }
+
+  if (role == Qt::EditRole || role == Qt::DisplayRole) {
+    QString name = value.toString();
+    if (name == m_tree.name(node)) {
+      return true;
+    }
+    m_tree.setName(node, name);
+    emit dataChanged(index, index,
+                     QVector<int>() << Qt::DisplayRole << Qt::EditRole);
+    return true;
+  }
+
+  if (role == ConfigRole) {
+    QByteArray config = value.toByteArray();
+    if (config == m_tree.config(node)) {
+      return true;
+    }
+    m_tree.setConfig(node, config);
+    emit dataChanged(index, index, QVector<int>() << ConfigRole);
+    return true;
+  }
+
+  if (role == ComponentIdRole) {
+    quint64 id = value.toULongLong();
+    if (id == m_tree.componentId(node)) {
+      return true;
+    }
+    // 编号必须在项目内唯一
+    if (!m_tree.setComponentId(node, id)) {
+      return false;
+    }
+    emit dataChanged(index, index, QVector<int>() << ComponentIdRole);
+    return true;
+  }
+
+  return false;
+}
+
+Qt::ItemFlags ProjectModel::flags(const QModelIndex &index) const {
+  if (!index.isValid()) {
+    return Qt::NoItemFlags;
+  }
+
+  Qt::ItemFlags itemFlags = Qt::ItemIsEnabled | Qt::ItemIsSelectable |
+                            Qt::ItemIsEditable | Qt::ItemIsDropEnabled;
+  // 项目根节点不能拖动
+  if (nodeForIndex(index) != m_tree.rootNode()) {
+    itemFlags |= Qt::ItemIsDragEnabled;
+  }
+  return itemFlags;
+}
+
+Qt::DropActions ProjectModel::supportedDropActions() const {
+  return Qt::MoveAction;
+}
+
+QStringList ProjectModel::mimeTypes() const {
+  return QStringList() << QString(kComponentMimeType);
+}
+
+QMimeData *ProjectModel::mimeData(const QModelIndexList &indexes) const {
+  QSet<int> selected;
+  for (const QModelIndex &index : indexes) {
+    int node = nodeForIndex(index);
+    if (node >= 0 && node != m_tree.rootNode()) {
+      selected.insert(node);
+    }
+  }
+
+  // 祖先也被选中的节点随祖先一起移动，其余按在树中的顺序排列
+  QVector<QPair<QVector<int>, quint64>> ordered;
+  for (int node : selected) {
+    bool coveredByAncestor = false;
+    for (int ancestor = m_tree.parentNode(node); ancestor >= 0;
+         ancestor = m_tree.parentNode(ancestor)) {
+      if (selected.contains(ancestor)) {
+        coveredByAncestor = true;
+        break;
+      }
+    }
+    if (!coveredByAncestor) {
+      ordered.append(
+          qMakePair(nodePath(m_tree, node), m_tree.componentId(node)));
+    }
+  }
+  std::sort(ordered.begin(), ordered.end());
+
+  QByteArray encoded;
+  QDataStream stream(&encoded, QIODevice::WriteOnly);
+  for (const auto &item : ordered) {
+    stream << item.second;
+  }
+
+  QMimeData *data = new QMimeData();
+  data->setData(QString(kComponentMimeType), encoded);
+  return data;
+}
+
+bool ProjectModel::canDropMimeData(const QMimeData *data,
+                                   Qt::DropAction action, int row, int column,
+                                   const QModelIndex &parent) const {
+  Q_UNUSED(row);
+  Q_UNUSED(column);
+  int parentNode = nodeForIndex(parent);
+  if (action != Qt::MoveAction || parentNode < 0 ||
+      !data->hasFormat(QString(kComponentMimeType))) {
+    return false;
+  }
+
+  QList<quint64> ids = componentIds(data);
+  if (ids.isEmpty()) {
+    return false;
+  }
+  for (quint64 id : ids) {
+    int node = m_tree.nodeForComponentId(id);
+    if (node < 0 || node == m_tree.rootNode()) {
+      return false;
+    }
+    // 不能放到被拖动组件自身的子树中
+    for (int ancestor = parentNode; ancestor >= 0;
+         ancestor = m_tree.parentNode(ancestor)) {
+      if (ancestor == node) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool ProjectModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
+                                int row, int column,
+                                const QModelIndex &parent) {
+  if (!canDropMimeData(data, action, row, column, parent)) {
+    return false;
+  }
+
+  // 模型没有实现 removeRows()，视图在拖动结束后不会删除源行
+  emit moveRequested(componentIds(data), parent, row);
+  return true;
+}
+
+QVariant ProjectModel::headerData(int section, Qt::Orientation orientation,
+                                  int role) const {
+  if (section == 0 && orientation == Qt::Horizontal &&
+      role == Qt::DisplayRole) {
+    return m_headerLabel;
+  }
+  return QVariant();
+}
+
+const ProjectTree &ProjectModel::tree() const { return m_tree; }
+
+void ProjectModel::setTree(const ProjectTree &tree) {
+  beginResetModel();
+  m_tree = tree;
+  m_tree.compactStrings();
+  m_decorationCache.clear();
+  m_statuses.clear();
+  endResetModel();
+}
+
+void ProjectModel::clear() { setTree(ProjectTree()); }
+
+void ProjectModel::compactStrings() { m_tree.compactStrings(); }
+
+void ProjectModel::setHeaderLabel(const QString &label) {
+  m_headerLabel = label;
+  emit headerDataChanged(Qt::Horizontal, 0, 0);
+}
+
+void ProjectModel::setTypeDecoration(const QString &type,
+                                     const QVariant &decoration) {
+  m_typeDecorations.insert(type, decoration);
+  m_decorationCache.clear();
+}
+
+QModelIndex ProjectModel::rootIndex() const { return index(0, 0); }
+
+QModelIndex ProjectModel::indexForNode(int node) const {
+  if (!m_tree.isValidNode(node)) {
+    return QModelIndex();
+  }
+  return createIndex(m_tree.rowOf(node), 0, quintptr(node));
+}
+
+int ProjectModel::nodeForIndex(const QModelIndex &index) const {
+  if (!index.isValid() || index.model() != this) {
+    return -1;
+  }
+
+  int node = static_cast<int>(index.internalId());
+  return m_tree.isValidNode(node) ? node : -1;
+}
+
+QModelIndex ProjectModel::appendNode(const QModelIndex &parent,
+                                     const QString &name, const QString &type,
+                                     const QByteArray &config) {
+  int parentNode = nodeForIndex(parent);
+  if (parentNode < 0) {
+    return QModelIndex();
+  }
+
+  return insertNode(parent, m_tree.childCount(parentNode), name, type, config);
+}
+
+QModelIndex ProjectModel::insertNode(const QModelIndex &parent, int row,
+                                     const QString &name, const QString &type,
+                                     const QByteArray &config) {
+  int parentNode = nodeForIndex(parent);
+  if (parentNode < 0) {
+    return QModelIndex();
+  }
+
+  int childCount = m_tree.childCount(parentNode);
+  if (row < 0 || row > childCount) {
+    row = childCount;
+  }
+  beginInsertRows(parent, row, row);
+  int node = m_tree.insertNode(parentNode, row, name, type, config);
+  endInsertRows();
+
+  return createIndex(row, 0, quintptr(node));
+}
+
+bool ProjectModel::removeNode(const QModelIndex &index) {
+  int node = nodeForIndex(index);
+  if (node < 0) {
+    return false;
+  }
+
+  int row = m_tree.rowOf(node);
+  QModelIndex parentIndex = parent(index);
+  beginRemoveRows(parentIndex, row, row);
+  m_tree.removeNode(node);
+  endRemoveRows();
+  return true;
+}
+
+int ProjectModel::insertNodes(const QModelIndex &parent, int row,
+                              const QVector<NodeSpec> &nodes) {
+  int parentNode = nodeForIndex(parent);
+  if (parentNode < 0 || nodes.isEmpty()) {
+    return -1;
+  }
+
+  int childCount = m_tree.childCount(parentNode);
+  if (row < 0 || row > childCount) {
+    row = childCount;
+  }
+  // 只在开始时定位一次，之后都插入到同一个节点之前
+  int before = row < childCount ? m_tree.childAt(parentNode, row) : -1;
+
+  // 新节点的子节点在视图取得父节点之前就已就位，不需要单独通知
+  beginInsertRows(parent, row, row + topLevelCount(nodes) - 1);
+  int position = 0;
+  while (position < nodes.size()) {
+    position = insertSubtree(parentNode, before, nodes, position);
+  }
+  endInsertRows();
+  return row;
+}
+
+int ProjectModel::topLevelCount(const QVector<NodeSpec> &nodes) {
+  int count = 0;
+  int pending = 0;
+  for (const NodeSpec &node : nodes) {
+    if (pending == 0) {
+      ++count;
+    } else {
+      --pending;
+    }
+    pending += node.childCount;
+  }
+  return count;
+}
+
+int ProjectModel::insertSubtree(int parentNode, int before,
+                                const QVector<NodeSpec> &nodes,
+                                int position) {
+  const NodeSpec &spec = nodes.at(position);
+  int node = m_tree.insertNodeBefore(parentNode, before, spec.name, spec.type,
+                                     spec.config);
+  // 直接写入项目树，不为每个节点发出 dataChanged
+  if (spec.componentId != 0) {
+    m_tree.setComponentId(node, spec.componentId);
+  }
+
+  ++position;
+  for (int child = 0; child < spec.childCount && position < nodes.size();
+       ++child) {
+    position = insertSubtree(node, -1, nodes, position);
+  }
+  return position;
+}
+
+bool ProjectModel::removeNodes(const QModelIndex &parent, int row,
+                               int count) {
+  int parentNode = nodeForIndex(parent);
+  if (parentNode < 0 || row < 0 || count <= 0 ||
+      row + count > m_tree.childCount(parentNode)) {
+    return false;
+  }
+
+  QVector<int> nodes;
+  nodes.reserve(count);
+  for (int node = m_tree.childAt(parentNode, row); nodes.size() < count;
+       node = m_tree.nextSibling(node)) {
+    nodes.append(node);
+  }
+
+  beginRemoveRows(parent, row, row + count - 1);
+  // 从后往前删除，删除的是末尾的行时行号缓存一直有效
+  for (int i = nodes.size() - 1; i >= 0; --i) {
+    m_tree.removeNode(nodes.at(i));
+  }
+  endRemoveRows();
+  return true;
+}
+
+bool ProjectModel::moveNode(const QModelIndex &index,
+                            const QModelIndex &newParent, int row) {
+  int node = nodeForIndex(index);
+  int parentNode = nodeForIndex(newParent);
+  if (node < 0 || parentNode < 0 || node == m_tree.rootNode()) {
+    return false;
+  }
+
+  // 不能移动到自身的子树中
+  for (int ancestor = parentNode; ancestor >= 0;
+       ancestor = m_tree.parentNode(ancestor)) {
+    if (ancestor == node) {
+      return false;
+    }
+  }
+
+  int childCount = m_tree.childCount(parentNode);
+  if (row < 0 || row > childCount) {
+    row = childCount;
+  }
+
+  int sourceRow = m_tree.rowOf(node);
+  QModelIndex sourceParent = parent(index);
+  if (!beginMoveRows(sourceParent, sourceRow, sourceRow, newParent, row)) {
+    // 移动到原位置
+    return false;
+  }
+
+  // ProjectTree 的目标行不计节点自身
+  int treeRow = row;
+  if (m_tree.parentNode(node) == parentNode && row > sourceRow) {
+    --treeRow;
+  }
+  m_tree.moveNode(node, parentNode, treeRow);
+  endMoveRows();
+  return true;
+}
+
+QVector<ProjectModel::NodeMove>
+ProjectModel::moveNodes(const QVector<NodeMove> &moves) {
+  QVector<NodeMove> undoMoves;
+
+  int first = 0;
+  while (first < moves.size()) {
+    const NodeMove &move = moves.at(first);
+    if (!isValidMove(m_tree, move)) {
+      ++first;
+      continue;
+    }
+
+    // 移到同一位置的相邻兄弟节点合并为一次行移动，依次移到 before 之前
+    // 与整段移动的结果相同
+    int lastNode = move.node;
+    int end = first + 1;
+    while (end < moves.size()) {
+      const NodeMove &next = moves.at(end);
+      if (next.parent != move.parent || next.before != move.before ||
+          next.node != m_tree.nextSibling(lastNode) ||
+          !isValidMove(m_tree, next)) {
+        break;
+      }
+      lastNode = next.node;
+      ++end;
+    }
+
+    int sourceParent = m_tree.parentNode(move.node);
+    int destinationRow = move.before >= 0 ? m_tree.rowOf(move.before)
+                                          : m_tree.childCount(move.parent);
+    // 原地不动时 beginMoveRows() 返回 false，不需要还原
+    if (beginMoveRows(indexForNode(sourceParent), m_tree.rowOf(move.node),
+                      m_tree.rowOf(lastNode), indexForNode(move.parent),
+                      destinationRow)) {
+      for (int i = first; i < end; ++i) {
+        int node = moves.at(i).node;
+        NodeMove undoMove = {node, m_tree.parentNode(node),
+                             m_tree.nextSibling(node)};
+        m_tree.moveNodeBefore(node, move.parent, move.before);
+        undoMoves.append(undoMove);
+      }
+      endMoveRows();
+    }
+    first = end;
+  }
+
+  std::reverse(undoMoves.begin(), undoMoves.end());
+  return undoMoves;
+}
+
+QString ProjectModel::nodeName(const QModelIndex &index) const {
+  return m_tree.name(nodeForIndex(index));
+}
+
+QString ProjectModel::nodeType(const QModelIndex &index) const {
+  return m_tree.type(nodeForIndex(index));
+}
+
+QByteArray ProjectModel::nodeConfig(const QModelIndex &index) const {
+  return m_tree.config(nodeForIndex(index));
+}
+
+quint64 ProjectModel::componentId(const QModelIndex &index) const {
+  return m_tree.componentId(nodeForIndex(index));
+}
+
+QModelIndex ProjectModel::indexForComponentId(quint64 id) const {
+  return indexForNode(m_tree.nodeForComponentId(id));
+}
+
+void ProjectModel::setNodeName(const QModelIndex &index, const QString &name) {
+  setData(index, name, Qt::EditRole);
+}
+
+void ProjectModel::setNodeConfig(const QModelIndex &index,
+                                 const QByteArray &config) {
+  setData(index, config, ConfigRole);
+}
+
+void ProjectModel::setComponentId(const QModelIndex &index, quint64 id) {
+  setData(index, QVariant::fromValue(id), ComponentIdRole);
+}
+
+void ProjectModel::setNodeStatus(quint64 componentId, const QString &status) {
+  if (status.isEmpty()) {
+    if (m_statuses.remove(componentId) == 0) {
+      return;
+    }
+  } else {
+    QString &current = m_statuses[componentId];
+    if (current == status) {
+      return;
+    }
+    current = status;
+  }
+
+  QModelIndex index = indexForComponentId(componentId);
+  if (index.isValid()) {
+    emit dataChanged(index, index,
+                     QVector<int>() << StatusRole << Qt::ToolTipRole);
+  }
+}
+
+QString ProjectModel::nodeStatus(quint64 componentId) const {
+  return m_statuses.value(componentId);
+}
+
+void ProjectModel::clearNodeStatuses() {
+  QList<quint64> ids = m_statuses.keys();
+  m_statuses.clear();
+  for (quint64 id : ids) {
+    QModelIndex index = indexForComponentId(id);
+    if (index.isValid()) {
+      emit dataChanged(index, index,
+                       QVector<int>() << StatusRole << Qt::ToolTipRole);
+    }
+  }
+}
+
+QList<quint64> ProjectModel::componentIds(const QMimeData *data) {
+  QList<quint64> ids;
+  QByteArray encoded = data->data(QString(kComponentMimeType));
+  QDataStream stream(&encoded, QIODevice::ReadOnly);
+  while (!stream.atEnd()) {
+    quint64 id;
+    stream >> id;
+    if (stream.status() != QDataStream::Ok) {
+      break;
+    }
+    ids.append(id);
+  }
+  return ids;
+}
+
+QVariant ProjectModel::decorationFor(int node) const {
+  quint16 typeId = m_tree.typeId(node);
+  if (m_decorationCache.size() != m_tree.typeCount()) {
+    m_decorationCache.resize(m_tree.typeCount());
+    for (int i = 0; i < m_decorationCache.size(); ++i) {
+      m_decorationCache[i] =
+          m_typeDecorations.value(m_tree.typeAt(quint16(i)));
+    }
+  }
+  return m_decorationCache.value(typeId);
+}
+
@@ -0,0 +1,147 @@
+#ifndef PROJECTMODEL_H
+#define PROJECTMODEL_H
+
+#include "projecttree.h"
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QList>
+#include <QMimeData>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+// 项目树模型
+//
+// 以 ProjectTree 作为存储，QModelIndex 的 internalId 即节点编号，
+// 不再为每个组件分配独立的 QStandardItem。
+class ProjectModel : public QAbstractItemModel {
+  Q_OBJECT
+
+public:
+  // 项目树节点的数据角色
+  enum ItemDataRole {
+    TypeRole = Qt::UserRole,            // 组件类型
+    ConfigRole = Qt::UserRole + 1,      // 组件配置段的原始内容(JSON)，按需解析
+    ComponentIdRole = Qt::UserRole + 2, // 组件编号(quint64)
+    StatusRole = Qt::UserRole + 3       // 运行时状态，如连接探测结果，不保存
+  };
+
+  explicit ProjectModel(QObject *parent = nullptr);
+
+  QModelIndex index(int row, int column,
+                    const QModelIndex &parent = QModelIndex()) const override;
+  QModelIndex parent(const QModelIndex &child) const override;
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override;
+  bool setData(const QModelIndex &index, const QVariant &value,
+               int role = Qt::EditRole) override;
+  Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+  // 拖放：拖动的内容是组件编号，放下时只发出 moveRequested()，
+  // 实际的移动由接收方执行，以便记录到撤销栈中
+  Qt::DropActions supportedDropActions() const override;
+  QStringList mimeTypes() const override;
+  QMimeData *mimeData(const QModelIndexList &indexes) const override;
+  bool canDropMimeData(const QMimeData *data, Qt::DropAction action, int row,
+                       int column, const QModelIndex &parent) const override;
+  bool dropMimeData(const QMimeData *data, Qt::DropAction action, int row,
+                    int column, const QModelIndex &parent) override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+  const ProjectTree &tree() const;
+  // 整体替换项目树，用于加载和新建项目
+  void setTree(const ProjectTree &tree);
+  void clear();
+  // 丢弃项目树字符串表中无人引用的名称，节点和模型索引不变
+  void compactStrings();
+
+  void setHeaderLabel(const QString &label);
+  // 按组件类型设置显示的图标，模型本身不依赖GUI模块
+  void setTypeDecoration(const QString &type, const QVariant &decoration);
+
+  QModelIndex rootIndex() const;
+  QModelIndex indexForNode(int node) const;
+  int nodeForIndex(const QModelIndex &index) const;
+
+  // 结构修改，会发出相应的行插入、删除和移动信号
+  QModelIndex appendNode(const QModelIndex &parent, const QString &name,
+                         const QString &type,
+                         const QByteArray &config = QByteArray());
+  // row 为 -1 时追加到末尾
+  QModelIndex insertNode(const QModelIndex &parent, int row,
+                         const QString &name, const QString &type,
+                         const QByteArray &config = QByteArray());
+  bool removeNode(const QModelIndex &index);
+
+  // 批量插入中的一个节点，componentId 为 0 时由项目树分配。
+  // 一组节点按先序排列，childCount 为紧随其后的直接子节点数。
+  struct NodeSpec {
+    QString name;
+    QString type;
+    QByteArray config;
+    quint64 componentId;
+    int childCount;
+  };
+  // 在 parent 的第 row 行起依次插入一组子树，视图只收到一次行插入通知，
+  // 每个节点的开销与 parent 已有的子节点数无关。row 为 -1 时追加到末尾。
+  // 返回第一棵子树所在的行，parent 无效或 nodes 为空时返回 -1。
+  int insertNodes(const QModelIndex &parent, int row,
+                  const QVector<NodeSpec> &nodes);
+  // nodes 中顶层子树的个数
+  static int topLevelCount(const QVector<NodeSpec> &nodes);
+  // 删除 parent 下从第 row 行开始的 count 个节点，只发出一次行删除通知
+  bool removeNodes(const QModelIndex &parent, int row, int count);
+  // row 与 beginMoveRows 的 destinationChild 含义相同，-1 表示追加到末尾
+  bool moveNode(const QModelIndex &index, const QModelIndex &newParent,
+                int row = -1);
+
+  // 批量移动中的一步：节点连同子树移动到 parent 下、before 节点之前，
+  // before 为 -1 时追加到末尾
+  struct NodeMove {
+    int node;
+    int parent;
+    int before;
+  };
+  // 依次执行一组移动，移到同一位置的相邻兄弟节点合并为一次行移动通知。
+  // 无效的移动被跳过。返回按逆序排列的还原步骤，原样传回即可撤销。
+  QVector<NodeMove> moveNodes(const QVector<NodeMove> &moves);
+
+  QString nodeName(const QModelIndex &index) const;
+  QString nodeType(const QModelIndex &index) const;
+  QByteArray nodeConfig(const QModelIndex &index) const;
+  quint64 componentId(const QModelIndex &index) const;
+  QModelIndex indexForComponentId(quint64 id) const;
+  void setNodeName(const QModelIndex &index, const QString &name);
+  void setNodeConfig(const QModelIndex &index, const QByteArray &config);
+  void setComponentId(const QModelIndex &index, quint64 id);
+
+  // 组件的运行时状态，显示在项目树中，项目树替换时清空。status 为空时移除。
+  void setNodeStatus(quint64 componentId, const QString &status);
+  QString nodeStatus(quint64 componentId) const;
+  void clearNodeStatuses();
+
+  // 拖放数据中的组件编号
+  static QList<quint64> componentIds(const QMimeData *data);
+
+signals:
+  // 拖放请求把 componentIds 移动到 parent 的第 row 行之前，-1 表示末尾
+  void moveRequested(const QList<quint64> &componentIds,
+                     const QModelIndex &parent, int row);
+
+private:
+  QVariant decorationFor(int node) const;
+  int insertSubtree(int parentNode, int before, const QVector<NodeSpec> &nodes,
+                    int position);
+
+  ProjectTree m_tree;
+  QString m_headerLabel;
+  QHash<QString, QVariant> m_typeDecorations;
+  // 按类型编号缓存的图标，项目树替换或图标变化时重建
+  mutable QVector<QVariant> m_decorationCache;
+  QHash<quint64, QString> m_statuses;
+};
+
+#endif // PROJECTMODEL_H
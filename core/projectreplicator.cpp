@@ -0,0 +1,235 @@
+#include "projectreplicator.h"
+#include "hostmodule.h"
+#include "projectcommands.h"
+#include <QHostAddress>
+#include <QtConcurrent>
+
+namespace {
+typedef QFutureWatcher<QVector<ProjectModel::NodeSpec>> CopyWatcher;
+
+void captureNode(const ProjectTree &tree, const ModuleRegistry *registry,
+                 int node, QVector<ProjectModel::NodeSpec> *nodes) {
+  // 已创建的模块可能有尚未写回项目树的修改
+  quint64 id = tree.componentId(node);
+  ProjectModel::NodeSpec spec;
+  spec.name = tree.name(node);
+  spec.type = tree.type(node);
+  spec.config = registry->isModified(id) ? registry->configuration(id)
+                                         : tree.config(node);
+  spec.componentId = 0;
+  spec.childCount = tree.childCount(node);
+  nodes->append(spec);
+
+  for (int child = tree.firstChild(node); child >= 0;
+       child = tree.nextSibling(child)) {
+    captureNode(tree, registry, child, nodes);
+  }
+}
+
+void replicateHost(HostModule *module, const ReplicationRules &rules,
+                   int copy) {
+  HostConfiguration config = module->getConfiguration();
+  config.hostName =
+      ReplicationRules::expand(rules.namePattern, config.hostName, copy);
+
+  // 只递增 IPv4 地址，无法解析的地址保持原样
+  QHostAddress address;
+  if (rules.ipIncrement != 0 && address.setAddress(config.ipAddress) &&
+      address.protocol() == QAbstractSocket::IPv4Protocol) {
+    address.setAddress(address.toIPv4Address() +
+                       quint32(copy * rules.ipIncrement));
+    config.ipAddress = address.toString();
+  }
+  module->setConfiguration(config);
+}
+
+void replicateLoop(LoopModule *module, const ReplicationRules &rules,
+                   int copy) {
+  ModuleUpdateGuard<LoopModule> guard(module);
+  for (int channel = 0; channel < module->getChannelCount(); ++channel) {
+    const LoopChannelDevices &devices = module->channelDevices(channel);
+    if (devices.isEmpty()) {
+      continue;
+    }
+
+    QVector<LoopDevice> rows;
+    rows.reserve(devices.size());
+    for (int row = 0; row < devices.size(); ++row) {
+      LoopDevice device = devices.device(row);
+      device.address += copy * rules.addressOffset;
+      device.panelNumber += copy * rules.panelIncrement;
+      device.cardNumber += copy * rules.cardIncrement;
+      if (!device.variableName.isEmpty()) {
+        device.variableName = ReplicationRules::expand(
+            rules.variablePattern, device.variableName, copy);
+      }
+      rows.append(device);
+    }
+    module->setDevices(channel, rows);
+  }
+}
+
+template <typename Module>
+void replicateBits(Module *module, const ReplicationRules &rules, int copy) {
+  ModuleUpdateGuard<Module> guard(module);
+  for (int channel = 0; channel < module->getChannelCount(); ++channel) {
+    for (int bit = 0; bit < 8; ++bit) {
+      auto variable = module->getBitVariable(channel, bit);
+      if (!variable.name.isEmpty()) {
+        variable.name = ReplicationRules::expand(rules.variablePattern,
+                                                 variable.name, copy);
+        module->setBitVariable(channel, bit, variable);
+      }
+    }
+  }
+}
+} // namespace
+
+QString ReplicationRules::expand(const QString &pattern, const QString &name,
+                                 int copy) {
+  QString result = pattern;
+  result.replace("{n}", QString::number(copy));
+  result.replace("{name}", name);
+  return result;
+}
+
+// QtConcurrent::mapped 的函数对象，每次生成一个副本
+struct ProjectReplicator::CopyTask {
+  typedef QVector<ProjectModel::NodeSpec> result_type;
+
+  CopyTask(const QVector<ProjectModel::NodeSpec> &source,
+           const ReplicationRules &rules)
+      : source(source), rules(rules) {}
+
+  QVector<ProjectModel::NodeSpec> operator()(int copy) const {
+    return replicate(source, rules, copy);
+  }
+
+  QVector<ProjectModel::NodeSpec> source;
+  ReplicationRules rules;
+};
+
+ProjectReplicator::ProjectReplicator(ProjectModel *model,
+                                     ModuleRegistry *registry,
+                                     UndoStack *undoStack, QObject *parent)
+    : QObject(parent), m_model(model), m_registry(registry),
+      m_undoStack(undoStack), m_sourceId(0) {
+  connect(&m_watcher, &CopyWatcher::progressValueChanged, this,
+          [this](int value) {
+            emit progressChanged(value, m_watcher.progressMaximum());
+          });
+  connect(&m_watcher, &CopyWatcher::finished, this,
+          &ProjectReplicator::onReplicationFinished);
+}
+
+ProjectReplicator::~ProjectReplicator() { cancel(); }
+
+bool ProjectReplicator::start(const QModelIndex &index,
+                              const ReplicationRules &rules) {
+  cancel();
+  // 项目根节点不能复制
+  if (!index.isValid() || !index.parent().isValid() || rules.copies < 1) {
+    return false;
+  }
+
+  m_sourceId = m_model->componentId(index);
+  m_sourceName = m_model->nodeName(index);
+
+  QVector<int> copies;
+  copies.reserve(rules.copies);
+  for (int copy = 1; copy <= rules.copies; ++copy) {
+    copies.append(copy);
+  }
+  m_watcher.setFuture(
+      QtConcurrent::mapped(copies, CopyTask(captureSubtree(index), rules)));
+  return true;
+}
+
+void ProjectReplicator::cancel() {
+  m_watcher.cancel();
+  m_watcher.waitForFinished();
+}
+
+bool ProjectReplicator::isRunning() const { return m_watcher.isRunning(); }
+
+QVector<ProjectModel::NodeSpec>
+ProjectReplicator::replicate(const QVector<ProjectModel::NodeSpec> &source,
+                             const ReplicationRules &rules, int copy) {
+  QVector<ProjectModel::NodeSpec> nodes = source;
+  for (int i = 0; i < nodes.size(); ++i) {
+    ProjectModel::NodeSpec &node = nodes[i];
+    node.componentId = 0;
+    QString sourceName = node.name;
+    if (i == 0) {
+      node.name = ReplicationRules::expand(rules.namePattern, node.name, copy);
+    }
+
+    // 没有保存配置的模块使用默认配置，副本同样保持为空；主机除外，
+    // 默认配置的主机也需要不同的地址
+    if (!ModuleRegistry::supportsType(node.type) ||
+        (node.config.isEmpty() && node.type != "HostModule")) {
+      continue;
+    }
+
+    QObject *module =
+        ModuleRegistry::createModule(node.type, node.config, sourceName);
+    if (HostModule *hostModule = qobject_cast<HostModule *>(module)) {
+      replicateHost(hostModule, rules, copy);
+    } else if (LoopModule *loopModule = qobject_cast<LoopModule *>(module)) {
+      replicateLoop(loopModule, rules, copy);
+    } else if (DIModule *diModule = qobject_cast<DIModule *>(module)) {
+      replicateBits(diModule, rules, copy);
+    } else if (DOModule *doModule = qobject_cast<DOModule *>(module)) {
+      replicateBits(doModule, rules, copy);
+    }
+    node.config = ModuleRegistry::serialize(module);
+    delete module;
+  }
+  return nodes;
+}
+
+QVector<ProjectModel::NodeSpec>
+ProjectReplicator::captureSubtree(const QModelIndex &index) {
+  QVector<ProjectModel::NodeSpec> nodes;
+  int node = m_model->nodeForIndex(index);
+  if (node >= 0) {
+    captureNode(m_model->tree(), m_registry, node, &nodes);
+  }
+  return nodes;
+}
+
+void ProjectReplicator::onReplicationFinished() {
+  if (m_watcher.isCanceled()) {
+    return;
+  }
+
+  // 源组件在生成期间被删除时放弃插入
+  QModelIndex source = m_model->indexForComponentId(m_sourceId);
+  if (!source.isValid()) {
+    emit failed(QString("%1 在复制期间已被删除，副本未插入").arg(m_sourceName));
+    return;
+  }
+
+  const QList<QVector<ProjectModel::NodeSpec>> copies =
+      m_watcher.future().results();
+  int nodeCount = 0;
+  for (const QVector<ProjectModel::NodeSpec> &copy : copies) {
+    nodeCount += copy.size();
+  }
+  QVector<ProjectModel::NodeSpec> nodes;
+  nodes.reserve(nodeCount);
+  for (const QVector<ProjectModel::NodeSpec> &copy : copies) {
+    nodes += copy;
+  }
+  if (nodes.isEmpty()) {
+    emit failed(QString("%1 没有可复制的组件").arg(m_sourceName));
+    return;
+  }
+
+  AddComponentsCommand *command = new AddComponentsCommand(
+      QString("复制 %1 %2 份").arg(m_sourceName).arg(copies.size()),
+      source.parent(), source.row() + 1, nodes, m_model);
+  m_undoStack->push(command);
+  emit finished(m_model->indexForComponentId(command->firstComponentId()),
+                copies.size());
+}
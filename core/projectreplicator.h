@@ -0,0 +1,83 @@
+#ifndef PROJECTREPLICATOR_H
+#define PROJECTREPLICATOR_H
+
+#include "moduleregistry.h"
+#include "projectmodel.h"
+#include "undostack.h"
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+// 复制规则
+//
+// 第 n 个副本(从 1 开始)的编号类字段在原值上加 n 倍的增量。名称模板中
+// {name} 代表原名称，{n} 代表副本序号。
+struct ReplicationRules {
+  int copies;
+  QString namePattern;     // 子树根组件的名称和主机名
+  QString variablePattern; // 回路设备和 DI/DO 位的变量名，空名称保持为空
+  int ipIncrement;         // 主机 IP 地址
+  int panelIncrement;      // 回路设备的盘号
+  int cardIncrement;       // 回路设备的卡号
+  int addressOffset;       // 回路设备的地址
+
+  ReplicationRules()
+      : copies(1), namePattern("{name}_{n}"), variablePattern("{name}_{n}"),
+        ipIncrement(1), panelIncrement(1), cardIncrement(0),
+        addressOffset(0) {}
+
+  static QString expand(const QString &pattern, const QString &name,
+                        int copy);
+};
+
+// 按规则把主机子树复制多份
+//
+// 源子树在主线程中读取，包括模块中尚未写回的修改。每个副本作为一个任务
+// 交给全局线程池，工作线程根据配置段创建临时模块、改写后重新序列化。
+// 全部副本按序号连接后作为一条 AddComponentsCommand 插入到源组件之后，
+// 视图只收到一次行插入通知。
+class ProjectReplicator : public QObject {
+  Q_OBJECT
+
+public:
+  ProjectReplicator(ProjectModel *model, ModuleRegistry *registry,
+                    UndoStack *undoStack, QObject *parent = nullptr);
+  ~ProjectReplicator();
+
+  // 开始复制 index 及其子树，正在进行的复制会被取消
+  bool start(const QModelIndex &index, const ReplicationRules &rules);
+  void cancel();
+  bool isRunning() const;
+
+  // 生成第 copy 个副本，可在任意线程中调用
+  static QVector<ProjectModel::NodeSpec>
+  replicate(const QVector<ProjectModel::NodeSpec> &source,
+            const ReplicationRules &rules, int copy);
+
+signals:
+  void progressChanged(int finishedCopies, int totalCopies);
+  // 副本已插入项目树，firstIndex 为第一个副本的根组件
+  void finished(const QModelIndex &firstIndex, int copies);
+  // 生成完成但副本无法插入，例如源组件在生成期间被删除。取消时不发出
+  void failed(const QString &errorString);
+
+private slots:
+  void onReplicationFinished();
+
+private:
+  // 交给工作线程的函数对象，定义在实现文件中
+  struct CopyTask;
+
+  QVector<ProjectModel::NodeSpec> captureSubtree(const QModelIndex &index);
+
+  ProjectModel *m_model;
+  ModuleRegistry *m_registry;
+  UndoStack *m_undoStack;
+
+  quint64 m_sourceId;
+  QString m_sourceName;
+  QFutureWatcher<QVector<ProjectModel::NodeSpec>> m_watcher;
+};
+
+#endif // PROJECTREPLICATOR_H
@@ -0,0 +1,408 @@
+#include "projectsearch.h"
+#include "dimodule.h"
+#include "domodule.h"
+#include "loopmodule.h"
+#include "projectcommands.h"
+#include <QtConcurrent>
+
+namespace {
+// 回路设备中参与查找的文本字段，类型和数值字段不参与
+const int kLoopTextFields[] = {
+    LoopDevice::SerialNumberField, LoopDevice::PersonalityCodeField,
+    LoopDevice::DescriptionField, LoopDevice::IdentifierField,
+    LoopDevice::VariableNameField};
+
+// 结果列表最多显示的匹配数，超出部分只计数
+const int kMaxReportedMatches = 100000;
+
+// 回路设备中可替换文本字段的地址
+QString *loopTextField(LoopDevice *device, int field) {
+  switch (field) {
+  case LoopDevice::SerialNumberField:
+    return &device->serialNumber;
+  case LoopDevice::PersonalityCodeField:
+    return &device->personalityCode;
+  case LoopDevice::DescriptionField:
+    return &device->description;
+  case LoopDevice::IdentifierField:
+    return &device->identifier;
+  case LoopDevice::VariableNameField:
+    return &device->variableName;
+  default:
+    return nullptr;
+  }
+}
+} // namespace
+
+TextMatcher::TextMatcher(const SearchQuery &query) : m_query(query) {
+  if (m_query.useRegex) {
+    m_regex.setPattern(m_query.pattern);
+    if (!m_query.caseSensitive) {
+      m_regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+    }
+    // 在构造线程中编译，工作线程只做匹配
+    m_regex.optimize();
+  }
+}
+
+bool TextMatcher::isValid() const {
+  if (m_query.pattern.isEmpty()) {
+    return false;
+  }
+  return !m_query.useRegex || m_regex.isValid();
+}
+
+QString TextMatcher::errorString() const {
+  if (m_query.pattern.isEmpty()) {
+    return QString("查找内容为空");
+  }
+  if (m_query.useRegex && !m_regex.isValid()) {
+    return QString("正则表达式无效：%1").arg(m_regex.errorString());
+  }
+  return QString();
+}
+
+bool TextMatcher::matches(const QString &text) const {
+  if (!isValid() || text.isEmpty()) {
+    return false;
+  }
+  if (m_query.useRegex) {
+    return m_regex.match(text).hasMatch();
+  }
+  return text.contains(m_query.pattern, m_query.caseSensitive
+                                            ? Qt::CaseSensitive
+                                            : Qt::CaseInsensitive);
+}
+
+QString TextMatcher::replace(const QString &text,
+                             const QString &replacement) const {
+  QString result = text;
+  if (m_query.useRegex) {
+    return result.replace(m_regex, replacement);
+  }
+  return result.replace(m_query.pattern, replacement,
+                        m_query.caseSensitive ? Qt::CaseSensitive
+                                              : Qt::CaseInsensitive);
+}
+
+struct ProjectSearch::ComponentSource {
+  quint64 componentId;
+  QString type;
+  QString name;
+  QByteArray config;
+};
+
+// QtConcurrent::mapped 的函数对象，每次处理一个组件
+struct ProjectSearch::ComponentSearch {
+  typedef QVector<SearchMatch> result_type;
+
+  explicit ComponentSearch(const SearchQuery &query)
+      : matcher(query), scopes(query.scopes) {}
+
+  QVector<SearchMatch> operator()(const ComponentSource &source) const {
+    QVector<SearchMatch> matches;
+    if ((scopes & SearchQuery::ComponentNames) &&
+        matcher.matches(source.name)) {
+      SearchMatch match = {SearchMatch::ComponentName,
+                           {source.componentId, -1, -1}, -1, source.name};
+      matches.append(match);
+    }
+
+    if ((scopes & (SearchQuery::LoopDevices | SearchQuery::BitVariables)) &&
+        ModuleRegistry::supportsType(source.type)) {
+      QObject *module = ModuleRegistry::createModule(
+          source.type, source.config, source.name);
+      if (module) {
+        searchModule(matcher, scopes, source.componentId, module, &matches);
+        delete module;
+      }
+    }
+    return matches;
+  }
+
+  TextMatcher matcher;
+  int scopes;
+};
+
+template <typename Module>
+void ProjectSearch::searchBits(const TextMatcher &matcher, quint64 id,
+                               Module *module, QVector<SearchMatch> *matches) {
+  for (int channel = 0; channel < module->getChannelCount(); ++channel) {
+    for (int bit = 0; bit < 8; ++bit) {
+      auto variable = module->getBitVariable(channel, bit);
+      if (matcher.matches(variable.name)) {
+        SearchMatch match = {SearchMatch::BitName, {id, channel, bit}, -1,
+                             variable.name};
+        matches->append(match);
+      }
+      if (matcher.matches(variable.description)) {
+        SearchMatch match = {SearchMatch::BitDescription, {id, channel, bit},
+                             -1, variable.description};
+        matches->append(match);
+      }
+    }
+  }
+}
+
+template <typename Command, typename Module>
+int ProjectSearch::replaceBits(const TextMatcher &matcher,
+                               const QString &replacement, quint64 id,
+                               Module *module) {
+  Command *command = new Command("替换位变量", id);
+  int count = 0;
+  for (int channel = 0; channel < module->getChannelCount(); ++channel) {
+    for (int bit = 0; bit < 8; ++bit) {
+      auto oldValue = module->getBitVariable(channel, bit);
+      auto newValue = oldValue;
+      if (matcher.matches(newValue.name)) {
+        newValue.name = matcher.replace(newValue.name, replacement);
+        ++count;
+      }
+      if (matcher.matches(newValue.description)) {
+        newValue.description =
+            matcher.replace(newValue.description, replacement);
+        ++count;
+      }
+      if (newValue.name != oldValue.name ||
+          newValue.description != oldValue.description) {
+        command->addChange(channel, bit, oldValue, newValue);
+      }
+    }
+  }
+
+  if (command->isEmpty()) {
+    delete command;
+  } else {
+    m_undoStack->push(command);
+  }
+  return count;
+}
+
+ProjectSearch::ProjectSearch(ProjectModel *model, ModuleRegistry *registry,
+                             UndoStack *undoStack, QObject *parent)
+    : QObject(parent), m_model(model), m_registry(registry),
+      m_undoStack(undoStack), m_matchCount(0) {
+  connect(&m_watcher, &QFutureWatcher<QVector<SearchMatch>>::resultsReadyAt,
+          this, &ProjectSearch::onResultsReadyAt);
+  connect(&m_watcher, &QFutureWatcher<QVector<SearchMatch>>::finished, this,
+          &ProjectSearch::onSearchFinished);
+}
+
+ProjectSearch::~ProjectSearch() { cancel(); }
+
+void ProjectSearch::start(const SearchQuery &query) {
+  cancel();
+  m_query = query;
+  m_matchCount = 0;
+  m_matchedIds.clear();
+
+  ComponentSearch search(query);
+  if (!search.matcher.isValid()) {
+    emit finished();
+    return;
+  }
+
+  // 已创建的模块在主线程中扫描，其余组件只复制名称和配置段
+  QVector<ComponentSource> sources;
+  QVector<SearchMatch> loadedMatches;
+  const ProjectTree &tree = m_model->tree();
+  QVector<int> stack;
+  if (!tree.isEmpty()) {
+    stack.append(tree.rootNode());
+  }
+  while (!stack.isEmpty()) {
+    int node = stack.takeLast();
+    for (int child = tree.firstChild(node); child >= 0;
+         child = tree.nextSibling(child)) {
+      stack.append(child);
+    }
+
+    // 没有组件编号的节点无法定位，不参与查找
+    quint64 id = tree.componentId(node);
+    if (id == 0) {
+      continue;
+    }
+    QObject *module = m_registry->module(id);
+    if (!module) {
+      ComponentSource source = {id, tree.type(node), tree.name(node),
+                                tree.config(node)};
+      sources.append(source);
+      continue;
+    }
+
+    QString name = tree.name(node);
+    if ((query.scopes & SearchQuery::ComponentNames) &&
+        search.matcher.matches(name)) {
+      SearchMatch match = {SearchMatch::ComponentName, {id, -1, -1}, -1, name};
+      loadedMatches.append(match);
+    }
+    searchModule(search.matcher, query.scopes, id, module, &loadedMatches);
+  }
+
+  report(loadedMatches);
+  m_watcher.setFuture(QtConcurrent::mapped(sources, search));
+}
+
+void ProjectSearch::cancel() {
+  m_watcher.cancel();
+  m_watcher.waitForFinished();
+}
+
+bool ProjectSearch::isRunning() const { return m_watcher.isRunning(); }
+
+const SearchQuery &ProjectSearch::query() const { return m_query; }
+
+int ProjectSearch::matchCount() const { return m_matchCount; }
+
+int ProjectSearch::maxReportedMatches() { return kMaxReportedMatches; }
+
+int ProjectSearch::replaceAll(const QString &replacement) {
+  TextMatcher matcher(m_query);
+  if (isRunning() || !matcher.isValid()) {
+    return 0;
+  }
+
+  // 全部修改作为一步撤销
+  int count = 0;
+  m_undoStack->beginMacro("全部替换");
+  for (quint64 id : m_matchedIds) {
+    QModelIndex index = m_model->indexForComponentId(id);
+    if (!index.isValid()) {
+      continue;
+    }
+
+    QString name = m_model->nodeName(index);
+    if ((m_query.scopes & SearchQuery::ComponentNames) &&
+        matcher.matches(name)) {
+      m_undoStack->push(new RenameComponentCommand(
+          index, matcher.replace(name, replacement), m_model));
+      ++count;
+    }
+
+    QString type = m_model->nodeType(index);
+    if (!(m_query.scopes & (SearchQuery::LoopDevices |
+                            SearchQuery::BitVariables)) ||
+        !ModuleRegistry::supportsType(type)) {
+      continue;
+    }
+    QObject *module = m_undoStack->module(id);
+
+    if (LoopModule *loopModule = qobject_cast<LoopModule *>(module)) {
+      if (m_query.scopes & SearchQuery::LoopDevices) {
+        count += replaceDevices(matcher, replacement, id, loopModule);
+      }
+    } else if (m_query.scopes & SearchQuery::BitVariables) {
+      if (DIModule *diModule = qobject_cast<DIModule *>(module)) {
+        count += replaceBits<DIBitVariablesCommand>(matcher, replacement, id,
+                                                    diModule);
+      } else if (DOModule *doModule = qobject_cast<DOModule *>(module)) {
+        count += replaceBits<DOBitVariablesCommand>(matcher, replacement, id,
+                                                    doModule);
+      }
+    }
+  }
+  m_undoStack->endMacro();
+
+  m_matchedIds.clear();
+  return count;
+}
+
+int ProjectSearch::replaceDevices(const TextMatcher &matcher,
+                                  const QString &replacement, quint64 id,
+                                  LoopModule *module) {
+  // 每个改动的设备记录为一行替换，相邻的行在命令中合并
+  LoopModuleCommand *command = new LoopModuleCommand("替换回路设备", id);
+  int count = 0;
+  for (int channel = 0; channel < module->getChannelCount(); ++channel) {
+    const LoopChannelDevices &devices = module->channelDevices(channel);
+    for (int row = 0; row < devices.size(); ++row) {
+      LoopDevice device;
+      bool changed = false;
+      for (int field : kLoopTextFields) {
+        QString text = devices.value(row, field).toString();
+        if (!matcher.matches(text)) {
+          continue;
+        }
+        if (!changed) {
+          device = devices.device(row);
+          changed = true;
+        }
+        *loopTextField(&device, field) = matcher.replace(text, replacement);
+        ++count;
+      }
+      if (changed) {
+        QVector<LoopDevice> oldRows(1, devices.device(row));
+        QVector<LoopDevice> newRows(1, device);
+        command->addSplice(channel, row, oldRows, newRows);
+      }
+    }
+  }
+
+  if (command->isEmpty()) {
+    delete command;
+  } else {
+    m_undoStack->push(command);
+  }
+  return count;
+}
+
+void ProjectSearch::onResultsReadyAt(int begin, int end) {
+  QVector<SearchMatch> matches;
+  for (int i = begin; i < end; ++i) {
+    matches += m_watcher.resultAt(i);
+  }
+  report(matches);
+}
+
+void ProjectSearch::onSearchFinished() {
+  if (!m_watcher.isCanceled()) {
+    emit finished();
+  }
+}
+
+void ProjectSearch::searchModule(const TextMatcher &matcher, int scopes,
+                                 quint64 id, QObject *module,
+                                 QVector<SearchMatch> *matches) {
+  if (LoopModule *loopModule = qobject_cast<LoopModule *>(module)) {
+    if (!(scopes & SearchQuery::LoopDevices)) {
+      return;
+    }
+    for (int channel = 0; channel < loopModule->getChannelCount(); ++channel) {
+      const LoopChannelDevices &devices = loopModule->channelDevices(channel);
+      for (int row = 0; row < devices.size(); ++row) {
+        for (int field : kLoopTextFields) {
+          QString text = devices.value(row, field).toString();
+          if (matcher.matches(text)) {
+            SearchMatch match = {SearchMatch::LoopDeviceField,
+                                 {id, channel, row}, field, text};
+            matches->append(match);
+          }
+        }
+      }
+    }
+  } else if (scopes & SearchQuery::BitVariables) {
+    if (DIModule *diModule = qobject_cast<DIModule *>(module)) {
+      searchBits(matcher, id, diModule, matches);
+    } else if (DOModule *doModule = qobject_cast<DOModule *>(module)) {
+      searchBits(matcher, id, doModule, matches);
+    }
+  }
+}
+
+void ProjectSearch::report(const QVector<SearchMatch> &matches) {
+  if (matches.isEmpty()) {
+    return;
+  }
+
+  int reportable = qMax(0, kMaxReportedMatches - m_matchCount);
+  m_matchCount += matches.size();
+  for (const SearchMatch &match : matches) {
+    m_matchedIds.insert(match.location.componentId);
+  }
+
+  if (reportable >= matches.size()) {
+    emit matchesFound(matches);
+  } else if (reportable > 0) {
+    emit matchesFound(matches.mid(0, reportable));
+  }
+}
@@ -0,0 +1,127 @@
+#ifndef PROJECTSEARCH_H
+#define PROJECTSEARCH_H
+
+#include "moduleregistry.h"
+#include "projectmodel.h"
+#include "symbolindex.h"
+#include "undostack.h"
+#include <QFutureWatcher>
+#include <QObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class LoopModule;
+
+// 查找条件
+struct SearchQuery {
+  enum Scope {
+    ComponentNames = 0x1, // 项目树中的组件名称
+    LoopDevices = 0x2,    // 回路设备的文本字段
+    BitVariables = 0x4,   // DI/DO 位变量的名称和描述
+    AllScopes = ComponentNames | LoopDevices | BitVariables
+  };
+
+  QString pattern;
+  bool useRegex;
+  bool caseSensitive;
+  int scopes;
+
+  SearchQuery() : useRegex(false), caseSensitive(false), scopes(AllScopes) {}
+};
+
+// 一条查找结果
+struct SearchMatch {
+  enum Target { ComponentName, LoopDeviceField, BitName, BitDescription };
+
+  Target target;
+  ComponentLocation location;
+  int field; // 回路设备字段(LoopDevice::Field)，其他为 -1
+  QString text;
+};
+
+// 按查找条件匹配和替换文本，可在多个线程中同时使用
+class TextMatcher {
+public:
+  explicit TextMatcher(const SearchQuery &query);
+
+  // 条件为空或正则表达式无效时不匹配任何文本
+  bool isValid() const;
+  QString errorString() const;
+
+  bool matches(const QString &text) const;
+  // 替换全部匹配，正则模式下 replacement 中的 \1 等引用捕获组
+  QString replace(const QString &text, const QString &replacement) const;
+
+private:
+  SearchQuery m_query;
+  QRegularExpression m_regex;
+};
+
+// 项目查找和替换
+//
+// 查找时每个组件作为一个任务交给全局线程池：工作线程根据配置段创建临时
+// 模块并扫描，已创建的模块可能有未写回的修改，在主线程中直接扫描。结果
+// 按组件陆续通过 matchesFound() 发出。全部替换只处理最近一次查找命中的
+// 组件，每个模块的修改合并为一条撤销命令。
+class ProjectSearch : public QObject {
+  Q_OBJECT
+
+public:
+  ProjectSearch(ProjectModel *model, ModuleRegistry *registry,
+                UndoStack *undoStack, QObject *parent = nullptr);
+  ~ProjectSearch();
+
+  // 开始新的查找，正在进行的查找会被取消
+  void start(const SearchQuery &query);
+  void cancel();
+  bool isRunning() const;
+
+  const SearchQuery &query() const;
+  // 最近一次查找的匹配总数，包括超出 maxReportedMatches 未发出的部分
+  int matchCount() const;
+  static int maxReportedMatches();
+
+  // 在最近一次查找命中的组件中替换全部匹配，返回修改的字段数。
+  // 全部修改压入撤销栈作为一步撤销。
+  int replaceAll(const QString &replacement);
+
+signals:
+  void matchesFound(const QVector<SearchMatch> &matches);
+  void finished();
+
+private slots:
+  void onResultsReadyAt(int begin, int end);
+  void onSearchFinished();
+
+private:
+  // 交给工作线程的组件快照和扫描函数对象，定义在实现文件中
+  struct ComponentSource;
+  struct ComponentSearch;
+
+  static void searchModule(const TextMatcher &matcher, int scopes, quint64 id,
+                           QObject *module, QVector<SearchMatch> *matches);
+  template <typename Module>
+  static void searchBits(const TextMatcher &matcher, quint64 id,
+                         Module *module, QVector<SearchMatch> *matches);
+  int replaceDevices(const TextMatcher &matcher, const QString &replacement,
+                     quint64 id, LoopModule *module);
+  template <typename Command, typename Module>
+  int replaceBits(const TextMatcher &matcher, const QString &replacement,
+                  quint64 id, Module *module);
+
+  void report(const QVector<SearchMatch> &matches);
+
+  ProjectModel *m_model;
+  ModuleRegistry *m_registry;
+  UndoStack *m_undoStack;
+
+  SearchQuery m_query;
+  QFutureWatcher<QVector<SearchMatch>> m_watcher;
+  int m_matchCount;
+  // 有匹配的组件，全部替换时只处理这些组件
+  QSet<quint64> m_matchedIds;
+};
+
+#endif // PROJECTSEARCH_H
@@ -0,0 +1,478 @@
+#include "projecttree.h"
+
+ProjectTree::ProjectTree()
+    : m_nextComponentId(1), m_root(-1), m_liveCount(0),
+      m_componentIndexValid(false) {}
+
+void ProjectTree::clear() {
+  m_nodes.clear();
+  m_configs.clear();
+  m_componentIds.clear();
+  m_nextComponentId = 1;
+  m_freeNodes.clear();
+  m_root = -1;
+  m_liveCount = 0;
+  m_strings.clear();
+  m_stringIds.clear();
+  m_types.clear();
+  m_typeIds.clear();
+  m_childRows.clear();
+  m_rows.clear();
+  m_componentIndex.clear();
+  m_componentIndexValid = false;
+}
+
+void ProjectTree::reserve(int nodeCount) {
+  m_nodes.reserve(nodeCount);
+  m_configs.reserve(nodeCount);
+  m_componentIds.reserve(nodeCount);
+  m_rows.reserve(nodeCount);
+}
+
+bool ProjectTree::isEmpty() const { return m_root < 0; }
+
+int ProjectTree::rootNode() const { return m_root; }
+
+int ProjectTree::nodeCount() const { return m_liveCount; }
+
+int ProjectTree::capacity() const { return m_nodes.size(); }
+
+bool ProjectTree::isValidNode(int node) const {
+  return node >= 0 && node < m_nodes.size() &&
+         !(m_nodes.at(node).flags & FreeNode);
+}
+
+int ProjectTree::parentNode(int node) const {
+  return isValidNode(node) ? m_nodes.at(node).parent : -1;
+}
+
+int ProjectTree::firstChild(int node) const {
+  return isValidNode(node) ? m_nodes.at(node).firstChild : -1;
+}
+
+int ProjectTree::nextSibling(int node) const {
+  return isValidNode(node) ? m_nodes.at(node).nextSibling : -1;
+}
+
+int ProjectTree::childCount(int node) const {
+  return isValidNode(node) ? m_nodes.at(node).childCount : 0;
+}
+
+int ProjectTree::childAt(int node, int row) const {
+  if (!isValidNode(node) || row < 0 || row >= m_nodes.at(node).childCount) {
+    return -1;
+  }
+  return childRows(node).at(row);
+}
+
+int ProjectTree::rowOf(int node) const {
+  if (!isValidNode(node)) {
+    return -1;
+  }
+
+  int parent = m_nodes.at(node).parent;
+  if (parent < 0) {
+    return 0;
+  }
+
+  childRows(parent);
+  return m_rows.at(node);
+}
+
+QString ProjectTree::name(int node) const {
+  return isValidNode(node) ? m_strings.at(int(m_nodes.at(node).nameId))
+                           : QString();
+}
+
+QString ProjectTree::type(int node) const {
+  return isValidNode(node) ? m_types.at(m_nodes.at(node).typeId) : QString();
+}
+
+quint32 ProjectTree::nameId(int node) const {
+  return isValidNode(node) ? m_nodes.at(node).nameId : 0;
+}
+
+quint16 ProjectTree::typeId(int node) const {
+  return isValidNode(node) ? m_nodes.at(node).typeId : 0;
+}
+
+QByteArray ProjectTree::config(int node) const {
+  return isValidNode(node) ? m_configs.at(node) : QByteArray();
+}
+
+quint64 ProjectTree::componentId(int node) const {
+  return isValidNode(node) ? m_componentIds.at(node) : 0;
+}
+
+bool ProjectTree::setComponentId(int node, quint64 id) {
+  if (!isValidNode(node) || id == 0) {
+    return false;
+  }
+  // 编号已被其他节点使用时拒绝，节点保留原来的编号
+  int owner = nodeForComponentId(id);
+  if (owner >= 0) {
+    return owner == node;
+  }
+
+  if (m_componentIndexValid) {
+    m_componentIndex.remove(m_componentIds.at(node));
+    m_componentIndex.insert(id, node);
+  }
+  m_componentIds[node] = id;
+
+  // 后续新建的节点从文件中出现过的最大编号之后分配
+  if (id >= m_nextComponentId) {
+    m_nextComponentId = id + 1;
+  }
+  return true;
+}
+
+int ProjectTree::nodeForComponentId(quint64 id) const {
+  if (!m_componentIndexValid) {
+    m_componentIndex.clear();
+    m_componentIndex.reserve(m_liveCount);
+    for (int node = 0; node < m_nodes.size(); ++node) {
+      if (!(m_nodes.at(node).flags & FreeNode)) {
+        m_componentIndex.insert(m_componentIds.at(node), node);
+      }
+    }
+    m_componentIndexValid = true;
+  }
+  return m_componentIndex.value(id, -1);
+}
+
+quint32 ProjectTree::internString(const QString &value) {
+  QHash<QString, quint32>::const_iterator it = m_stringIds.constFind(value);
+  if (it != m_stringIds.constEnd()) {
+    return it.value();
+  }
+
+  quint32 id = static_cast<quint32>(m_strings.size());
+  m_strings.append(value);
+  m_stringIds.insert(value, id);
+  return id;
+}
+
+quint16 ProjectTree::internType(const QString &type) {
+  QHash<QString, quint16>::const_iterator it = m_typeIds.constFind(type);
+  if (it != m_typeIds.constEnd()) {
+    return it.value();
+  }
+
+  quint16 id = static_cast<quint16>(m_types.size());
+  m_types.append(type);
+  m_typeIds.insert(type, id);
+  return id;
+}
+
+QString ProjectTree::stringAt(quint32 id) const {
+  return id < quint32(m_strings.size()) ? m_strings.at(int(id)) : QString();
+}
+
+QString ProjectTree::typeAt(quint16 id) const {
+  return id < m_types.size() ? m_types.at(id) : QString();
+}
+
+int ProjectTree::typeCount() const { return m_types.size(); }
+
+void ProjectTree::compactStrings() {
+  QVector<QString> strings;
+  QHash<QString, quint32> stringIds;
+  strings.reserve(m_liveCount);
+  stringIds.reserve(m_liveCount);
+  for (int node = 0; node < m_nodes.size(); ++node) {
+    if (!isValidNode(node)) {
+      continue;
+    }
+    const QString &value = m_strings.at(int(m_nodes.at(node).nameId));
+    QHash<QString, quint32>::const_iterator it = stringIds.constFind(value);
+    if (it == stringIds.constEnd()) {
+      it = stringIds.insert(value, static_cast<quint32>(strings.size()));
+      strings.append(value);
+    }
+    m_nodes[node].nameId = it.value();
+  }
+  m_strings.swap(strings);
+  m_stringIds.swap(stringIds);
+}
+
+int ProjectTree::createRoot(const QString &name) {
+  clear();
+  m_root = allocateNode(internString(name), internType("Project"),
+                        QByteArray());
+  return m_root;
+}
+
+int ProjectTree::insertNode(int parent, int row, const QString &name,
+                            const QString &type, const QByteArray &config) {
+  if (!isValidNode(parent)) {
+    return -1;
+  }
+
+  int node = allocateNode(internString(name), internType(type), config);
+  linkNode(parent, node, row);
+  return node;
+}
+
+int ProjectTree::insertNodeBefore(int parent, int before, const QString &name,
+                                  const QString &type,
+                                  const QByteArray &config) {
+  if (!isValidNode(parent)) {
+    return -1;
+  }
+  if (before >= 0 &&
+      (!isValidNode(before) || m_nodes.at(before).parent != parent)) {
+    return -1;
+  }
+
+  int node = allocateNode(internString(name), internType(type), config);
+  linkNodeBefore(parent, node, before);
+  return node;
+}
+
+int ProjectTree::appendNode(int parent, const QString &name,
+                            const QString &type, const QByteArray &config) {
+  return insertNode(parent, -1, name, type, config);
+}
+
+int ProjectTree::appendNode(int parent, quint32 nameId, quint16 typeId,
+                            const QByteArray &config) {
+  if (!isValidNode(parent)) {
+    return -1;
+  }
+
+  int node = allocateNode(nameId, typeId, config);
+  linkNode(parent, node, -1);
+  return node;
+}
+
+void ProjectTree::removeNode(int node) {
+  if (!isValidNode(node)) {
+    return;
+  }
+
+  if (node == m_root) {
+    clear();
+    return;
+  }
+
+  unlinkNode(node);
+  freeSubtree(node);
+}
+
+void ProjectTree::moveNode(int node, int newParent, int row) {
+  if (!isValidNode(node) || !isValidNode(newParent) || node == m_root) {
+    return;
+  }
+
+  // 不能移动到自身的子树中
+  for (int ancestor = newParent; ancestor >= 0;
+       ancestor = m_nodes.at(ancestor).parent) {
+    if (ancestor == node) {
+      return;
+    }
+  }
+
+  unlinkNode(node);
+  linkNode(newParent, node, row);
+}
+
+void ProjectTree::moveNodeBefore(int node, int newParent, int before) {
+  if (!isValidNode(node) || !isValidNode(newParent) || node == m_root ||
+      before == node) {
+    return;
+  }
+  if (before >= 0 &&
+      (!isValidNode(before) || m_nodes.at(before).parent != newParent)) {
+    return;
+  }
+
+  for (int ancestor = newParent; ancestor >= 0;
+       ancestor = m_nodes.at(ancestor).parent) {
+    if (ancestor == node) {
+      return;
+    }
+  }
+
+  unlinkNode(node);
+  linkNodeBefore(newParent, node, before);
+}
+
+void ProjectTree::setName(int node, const QString &name) {
+  if (isValidNode(node)) {
+    m_nodes[node].nameId = internString(name);
+    // 每次压缩后至少再经过 m_liveCount 次重命名才会再次压缩，均摊为常数
+    if (m_strings.size() > 2 * m_liveCount) {
+      compactStrings();
+    }
+  }
+}
+
+void ProjectTree::setConfig(int node, const QByteArray &config) {
+  if (isValidNode(node)) {
+    m_configs[node] = config;
+  }
+}
+
+int ProjectTree::allocateNode(quint32 nameId, quint16 typeId,
+                              const QByteArray &config) {
+  Node node;
+  node.parent = -1;
+  node.firstChild = -1;
+  node.lastChild = -1;
+  node.prevSibling = -1;
+  node.nextSibling = -1;
+  node.childCount = 0;
+  node.nameId = nameId;
+  node.typeId = typeId;
+  node.flags = 0;
+
+  quint64 id = m_nextComponentId++;
+
+  int index;
+  if (!m_freeNodes.isEmpty()) {
+    // 优先复用已释放的槽位，组件编号不复用
+    index = m_freeNodes.takeLast();
+    m_nodes[index] = node;
+    m_configs[index] = config;
+    m_componentIds[index] = id;
+    m_rows[index] = 0;
+  } else {
+    index = m_nodes.size();
+    m_nodes.append(node);
+    m_configs.append(config);
+    m_componentIds.append(id);
+    m_rows.append(0);
+  }
+
+  if (m_componentIndexValid) {
+    m_componentIndex.insert(id, index);
+  }
+
+  ++m_liveCount;
+  return index;
+}
+
+void ProjectTree::linkNode(int parent, int node, int row) {
+  int count = m_nodes.at(parent).childCount;
+
+  if (row < 0 || row >= count) {
+    // 追加到末尾，已有的行号缓存仍然有效
+    int last = m_nodes.at(parent).lastChild;
+    m_nodes[node].prevSibling = last;
+    m_nodes[node].nextSibling = -1;
+    if (last >= 0) {
+      m_nodes[last].nextSibling = node;
+    } else {
+      m_nodes[parent].firstChild = node;
+    }
+    m_nodes[parent].lastChild = node;
+
+    QHash<qint32, QVector<qint32>>::iterator it = m_childRows.find(parent);
+    if (it != m_childRows.end()) {
+      m_rows[node] = it.value().size();
+      it.value().append(node);
+    }
+    m_nodes[node].parent = parent;
+    ++m_nodes[parent].childCount;
+  } else {
+    linkNodeBefore(parent, node, childAt(parent, row));
+  }
+}
+
+void ProjectTree::linkNodeBefore(int parent, int node, int next) {
+  if (next < 0) {
+    linkNode(parent, node, -1);
+    return;
+  }
+
+  int prev = m_nodes.at(next).prevSibling;
+  m_nodes[node].prevSibling = prev;
+  m_nodes[node].nextSibling = next;
+  m_nodes[next].prevSibling = node;
+  if (prev >= 0) {
+    m_nodes[prev].nextSibling = node;
+  } else {
+    m_nodes[parent].firstChild = node;
+  }
+  m_childRows.remove(parent);
+
+  m_nodes[node].parent = parent;
+  ++m_nodes[parent].childCount;
+}
+
+void ProjectTree::unlinkNode(int node) {
+  Node current = m_nodes.at(node);
+  int parent = current.parent;
+  if (parent < 0) {
+    return;
+  }
+
+  if (current.prevSibling >= 0) {
+    m_nodes[current.prevSibling].nextSibling = current.nextSibling;
+  } else {
+    m_nodes[parent].firstChild = current.nextSibling;
+  }
+
+  if (current.nextSibling >= 0) {
+    m_nodes[current.nextSibling].prevSibling = current.prevSibling;
+  } else {
+    m_nodes[parent].lastChild = current.prevSibling;
+  }
+
+  --m_nodes[parent].childCount;
+  m_nodes[node].parent = -1;
+  m_nodes[node].prevSibling = -1;
+  m_nodes[node].nextSibling = -1;
+
+  // 移除最后一个子节点时缓存仍然有效
+  QHash<qint32, QVector<qint32>>::iterator it = m_childRows.find(parent);
+  if (it != m_childRows.end()) {
+    if (!it.value().isEmpty() && it.value().last() == node) {
+      it.value().removeLast();
+    } else {
+      m_childRows.erase(it);
+    }
+  }
+}
+
+void ProjectTree::freeSubtree(int node) {
+  QVector<qint32> pending;
+  pending.append(node);
+
+  while (!pending.isEmpty()) {
+    int current = pending.takeLast();
+    for (int child = m_nodes.at(current).firstChild; child >= 0;
+         child = m_nodes.at(child).nextSibling) {
+      pending.append(child);
+    }
+
+    m_nodes[current].flags |= FreeNode;
+    m_nodes[current].firstChild = -1;
+    m_nodes[current].lastChild = -1;
+    m_nodes[current].childCount = 0;
+    m_configs[current] = QByteArray();
+    if (m_componentIndexValid) {
+      m_componentIndex.remove(m_componentIds.at(current));
+    }
+    m_componentIds[current] = 0;
+    m_childRows.remove(current);
+    m_freeNodes.append(current);
+    --m_liveCount;
+  }
+}
+
+const QVector<qint32> &ProjectTree::childRows(int node) const {
+  QHash<qint32, QVector<qint32>>::iterator it = m_childRows.find(node);
+  if (it == m_childRows.end()) {
+    QVector<qint32> rows;
+    rows.reserve(m_nodes.at(node).childCount);
+    for (int child = m_nodes.at(node).firstChild; child >= 0;
+         child = m_nodes.at(child).nextSibling) {
+      m_rows[child] = rows.size();
+      rows.append(child);
+    }
+    it = m_childRows.insert(node, rows);
+  }
+  return it.value();
+}
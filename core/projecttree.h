@@ -0,0 +1,127 @@
+#ifndef PROJECTTREE_H
+#define PROJECTTREE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// 项目树的紧凑存储
+//
+// 所有节点保存在连续数组中，节点之间通过下标(父节点、首个/末个子节点、
+// 前后兄弟节点)相连。名称和类型都以编号形式保存，相同的字符串只存一份。
+// 该类不依赖任何 QObject，可以在工作线程中构建后整体交给 ProjectModel。
+class ProjectTree {
+public:
+  ProjectTree();
+
+  void clear();
+  void reserve(int nodeCount);
+
+  bool isEmpty() const;
+  int rootNode() const;
+  int nodeCount() const;
+  // 节点数组的长度，遍历时需要用 isValidNode 跳过已释放的节点
+  int capacity() const;
+  bool isValidNode(int node) const;
+
+  // 结构访问
+  int parentNode(int node) const;
+  int firstChild(int node) const;
+  int nextSibling(int node) const;
+  int childCount(int node) const;
+  int childAt(int node, int row) const;
+  int rowOf(int node) const;
+
+  // 节点属性
+  QString name(int node) const;
+  QString type(int node) const;
+  quint32 nameId(int node) const;
+  quint16 typeId(int node) const;
+  QByteArray config(int node) const;
+
+  // 组件编号在项目内唯一且保存在项目文件中，节点被移动或重建后保持不变。
+  // setComponentId() 在编号为 0 或已被其他节点使用时返回 false，不做修改
+  quint64 componentId(int node) const;
+  bool setComponentId(int node, quint64 id);
+  int nodeForComponentId(quint64 id) const;
+
+  // 字符串表。重命名和删除节点后旧名称仍留在表中，compactStrings() 只保留
+  // 有效节点引用的名称并重新编号，之前取得的名称编号随之失效
+  quint32 internString(const QString &value);
+  quint16 internType(const QString &type);
+  QString stringAt(quint32 id) const;
+  QString typeAt(quint16 id) const;
+  int typeCount() const;
+  void compactStrings();
+
+  // 结构修改，row 为 -1 时追加到末尾
+  int createRoot(const QString &name);
+  int insertNode(int parent, int row, const QString &name,
+                 const QString &type, const QByteArray &config = QByteArray());
+  int appendNode(int parent, const QString &name, const QString &type,
+                 const QByteArray &config = QByteArray());
+  // 插入到 parent 下、before 节点之前，before 为 -1 时追加到末尾。
+  // 不需要按行号定位，批量插入时每个节点的开销是常数。
+  int insertNodeBefore(int parent, int before, const QString &name,
+                       const QString &type,
+                       const QByteArray &config = QByteArray());
+  // 按已登记的字符串编号追加节点，批量加载时避免重复查表
+  int appendNode(int parent, quint32 nameId, quint16 typeId,
+                 const QByteArray &config = QByteArray());
+  void removeNode(int node);
+  // 将节点连同子树移动到 newParent 的第 row 个位置(不计节点自身)
+  void moveNode(int node, int newParent, int row);
+  // 将节点连同子树移动到 newParent 下、before 节点之前，before 为 -1 时
+  // 追加到末尾。只修改相邻节点的链接，不需要计算行号。
+  void moveNodeBefore(int node, int newParent, int before);
+
+  // 无人引用的名称超过有效节点数时自动压缩字符串表
+  void setName(int node, const QString &name);
+  void setConfig(int node, const QByteArray &config);
+
+private:
+  enum NodeFlag { FreeNode = 0x1 };
+
+  struct Node {
+    qint32 parent;
+    qint32 firstChild;
+    qint32 lastChild;
+    qint32 prevSibling;
+    qint32 nextSibling;
+    qint32 childCount;
+    quint32 nameId;
+    quint16 typeId;
+    quint16 flags;
+  };
+
+  int allocateNode(quint32 nameId, quint16 typeId, const QByteArray &config);
+  void linkNode(int parent, int node, int row);
+  void linkNodeBefore(int parent, int node, int next);
+  void unlinkNode(int node);
+  void freeSubtree(int node);
+  const QVector<qint32> &childRows(int node) const;
+
+  QVector<Node> m_nodes;
+  QVector<QByteArray> m_configs;
+  QVector<quint64> m_componentIds;
+  quint64 m_nextComponentId;
+  QVector<qint32> m_freeNodes;
+  int m_root;
+  int m_liveCount;
+
+  QVector<QString> m_strings;
+  QHash<QString, quint32> m_stringIds;
+  QVector<QString> m_types;
+  QHash<QString, quint16> m_typeIds;
+
+  // 按需建立的子节点行号缓存，父节点的子节点变化时失效
+  mutable QHash<qint32, QVector<qint32>> m_childRows;
+  mutable QVector<qint32> m_rows;
+
+  // 按需建立的组件编号索引，建立后随节点分配和释放同步更新
+  mutable QHash<quint64, qint32> m_componentIndex;
+  mutable bool m_componentIndexValid;
+};
+
+#endif // PROJECTTREE_H
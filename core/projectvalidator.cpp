@@ -0,0 +1,445 @@
+#include "projectvalidator.h"
+#include "dimodule.h"
+#include "domodule.h"
+#include "hostmodule.h"
+#include "loopmodule.h"
+#include <QtConcurrent>
+
+template <typename Module>
+void ProjectValidator::collectBitVariables(quint64 id, Module *module,
+                                           QVector<VariableEntry> *variables) {
+  // DI/DO 模块的位结构相同
+  for (int channel = 0; channel < module->getChannelCount(); ++channel) {
+    for (int bit = 0; bit < 8; ++bit) {
+      auto variable = module->getBitVariable(channel, bit);
+      if (variable.name.isEmpty()) {
+        continue;
+      }
+      VariableEntry entry;
+      entry.key = qMakePair(variable.isGlobal ? quint64(0) : id, variable.name);
+      entry.location = {id, channel, bit};
+      variables->append(entry);
+    }
+  }
+}
+
+ProjectValidator::ProjectValidator(ProjectModel *model,
+                                   ModuleRegistry *registry, QObject *parent)
+    : QObject(parent), m_model(model), m_registry(registry),
+      m_addressProblemCount(0), m_fullValidationPending(false) {
+  m_flushTimer.setSingleShot(true);
+  m_flushTimer.setInterval(0);
+  connect(&m_flushTimer, &QTimer::timeout, this,
+          &ProjectValidator::flushPendingComponents);
+  connect(&m_watcher, &QFutureWatcher<ComponentFacts>::finished, this,
+          &ProjectValidator::onFullValidationFinished);
+
+  connect(m_model, &QAbstractItemModel::modelReset, this,
+          &ProjectValidator::revalidateAll);
+  connect(m_model, &QAbstractItemModel::rowsInserted, this,
+          &ProjectValidator::onRowsInserted);
+  connect(m_model, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+          &ProjectValidator::onRowsAboutToBeRemoved);
+  connect(m_model, &QAbstractItemModel::dataChanged, this,
+          &ProjectValidator::onDataChanged);
+  connect(m_registry, &ModuleRegistry::moduleChanged, this,
+          &ProjectValidator::invalidateComponent);
+
+  revalidateAll();
+}
+
+ProjectValidator::~ProjectValidator() {
+  m_watcher.cancel();
+  m_watcher.waitForFinished();
+}
+
+QVector<ValidationProblem> ProjectValidator::problems() const {
+  QVector<ValidationProblem> result;
+  result.reserve(problemCount());
+
+  for (const ComponentFacts &facts : m_facts) {
+    result += facts.addressProblems;
+  }
+
+  for (const VariableKey &key : m_conflictingVariables) {
+    ValidationProblem problem;
+    problem.kind = ValidationProblem::DuplicateVariableName;
+    problem.value = key.second;
+    problem.locations = m_variables.value(key);
+    result.append(problem);
+  }
+
+  for (const QString &ip : m_conflictingIps) {
+    ValidationProblem problem;
+    problem.kind = ValidationProblem::DuplicateHostIp;
+    problem.value = ip;
+    for (quint64 id : m_hostIps.value(ip)) {
+      ComponentLocation location = {id, -1, -1};
+      problem.locations.append(location);
+    }
+    result.append(problem);
+  }
+
+  return result;
+}
+
+int ProjectValidator::problemCount() const {
+  return m_addressProblemCount + m_conflictingVariables.size() +
+         m_conflictingIps.size();
+}
+
+QString ProjectValidator::describe(const ValidationProblem &problem) const {
+  QStringList names;
+  for (const ComponentLocation &location : problem.locations) {
+    QString name =
+        m_model->nodeName(m_model->indexForComponentId(location.componentId));
+    if (!names.contains(name)) {
+      names.append(name);
+    }
+  }
+
+  switch (problem.kind) {
+  case ValidationProblem::DuplicateLoopAddress:
+    return QString("%1 通道 %2 的地址 %3 被 %4 个设备使用")
+        .arg(names.join("、"))
+        .arg(problem.locations.first().channel + 1)
+        .arg(problem.value)
+        .arg(problem.locations.size());
+  case ValidationProblem::DuplicateVariableName:
+    return QString("变量名 \"%1\" 重复 (%2)")
+        .arg(problem.value)
+        .arg(names.join("、"));
+  case ValidationProblem::DuplicateHostIp:
+    return QString("IP 地址 %1 重复 (%2)")
+        .arg(problem.value)
+        .arg(names.join("、"));
+  }
+  return QString();
+}
+
+bool ProjectValidator::isValidating() const { return m_watcher.isRunning(); }
+
+const SymbolIndex &ProjectValidator::symbolIndex() const {
+  return m_symbolIndex;
+}
+
+void ProjectValidator::revalidateAll() {
+  m_watcher.cancel();
+  m_watcher.waitForFinished();
+  m_pendingIds.clear();
+  m_flushTimer.stop();
+
+  // 已创建的模块可能有尚未写回的修改，在主线程中直接读取模块；
+  // 其余组件只复制配置段，交给工作线程解析
+  QVector<ComponentSource> sources;
+  m_loadedFacts.clear();
+  const ProjectTree &tree = m_model->tree();
+  QVector<int> stack;
+  if (!tree.isEmpty()) {
+    stack.append(tree.rootNode());
+  }
+  while (!stack.isEmpty()) {
+    int node = stack.takeLast();
+    for (int child = tree.firstChild(node); child >= 0;
+         child = tree.nextSibling(child)) {
+      stack.append(child);
+    }
+
+    QString type = tree.type(node);
+    if (!ModuleRegistry::supportsType(type)) {
+      continue;
+    }
+    quint64 id = tree.componentId(node);
+    if (QObject *module = m_registry->module(id)) {
+      m_loadedFacts.append(factsFromModule(id, module));
+    } else {
+      ComponentSource source = {id, type, tree.config(node)};
+      sources.append(source);
+    }
+  }
+
+  m_fullValidationPending = true;
+  m_watcher.setFuture(QtConcurrent::mapped(sources, factsFromSource));
+}
+
+void ProjectValidator::validateNow() {
+  if (!m_fullValidationPending) {
+    revalidateAll();
+  }
+  m_watcher.waitForFinished();
+  onFullValidationFinished();
+}
+
+void ProjectValidator::invalidateComponent(quint64 id) {
+  m_pendingIds.insert(id);
+  // 全量校验结束时会统一处理
+  if (!m_watcher.isRunning()) {
+    m_flushTimer.start();
+  }
+}
+
+void ProjectValidator::onRowsInserted(const QModelIndex &parent, int first,
+                                      int last) {
+  for (int row = first; row <= last; ++row) {
+    QVector<quint64> ids;
+    collectSubtree(m_model->nodeForIndex(m_model->index(row, 0, parent)),
+                   &ids);
+    for (quint64 id : ids) {
+      invalidateComponent(id);
+    }
+  }
+}
+
+void ProjectValidator::onRowsAboutToBeRemoved(const QModelIndex &parent,
+                                              int first, int last) {
+  // 节点删除后就无法再找到子树中的组件，先记下编号
+  for (int row = first; row <= last; ++row) {
+    QVector<quint64> ids;
+    collectSubtree(m_model->nodeForIndex(m_model->index(row, 0, parent)),
+                   &ids);
+    for (quint64 id : ids) {
+      invalidateComponent(id);
+    }
+  }
+}
+
+void ProjectValidator::onDataChanged(const QModelIndex &topLeft,
+                                     const QModelIndex &bottomRight,
+                                     const QVector<int> &roles) {
+  Q_UNUSED(bottomRight);
+  if (roles.contains(ProjectModel::ComponentIdRole)) {
+    // 编号变化后旧编号下的校验键无法对应，重新全量校验
+    revalidateAll();
+  } else if (roles.isEmpty() || roles.contains(ProjectModel::ConfigRole)) {
+    invalidateComponent(m_model->componentId(topLeft));
+  }
+}
+
+void ProjectValidator::onFullValidationFinished() {
+  // validateNow() 已经合并过的结果不再重复处理
+  if (m_watcher.isCanceled() || !m_fullValidationPending) {
+    return;
+  }
+  m_fullValidationPending = false;
+
+  m_facts.clear();
+  m_variables.clear();
+  m_hostIps.clear();
+  m_conflictingVariables.clear();
+  m_conflictingIps.clear();
+  m_addressProblemCount = 0;
+  m_symbolIndex.clear();
+
+  for (const ComponentFacts &facts : m_loadedFacts) {
+    addFacts(facts);
+  }
+  m_loadedFacts.clear();
+
+  const QFuture<ComponentFacts> future = m_watcher.future();
+  for (int i = 0; i < future.resultCount(); ++i) {
+    addFacts(future.resultAt(i));
+  }
+
+  // 校验期间发生的修改
+  for (quint64 id : m_pendingIds) {
+    updateComponentNow(id);
+  }
+  m_pendingIds.clear();
+
+  emit problemsChanged();
+}
+
+void ProjectValidator::flushPendingComponents() {
+  if (m_pendingIds.isEmpty() || m_watcher.isRunning()) {
+    return;
+  }
+
+  QSet<quint64> ids;
+  ids.swap(m_pendingIds);
+  for (quint64 id : ids) {
+    updateComponentNow(id);
+  }
+  emit problemsChanged();
+}
+
+ProjectValidator::ComponentFacts
+ProjectValidator::factsFromSource(const ComponentSource &source) {
+  // 工作线程中临时创建模块来解析配置段，与界面使用的解析逻辑一致
+  QObject *module = ModuleRegistry::createModule(source.type, source.config);
+  ComponentFacts facts = factsFromModule(source.componentId, module);
+  delete module;
+  return facts;
+}
+
+ProjectValidator::ComponentFacts
+ProjectValidator::factsFromModule(quint64 id, QObject *module) {
+  ComponentFacts facts;
+  facts.componentId = id;
+
+  if (LoopModule *loopModule = qobject_cast<LoopModule *>(module)) {
+    for (int channel = 0; channel < loopModule->getChannelCount(); ++channel) {
+      const LoopChannelDevices &devices = loopModule->channelDevices(channel);
+
+      // 只为重复的地址记录全部行号
+      QHash<int, int> firstRows;
+      QHash<int, QVector<int>> duplicateRows;
+      firstRows.reserve(devices.size());
+      for (int row = 0; row < devices.size(); ++row) {
+        int address = devices.address(row);
+        QHash<int, int>::const_iterator it = firstRows.constFind(address);
+        if (it == firstRows.constEnd()) {
+          firstRows.insert(address, row);
+        } else {
+          QVector<int> &rows = duplicateRows[address];
+          if (rows.isEmpty()) {
+            rows.append(it.value());
+          }
+          rows.append(row);
+        }
+
+        // 回路设备的变量名都是全局的
+        if (!devices.variableName(row).isEmpty()) {
+          VariableEntry entry;
+          entry.key = qMakePair(quint64(0), devices.variableName(row));
+          entry.location = {id, channel, row};
+          facts.variables.append(entry);
+        }
+      }
+
+      for (auto it = duplicateRows.constBegin();
+           it != duplicateRows.constEnd(); ++it) {
+        ValidationProblem problem;
+        problem.kind = ValidationProblem::DuplicateLoopAddress;
+        problem.value = QString::number(it.key());
+        for (int row : it.value()) {
+          ComponentLocation location = {id, channel, row};
+          problem.locations.append(location);
+        }
+        facts.addressProblems.append(problem);
+      }
+    }
+    return facts;
+  }
+
+  if (DIModule *diModule = qobject_cast<DIModule *>(module)) {
+    collectBitVariables(id, diModule, &facts.variables);
+  } else if (DOModule *doModule = qobject_cast<DOModule *>(module)) {
+    collectBitVariables(id, doModule, &facts.variables);
+  } else if (HostModule *hostModule = qobject_cast<HostModule *>(module)) {
+    HostConfiguration config = hostModule->getConfiguration();
+    // 启用 DHCP 的主机不使用配置的地址
+    if (!config.dhcpEnabled && !config.ipAddress.isEmpty()) {
+      facts.hostIp = config.ipAddress.trimmed();
+    }
+  }
+  return facts;
+}
+
+void ProjectValidator::collectSubtree(int node, QVector<quint64> *ids) const {
+  const ProjectTree &tree = m_model->tree();
+  if (!tree.isValidNode(node)) {
+    return;
+  }
+
+  QVector<int> stack;
+  stack.append(node);
+  while (!stack.isEmpty()) {
+    int current = stack.takeLast();
+    if (ModuleRegistry::supportsType(tree.type(current))) {
+      ids->append(tree.componentId(current));
+    }
+    for (int child = tree.firstChild(current); child >= 0;
+         child = tree.nextSibling(child)) {
+      stack.append(child);
+    }
+  }
+}
+
+void ProjectValidator::removeFacts(quint64 id) {
+  QHash<quint64, ComponentFacts>::iterator it = m_facts.find(id);
+  if (it == m_facts.end()) {
+    return;
+  }
+
+  const ComponentFacts &facts = it.value();
+  m_addressProblemCount -= facts.addressProblems.size();
+
+  for (const VariableEntry &entry : facts.variables) {
+    m_symbolIndex.removeSymbol(entry.key.second, id);
+
+    QHash<VariableKey, QVector<ComponentLocation>>::iterator locations =
+        m_variables.find(entry.key);
+    if (locations == m_variables.end()) {
+      // 同一组件中的重名变量已在前面一并移除
+      continue;
+    }
+
+    QVector<ComponentLocation> &list = locations.value();
+    for (int i = list.size() - 1; i >= 0; --i) {
+      if (list.at(i).componentId == id) {
+        list.remove(i);
+      }
+    }
+    if (list.size() <= 1) {
+      m_conflictingVariables.remove(entry.key);
+    }
+    if (list.isEmpty()) {
+      m_variables.erase(locations);
+    }
+  }
+
+  if (!facts.hostIp.isEmpty()) {
+    QVector<quint64> &hosts = m_hostIps[facts.hostIp];
+    hosts.removeAll(id);
+    if (hosts.size() <= 1) {
+      m_conflictingIps.remove(facts.hostIp);
+    }
+    if (hosts.isEmpty()) {
+      m_hostIps.remove(facts.hostIp);
+    }
+  }
+
+  m_facts.erase(it);
+}
+
+void ProjectValidator::addFacts(const ComponentFacts &facts) {
+  m_addressProblemCount += facts.addressProblems.size();
+
+  for (const VariableEntry &entry : facts.variables) {
+    m_symbolIndex.addSymbol(entry.key.second, entry.location);
+
+    QVector<ComponentLocation> &list = m_variables[entry.key];
+    list.append(entry.location);
+    if (list.size() > 1) {
+      m_conflictingVariables.insert(entry.key);
+    }
+  }
+
+  if (!facts.hostIp.isEmpty()) {
+    QVector<quint64> &hosts = m_hostIps[facts.hostIp];
+    hosts.append(facts.componentId);
+    if (hosts.size() > 1) {
+      m_conflictingIps.insert(facts.hostIp);
+    }
+  }
+
+  m_facts.insert(facts.componentId, facts);
+}
+
+void ProjectValidator::updateComponentNow(quint64 id) {
+  removeFacts(id);
+
+  QModelIndex index = m_model->indexForComponentId(id);
+  if (!index.isValid()) {
+    // 组件已删除
+    return;
+  }
+
+  if (QObject *module = m_registry->module(id)) {
+    addFacts(factsFromModule(id, module));
+  } else {
+    ComponentSource source = {id, m_model->nodeType(index),
+                              m_model->nodeConfig(index)};
+    addFacts(factsFromSource(source));
+  }
+}
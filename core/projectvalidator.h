@@ -0,0 +1,125 @@
+#ifndef PROJECTVALIDATOR_H
+#define PROJECTVALIDATOR_H
+
+#include "moduleregistry.h"
+#include "projectmodel.h"
+#include "symbolindex.h"
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+// 一条校验问题，locations 中是互相冲突的全部位置
+struct ValidationProblem {
+  enum Kind { DuplicateLoopAddress, DuplicateVariableName, DuplicateHostIp };
+
+  Kind kind;
+  QString value; // 冲突的地址、变量名或 IP 地址
+  QVector<ComponentLocation> locations;
+};
+
+// 项目校验服务
+//
+// 检查同一回路通道内的设备地址、变量名(全局变量在全项目内、局部变量在
+// 模块内)以及主机 IP 地址是否重复。每个组件的校验键记录在哈希索引中，
+// 组件修改后只重新提取该组件的键并复查受影响的键；加载项目后的全量校验
+// 在线程池中并行解析各组件的配置段。
+class ProjectValidator : public QObject {
+  Q_OBJECT
+
+public:
+  ProjectValidator(ProjectModel *model, ModuleRegistry *registry,
+                   QObject *parent = nullptr);
+  ~ProjectValidator();
+
+  QVector<ValidationProblem> problems() const;
+  int problemCount() const;
+  QString describe(const ValidationProblem &problem) const;
+
+  // 全量校验是否正在后台进行
+  bool isValidating() const;
+  // 等待全量校验完成并立即更新结果，用于没有事件循环的命令行工具
+  void validateNow();
+
+  // 项目中全部变量名(含局部变量)的索引，随校验结果一起更新
+  const SymbolIndex &symbolIndex() const;
+
+public slots:
+  // 在后台重新校验整个项目
+  void revalidateAll();
+  // 组件配置或模块发生变化后调用，稍后合并处理
+  void invalidateComponent(quint64 id);
+
+signals:
+  void problemsChanged();
+
+private slots:
+  void onRowsInserted(const QModelIndex &parent, int first, int last);
+  void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+  void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                     const QVector<int> &roles);
+  void onFullValidationFinished();
+  void flushPendingComponents();
+
+private:
+  // 变量名的作用域：0 表示全局，否则为所属组件编号
+  typedef QPair<quint64, QString> VariableKey;
+
+  struct VariableEntry {
+    VariableKey key;
+    ComponentLocation location;
+  };
+
+  // 从一个组件中提取的校验键
+  struct ComponentFacts {
+    quint64 componentId;
+    // 地址冲突只发生在同一组件内，提取时直接得出
+    QVector<ValidationProblem> addressProblems;
+    QVector<VariableEntry> variables;
+    QString hostIp;
+  };
+
+  // 全量校验时交给工作线程的配置段快照
+  struct ComponentSource {
+    quint64 componentId;
+    QString type;
+    QByteArray config;
+  };
+
+  static ComponentFacts factsFromSource(const ComponentSource &source);
+  static ComponentFacts factsFromModule(quint64 id, QObject *module);
+  template <typename Module>
+  static void collectBitVariables(quint64 id, Module *module,
+                                  QVector<VariableEntry> *variables);
+
+  void collectSubtree(int node, QVector<quint64> *ids) const;
+  void removeFacts(quint64 id);
+  void addFacts(const ComponentFacts &facts);
+  void updateComponentNow(quint64 id);
+
+  ProjectModel *m_model;
+  ModuleRegistry *m_registry;
+
+  QHash<quint64, ComponentFacts> m_facts;
+  QHash<VariableKey, QVector<ComponentLocation>> m_variables;
+  QHash<QString, QVector<quint64>> m_hostIps;
+  // 当前存在冲突的键
+  QSet<VariableKey> m_conflictingVariables;
+  QSet<QString> m_conflictingIps;
+  int m_addressProblemCount;
+  SymbolIndex m_symbolIndex;
+
+  QSet<quint64> m_pendingIds;
+  QTimer m_flushTimer;
+  QFutureWatcher<ComponentFacts> m_watcher;
+  // 全量校验的结果尚未合并
+  bool m_fullValidationPending;
+  // 全量校验期间已在主线程提取的组件(模块已创建)
+  QVector<ComponentFacts> m_loadedFacts;
+};
+
+#endif // PROJECTVALIDATOR_H
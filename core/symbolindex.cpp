@@ -0,0 +1,92 @@
+#include "symbolindex.h"
+#include <algorithm>
+
+SymbolIndex::SymbolIndex() : m_sortedValid(true) {}
+
+void SymbolIndex::clear() {
+  m_symbols.clear();
+  m_sortedNames.clear();
+  // 随后的批量添加不维护有序数组
+  m_sortedValid = false;
+}
+
+void SymbolIndex::addSymbol(const QString &name,
+                            const ComponentLocation &location) {
+  QVector<ComponentLocation> &list = m_symbols[name];
+  list.append(location);
+  if (list.size() > 1 || !m_sortedValid) {
+    return;
+  }
+
+  QVector<QString>::iterator it =
+      std::lower_bound(m_sortedNames.begin(), m_sortedNames.end(), name);
+  m_sortedNames.insert(it, name);
+}
+
+void SymbolIndex::removeSymbol(const QString &name, quint64 componentId) {
+  QHash<QString, QVector<ComponentLocation>>::iterator it =
+      m_symbols.find(name);
+  if (it == m_symbols.end()) {
+    return;
+  }
+
+  QVector<ComponentLocation> &list = it.value();
+  for (int i = list.size() - 1; i >= 0; --i) {
+    if (list.at(i).componentId == componentId) {
+      list.remove(i);
+    }
+  }
+  if (!list.isEmpty()) {
+    return;
+  }
+
+  m_symbols.erase(it);
+  if (m_sortedValid) {
+    QVector<QString>::iterator pos =
+        std::lower_bound(m_sortedNames.begin(), m_sortedNames.end(), name);
+    if (pos != m_sortedNames.end() && *pos == name) {
+      m_sortedNames.erase(pos);
+    }
+  }
+}
+
+bool SymbolIndex::contains(const QString &name) const {
+  return m_symbols.contains(name);
+}
+
+QVector<ComponentLocation> SymbolIndex::locations(const QString &name) const {
+  return m_symbols.value(name);
+}
+
+int SymbolIndex::symbolCount() const { return m_symbols.size(); }
+
+QStringList SymbolIndex::completions(const QString &prefix, int limit) const {
+  ensureSorted();
+
+  QStringList result;
+  QVector<QString>::const_iterator it = std::lower_bound(
+      m_sortedNames.constBegin(), m_sortedNames.constEnd(), prefix);
+  for (; it != m_sortedNames.constEnd() && result.size() < limit; ++it) {
+    if (!it->startsWith(prefix)) {
+      break;
+    }
+    result.append(*it);
+  }
+  return result;
+}
+
+void SymbolIndex::ensureSorted() const {
+  if (m_sortedValid) {
+    return;
+  }
+
+  m_sortedNames.clear();
+  m_sortedNames.reserve(m_symbols.size());
+  for (QHash<QString, QVector<ComponentLocation>>::const_iterator it =
+           m_symbols.constBegin();
+       it != m_symbols.constEnd(); ++it) {
+    m_sortedNames.append(it.key());
+  }
+  std::sort(m_sortedNames.begin(), m_sortedNames.end());
+  m_sortedValid = true;
+}
@@ -0,0 +1,46 @@
+#ifndef SYMBOLINDEX_H
+#define SYMBOLINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 组件内的一个位置
+struct ComponentLocation {
+  quint64 componentId;
+  int channel; // 通道号，主机为 -1
+  int index;   // 回路设备行号或 DI/DO 位号，主机为 -1
+};
+
+// 项目变量名索引
+//
+// 名称到位置的哈希表用于精确查找，另有一份有序的名称数组用于前缀查询
+// (二分查找定位后顺序读取)。单个符号的增删直接在有序数组中插入或删除；
+// 批量重建时先只写哈希表，首次查询时再整体排序。
+class SymbolIndex {
+public:
+  SymbolIndex();
+
+  void clear();
+  void addSymbol(const QString &name, const ComponentLocation &location);
+  // 删除组件在该名称下的全部位置
+  void removeSymbol(const QString &name, quint64 componentId);
+
+  bool contains(const QString &name) const;
+  QVector<ComponentLocation> locations(const QString &name) const;
+  // 不同名称的数量
+  int symbolCount() const;
+
+  // 按字典序返回以 prefix 开头的名称，最多 limit 个
+  QStringList completions(const QString &prefix, int limit) const;
+
+private:
+  void ensureSorted() const;
+
+  QHash<QString, QVector<ComponentLocation>> m_symbols;
+  mutable QVector<QString> m_sortedNames;
+  mutable bool m_sortedValid;
+};
+
+#endif // SYMBOLINDEX_H
@@ -0,0 +1,238 @@
+#include "undostack.h"
+
+namespace {
+// 默认保留的撤销历史大小
+const qint64 kDefaultMemoryLimit = 64 * 1024 * 1024;
+} // namespace
+
+UndoCommand::UndoCommand(const QString &text) : m_text(text) {}
+
+UndoCommand::~UndoCommand() {}
+
+QString UndoCommand::text() const { return m_text; }
+
+int UndoCommand::mergeId() const { return -1; }
+
+bool UndoCommand::mergeWith(const UndoCommand *other) {
+  Q_UNUSED(other);
+  return false;
+}
+
+// beginMacro() 与 endMacro() 之间的命令，按顺序重做、逆序撤销
+class UndoStack::MacroCommand : public UndoCommand {
+public:
+  explicit MacroCommand(const QString &text) : UndoCommand(text) {}
+  ~MacroCommand() { qDeleteAll(m_children); }
+
+  void append(UndoCommand *command) { m_children.append(command); }
+  bool isEmpty() const { return m_children.isEmpty(); }
+
+  void redo(UndoStack *stack) override {
+    for (UndoCommand *command : m_children) {
+      command->redo(stack);
+    }
+  }
+
+  void undo(UndoStack *stack) override {
+    for (int i = m_children.size() - 1; i >= 0; --i) {
+      m_children.at(i)->undo(stack);
+    }
+  }
+
+  qint64 memoryCost() const override {
+    qint64 cost = sizeof(*this);
+    for (UndoCommand *command : m_children) {
+      cost += command->memoryCost();
+    }
+    return cost;
+  }
+
+private:
+  QList<UndoCommand *> m_children;
+};
+
+UndoStack::UndoStack(ProjectModel *model, ModuleRegistry *registry,
+                     QObject *parent)
+    : QObject(parent), m_model(model), m_registry(registry), m_index(0),
+      m_memoryUsage(0), m_memoryLimit(kDefaultMemoryLimit),
+      m_applying(false) {}
+
+UndoStack::~UndoStack() {
+  qDeleteAll(m_macros);
+  qDeleteAll(m_commands);
+}
+
+ProjectModel *UndoStack::model() const { return m_model; }
+
+ModuleRegistry *UndoStack::registry() const { return m_registry; }
+
+QObject *UndoStack::module(quint64 componentId) const {
+  if (QObject *module = m_registry->module(componentId)) {
+    return module;
+  }
+  QModelIndex index = m_model->indexForComponentId(componentId);
+  if (!index.isValid()) {
+    return nullptr;
+  }
+  return m_registry->acquire(componentId, m_model->nodeType(index),
+                             m_model->nodeConfig(index),
+                             m_model->nodeName(index));
+}
+
+void UndoStack::releaseModules(const QModelIndex &index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  for (int row = 0; row < m_model->rowCount(index); ++row) {
+    releaseModules(m_model->index(row, 0, index));
+  }
+
+  quint64 id = m_model->componentId(index);
+  if (m_registry->isModified(id)) {
+    m_model->setNodeConfig(index, m_registry->configuration(id));
+    m_registry->clearModified(id);
+  }
+  m_registry->release(id);
+}
+
+void UndoStack::push(UndoCommand *command) {
+  m_applying = true;
+  command->redo(this);
+  m_applying = false;
+
+  if (!m_macros.isEmpty()) {
+    m_macros.last()->append(command);
+    return;
+  }
+  addCommand(command);
+  emit projectEdited();
+}
+
+void UndoStack::beginMacro(const QString &text) {
+  m_macros.append(new MacroCommand(text));
+}
+
+void UndoStack::endMacro() {
+  if (m_macros.isEmpty()) {
+    return;
+  }
+
+  MacroCommand *macro = m_macros.takeLast();
+  if (macro->isEmpty()) {
+    delete macro;
+    return;
+  }
+  if (!m_macros.isEmpty()) {
+    m_macros.last()->append(macro);
+    return;
+  }
+  addCommand(macro);
+  emit projectEdited();
+}
+
+bool UndoStack::canUndo() const { return m_macros.isEmpty() && m_index > 0; }
+
+bool UndoStack::canRedo() const {
+  return m_macros.isEmpty() && m_index < m_commands.size();
+}
+
+QString UndoStack::undoText() const {
+  return canUndo() ? m_commands.at(m_index - 1)->text() : QString();
+}
+
+QString UndoStack::redoText() const {
+  return canRedo() ? m_commands.at(m_index)->text() : QString();
+}
+
+bool UndoStack::isApplying() const { return m_applying; }
+
+void UndoStack::setMemoryLimit(qint64 bytes) {
+  m_memoryLimit = bytes;
+  trimToLimit();
+  emit stateChanged();
+}
+
+qint64 UndoStack::memoryLimit() const { return m_memoryLimit; }
+
+qint64 UndoStack::memoryUsage() const { return m_memoryUsage; }
+
+void UndoStack::undo() {
+  if (!canUndo()) {
+    return;
+  }
+
+  --m_index;
+  m_applying = true;
+  m_commands.at(m_index)->undo(this);
+  m_applying = false;
+  emit stateChanged();
+  emit projectEdited();
+}
+
+void UndoStack::redo() {
+  if (!canRedo()) {
+    return;
+  }
+
+  m_applying = true;
+  m_commands.at(m_index)->redo(this);
+  m_applying = false;
+  ++m_index;
+  emit stateChanged();
+  emit projectEdited();
+}
+
+void UndoStack::clear() {
+  qDeleteAll(m_macros);
+  m_macros.clear();
+  qDeleteAll(m_commands);
+  m_commands.clear();
+  m_costs.clear();
+  m_index = 0;
+  m_memoryUsage = 0;
+  emit stateChanged();
+}
+
+void UndoStack::addCommand(UndoCommand *command) {
+  discardRedoCommands();
+
+  // 与栈顶的同类命令合并，例如连续编辑同一个单元格
+  if (m_index > 0 && command->mergeId() != -1) {
+    UndoCommand *top = m_commands.at(m_index - 1);
+    if (top->mergeId() == command->mergeId() && top->mergeWith(command)) {
+      delete command;
+      qint64 cost = top->memoryCost();
+      m_memoryUsage += cost - m_costs.at(m_index - 1);
+      m_costs[m_index - 1] = cost;
+      trimToLimit();
+      emit stateChanged();
+      return;
+    }
+  }
+
+  qint64 cost = command->memoryCost();
+  m_commands.append(command);
+  m_costs.append(cost);
+  m_memoryUsage += cost;
+  ++m_index;
+  trimToLimit();
+  emit stateChanged();
+}
+
+void UndoStack::discardRedoCommands() {
+  while (m_commands.size() > m_index) {
+    m_memoryUsage -= m_costs.takeLast();
+    delete m_commands.takeLast();
+  }
+}
+
+void UndoStack::trimToLimit() {
+  // 最近的一条命令总是保留，即使它本身超过上限
+  while (m_memoryUsage > m_memoryLimit && m_commands.size() > 1 &&
+         m_index > 1) {
+    m_memoryUsage -= m_costs.takeFirst();
+    delete m_commands.takeFirst();
+    --m_index;
+  }
+}
@@ -0,0 +1,106 @@
+#ifndef UNDOSTACK_H
+#define UNDOSTACK_H
+
+#include "moduleregistry.h"
+#include "projectmodel.h"
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class UndoStack;
+
+// 可撤销的编辑命令
+//
+// 命令只保存修改前后发生变化的部分，组件和模块都按组件编号查找，
+// 模块被释放或重新创建后命令仍然有效。
+class UndoCommand {
+public:
+  explicit UndoCommand(const QString &text);
+  virtual ~UndoCommand();
+
+  QString text() const;
+
+  virtual void redo(UndoStack *stack) = 0;
+  virtual void undo(UndoStack *stack) = 0;
+
+  // 命令占用内存的估计值(字节)，用于限制撤销历史的总大小
+  virtual qint64 memoryCost() const = 0;
+
+  // 连续的同类编辑可以合并为一条命令，mergeId 为 -1 时不合并。
+  // 返回 true 表示 other 的修改已并入本命令，other 随后被删除。
+  virtual int mergeId() const;
+  virtual bool mergeWith(const UndoCommand *other);
+
+private:
+  QString m_text;
+};
+
+// 项目的撤销栈
+//
+// 历史中命令的总内存超过上限时从最早的命令开始丢弃；beginMacro() 与
+// endMacro() 之间压入的命令合并为一步撤销。项目被替换时应调用 clear()。
+class UndoStack : public QObject {
+  Q_OBJECT
+
+public:
+  UndoStack(ProjectModel *model, ModuleRegistry *registry,
+            QObject *parent = nullptr);
+  ~UndoStack();
+
+  ProjectModel *model() const;
+  ModuleRegistry *registry() const;
+  // 组件对应的模块，尚未创建时按保存的配置段创建
+  QObject *module(quint64 componentId) const;
+  // 写回节点及其子节点中修改过的模块配置并释放模块
+  void releaseModules(const QModelIndex &index);
+
+  // 执行命令并压入撤销栈，栈取得命令的所有权
+  void push(UndoCommand *command);
+  void beginMacro(const QString &text);
+  void endMacro();
+
+  bool canUndo() const;
+  bool canRedo() const;
+  QString undoText() const;
+  QString redoText() const;
+  // 正在执行撤销或重做，编辑界面据此区分用户操作
+  bool isApplying() const;
+
+  void setMemoryLimit(qint64 bytes);
+  qint64 memoryLimit() const;
+  qint64 memoryUsage() const;
+
+public slots:
+  void undo();
+  void redo();
+  void clear();
+
+signals:
+  // 撤销栈的内容或位置发生变化
+  void stateChanged();
+  // 压入、撤销或重做了一条命令，项目内容已被修改
+  void projectEdited();
+
+private:
+  class MacroCommand;
+
+  void addCommand(UndoCommand *command);
+  void discardRedoCommands();
+  void trimToLimit();
+
+  ProjectModel *m_model;
+  ModuleRegistry *m_registry;
+
+  QList<UndoCommand *> m_commands;
+  QList<qint64> m_costs;
+  // 下一条可重做命令的位置，之前的命令都可以撤销
+  int m_index;
+  qint64 m_memoryUsage;
+  qint64 m_memoryLimit;
+  bool m_applying;
+
+  // 正在记录的组合命令，可以嵌套
+  QList<MacroCommand *> m_macros;
+};
+
+#endif // UNDOSTACK_H